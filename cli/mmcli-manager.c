@@ -57,6 +57,7 @@ static gboolean monitor_modems_flag;
 static gboolean scan_modems_flag;
 static gchar *set_logging_str;
 static gchar *inhibit_device_str;
+static gchar *get_log_history_str;
 static gchar *report_kernel_event_str;
 
 #if defined WITH_UDEV
@@ -88,6 +89,10 @@ static GOptionEntry entries[] = {
       "Inhibit device given a unique device identifier",
       "[UID]"
     },
+    { "get-log-history", 0, 0, G_OPTION_ARG_STRING, &get_log_history_str,
+      "Get the log history of the device given a unique device identifier",
+      "[UID]"
+    },
     { "report-kernel-event", 'K', 0, G_OPTION_ARG_STRING, &report_kernel_event_str,
       "Report kernel event",
       "[\"key=value,...\"]"
@@ -132,6 +137,7 @@ mmcli_manager_options_enabled (void)
                  scan_modems_flag +
                  !!set_logging_str +
                  !!inhibit_device_str +
+                 !!get_log_history_str +
                  !!report_kernel_event_str);
 
 #if defined WITH_UDEV
@@ -263,6 +269,36 @@ build_kernel_event_properties_from_input (const gchar *properties_string)
     return properties;
 }
 
+static void
+get_log_history_process_reply (gchar        **lines,
+                               const GError  *error)
+{
+    guint i;
+
+    if (!lines) {
+        g_printerr ("error: couldn't get log history: '%s'\n",
+                    error ? error->message : "unknown error");
+        exit (EXIT_FAILURE);
+    }
+
+    for (i = 0; lines[i]; i++)
+        g_print ("%s\n", lines[i]);
+    g_strfreev (lines);
+}
+
+static void
+get_log_history_ready (MMManager    *manager,
+                       GAsyncResult *result)
+{
+    gchar  **lines;
+    GError  *error = NULL;
+
+    lines = mm_manager_get_log_history_finish (manager, result, &error);
+    get_log_history_process_reply (lines, error);
+
+    mmcli_async_operation_done ();
+}
+
 static void
 set_logging_process_reply (gboolean      result,
                            const GError *error)
@@ -419,6 +455,16 @@ get_manager_ready (GObject      *source,
         return;
     }
 
+    /* Request to get log history? */
+    if (get_log_history_str) {
+        mm_manager_get_log_history (ctx->manager,
+                                    get_log_history_str,
+                                    ctx->cancellable,
+                                    (GAsyncReadyCallback)get_log_history_ready,
+                                    NULL);
+        return;
+    }
+
     /* Request to scan modems? */
     if (scan_modems_flag) {
         mm_manager_scan_devices (ctx->manager,
@@ -576,6 +622,18 @@ mmcli_manager_run_synchronous (GDBusConnection *connection)
         return;
     }
 
+    /* Request to get log history? */
+    if (get_log_history_str) {
+        gchar **lines;
+
+        lines = mm_manager_get_log_history_sync (ctx->manager,
+                                                 get_log_history_str,
+                                                 NULL,
+                                                 &error);
+        get_log_history_process_reply (lines, error);
+        return;
+    }
+
     /* Request to scan modems? */
     if (scan_modems_flag) {
         gboolean result;
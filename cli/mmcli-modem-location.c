@@ -55,6 +55,8 @@ static gboolean enable_gps_nmea_flag;
 static gboolean disable_gps_nmea_flag;
 static gboolean enable_gps_raw_flag;
 static gboolean disable_gps_raw_flag;
+static gboolean enable_gps_fix_flag;
+static gboolean disable_gps_fix_flag;
 static gboolean enable_cdma_bs_flag;
 static gboolean disable_cdma_bs_flag;
 static gboolean enable_gps_unmanaged_flag;
@@ -107,6 +109,14 @@ static GOptionEntry entries[] = {
       "Disable raw GPS location gathering.",
       NULL
     },
+    { "location-enable-gps-fix", 0, 0, G_OPTION_ARG_NONE, &enable_gps_fix_flag,
+      "Enable decoded GPS fix gathering.",
+      NULL
+    },
+    { "location-disable-gps-fix", 0, 0, G_OPTION_ARG_NONE, &disable_gps_fix_flag,
+      "Disable decoded GPS fix gathering.",
+      NULL
+    },
     { "location-enable-cdma-bs", 0, 0, G_OPTION_ARG_NONE, &enable_cdma_bs_flag,
       "Enable CDMA base station location gathering.",
       NULL
@@ -174,6 +184,7 @@ mmcli_modem_location_options_enabled (void)
         (enable_agps_flag && disable_agps_flag) ||
         (enable_gps_nmea_flag && disable_gps_nmea_flag) ||
         (enable_gps_raw_flag && disable_gps_raw_flag) ||
+        (enable_gps_fix_flag && disable_gps_fix_flag) ||
         (enable_gps_unmanaged_flag && disable_gps_unmanaged_flag) ||
         (enable_cdma_bs_flag && disable_cdma_bs_flag)) {
         g_printerr ("error: cannot enable and disable the same source\n");
@@ -194,6 +205,8 @@ mmcli_modem_location_options_enabled (void)
                     disable_gps_nmea_flag +
                     enable_gps_raw_flag +
                     disable_gps_raw_flag +
+                    enable_gps_fix_flag +
+                    disable_gps_fix_flag +
                     enable_cdma_bs_flag +
                     disable_cdma_bs_flag +
                     enable_gps_unmanaged_flag +
@@ -466,6 +479,11 @@ build_sources_from_flags (void)
     if (disable_gps_raw_flag)
         sources &= ~MM_MODEM_LOCATION_SOURCE_GPS_RAW;
 
+    if (enable_gps_fix_flag)
+        sources |= MM_MODEM_LOCATION_SOURCE_GPS_FIX;
+    if (disable_gps_fix_flag)
+        sources &= ~MM_MODEM_LOCATION_SOURCE_GPS_FIX;
+
     if (enable_cdma_bs_flag)
         sources |= MM_MODEM_LOCATION_SOURCE_CDMA_BS;
     if (disable_cdma_bs_flag)
@@ -605,6 +623,8 @@ get_modem_ready (GObject      *source,
         disable_gps_nmea_flag ||
         enable_gps_raw_flag ||
         disable_gps_raw_flag ||
+        enable_gps_fix_flag ||
+        disable_gps_fix_flag ||
         enable_cdma_bs_flag ||
         disable_cdma_bs_flag ||
         enable_gps_unmanaged_flag ||
@@ -735,6 +755,8 @@ mmcli_modem_location_run_synchronous (GDBusConnection *connection)
         disable_gps_nmea_flag ||
         enable_gps_raw_flag ||
         disable_gps_raw_flag ||
+        enable_gps_fix_flag ||
+        disable_gps_fix_flag ||
         enable_cdma_bs_flag ||
         disable_cdma_bs_flag ||
         enable_gps_unmanaged_flag ||
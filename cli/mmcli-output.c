@@ -222,6 +222,12 @@ static FieldInfo field_infos[] = {
     [MMC_F_BEARER_STATS_DURATION]             = { "bearer.stats.duration",                           "duration",                 MMC_S_BEARER_STATS,            },
     [MMC_F_BEARER_STATS_BYTES_RX]             = { "bearer.stats.bytes-rx",                           "bytes rx",                 MMC_S_BEARER_STATS,            },
     [MMC_F_BEARER_STATS_BYTES_TX]             = { "bearer.stats.bytes-tx",                           "bytes tx",                 MMC_S_BEARER_STATS,            },
+    [MMC_F_BEARER_STATS_RATE_RX]              = { "bearer.stats.rate-rx",                            "rate rx",                  MMC_S_BEARER_STATS,            },
+    [MMC_F_BEARER_STATS_RATE_TX]              = { "bearer.stats.rate-tx",                            "rate tx",                  MMC_S_BEARER_STATS,            },
+    [MMC_F_BEARER_STATS_PEAK_RATE_RX]         = { "bearer.stats.peak-rate-rx",                       "peak rate rx",             MMC_S_BEARER_STATS,            },
+    [MMC_F_BEARER_STATS_PEAK_RATE_TX]         = { "bearer.stats.peak-rate-tx",                       "peak rate tx",             MMC_S_BEARER_STATS,            },
+    [MMC_F_BEARER_STATS_ATTEMPTS]             = { "bearer.stats.attempts",                           "attempts",                 MMC_S_BEARER_STATS,            },
+    [MMC_F_BEARER_STATS_FAILED_ATTEMPTS]      = { "bearer.stats.failed-attempts",                    "failed attempts",          MMC_S_BEARER_STATS,            },
     [MMC_F_CALL_GENERAL_DBUS_PATH]            = { "call.dbus-path",                                  "dbus path",                MMC_S_CALL_GENERAL,            },
     [MMC_F_CALL_PROPERTIES_NUMBER]            = { "call.properties.number",                          "number",                   MMC_S_CALL_PROPERTIES,         },
     [MMC_F_CALL_PROPERTIES_DIRECTION]         = { "call.properties.direction",                       "direction",                MMC_S_CALL_PROPERTIES,         },
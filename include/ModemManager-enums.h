@@ -929,6 +929,7 @@ typedef enum { /*< underscore_name=mm_sms_cdma_service_category >*/
  * @MM_MODEM_LOCATION_SOURCE_CDMA_BS: CDMA base station position.
  * @MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED: No location given, just GPS module setup.
  * @MM_MODEM_LOCATION_SOURCE_AGPS: A-GPS location requested.
+ * @MM_MODEM_LOCATION_SOURCE_GPS_FIX: GPS fix decoded by the daemon, given as a packed binary structure.
  *
  * Sources of location information supported by the modem.
  */
@@ -940,6 +941,7 @@ typedef enum { /*< underscore_name=mm_modem_location_source >*/
     MM_MODEM_LOCATION_SOURCE_CDMA_BS       = 1 << 3,
     MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED = 1 << 4,
     MM_MODEM_LOCATION_SOURCE_AGPS          = 1 << 5,
+    MM_MODEM_LOCATION_SOURCE_GPS_FIX       = 1 << 6,
 } MMModemLocationSource;
 
 /**
@@ -207,4 +207,17 @@
  */
 #define ID_MM_TTY_FLOW_CONTROL "ID_MM_TTY_FLOW_CONTROL"
 
+/**
+ * ID_MM_PORT_AT_PIPELINE:
+ *
+ * This is a port-specific tag applied to AT ports that can receive new
+ * commands while still processing the previous ones, replying to each of
+ * them in order.
+ *
+ * When given, queued commands are sent to the port without waiting for the
+ * response to the previous one, reducing the number of round trips needed
+ * when several operations run at the same time.
+ */
+#define ID_MM_PORT_AT_PIPELINE "ID_MM_PORT_AT_PIPELINE"
+
 #endif /* MM_TAGS_H */
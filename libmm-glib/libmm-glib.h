@@ -70,6 +70,7 @@
 #include <mm-location-common.h>
 #include <mm-location-3gpp.h>
 #include <mm-location-gps-raw.h>
+#include <mm-location-gps-fix.h>
 #include <mm-location-gps-nmea.h>
 #include <mm-location-cdma-bs.h>
 #include <mm-unlock-retries.h>
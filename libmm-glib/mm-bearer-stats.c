@@ -37,11 +37,35 @@ G_DEFINE_TYPE (MMBearerStats, mm_bearer_stats, G_TYPE_OBJECT)
 #define PROPERTY_DURATION "duration"
 #define PROPERTY_RX_BYTES "rx-bytes"
 #define PROPERTY_TX_BYTES "tx-bytes"
+#define PROPERTY_RX_RATE "rx-rate"
+#define PROPERTY_TX_RATE "tx-rate"
+#define PROPERTY_PEAK_RX_RATE "peak-rx-rate"
+#define PROPERTY_PEAK_TX_RATE "peak-tx-rate"
+#define PROPERTY_ATTEMPTS "attempts"
+#define PROPERTY_FAILED_ATTEMPTS "failed-attempts"
+#define PROPERTY_SAMPLES "samples"
+
+typedef struct {
+    guint64 timestamp;
+    guint64 rx_bytes;
+    guint64 tx_bytes;
+} Sample;
 
 struct _MMBearerStatsPrivate {
     guint   duration;
     guint64 rx_bytes;
     guint64 tx_bytes;
+    guint64 rx_rate;
+    guint64 tx_rate;
+    guint64 peak_rx_rate;
+    guint64 peak_tx_rate;
+    guint   attempts;
+    guint   failed_attempts;
+    /* Ring of the most recent samples; once full, the oldest one is
+     * overwritten */
+    Sample  samples[MM_BEARER_STATS_MAX_SAMPLES];
+    guint   samples_first;
+    guint   n_samples;
 };
 
 /*****************************************************************************/
@@ -127,10 +151,259 @@ mm_bearer_stats_set_tx_bytes (MMBearerStats *self,
 
 /*****************************************************************************/
 
+/**
+ * mm_bearer_stats_get_rx_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the receive throughput between the two most recent samples, in bytes
+ * per second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_rx_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->rx_rate;
+}
+
+void
+mm_bearer_stats_set_rx_rate (MMBearerStats *self,
+                             guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->rx_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_tx_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the transmit throughput between the two most recent samples, in bytes
+ * per second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_tx_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->tx_rate;
+}
+
+void
+mm_bearer_stats_set_tx_rate (MMBearerStats *self,
+                             guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->tx_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_peak_rx_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the highest receive throughput seen in the connection, in bytes per
+ * second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_peak_rx_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->peak_rx_rate;
+}
+
+void
+mm_bearer_stats_set_peak_rx_rate (MMBearerStats *self,
+                                  guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->peak_rx_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_peak_tx_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the highest transmit throughput seen in the connection, in bytes per
+ * second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_peak_tx_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->peak_tx_rate;
+}
+
+void
+mm_bearer_stats_set_peak_tx_rate (MMBearerStats *self,
+                                  guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->peak_tx_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_attempts:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the number of connection attempts done with the bearer.
+ *
+ * Returns: a #guint.
+ */
+guint
+mm_bearer_stats_get_attempts (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->attempts;
+}
+
+void
+mm_bearer_stats_set_attempts (MMBearerStats *self,
+                              guint attempts)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->attempts = attempts;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_failed_attempts:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the number of connection attempts done with the bearer that failed.
+ *
+ * Returns: a #guint.
+ */
+guint
+mm_bearer_stats_get_failed_attempts (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->failed_attempts;
+}
+
+void
+mm_bearer_stats_set_failed_attempts (MMBearerStats *self,
+                                     guint failed_attempts)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->failed_attempts = failed_attempts;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_n_samples:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the number of traffic samples available, up to
+ * %MM_BEARER_STATS_MAX_SAMPLES.
+ *
+ * Returns: a #guint.
+ */
+guint
+mm_bearer_stats_get_n_samples (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->n_samples;
+}
+
+/**
+ * mm_bearer_stats_get_sample:
+ * @self: a #MMBearerStats.
+ * @i: index of the sample, 0 being the oldest one.
+ * @timestamp: (out) (allow-none): return location for the time of the
+ *  sample, in milliseconds since the connection was established.
+ * @rx_bytes: (out) (allow-none): return location for the bytes received up
+ *  to the sample.
+ * @tx_bytes: (out) (allow-none): return location for the bytes transmitted up
+ *  to the sample.
+ *
+ * Gets one of the most recent traffic samples of the connection.
+ *
+ * Returns: %TRUE if @i is a valid sample index, %FALSE otherwise.
+ */
+gboolean
+mm_bearer_stats_get_sample (MMBearerStats *self,
+                            guint i,
+                            guint64 *timestamp,
+                            guint64 *rx_bytes,
+                            guint64 *tx_bytes)
+{
+    Sample *sample;
+
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), FALSE);
+
+    if (i >= self->priv->n_samples)
+        return FALSE;
+
+    sample = &self->priv->samples[(self->priv->samples_first + i) % MM_BEARER_STATS_MAX_SAMPLES];
+    if (timestamp)
+        *timestamp = sample->timestamp;
+    if (rx_bytes)
+        *rx_bytes = sample->rx_bytes;
+    if (tx_bytes)
+        *tx_bytes = sample->tx_bytes;
+    return TRUE;
+}
+
+void
+mm_bearer_stats_add_sample (MMBearerStats *self,
+                            guint64 timestamp,
+                            guint64 rx_bytes,
+                            guint64 tx_bytes)
+{
+    Sample *sample;
+
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    if (self->priv->n_samples < MM_BEARER_STATS_MAX_SAMPLES) {
+        sample = &self->priv->samples[(self->priv->samples_first + self->priv->n_samples) % MM_BEARER_STATS_MAX_SAMPLES];
+        self->priv->n_samples++;
+    } else {
+        sample = &self->priv->samples[self->priv->samples_first];
+        self->priv->samples_first = (self->priv->samples_first + 1) % MM_BEARER_STATS_MAX_SAMPLES;
+    }
+
+    sample->timestamp = timestamp;
+    sample->rx_bytes = rx_bytes;
+    sample->tx_bytes = tx_bytes;
+}
+
+/*****************************************************************************/
+
 GVariant *
 mm_bearer_stats_get_dictionary (MMBearerStats *self)
 {
     GVariantBuilder builder;
+    GVariantBuilder samples;
+    guint i;
 
     /* We do allow self==NULL. We'll just report NULL. */
     if (!self)
@@ -149,6 +422,42 @@ mm_bearer_stats_get_dictionary (MMBearerStats *self)
                             "{sv}",
                             PROPERTY_TX_BYTES,
                             g_variant_new_uint64 (self->priv->tx_bytes));
+    g_variant_builder_add  (&builder,
+                            "{sv}",
+                            PROPERTY_RX_RATE,
+                            g_variant_new_uint64 (self->priv->rx_rate));
+    g_variant_builder_add  (&builder,
+                            "{sv}",
+                            PROPERTY_TX_RATE,
+                            g_variant_new_uint64 (self->priv->tx_rate));
+    g_variant_builder_add  (&builder,
+                            "{sv}",
+                            PROPERTY_PEAK_RX_RATE,
+                            g_variant_new_uint64 (self->priv->peak_rx_rate));
+    g_variant_builder_add  (&builder,
+                            "{sv}",
+                            PROPERTY_PEAK_TX_RATE,
+                            g_variant_new_uint64 (self->priv->peak_tx_rate));
+    g_variant_builder_add  (&builder,
+                            "{sv}",
+                            PROPERTY_ATTEMPTS,
+                            g_variant_new_uint32 (self->priv->attempts));
+    g_variant_builder_add  (&builder,
+                            "{sv}",
+                            PROPERTY_FAILED_ATTEMPTS,
+                            g_variant_new_uint32 (self->priv->failed_attempts));
+
+    g_variant_builder_init (&samples, G_VARIANT_TYPE ("a(ttt)"));
+    for (i = 0; i < self->priv->n_samples; i++) {
+        Sample *sample;
+
+        sample = &self->priv->samples[(self->priv->samples_first + i) % MM_BEARER_STATS_MAX_SAMPLES];
+        g_variant_builder_add (&samples, "(ttt)", sample->timestamp, sample->rx_bytes, sample->tx_bytes);
+    }
+    g_variant_builder_add  (&builder,
+                            "{sv}",
+                            PROPERTY_SAMPLES,
+                            g_variant_builder_end (&samples));
     return g_variant_builder_end (&builder);
 }
 
@@ -191,6 +500,40 @@ mm_bearer_stats_new_from_dictionary (GVariant *dictionary,
             mm_bearer_stats_set_tx_bytes (
                 self,
                 g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_RX_RATE)) {
+            mm_bearer_stats_set_rx_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_TX_RATE)) {
+            mm_bearer_stats_set_tx_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_PEAK_RX_RATE)) {
+            mm_bearer_stats_set_peak_rx_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_PEAK_TX_RATE)) {
+            mm_bearer_stats_set_peak_tx_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_ATTEMPTS)) {
+            mm_bearer_stats_set_attempts (
+                self,
+                g_variant_get_uint32 (value));
+        } else if (g_str_equal (key, PROPERTY_FAILED_ATTEMPTS)) {
+            mm_bearer_stats_set_failed_attempts (
+                self,
+                g_variant_get_uint32 (value));
+        } else if (g_str_equal (key, PROPERTY_SAMPLES) &&
+                   g_variant_is_of_type (value, G_VARIANT_TYPE ("a(ttt)"))) {
+            GVariantIter samples;
+            guint64 timestamp;
+            guint64 rx_bytes;
+            guint64 tx_bytes;
+
+            g_variant_iter_init (&samples, value);
+            while (g_variant_iter_next (&samples, "(ttt)", &timestamp, &rx_bytes, &tx_bytes))
+                mm_bearer_stats_add_sample (self, timestamp, rx_bytes, tx_bytes);
         }
         g_free (key);
         g_variant_unref (value);
@@ -61,9 +61,28 @@ GType mm_bearer_stats_get_type (void);
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMBearerStats, g_object_unref)
 #endif
 
-guint   mm_bearer_stats_get_duration (MMBearerStats *self);
-guint64 mm_bearer_stats_get_rx_bytes (MMBearerStats *self);
-guint64 mm_bearer_stats_get_tx_bytes (MMBearerStats *self);
+/**
+ * MM_BEARER_STATS_MAX_SAMPLES:
+ *
+ * Maximum number of throughput samples kept in a #MMBearerStats.
+ */
+#define MM_BEARER_STATS_MAX_SAMPLES 60
+
+guint   mm_bearer_stats_get_duration        (MMBearerStats *self);
+guint64 mm_bearer_stats_get_rx_bytes        (MMBearerStats *self);
+guint64 mm_bearer_stats_get_tx_bytes        (MMBearerStats *self);
+guint64 mm_bearer_stats_get_rx_rate         (MMBearerStats *self);
+guint64 mm_bearer_stats_get_tx_rate         (MMBearerStats *self);
+guint64 mm_bearer_stats_get_peak_rx_rate    (MMBearerStats *self);
+guint64 mm_bearer_stats_get_peak_tx_rate    (MMBearerStats *self);
+guint   mm_bearer_stats_get_attempts        (MMBearerStats *self);
+guint   mm_bearer_stats_get_failed_attempts (MMBearerStats *self);
+guint   mm_bearer_stats_get_n_samples       (MMBearerStats *self);
+gboolean mm_bearer_stats_get_sample         (MMBearerStats *self,
+                                             guint          i,
+                                             guint64       *timestamp,
+                                             guint64       *rx_bytes,
+                                             guint64       *tx_bytes);
 
 /*****************************************************************************/
 /* ModemManager/libmm-glib/mmcli specific methods */
@@ -79,6 +98,13 @@ MMBearerStats *mm_bearer_stats_new_from_dictionary (GVariant *dictionary,
 void mm_bearer_stats_set_duration (MMBearerStats *self, guint duration);
 void mm_bearer_stats_set_rx_bytes (MMBearerStats *self, guint64 rx_bytes);
 void mm_bearer_stats_set_tx_bytes (MMBearerStats *self, guint64 tx_bytes);
+void mm_bearer_stats_set_rx_rate (MMBearerStats *self, guint64 rx_rate);
+void mm_bearer_stats_set_tx_rate (MMBearerStats *self, guint64 tx_rate);
+void mm_bearer_stats_set_peak_rx_rate (MMBearerStats *self, guint64 peak_rx_rate);
+void mm_bearer_stats_set_peak_tx_rate (MMBearerStats *self, guint64 peak_tx_rate);
+void mm_bearer_stats_set_attempts (MMBearerStats *self, guint attempts);
+void mm_bearer_stats_set_failed_attempts (MMBearerStats *self, guint failed_attempts);
+void mm_bearer_stats_add_sample (MMBearerStats *self, guint64 timestamp, guint64 rx_bytes, guint64 tx_bytes);
 
 GVariant *mm_bearer_stats_get_dictionary (MMBearerStats *self);
 
@@ -45,4 +45,27 @@
  */
 #define MM_LOCATION_ALTITUDE_UNKNOWN  G_MINDOUBLE
 
+/**
+ * MM_LOCATION_SPEED_UNKNOWN:
+ *
+ * Identifier for an unknown speed value.
+ */
+#define MM_LOCATION_SPEED_UNKNOWN     G_MINDOUBLE
+
+/**
+ * MM_LOCATION_HEADING_UNKNOWN:
+ *
+ * Identifier for an unknown heading value.
+ *
+ * Proper heading values fall in the [0,360) range.
+ */
+#define MM_LOCATION_HEADING_UNKNOWN   G_MINDOUBLE
+
+/**
+ * MM_LOCATION_HDOP_UNKNOWN:
+ *
+ * Identifier for an unknown horizontal dilution of precision value.
+ */
+#define MM_LOCATION_HDOP_UNKNOWN      G_MINDOUBLE
+
 #endif /* MM_LOCATION_COMMON_H */
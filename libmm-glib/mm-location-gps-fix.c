@@ -0,0 +1,843 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <string.h>
+
+#include "mm-errors-types.h"
+#include "mm-location-gps-fix.h"
+
+/**
+ * SECTION: mm-location-gps-fix
+ * @title: MMLocationGpsFix
+ * @short_description: Helper object to handle decoded GPS fix information.
+ *
+ * The #MMLocationGpsFix is an object handling the location information of the
+ * modem when this is reported by GPS, decoded from the GGA, RMC, GSA and VTG
+ * NMEA traces by the daemon and transferred in a compact binary format.
+ *
+ * This object is retrieved with either mm_modem_location_get_gps_fix() or
+ * mm_modem_location_get_gps_fix_sync().
+ */
+
+G_DEFINE_TYPE (MMLocationGpsFix, mm_location_gps_fix, G_TYPE_OBJECT);
+
+/* Packed format, see the Location property documentation for the layout */
+#define FORMAT_VERSION 1
+#define FORMAT_SIZE    36
+
+#define KNOWN_TIMESTAMP (1 << 0)
+#define KNOWN_POSITION  (1 << 1)
+#define KNOWN_ALTITUDE  (1 << 2)
+#define KNOWN_SPEED     (1 << 3)
+#define KNOWN_HEADING   (1 << 4)
+#define KNOWN_HDOP      (1 << 5)
+
+#define DAY_MS (24 * 60 * 60 * 1000)
+
+/* Julian day number of 1970-01-01, as given by g_date_get_julian() */
+#define EPOCH_JULIAN_DAYS 719163
+
+struct _MMLocationGpsFixPrivate {
+    /* Whether any trace has been decoded */
+    gboolean valid;
+
+    /* Fix contents, in the units of the packed format */
+    guint8  known;
+    guint8  fix_quality;
+    guint8  fix_type;
+    guint8  n_satellites;
+    guint16 hdop;
+    gint64  timestamp;
+    gint32  latitude;
+    gint32  longitude;
+    gint32  altitude;
+    guint32 speed;
+    guint16 heading;
+
+    /* Start of the UTC day given in the last RMC trace, in ms since the
+     * epoch; or -1 if unknown */
+    gint64  date;
+};
+
+/*****************************************************************************/
+
+/**
+ * mm_location_gps_fix_get_timestamp:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the UTC time of the fix.
+ *
+ * Returns: the number of milliseconds since the epoch, or -1 if unknown.
+ */
+gint64
+mm_location_gps_fix_get_timestamp (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self), -1);
+
+    return ((self->priv->known & KNOWN_TIMESTAMP) ? self->priv->timestamp : -1);
+}
+
+/**
+ * mm_location_gps_fix_get_longitude:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the longitude, in the [-180,180] range.
+ *
+ * Returns: the longitude, or %MM_LOCATION_LONGITUDE_UNKNOWN if unknown.
+ */
+gdouble
+mm_location_gps_fix_get_longitude (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self),
+                          MM_LOCATION_LONGITUDE_UNKNOWN);
+
+    return ((self->priv->known & KNOWN_POSITION) ?
+            (self->priv->longitude / 1e7) :
+            MM_LOCATION_LONGITUDE_UNKNOWN);
+}
+
+/**
+ * mm_location_gps_fix_get_latitude:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the latitude, in the [-90,90] range.
+ *
+ * Returns: the latitude, or %MM_LOCATION_LATITUDE_UNKNOWN if unknown.
+ */
+gdouble
+mm_location_gps_fix_get_latitude (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self),
+                          MM_LOCATION_LATITUDE_UNKNOWN);
+
+    return ((self->priv->known & KNOWN_POSITION) ?
+            (self->priv->latitude / 1e7) :
+            MM_LOCATION_LATITUDE_UNKNOWN);
+}
+
+/**
+ * mm_location_gps_fix_get_altitude:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the altitude above sea level, in meters.
+ *
+ * Returns: the altitude, or %MM_LOCATION_ALTITUDE_UNKNOWN if unknown.
+ */
+gdouble
+mm_location_gps_fix_get_altitude (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self),
+                          MM_LOCATION_ALTITUDE_UNKNOWN);
+
+    return ((self->priv->known & KNOWN_ALTITUDE) ?
+            (self->priv->altitude / 1e3) :
+            MM_LOCATION_ALTITUDE_UNKNOWN);
+}
+
+/**
+ * mm_location_gps_fix_get_speed:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the speed over ground, in meters per second.
+ *
+ * Returns: the speed, or %MM_LOCATION_SPEED_UNKNOWN if unknown.
+ */
+gdouble
+mm_location_gps_fix_get_speed (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self),
+                          MM_LOCATION_SPEED_UNKNOWN);
+
+    return ((self->priv->known & KNOWN_SPEED) ?
+            (self->priv->speed / 1e3) :
+            MM_LOCATION_SPEED_UNKNOWN);
+}
+
+/**
+ * mm_location_gps_fix_get_heading:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the heading, in degrees from true north, in the [0,360) range.
+ *
+ * Returns: the heading, or %MM_LOCATION_HEADING_UNKNOWN if unknown.
+ */
+gdouble
+mm_location_gps_fix_get_heading (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self),
+                          MM_LOCATION_HEADING_UNKNOWN);
+
+    return ((self->priv->known & KNOWN_HEADING) ?
+            (self->priv->heading / 1e2) :
+            MM_LOCATION_HEADING_UNKNOWN);
+}
+
+/**
+ * mm_location_gps_fix_get_hdop:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the horizontal dilution of precision.
+ *
+ * Returns: the HDOP, or %MM_LOCATION_HDOP_UNKNOWN if unknown.
+ */
+gdouble
+mm_location_gps_fix_get_hdop (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self),
+                          MM_LOCATION_HDOP_UNKNOWN);
+
+    return ((self->priv->known & KNOWN_HDOP) ?
+            (self->priv->hdop / 1e2) :
+            MM_LOCATION_HDOP_UNKNOWN);
+}
+
+/**
+ * mm_location_gps_fix_get_n_satellites:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the number of satellites used in the fix.
+ *
+ * Returns: the number of satellites.
+ */
+guint
+mm_location_gps_fix_get_n_satellites (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self), 0);
+
+    return self->priv->n_satellites;
+}
+
+/**
+ * mm_location_gps_fix_get_fix_quality:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the quality of the fix, as given in the GGA traces: 0 if invalid, 1 for
+ * a GPS fix, 2 for a differential GPS fix, and so on.
+ *
+ * Returns: the fix quality.
+ */
+guint
+mm_location_gps_fix_get_fix_quality (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self), 0);
+
+    return self->priv->fix_quality;
+}
+
+/**
+ * mm_location_gps_fix_get_fix_type:
+ * @self: a #MMLocationGpsFix.
+ *
+ * Gets the type of the fix, as given in the GSA traces: 1 if there is no fix,
+ * 2 for a 2D fix and 3 for a 3D fix.
+ *
+ * Returns: the fix type, or 0 if unknown.
+ */
+guint
+mm_location_gps_fix_get_fix_type (MMLocationGpsFix *self)
+{
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self), 0);
+
+    return self->priv->fix_type;
+}
+
+/*****************************************************************************/
+
+/* Traces are split in place, without copying them */
+#define MAX_FIELDS 20
+
+typedef struct {
+    const gchar *str;
+    gsize        len;
+} Field;
+
+static guint
+split_fields (const gchar *trace,
+              Field       *fields)
+{
+    const gchar *p;
+    guint        n = 0;
+
+    if (trace[0] != '$')
+        return 0;
+
+    p = trace + 1;
+    fields[0].str = p;
+    for (;; p++) {
+        if (*p == ',') {
+            fields[n].len = p - fields[n].str;
+            if (++n == MAX_FIELDS)
+                return n;
+            fields[n].str = p + 1;
+        } else if (*p == '\0' || *p == '*' || *p == '\r' || *p == '\n') {
+            fields[n].len = p - fields[n].str;
+            return n + 1;
+        }
+    }
+}
+
+static gboolean
+field_get_uint (const Field *field,
+                guint       *out)
+{
+    guint value = 0;
+    gsize i;
+
+    if (!field->len || field->len > 6)
+        return FALSE;
+
+    for (i = 0; i < field->len; i++) {
+        if (!g_ascii_isdigit (field->str[i]))
+            return FALSE;
+        value = (value * 10) + (field->str[i] - '0');
+    }
+
+    *out = value;
+    return TRUE;
+}
+
+/* Plain decimal numbers only, no exponents nor infinities */
+static gboolean
+field_get_double (const Field *field,
+                  gdouble     *out)
+{
+    gchar  buffer[24];
+    gchar *end = NULL;
+    gsize  i;
+
+    if (!field->len || field->len >= sizeof (buffer))
+        return FALSE;
+
+    for (i = 0; i < field->len; i++) {
+        if (!g_ascii_isdigit (field->str[i]) &&
+            field->str[i] != '.' &&
+            field->str[i] != '-' &&
+            field->str[i] != '+')
+            return FALSE;
+        buffer[i] = field->str[i];
+    }
+    buffer[field->len] = '\0';
+
+    *out = g_ascii_strtod (buffer, &end);
+    return (end == buffer + field->len);
+}
+
+static gint64
+round_to_int (gdouble value)
+{
+    return (gint64) (value < 0.0 ? value - 0.5 : value + 0.5);
+}
+
+/* 4533.35 is 45 degrees and 33.35 minutes */
+static gboolean
+field_get_coordinate (const Field *value,
+                      const Field *hemisphere,
+                      gchar        positive,
+                      gchar        negative,
+                      gdouble      max,
+                      gint32      *out)
+{
+    gdouble raw;
+    gdouble degrees;
+
+    if (!field_get_double (value, &raw) || raw < 0.0 || hemisphere->len != 1)
+        return FALSE;
+
+    degrees = (gdouble) (gint64) (raw / 100.0);
+    degrees += (raw - (degrees * 100.0)) / 60.0;
+    if (degrees > max)
+        return FALSE;
+
+    if (hemisphere->str[0] == negative)
+        degrees = -degrees;
+    else if (hemisphere->str[0] != positive)
+        return FALSE;
+
+    *out = (gint32) round_to_int (degrees * 1e7);
+    return TRUE;
+}
+
+static guint
+digits_get_uint (const gchar *str,
+                 guint        n_digits)
+{
+    guint value = 0;
+    guint i;
+
+    for (i = 0; i < n_digits; i++)
+        value = (value * 10) + (str[i] - '0');
+    return value;
+}
+
+/* hhmmss[.sss], in ms since the start of the day */
+static gboolean
+field_get_time (const Field *field,
+                gint64      *out)
+{
+    guint hours;
+    guint minutes;
+    guint seconds;
+    guint milliseconds = 0;
+    gsize i;
+
+    if (field->len < 6)
+        return FALSE;
+    for (i = 0; i < 6; i++) {
+        if (!g_ascii_isdigit (field->str[i]))
+            return FALSE;
+    }
+
+    hours   = digits_get_uint (&field->str[0], 2);
+    minutes = digits_get_uint (&field->str[2], 2);
+    seconds = digits_get_uint (&field->str[4], 2);
+    if (hours > 23 || minutes > 59 || seconds > 60)
+        return FALSE;
+
+    if (field->len > 6) {
+        guint scale = 100;
+
+        if (field->str[6] != '.')
+            return FALSE;
+        for (i = 7; i < field->len; i++) {
+            if (!g_ascii_isdigit (field->str[i]))
+                return FALSE;
+            milliseconds += (field->str[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    *out = ((((hours * 60) + minutes) * 60) + seconds) * (gint64) 1000 + milliseconds;
+    return TRUE;
+}
+
+/* ddmmyy, in ms since the epoch */
+static gboolean
+field_get_date (const Field *field,
+                gint64      *out)
+{
+    GDate date;
+    guint day;
+    guint month;
+    guint year;
+    gsize i;
+
+    if (field->len != 6)
+        return FALSE;
+    for (i = 0; i < 6; i++) {
+        if (!g_ascii_isdigit (field->str[i]))
+            return FALSE;
+    }
+
+    day   = digits_get_uint (&field->str[0], 2);
+    month = digits_get_uint (&field->str[2], 2);
+    year  = digits_get_uint (&field->str[4], 2);
+    year += (year < 80) ? 2000 : 1900;
+    if (!g_date_valid_dmy (day, month, year))
+        return FALSE;
+
+    g_date_clear (&date, 1);
+    g_date_set_dmy (&date, day, month, year);
+    *out = ((gint64) g_date_get_julian (&date) - EPOCH_JULIAN_DAYS) * DAY_MS;
+    return TRUE;
+}
+
+static void
+set_speed (MMLocationGpsFix *self,
+           const Field      *field,
+           gdouble           mm_s_per_unit)
+{
+    gdouble value;
+
+    if (!field_get_double (field, &value) || value < 0.0) {
+        self->priv->known &= ~KNOWN_SPEED;
+        return;
+    }
+
+    self->priv->speed = (guint32) round_to_int (MIN (value * mm_s_per_unit, (gdouble) G_MAXUINT32));
+    self->priv->known |= KNOWN_SPEED;
+}
+
+static void
+set_heading (MMLocationGpsFix *self,
+             const Field      *field)
+{
+    gdouble value;
+
+    if (!field_get_double (field, &value) || value < 0.0 || value > 360.0) {
+        self->priv->known &= ~KNOWN_HEADING;
+        return;
+    }
+
+    self->priv->heading = (guint16) (round_to_int (value * 100.0) % 36000);
+    self->priv->known |= KNOWN_HEADING;
+}
+
+static void
+set_hdop (MMLocationGpsFix *self,
+          const Field      *field)
+{
+    gdouble value;
+
+    if (!field_get_double (field, &value) || value < 0.0) {
+        self->priv->known &= ~KNOWN_HDOP;
+        return;
+    }
+
+    self->priv->hdop = (guint16) MIN (round_to_int (value * 100.0), G_MAXUINT16);
+    self->priv->known |= KNOWN_HDOP;
+}
+
+static void
+set_position (MMLocationGpsFix *self,
+              const Field      *fields)
+{
+    gint32 latitude;
+    gint32 longitude;
+
+    if (!field_get_coordinate (&fields[0], &fields[1], 'N', 'S', 90.0, &latitude) ||
+        !field_get_coordinate (&fields[2], &fields[3], 'E', 'W', 180.0, &longitude)) {
+        self->priv->known &= ~KNOWN_POSITION;
+        return;
+    }
+
+    self->priv->latitude = latitude;
+    self->priv->longitude = longitude;
+    self->priv->known |= KNOWN_POSITION;
+}
+
+/*
+ * $GPGGA,hhmmss.ss,llll.ll,a,yyyyy.yy,a,x,xx,x.x,x.x,M,...
+ * 1 = UTC time, 2-5 = latitude and longitude, 6 = fix quality,
+ * 7 = satellites in use, 8 = HDOP, 9 = altitude above sea level
+ */
+static gboolean
+decode_gga (MMLocationGpsFix *self,
+            const Field      *fields,
+            guint             n_fields)
+{
+    gint64  time_of_day;
+    guint   value;
+    gdouble altitude;
+
+    if (n_fields < 10)
+        return FALSE;
+
+    /* GGA traces don't have the date, so take the one of the last RMC trace
+     * and assume midnight was crossed if time goes back more than half a day */
+    if (self->priv->date >= 0 && field_get_time (&fields[1], &time_of_day)) {
+        gint64 timestamp;
+
+        timestamp = self->priv->date + time_of_day;
+        if ((self->priv->known & KNOWN_TIMESTAMP) && timestamp < self->priv->timestamp - (DAY_MS / 2))
+            timestamp += DAY_MS;
+        self->priv->timestamp = timestamp;
+        self->priv->known |= KNOWN_TIMESTAMP;
+    }
+
+    self->priv->fix_quality = field_get_uint (&fields[6], &value) ? MIN (value, G_MAXUINT8) : 0;
+    self->priv->n_satellites = field_get_uint (&fields[7], &value) ? MIN (value, G_MAXUINT8) : 0;
+    set_hdop (self, &fields[8]);
+
+    if (!self->priv->fix_quality) {
+        self->priv->known &= ~(KNOWN_POSITION | KNOWN_ALTITUDE);
+        return TRUE;
+    }
+
+    set_position (self, &fields[2]);
+
+    if (field_get_double (&fields[9], &altitude) && altitude > -1e6 && altitude < 1e6) {
+        self->priv->altitude = (gint32) round_to_int (altitude * 1000.0);
+        self->priv->known |= KNOWN_ALTITUDE;
+    } else
+        self->priv->known &= ~KNOWN_ALTITUDE;
+
+    return TRUE;
+}
+
+/*
+ * $GPRMC,hhmmss.ss,A,llll.ll,a,yyyyy.yy,a,x.x,x.x,ddmmyy,...
+ * 1 = UTC time, 2 = status (A=valid, V=warning), 3-6 = latitude and
+ * longitude, 7 = speed in knots, 8 = course, 9 = date
+ */
+static gboolean
+decode_rmc (MMLocationGpsFix *self,
+            const Field      *fields,
+            guint             n_fields)
+{
+    gint64 date;
+    gint64 time_of_day;
+
+    if (n_fields < 10)
+        return FALSE;
+
+    if (field_get_date (&fields[9], &date))
+        self->priv->date = date;
+
+    if (self->priv->date >= 0 && field_get_time (&fields[1], &time_of_day)) {
+        self->priv->timestamp = self->priv->date + time_of_day;
+        self->priv->known |= KNOWN_TIMESTAMP;
+    }
+
+    /* Nothing else to trust if the receiver says the data isn't valid */
+    if (fields[2].len != 1 || fields[2].str[0] != 'A')
+        return TRUE;
+
+    set_position (self, &fields[3]);
+    set_speed (self, &fields[7], 1852000.0 / 3600.0);
+    set_heading (self, &fields[8]);
+    return TRUE;
+}
+
+/*
+ * $GPGSA,a,x,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,x.x,x.x,x.x
+ * 1 = selection mode, 2 = fix type, 3-14 = satellites used, 15 = PDOP,
+ * 16 = HDOP, 17 = VDOP
+ */
+static gboolean
+decode_gsa (MMLocationGpsFix *self,
+            const Field      *fields,
+            guint             n_fields)
+{
+    guint value;
+
+    if (n_fields < 3)
+        return FALSE;
+
+    self->priv->fix_type = (field_get_uint (&fields[2], &value) && value <= 3) ? value : 0;
+    if (n_fields > 16)
+        set_hdop (self, &fields[16]);
+    return TRUE;
+}
+
+/*
+ * $GPVTG,x.x,T,x.x,M,x.x,N,x.x,K[,a]
+ * 1 = course (true), 3 = course (magnetic), 5 = speed in knots,
+ * 7 = speed in km/h, 9 = mode indicator (N=not valid)
+ */
+static gboolean
+decode_vtg (MMLocationGpsFix *self,
+            const Field      *fields,
+            guint             n_fields)
+{
+    if (n_fields < 8)
+        return FALSE;
+
+    if (n_fields > 9 && fields[9].len == 1 && fields[9].str[0] == 'N')
+        return TRUE;
+
+    set_heading (self, &fields[1]);
+    if (fields[7].len)
+        set_speed (self, &fields[7], 1000000.0 / 3600.0);
+    else
+        set_speed (self, &fields[5], 1852000.0 / 3600.0);
+    return TRUE;
+}
+
+gboolean
+mm_location_gps_fix_add_trace (MMLocationGpsFix *self,
+                               const gchar *trace)
+{
+    Field        fields[MAX_FIELDS];
+    guint        n_fields;
+    const gchar *type;
+    gboolean     decoded;
+
+    /* Only standard sentences, with a two char talker id and a three char
+     * sentence type; the talker id is ignored, so that fixes from multiple
+     * constellations are taken as well */
+    n_fields = split_fields (trace, fields);
+    if (n_fields < 2 || fields[0].len != 5)
+        return FALSE;
+
+    type = fields[0].str + 2;
+    if (!strncmp (type, "GGA", 3))
+        decoded = decode_gga (self, fields, n_fields);
+    else if (!strncmp (type, "RMC", 3))
+        decoded = decode_rmc (self, fields, n_fields);
+    else if (!strncmp (type, "GSA", 3))
+        decoded = decode_gsa (self, fields, n_fields);
+    else if (!strncmp (type, "VTG", 3))
+        decoded = decode_vtg (self, fields, n_fields);
+    else
+        decoded = FALSE;
+
+    self->priv->valid |= decoded;
+    return decoded;
+}
+
+/*****************************************************************************/
+
+static void
+write_uint16 (guint8  *buffer,
+              guint16  value)
+{
+    value = GUINT16_TO_LE (value);
+    memcpy (buffer, &value, sizeof (value));
+}
+
+static void
+write_uint32 (guint8  *buffer,
+              guint32  value)
+{
+    value = GUINT32_TO_LE (value);
+    memcpy (buffer, &value, sizeof (value));
+}
+
+static void
+write_uint64 (guint8  *buffer,
+              guint64  value)
+{
+    value = GUINT64_TO_LE (value);
+    memcpy (buffer, &value, sizeof (value));
+}
+
+static guint16
+read_uint16 (const guint8 *buffer)
+{
+    guint16 value;
+
+    memcpy (&value, buffer, sizeof (value));
+    return GUINT16_FROM_LE (value);
+}
+
+static guint32
+read_uint32 (const guint8 *buffer)
+{
+    guint32 value;
+
+    memcpy (&value, buffer, sizeof (value));
+    return GUINT32_FROM_LE (value);
+}
+
+static guint64
+read_uint64 (const guint8 *buffer)
+{
+    guint64 value;
+
+    memcpy (&value, buffer, sizeof (value));
+    return GUINT64_FROM_LE (value);
+}
+
+GVariant *
+mm_location_gps_fix_get_bytes_variant (MMLocationGpsFix *self)
+{
+    guint8 buffer[FORMAT_SIZE] = { 0 };
+
+    /* We do allow NULL */
+    if (!self)
+        return NULL;
+
+    g_return_val_if_fail (MM_IS_LOCATION_GPS_FIX (self), NULL);
+
+    /* Nothing to report until the first trace is decoded */
+    if (!self->priv->valid)
+        return NULL;
+
+    buffer[0] = FORMAT_VERSION;
+    buffer[1] = self->priv->known;
+    buffer[2] = self->priv->fix_quality;
+    buffer[3] = self->priv->fix_type;
+    buffer[4] = self->priv->n_satellites;
+    write_uint16 (&buffer[6], self->priv->hdop);
+    write_uint64 (&buffer[8], (guint64) self->priv->timestamp);
+    write_uint32 (&buffer[16], (guint32) self->priv->latitude);
+    write_uint32 (&buffer[20], (guint32) self->priv->longitude);
+    write_uint32 (&buffer[24], (guint32) self->priv->altitude);
+    write_uint32 (&buffer[28], self->priv->speed);
+    write_uint16 (&buffer[32], self->priv->heading);
+
+    return g_variant_ref_sink (g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+                                                          buffer,
+                                                          sizeof (buffer),
+                                                          sizeof (guint8)));
+}
+
+/*****************************************************************************/
+
+MMLocationGpsFix *
+mm_location_gps_fix_new_from_bytes_variant (GVariant *bytes,
+                                            GError **error)
+{
+    MMLocationGpsFix *self;
+    const guint8 *buffer;
+    gsize size = 0;
+
+    self = mm_location_gps_fix_new ();
+    if (!bytes)
+        return self;
+
+    if (!g_variant_is_of_type (bytes, G_VARIANT_TYPE_BYTESTRING)) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_INVALID_ARGS,
+                     "Cannot create GPS FIX location from bytes: "
+                     "invalid variant type received");
+        g_object_unref (self);
+        return NULL;
+    }
+
+    /* Newer versions of the format may only append fields */
+    buffer = g_variant_get_fixed_array (bytes, &size, sizeof (guint8));
+    if (size < FORMAT_SIZE || buffer[0] < FORMAT_VERSION) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_INVALID_ARGS,
+                     "Cannot create GPS FIX location from bytes: "
+                     "unsupported format (version %u, %" G_GSIZE_FORMAT " bytes)",
+                     size ? buffer[0] : 0, size);
+        g_object_unref (self);
+        return NULL;
+    }
+
+    self->priv->valid = TRUE;
+    self->priv->known = buffer[1];
+    self->priv->fix_quality = buffer[2];
+    self->priv->fix_type = buffer[3];
+    self->priv->n_satellites = buffer[4];
+    self->priv->hdop = read_uint16 (&buffer[6]);
+    self->priv->timestamp = (gint64) read_uint64 (&buffer[8]);
+    self->priv->latitude = (gint32) read_uint32 (&buffer[16]);
+    self->priv->longitude = (gint32) read_uint32 (&buffer[20]);
+    self->priv->altitude = (gint32) read_uint32 (&buffer[24]);
+    self->priv->speed = read_uint32 (&buffer[28]);
+    self->priv->heading = read_uint16 (&buffer[32]);
+
+    return self;
+}
+
+/*****************************************************************************/
+
+MMLocationGpsFix *
+mm_location_gps_fix_new (void)
+{
+    return (MM_LOCATION_GPS_FIX (
+                g_object_new (MM_TYPE_LOCATION_GPS_FIX, NULL)));
+}
+
+static void
+mm_location_gps_fix_init (MMLocationGpsFix *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE ((self),
+                                              MM_TYPE_LOCATION_GPS_FIX,
+                                              MMLocationGpsFixPrivate);
+
+    self->priv->date = -1;
+}
+
+static void
+mm_location_gps_fix_class_init (MMLocationGpsFixClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMLocationGpsFixPrivate));
+}
@@ -0,0 +1,93 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_LOCATION_GPS_FIX_H
+#define MM_LOCATION_GPS_FIX_H
+
+#if !defined (__LIBMM_GLIB_H_INSIDE__) && !defined (LIBMM_GLIB_COMPILATION)
+#error "Only <libmm-glib.h> can be included directly."
+#endif
+
+#include <ModemManager.h>
+#include <glib-object.h>
+
+#include "mm-location-common.h"
+
+G_BEGIN_DECLS
+
+#define MM_TYPE_LOCATION_GPS_FIX            (mm_location_gps_fix_get_type ())
+#define MM_LOCATION_GPS_FIX(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_LOCATION_GPS_FIX, MMLocationGpsFix))
+#define MM_LOCATION_GPS_FIX_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  MM_TYPE_LOCATION_GPS_FIX, MMLocationGpsFixClass))
+#define MM_IS_LOCATION_GPS_FIX(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MM_TYPE_LOCATION_GPS_FIX))
+#define MM_IS_LOCATION_GPS_FIX_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_LOCATION_GPS_FIX))
+#define MM_LOCATION_GPS_FIX_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_LOCATION_GPS_FIX, MMLocationGpsFixClass))
+
+typedef struct _MMLocationGpsFix MMLocationGpsFix;
+typedef struct _MMLocationGpsFixClass MMLocationGpsFixClass;
+typedef struct _MMLocationGpsFixPrivate MMLocationGpsFixPrivate;
+
+/**
+ * MMLocationGpsFix:
+ *
+ * The #MMLocationGpsFix structure contains private data and should
+ * only be accessed using the provided API.
+ */
+struct _MMLocationGpsFix {
+    /*< private >*/
+    GObject parent;
+    MMLocationGpsFixPrivate *priv;
+};
+
+struct _MMLocationGpsFixClass {
+    /*< private >*/
+    GObjectClass parent;
+};
+
+GType mm_location_gps_fix_get_type (void);
+
+#if GLIB_CHECK_VERSION(2, 44, 0)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMLocationGpsFix, g_object_unref)
+#endif
+
+gint64  mm_location_gps_fix_get_timestamp    (MMLocationGpsFix *self);
+gdouble mm_location_gps_fix_get_longitude    (MMLocationGpsFix *self);
+gdouble mm_location_gps_fix_get_latitude     (MMLocationGpsFix *self);
+gdouble mm_location_gps_fix_get_altitude     (MMLocationGpsFix *self);
+gdouble mm_location_gps_fix_get_speed        (MMLocationGpsFix *self);
+gdouble mm_location_gps_fix_get_heading      (MMLocationGpsFix *self);
+gdouble mm_location_gps_fix_get_hdop         (MMLocationGpsFix *self);
+guint   mm_location_gps_fix_get_n_satellites (MMLocationGpsFix *self);
+guint   mm_location_gps_fix_get_fix_quality  (MMLocationGpsFix *self);
+guint   mm_location_gps_fix_get_fix_type     (MMLocationGpsFix *self);
+
+/*****************************************************************************/
+/* ModemManager/libmm-glib/mmcli specific methods */
+
+#if defined (_LIBMM_INSIDE_MM) ||    \
+    defined (_LIBMM_INSIDE_MMCLI) || \
+    defined (LIBMM_GLIB_COMPILATION)
+
+MMLocationGpsFix *mm_location_gps_fix_new (void);
+MMLocationGpsFix *mm_location_gps_fix_new_from_bytes_variant (GVariant *bytes,
+                                                              GError **error);
+
+gboolean mm_location_gps_fix_add_trace (MMLocationGpsFix *self,
+                                        const gchar *trace);
+
+GVariant *mm_location_gps_fix_get_bytes_variant (MMLocationGpsFix *self);
+
+#endif
+
+G_END_DECLS
+
+#endif /* MM_LOCATION_GPS_FIX_H */
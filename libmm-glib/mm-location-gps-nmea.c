@@ -36,94 +36,117 @@
 
 G_DEFINE_TYPE (MMLocationGpsNmea, mm_location_gps_nmea, G_TYPE_OBJECT);
 
+/* Last trace of each type, with the types kept in the order in which they
+ * were first seen. Slots are reused as new traces arrive, so that updating
+ * an already known trace type doesn't allocate. */
+typedef struct {
+    gchar   *type;
+    GString *trace;
+} TraceSlot;
+
 struct _MMLocationGpsNmeaPrivate {
-    GHashTable *traces;
-    GRegex *sequence_regex;
+    GPtrArray *slots;
+    GHashTable *slots_by_type;
 };
 
 /*****************************************************************************/
 
-static gboolean
-check_append_or_replace (MMLocationGpsNmea *self,
-                         const gchar *trace)
+static void
+trace_slot_free (TraceSlot *slot)
+{
+    g_free (slot->type);
+    g_string_free (slot->trace, TRUE);
+    g_slice_free (TraceSlot, slot);
+}
+
+static TraceSlot *
+lookup_slot (MMLocationGpsNmea *self,
+             const gchar *trace,
+             gsize type_len)
 {
-    /* By default, replace */
-    gboolean append_or_replace = FALSE;
-    GMatchInfo *match_info = NULL;
-
-    if (G_UNLIKELY (!self->priv->sequence_regex))
-        self->priv->sequence_regex = g_regex_new ("\\$GPGSV,(\\d),(\\d).*",
-                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                                                  0,
-                                                  NULL);
-
-    if (g_regex_match (self->priv->sequence_regex, trace, 0, &match_info)) {
-        guint index;
-
-        /* If we don't have the first element of a sequence, append */
-        if (mm_get_uint_from_match_info (match_info, 2, &index) && index != 1)
-            append_or_replace = TRUE;
+    TraceSlot *slot;
+    gchar type_buffer[16];
+    gchar *type;
+
+    /* Avoid allocating the key for the usual short trace types */
+    type = (type_len < sizeof (type_buffer) ? type_buffer : g_malloc (type_len + 1));
+    memcpy (type, trace, type_len);
+    type[type_len] = '\0';
+
+    slot = g_hash_table_lookup (self->priv->slots_by_type, type);
+    if (!slot) {
+        slot = g_slice_new (TraceSlot);
+        slot->type = g_strdup (type);
+        slot->trace = g_string_sized_new (128);
+        g_ptr_array_add (self->priv->slots, slot);
+        g_hash_table_insert (self->priv->slots_by_type, slot->type, slot);
     }
-    g_match_info_free (match_info);
 
-    return append_or_replace;
+    if (type != type_buffer)
+        g_free (type);
+    return slot;
 }
 
+/* Satellites in view are reported in a sequence of several traces, given as
+ * e.g. "$GPGSV,<number of traces>,<index of this trace>,...", which are all
+ * kept together */
 static gboolean
-location_gps_nmea_take_trace (MMLocationGpsNmea *self,
-                              gchar *trace)
+check_append_or_replace (const gchar *trace,
+                         gsize type_len)
 {
-    gchar *i;
-    gchar *trace_type;
+    const gchar *p;
+    guint index = 0;
 
-    i = strchr (trace, ',');
-    if (!i || i == trace) {
-        g_free (trace);
+    if (type_len != 6 || strncmp (&trace[3], "GSV", 3) != 0)
         return FALSE;
-    }
 
-    trace_type = g_malloc (i - trace + 1);
-    memcpy (trace_type, trace, i - trace);
-    trace_type[i - trace] = '\0';
+    /* Skip the number of traces in the sequence */
+    p = &trace[type_len + 1];
+    if (!g_ascii_isdigit (*p))
+        return FALSE;
+    while (g_ascii_isdigit (*p))
+        p++;
+    if (*p++ != ',' || !g_ascii_isdigit (*p))
+        return FALSE;
 
-    /* Some traces are part of a SEQUENCE; so we need to decide whether we
-     * completely replace the previous trace, or we append the new one to
-     * the already existing list */
-    if (check_append_or_replace (self, trace)) {
-        /* Append */
-        const gchar *previous;
-
-        previous = g_hash_table_lookup (self->priv->traces, trace_type);
-        if (previous) {
-            gchar *sequence;
-
-            /* Skip the trace if we already have it there */
-            if (strstr (previous, trace)) {
-                g_free (trace_type);
-                g_free (trace);
-                return TRUE;
-            }
-
-            sequence = g_strdup_printf ("%s%s%s",
-                                        previous,
-                                        g_str_has_suffix (previous, "\r\n") ? "" : "\r\n",
-                                        trace);
-            g_free (trace);
-            trace = sequence;
-        }
-    }
+    while (g_ascii_isdigit (*p))
+        index = (index * 10) + (*p++ - '0');
 
-    g_hash_table_replace (self->priv->traces,
-                          trace_type,
-                          trace);
-    return TRUE;
+    /* If we don't have the first element of a sequence, append */
+    return (index != 1);
 }
 
 gboolean
 mm_location_gps_nmea_add_trace (MMLocationGpsNmea *self,
                                 const gchar *trace)
 {
-    return location_gps_nmea_take_trace (self, g_strdup (trace));
+    const gchar *i;
+    TraceSlot *slot;
+    gsize type_len;
+
+    i = strchr (trace, ',');
+    if (!i || i == trace)
+        return FALSE;
+    type_len = i - trace;
+
+    slot = lookup_slot (self, trace, type_len);
+
+    /* Some traces are part of a SEQUENCE; so we need to decide whether we
+     * completely replace the previous trace, or we append the new one to
+     * the already existing list */
+    if (slot->trace->len > 0 && check_append_or_replace (trace, type_len)) {
+        /* Skip the trace if we already have it there */
+        if (strstr (slot->trace->str, trace))
+            return TRUE;
+
+        if (!g_str_has_suffix (slot->trace->str, "\r\n"))
+            g_string_append (slot->trace, "\r\n");
+        g_string_append (slot->trace, trace);
+        return TRUE;
+    }
+
+    g_string_assign (slot->trace, trace);
+    return TRUE;
 }
 
 /*****************************************************************************/
@@ -141,22 +164,14 @@ const gchar *
 mm_location_gps_nmea_get_trace (MMLocationGpsNmea *self,
                                 const gchar *trace_type)
 {
-    return (const gchar *)g_hash_table_lookup (self->priv->traces, trace_type);
+    TraceSlot *slot;
+
+    slot = g_hash_table_lookup (self->priv->slots_by_type, trace_type);
+    return (slot ? slot->trace->str : NULL);
 }
 
 /*****************************************************************************/
 
-static void
-build_full_foreach (const gchar *trace_type,
-                    const gchar *trace,
-                    GString **built)
-{
-    if ((*built)->len == 0 || g_str_has_suffix ((*built)->str, "\r\n"))
-        g_string_append (*built, trace);
-    else
-        g_string_append_printf (*built, "\r\n%s", trace);
-}
-
 /**
  * mm_location_gps_nmea_build_full:
  * @self: a #MMLocationGpsNmea.
@@ -169,11 +184,21 @@ gchar *
 mm_location_gps_nmea_build_full (MMLocationGpsNmea *self)
 {
     GString *built;
+    gsize len = 0;
+    guint i;
+
+    for (i = 0; i < self->priv->slots->len; i++)
+        len += ((TraceSlot *) g_ptr_array_index (self->priv->slots, i))->trace->len + 2;
 
-    built = g_string_new ("");
-    g_hash_table_foreach (self->priv->traces,
-                          (GHFunc)build_full_foreach,
-                          &built);
+    built = g_string_sized_new (len + 1);
+    for (i = 0; i < self->priv->slots->len; i++) {
+        const GString *trace;
+
+        trace = ((TraceSlot *) g_ptr_array_index (self->priv->slots, i))->trace;
+        if (built->len > 0 && !g_str_has_suffix (built->str, "\r\n"))
+            g_string_append (built, "\r\n");
+        g_string_append_len (built, trace->str, trace->len);
+    }
     return g_string_free (built, FALSE);
 }
 
@@ -226,13 +251,9 @@ mm_location_gps_nmea_new_from_string_variant (GVariant *string,
     /* Create new location object */
     self = mm_location_gps_nmea_new ();
 
-    for (i = 0; split[i]; i++) {
-        location_gps_nmea_take_trace (self, split[i]);
-    }
-
-    /* Note that the strings in the array of strings were already taken
-     * or freed */
-    g_free (split);
+    for (i = 0; split[i]; i++)
+        mm_location_gps_nmea_add_trace (self, split[i]);
+    g_strfreev (split);
 
     return self;
 }
@@ -253,10 +274,8 @@ mm_location_gps_nmea_init (MMLocationGpsNmea *self)
                                               MM_TYPE_LOCATION_GPS_NMEA,
                                               MMLocationGpsNmeaPrivate);
 
-    self->priv->traces = g_hash_table_new_full (g_str_hash,
-                                                g_str_equal,
-                                                g_free,
-                                                g_free);
+    self->priv->slots = g_ptr_array_new_with_free_func ((GDestroyNotify) trace_slot_free);
+    self->priv->slots_by_type = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -264,9 +283,8 @@ finalize (GObject *object)
 {
     MMLocationGpsNmea *self = MM_LOCATION_GPS_NMEA (object);
 
-    g_hash_table_destroy (self->priv->traces);
-    if (self->priv->sequence_regex)
-        g_regex_unref (self->priv->sequence_regex);
+    g_hash_table_destroy (self->priv->slots_by_type);
+    g_ptr_array_unref (self->priv->slots);
 
     G_OBJECT_CLASS (mm_location_gps_nmea_parent_class)->finalize (object);
 }
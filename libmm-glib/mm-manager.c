@@ -888,6 +888,134 @@ mm_manager_uninhibit_device_sync (MMManager     *manager,
 
 /*****************************************************************************/
 
+/**
+ * mm_manager_get_log_history_finish:
+ * @manager: A #MMManager.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_manager_get_log_history().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_manager_get_log_history().
+ *
+ * Returns: (transfer full): A %NULL-terminated array of log lines, or %NULL if @error is set. The returned value should be freed with g_strfreev().
+ */
+gchar **
+mm_manager_get_log_history_finish (MMManager     *manager,
+                                   GAsyncResult  *res,
+                                   GError       **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static void
+get_log_history_ready (MmGdbusOrgFreedesktopModemManager1 *manager_iface_proxy,
+                       GAsyncResult                       *res,
+                       GTask                              *task)
+{
+    GError  *error = NULL;
+    gchar  **lines = NULL;
+
+    if (!mm_gdbus_org_freedesktop_modem_manager1_call_get_log_history_finish (
+            manager_iface_proxy,
+            &lines,
+            res,
+            &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_pointer (task, lines, (GDestroyNotify) g_strfreev);
+
+    g_object_unref (task);
+}
+
+/**
+ * mm_manager_get_log_history:
+ * @manager: A #MMManager.
+ * @uid: the unique ID of the physical device.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously requests the last lines logged by the daemon about the
+ * physical device, at any log level.
+ *
+ * The log history is only available if enabled in the daemon.
+ *
+ * When the operation is finished, @callback will be invoked in the
+ * <link linkend="g-main-context-push-thread-default">thread-default main loop</link>
+ * of the thread you are calling this method from. You can then call
+ * mm_manager_get_log_history_finish() to get the result of the operation.
+ *
+ * See mm_manager_get_log_history_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_manager_get_log_history (MMManager           *manager,
+                            const gchar         *uid,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+    GTask *task;
+    GError *inner_error = NULL;
+
+    g_return_if_fail (MM_IS_MANAGER (manager));
+
+    task = g_task_new (manager, cancellable, callback, user_data);
+
+    if (!ensure_modem_manager1_proxy (manager, &inner_error)) {
+        g_task_return_error (task, inner_error);
+        g_object_unref (task);
+        return;
+    }
+
+    mm_gdbus_org_freedesktop_modem_manager1_call_get_log_history (
+        manager->priv->manager_iface_proxy,
+        uid,
+        cancellable,
+        (GAsyncReadyCallback)get_log_history_ready,
+        task);
+}
+
+/**
+ * mm_manager_get_log_history_sync:
+ * @manager: A #MMManager.
+ * @uid: the unique ID of the physical device.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously requests the last lines logged by the daemon about the
+ * physical device, at any log level.
+ *
+ * The calling thread is blocked until a reply is received.
+ *
+ * See mm_manager_get_log_history() for the asynchronous version of this method.
+ *
+ * Returns: (transfer full): A %NULL-terminated array of log lines, or %NULL if @error is set. The returned value should be freed with g_strfreev().
+ */
+gchar **
+mm_manager_get_log_history_sync (MMManager     *manager,
+                                 const gchar   *uid,
+                                 GCancellable  *cancellable,
+                                 GError       **error)
+{
+    gchar **lines = NULL;
+
+    g_return_val_if_fail (MM_IS_MANAGER (manager), NULL);
+
+    if (!ensure_modem_manager1_proxy (manager, error))
+        return NULL;
+
+    if (!mm_gdbus_org_freedesktop_modem_manager1_call_get_log_history_sync (
+            manager->priv->manager_iface_proxy,
+            uid,
+            &lines,
+            cancellable,
+            error))
+        return NULL;
+
+    return lines;
+}
+
+/*****************************************************************************/
+
 static void
 register_dbus_errors (void)
 {
@@ -154,6 +154,19 @@ gboolean mm_manager_uninhibit_device_sync   (MMManager           *manager,
                                              GCancellable        *cancellable,
                                              GError             **error);
 
+void    mm_manager_get_log_history        (MMManager           *manager,
+                                           const gchar         *uid,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             user_data);
+gchar **mm_manager_get_log_history_finish (MMManager           *manager,
+                                           GAsyncResult        *res,
+                                           GError             **error);
+gchar **mm_manager_get_log_history_sync   (MMManager           *manager,
+                                           const gchar         *uid,
+                                           GCancellable        *cancellable,
+                                           GError             **error);
+
 G_END_DECLS
 
 #endif /* _MM_MANAGER_H_ */
@@ -494,12 +494,98 @@ mm_modem_location_set_gps_refresh_rate_sync (MMModemLocation *self,
 
 /*****************************************************************************/
 
+/**
+ * mm_modem_location_set_gps_fix_rate_finish:
+ * @self: A #MMModemLocation.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_location_set_gps_fix_rate().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_location_set_gps_fix_rate().
+ *
+ * Returns: %TRUE if setting the GPS fix rate was successful, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_location_set_gps_fix_rate_finish (MMModemLocation *self,
+                                           GAsyncResult *res,
+                                           GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_LOCATION (self), FALSE);
+
+    return mm_gdbus_modem_location_call_set_gps_fix_rate_finish (MM_GDBUS_MODEM_LOCATION (self), res, error);
+}
+
+/**
+ * mm_modem_location_set_gps_fix_rate:
+ * @self: A #MMModemLocation.
+ * @rate: The GPS fix rate, in milliseconds.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously configures the rate at which the decoded GPS fix is published.
+ *
+ * If a 0 rate is used, every GPS fix will be immediately propagated to the interface.
+ *
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call mm_modem_location_set_gps_fix_rate_finish() to get the result of the operation.
+ *
+ * See mm_modem_location_set_gps_fix_rate_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_location_set_gps_fix_rate (MMModemLocation *self,
+                                    guint rate,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data)
+{
+    g_return_if_fail (MM_IS_MODEM_LOCATION (self));
+
+    mm_gdbus_modem_location_call_set_gps_fix_rate (MM_GDBUS_MODEM_LOCATION (self),
+                                                   rate,
+                                                   cancellable,
+                                                   callback,
+                                                   user_data);
+}
+
+/**
+ * mm_modem_location_set_gps_fix_rate_sync:
+ * @self: A #MMModemLocation.
+ * @rate: The GPS fix rate, in milliseconds.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously configures the rate at which the decoded GPS fix is published.
+ *
+ * If a 0 rate is used, every GPS fix will be immediately propagated to the interface.
+ *
+ * The calling thread is blocked until a reply is received. See mm_modem_location_set_gps_fix_rate()
+ * for the asynchronous version of this method.
+ *
+ * Returns: %TRUE if setting the fix rate was successful, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_location_set_gps_fix_rate_sync (MMModemLocation *self,
+                                         guint rate,
+                                         GCancellable *cancellable,
+                                         GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_LOCATION (self), FALSE);
+
+    return mm_gdbus_modem_location_call_set_gps_fix_rate_sync (MM_GDBUS_MODEM_LOCATION (self),
+                                                               rate,
+                                                               cancellable,
+                                                               error);
+}
+
+/*****************************************************************************/
+
 static gboolean
 build_locations (GVariant *dictionary,
                  MMLocation3gpp **location_3gpp,
                  MMLocationGpsNmea **location_gps_nmea,
                  MMLocationGpsRaw **location_gps_raw,
                  MMLocationCdmaBs **location_cdma_bs,
+                 MMLocationGpsFix **location_gps_fix,
                  GError **error)
 {
     GError *inner_error = NULL;
@@ -531,6 +617,10 @@ build_locations (GVariant *dictionary,
             if (location_cdma_bs)
                 *location_cdma_bs = mm_location_cdma_bs_new_from_dictionary (value, &inner_error);
             break;
+        case MM_MODEM_LOCATION_SOURCE_GPS_FIX:
+            if (location_gps_fix)
+                *location_gps_fix = mm_location_gps_fix_new_from_bytes_variant (value, &inner_error);
+            break;
         default:
             g_warn_if_reached ();
             break;
@@ -581,7 +671,7 @@ mm_modem_location_get_full_finish (MMModemLocation *self,
     if (!mm_gdbus_modem_location_call_get_location_finish (MM_GDBUS_MODEM_LOCATION (self), &dictionary, res, error))
         return FALSE;
 
-    return build_locations (dictionary, location_3gpp, location_gps_nmea, location_gps_raw, location_cdma_bs, error);
+    return build_locations (dictionary, location_3gpp, location_gps_nmea, location_gps_raw, location_cdma_bs, NULL, error);
 }
 
 /**
@@ -645,7 +735,7 @@ mm_modem_location_get_full_sync (MMModemLocation *self,
     if (!mm_gdbus_modem_location_call_get_location_sync (MM_GDBUS_MODEM_LOCATION (self), &dictionary, cancellable, error))
         return FALSE;
 
-    return build_locations (dictionary, location_3gpp, location_gps_nmea, location_gps_raw, location_cdma_bs, error);
+    return build_locations (dictionary, location_3gpp, location_gps_nmea, location_gps_raw, location_cdma_bs, NULL, error);
 }
 
 /*****************************************************************************/
@@ -866,6 +956,86 @@ mm_modem_location_get_gps_raw_sync (MMModemLocation *self,
 
 /*****************************************************************************/
 
+/**
+ * mm_modem_location_get_gps_fix_finish:
+ * @self: A #MMModemLocation.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_location_get_gps_fix().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_location_get_gps_fix().
+ *
+ * Returns: (transfer full): A #MMLocationGpsFix, or #NULL if not available. The returned value should be freed with g_object_unref().
+ */
+MMLocationGpsFix *
+mm_modem_location_get_gps_fix_finish (MMModemLocation *self,
+                                      GAsyncResult *res,
+                                      GError **error)
+{
+    MMLocationGpsFix *location = NULL;
+    GVariant *dictionary = NULL;
+
+    g_return_val_if_fail (MM_IS_MODEM_LOCATION (self), NULL);
+
+    if (mm_gdbus_modem_location_call_get_location_finish (MM_GDBUS_MODEM_LOCATION (self), &dictionary, res, error))
+        build_locations (dictionary, NULL, NULL, NULL, NULL, &location, error);
+
+    return location;
+}
+
+/**
+ * mm_modem_location_get_gps_fix:
+ * @self: A #MMModemLocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously gets the current GPS fix, as decoded by the daemon.
+ *
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call mm_modem_location_get_gps_fix_finish() to get the result of the operation.
+ *
+ * See mm_modem_location_get_gps_fix_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_location_get_gps_fix (MMModemLocation *self,
+                               GCancellable *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+    mm_modem_location_get_full (self, cancellable, callback, user_data);
+}
+
+/**
+ * mm_modem_location_get_gps_fix_sync:
+ * @self: A #MMModemLocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously gets the current GPS fix, as decoded by the daemon.
+ *
+ * The calling thread is blocked until a reply is received. See mm_modem_location_get_gps_fix()
+ * for the asynchronous version of this method.
+ *
+ * Returns: (transfer full): A #MMLocationGpsFix, or #NULL if not available. The returned value should be freed with g_object_unref().
+ */
+MMLocationGpsFix *
+mm_modem_location_get_gps_fix_sync (MMModemLocation *self,
+                                    GCancellable *cancellable,
+                                    GError **error)
+{
+    MMLocationGpsFix *location = NULL;
+    GVariant *dictionary = NULL;
+
+    g_return_val_if_fail (MM_IS_MODEM_LOCATION (self), NULL);
+
+    if (mm_gdbus_modem_location_call_get_location_sync (MM_GDBUS_MODEM_LOCATION (self), &dictionary, cancellable, error))
+        build_locations (dictionary, NULL, NULL, NULL, NULL, &location, error);
+
+    return location;
+}
+
+/*****************************************************************************/
+
 /**
  * mm_modem_location_get_cdma_bs_finish:
  * @self: A #MMModemLocation.
@@ -1047,6 +1217,24 @@ mm_modem_location_get_gps_refresh_rate (MMModemLocation *self)
 
 /*****************************************************************************/
 
+/**
+ * mm_modem_location_get_gps_fix_rate:
+ * @self: A #MMModemLocation.
+ *
+ * Gets the rate at which the decoded GPS fix is published, in milliseconds.
+ *
+ * Returns: The GPS fix rate, or 0 if every fix is published.
+ */
+guint
+mm_modem_location_get_gps_fix_rate (MMModemLocation *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_LOCATION (self), 0);
+
+    return mm_gdbus_modem_location_get_gps_fix_rate (MM_GDBUS_MODEM_LOCATION (self));
+}
+
+/*****************************************************************************/
+
 static void
 mm_modem_location_init (MMModemLocation *self)
 {
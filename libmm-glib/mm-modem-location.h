@@ -34,6 +34,7 @@
 #include "mm-location-3gpp.h"
 #include "mm-location-gps-nmea.h"
 #include "mm-location-gps-raw.h"
+#include "mm-location-gps-fix.h"
 #include "mm-location-cdma-bs.h"
 
 G_BEGIN_DECLS
@@ -89,6 +90,7 @@ const gchar **mm_modem_location_get_assistance_data_servers (MMModemLocation *se
 gchar       **mm_modem_location_dup_assistance_data_servers (MMModemLocation *self);
 
 guint mm_modem_location_get_gps_refresh_rate (MMModemLocation *self);
+guint mm_modem_location_get_gps_fix_rate     (MMModemLocation *self);
 
 void     mm_modem_location_setup        (MMModemLocation *self,
                                          MMModemLocationSource sources,
@@ -146,6 +148,19 @@ gboolean mm_modem_location_set_gps_refresh_rate_sync   (MMModemLocation *self,
                                                         GCancellable *cancellable,
                                                         GError **error);
 
+void     mm_modem_location_set_gps_fix_rate        (MMModemLocation *self,
+                                                    guint rate,
+                                                    GCancellable *cancellable,
+                                                    GAsyncReadyCallback callback,
+                                                    gpointer user_data);
+gboolean mm_modem_location_set_gps_fix_rate_finish (MMModemLocation *self,
+                                                    GAsyncResult *res,
+                                                    GError **error);
+gboolean mm_modem_location_set_gps_fix_rate_sync   (MMModemLocation *self,
+                                                    guint rate,
+                                                    GCancellable *cancellable,
+                                                    GError **error);
+
 void            mm_modem_location_get_3gpp        (MMModemLocation *self,
                                                    GCancellable *cancellable,
                                                    GAsyncReadyCallback callback,
@@ -179,6 +194,17 @@ MMLocationGpsRaw *mm_modem_location_get_gps_raw_sync   (MMModemLocation *self,
                                                         GCancellable *cancellable,
                                                         GError **error);
 
+void              mm_modem_location_get_gps_fix        (MMModemLocation *self,
+                                                        GCancellable *cancellable,
+                                                        GAsyncReadyCallback callback,
+                                                        gpointer user_data);
+MMLocationGpsFix *mm_modem_location_get_gps_fix_finish (MMModemLocation *self,
+                                                        GAsyncResult *res,
+                                                        GError **error);
+MMLocationGpsFix *mm_modem_location_get_gps_fix_sync   (MMModemLocation *self,
+                                                        GCancellable *cancellable,
+                                                        GError **error);
+
 void              mm_modem_location_get_cdma_bs        (MMModemLocation *self,
                                                         GCancellable *cancellable,
                                                         GAsyncReadyCallback callback,
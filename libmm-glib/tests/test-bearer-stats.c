@@ -0,0 +1,168 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <libmm-glib.h>
+#include <string.h>
+
+/* Sample i is taken i seconds after connecting, with i KB received and
+ * twice as much transmitted */
+static void
+add_samples (MMBearerStats *stats,
+             guint          first,
+             guint          n)
+{
+    guint i;
+
+    for (i = first; i < first + n; i++)
+        mm_bearer_stats_add_sample (stats, (guint64) i * 1000, (guint64) i * 1024, (guint64) i * 2048);
+}
+
+static void
+check_samples (MMBearerStats *stats,
+               guint          first,
+               guint          n)
+{
+    guint64 timestamp;
+    guint64 rx_bytes;
+    guint64 tx_bytes;
+    guint   i;
+
+    g_assert_cmpuint (mm_bearer_stats_get_n_samples (stats), ==, n);
+    for (i = 0; i < n; i++) {
+        g_assert (mm_bearer_stats_get_sample (stats, i, &timestamp, &rx_bytes, &tx_bytes));
+        g_assert_cmpuint (timestamp, ==, (guint64) (first + i) * 1000);
+        g_assert_cmpuint (rx_bytes,  ==, (guint64) (first + i) * 1024);
+        g_assert_cmpuint (tx_bytes,  ==, (guint64) (first + i) * 2048);
+    }
+    g_assert (!mm_bearer_stats_get_sample (stats, n, NULL, NULL, NULL));
+}
+
+/**************************************************************/
+
+static void
+test_samples_ring (void)
+{
+    MMBearerStats *stats;
+
+    stats = mm_bearer_stats_new ();
+    check_samples (stats, 0, 0);
+
+    add_samples (stats, 0, 10);
+    check_samples (stats, 0, 10);
+
+    /* Up to the ring size, nothing is lost */
+    add_samples (stats, 10, MM_BEARER_STATS_MAX_SAMPLES - 10);
+    check_samples (stats, 0, MM_BEARER_STATS_MAX_SAMPLES);
+
+    /* Then the oldest samples are overwritten, oldest first */
+    add_samples (stats, MM_BEARER_STATS_MAX_SAMPLES, 15);
+    check_samples (stats, 15, MM_BEARER_STATS_MAX_SAMPLES);
+
+    /* Even after wrapping around several times */
+    add_samples (stats, MM_BEARER_STATS_MAX_SAMPLES + 15, 3 * MM_BEARER_STATS_MAX_SAMPLES + 7);
+    check_samples (stats, 3 * MM_BEARER_STATS_MAX_SAMPLES + 22, MM_BEARER_STATS_MAX_SAMPLES);
+
+    g_object_unref (stats);
+}
+
+static void
+check_dictionary_round_trip (guint n_samples)
+{
+    MMBearerStats *stats;
+    MMBearerStats *copy;
+    GVariant      *dictionary;
+    GError        *error = NULL;
+
+    stats = mm_bearer_stats_new ();
+    mm_bearer_stats_set_duration (stats, 3600);
+    mm_bearer_stats_set_rx_bytes (stats, G_GUINT64_CONSTANT (5000000000));
+    mm_bearer_stats_set_tx_bytes (stats, 123456);
+    mm_bearer_stats_set_rx_rate (stats, 1000);
+    mm_bearer_stats_set_tx_rate (stats, 200);
+    mm_bearer_stats_set_peak_rx_rate (stats, 1500000);
+    mm_bearer_stats_set_peak_tx_rate (stats, 30000);
+    mm_bearer_stats_set_attempts (stats, 4);
+    mm_bearer_stats_set_failed_attempts (stats, 3);
+    add_samples (stats, 0, n_samples);
+
+    dictionary = mm_bearer_stats_get_dictionary (stats);
+    g_assert (dictionary);
+    copy = mm_bearer_stats_new_from_dictionary (dictionary, &error);
+    g_assert_no_error (error);
+    g_assert (copy);
+
+    g_assert_cmpuint (mm_bearer_stats_get_duration (copy), ==, 3600);
+    g_assert_cmpuint (mm_bearer_stats_get_rx_bytes (copy), ==, G_GUINT64_CONSTANT (5000000000));
+    g_assert_cmpuint (mm_bearer_stats_get_tx_bytes (copy), ==, 123456);
+    g_assert_cmpuint (mm_bearer_stats_get_rx_rate (copy), ==, 1000);
+    g_assert_cmpuint (mm_bearer_stats_get_tx_rate (copy), ==, 200);
+    g_assert_cmpuint (mm_bearer_stats_get_peak_rx_rate (copy), ==, 1500000);
+    g_assert_cmpuint (mm_bearer_stats_get_peak_tx_rate (copy), ==, 30000);
+    g_assert_cmpuint (mm_bearer_stats_get_attempts (copy), ==, 4);
+    g_assert_cmpuint (mm_bearer_stats_get_failed_attempts (copy), ==, 3);
+
+    /* Samples are kept in order, also once the ring has wrapped around */
+    if (n_samples > MM_BEARER_STATS_MAX_SAMPLES)
+        check_samples (copy, n_samples - MM_BEARER_STATS_MAX_SAMPLES, MM_BEARER_STATS_MAX_SAMPLES);
+    else
+        check_samples (copy, 0, n_samples);
+
+    g_variant_unref (dictionary);
+    g_object_unref (copy);
+    g_object_unref (stats);
+}
+
+static void
+test_dictionary_round_trip (void)
+{
+    check_dictionary_round_trip (0);
+    check_dictionary_round_trip (5);
+    check_dictionary_round_trip (MM_BEARER_STATS_MAX_SAMPLES + 25);
+}
+
+static void
+test_dictionary_empty (void)
+{
+    MMBearerStats *stats;
+    GVariant      *invalid;
+    GError        *error = NULL;
+
+    stats = mm_bearer_stats_new_from_dictionary (NULL, &error);
+    g_assert_no_error (error);
+    g_assert (stats);
+    g_assert_cmpuint (mm_bearer_stats_get_duration (stats), ==, 0);
+    g_assert_cmpuint (mm_bearer_stats_get_attempts (stats), ==, 0);
+    check_samples (stats, 0, 0);
+    g_object_unref (stats);
+
+    invalid = g_variant_ref_sink (g_variant_new_uint32 (1));
+    stats = mm_bearer_stats_new_from_dictionary (invalid, &error);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS);
+    g_assert (!stats);
+    g_error_free (error);
+    g_variant_unref (invalid);
+}
+
+/**************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/BearerStats/samples-ring",          test_samples_ring);
+    g_test_add_func ("/MM/BearerStats/dictionary-round-trip", test_dictionary_round_trip);
+    g_test_add_func ("/MM/BearerStats/dictionary-empty",      test_dictionary_empty);
+
+    return g_test_run ();
+}
@@ -0,0 +1,142 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <libmm-glib.h>
+#include <string.h>
+
+/**************************************************************/
+
+static void
+test_decode (void)
+{
+    MMLocationGpsFix *fix;
+
+    fix = mm_location_gps_fix_new ();
+
+    /* Nothing reported until a trace is decoded */
+    g_assert (mm_location_gps_fix_get_bytes_variant (fix) == NULL);
+    g_assert (!mm_location_gps_fix_add_trace (fix, "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74"));
+    g_assert (!mm_location_gps_fix_add_trace (fix, "$PQXYZ,1,2*00"));
+
+    /* No date known yet, so no timestamp either */
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GPGGA,123519.50,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"));
+    g_assert_cmpint (mm_location_gps_fix_get_timestamp (fix), ==, -1);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_latitude (fix) - 48.1173), <, 1e-6);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_longitude (fix) - 11.516667), <, 1e-6);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_altitude (fix) - 545.4), <, 1e-3);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_hdop (fix) - 0.9), <, 1e-3);
+    g_assert_cmpuint (mm_location_gps_fix_get_n_satellites (fix), ==, 8);
+    g_assert_cmpuint (mm_location_gps_fix_get_fix_quality (fix), ==, 1);
+    g_assert (mm_location_gps_fix_get_speed (fix) == MM_LOCATION_SPEED_UNKNOWN);
+
+    /* 1994-03-23 12:35:19.5 UTC; speed given in knots */
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GPRMC,123519.50,A,4807.038,N,01131.000,W,022.4,084.4,230394,003.1,W*6A"));
+    g_assert_cmpint (mm_location_gps_fix_get_timestamp (fix), ==, G_GINT64_CONSTANT (764426119500));
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_longitude (fix) + 11.516667), <, 1e-6);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_speed (fix) - 11.524), <, 1e-3);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_heading (fix) - 84.4), <, 1e-3);
+
+    /* Any talker is accepted */
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GNGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39"));
+    g_assert_cmpuint (mm_location_gps_fix_get_fix_type (fix), ==, 3);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_hdop (fix) - 1.3), <, 1e-3);
+
+    /* Speed given in km/h */
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*48"));
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_speed (fix) - 2.833), <, 1e-3);
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_heading (fix) - 54.7), <, 1e-3);
+
+    /* GGA crossing midnight before the RMC with the new date arrives */
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GPRMC,235959.90,A,4807.038,S,01131.000,W,,,311299,003.1,W*6A"));
+    g_assert_cmpint (mm_location_gps_fix_get_timestamp (fix), ==, G_GINT64_CONSTANT (946684799900));
+    g_assert (mm_location_gps_fix_get_heading (fix) == MM_LOCATION_HEADING_UNKNOWN);
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GPGGA,000000.10,,,,,0,00,99.99,,M,,M,,*47"));
+    g_assert_cmpint (mm_location_gps_fix_get_timestamp (fix), ==, G_GINT64_CONSTANT (946684800100));
+
+    /* Fix lost */
+    g_assert_cmpuint (mm_location_gps_fix_get_fix_quality (fix), ==, 0);
+    g_assert (mm_location_gps_fix_get_latitude (fix) == MM_LOCATION_LATITUDE_UNKNOWN);
+    g_assert (mm_location_gps_fix_get_longitude (fix) == MM_LOCATION_LONGITUDE_UNKNOWN);
+    g_assert (mm_location_gps_fix_get_altitude (fix) == MM_LOCATION_ALTITUDE_UNKNOWN);
+
+    g_object_unref (fix);
+}
+
+/**************************************************************/
+
+static void
+test_bytes_variant (void)
+{
+    MMLocationGpsFix *fix;
+    MMLocationGpsFix *copy;
+    GVariant *bytes;
+    GVariant *truncated;
+    const guint8 *buffer;
+    gsize size = 0;
+    GError *error = NULL;
+
+    fix = mm_location_gps_fix_new ();
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GPRMC,123519.50,A,4807.038,N,01131.000,W,022.4,084.4,230394,003.1,W*6A"));
+    g_assert (mm_location_gps_fix_add_trace (fix, "$GPGGA,123519.50,4807.038,N,01131.000,W,2,11,0.9,-12.3,M,46.9,M,,*47"));
+
+    bytes = mm_location_gps_fix_get_bytes_variant (fix);
+    g_assert (bytes != NULL);
+    buffer = g_variant_get_fixed_array (bytes, &size, sizeof (guint8));
+    g_assert_cmpuint (size, ==, 36);
+
+    /* Version, known fields, quality, satellites, little endian latitude */
+    g_assert_cmpuint (buffer[0], ==, 1);
+    g_assert_cmpuint (buffer[1], ==, 0x3F);
+    g_assert_cmpuint (buffer[2], ==, 2);
+    g_assert_cmpuint (buffer[4], ==, 11);
+    g_assert_cmpuint (buffer[16] | (buffer[17] << 8) | (buffer[18] << 16) | ((guint32) buffer[19] << 24), ==, 481173000);
+
+    copy = mm_location_gps_fix_new_from_bytes_variant (bytes, &error);
+    g_assert_no_error (error);
+    g_assert (copy != NULL);
+    g_assert_cmpint (mm_location_gps_fix_get_timestamp (copy), ==, mm_location_gps_fix_get_timestamp (fix));
+    g_assert_cmpfloat (mm_location_gps_fix_get_latitude (copy), ==, mm_location_gps_fix_get_latitude (fix));
+    g_assert_cmpfloat (mm_location_gps_fix_get_longitude (copy), ==, mm_location_gps_fix_get_longitude (fix));
+    g_assert_cmpfloat (mm_location_gps_fix_get_altitude (copy), ==, mm_location_gps_fix_get_altitude (fix));
+    g_assert_cmpfloat (ABS (mm_location_gps_fix_get_altitude (copy) + 12.3), <, 1e-3);
+    g_assert_cmpfloat (mm_location_gps_fix_get_speed (copy), ==, mm_location_gps_fix_get_speed (fix));
+    g_assert_cmpfloat (mm_location_gps_fix_get_heading (copy), ==, mm_location_gps_fix_get_heading (fix));
+    g_assert_cmpfloat (mm_location_gps_fix_get_hdop (copy), ==, mm_location_gps_fix_get_hdop (fix));
+    g_assert_cmpuint (mm_location_gps_fix_get_n_satellites (copy), ==, 11);
+    g_assert_cmpuint (mm_location_gps_fix_get_fix_quality (copy), ==, 2);
+    g_object_unref (copy);
+
+    /* Truncated payloads are rejected */
+    truncated = g_variant_ref_sink (g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, buffer, 10, sizeof (guint8)));
+    copy = mm_location_gps_fix_new_from_bytes_variant (truncated, &error);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS);
+    g_assert (copy == NULL);
+    g_clear_error (&error);
+    g_variant_unref (truncated);
+    g_variant_unref (bytes);
+
+    g_object_unref (fix);
+}
+
+/**************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/LocationGpsFix/decode",        test_decode);
+    g_test_add_func ("/MM/LocationGpsFix/bytes-variant", test_bytes_variant);
+
+    return g_test_run ();
+}
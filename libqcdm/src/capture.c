@@ -0,0 +1,383 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <endian.h>
+
+#include "capture.h"
+#include "errors.h"
+#include "dm-commands.h"
+
+/* Input is read straight into a large buffer and every complete frame is
+ * decapsulated in place; only a trailing partial frame is ever moved back to
+ * the start of the buffer.  Records are batched in the output buffer so that
+ * the capture file sees a few large writes instead of one per frame.
+ */
+#define INBUF_SIZE  (QCDM_CAPTURE_MAX_FRAME_LEN * 16)
+#define OUTBUF_SIZE (64 * 1024)
+
+typedef struct {
+    uint16_t log_code;
+    QcdmCaptureLogFunc func;
+    void *user_data;
+} LogHandler;
+
+struct QcdmCapture {
+    int out_fd;
+
+    /* Pending input lives in [start, end); [start, scanned) is known not to
+     * contain a control character. */
+    char *inbuf;
+    size_t start;
+    size_t scanned;
+    size_t end;
+
+    char *outbuf;
+    size_t outbuf_len;
+
+    char frame[QCDM_CAPTURE_MAX_FRAME_LEN + 1];
+
+    /* One bit per log code, so that unhandled items are skipped quickly */
+    uint8_t log_mask[(UINT16_MAX + 1) / 8];
+    LogHandler *handlers;
+    size_t n_handlers;
+
+    QcdmCaptureStats stats;
+};
+
+/**********************************************************************/
+
+static qcdmbool
+write_all (int fd, const char *buf, size_t len)
+{
+    ssize_t n;
+
+    while (len > 0) {
+        n = write (fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return FALSE;
+        }
+        buf += n;
+        len -= n;
+    }
+    return TRUE;
+}
+
+static uint64_t
+now_usecs (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_REALTIME, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**********************************************************************/
+
+int
+qcdm_capture_flush (QcdmCapture *capture)
+{
+    qcdm_return_val_if_fail (capture != NULL, -QCDM_ERROR_INVALID_ARGUMENTS);
+
+    if (capture->outbuf_len == 0)
+        return 0;
+
+    if (!write_all (capture->out_fd, capture->outbuf, capture->outbuf_len)) {
+        qcdm_err (0, "failed to write capture file: %s", strerror (errno));
+        return -QCDM_ERROR_WRITE_FAILED;
+    }
+
+    capture->stats.bytes_written += capture->outbuf_len;
+    capture->outbuf_len = 0;
+    return 0;
+}
+
+static int
+store_frame (QcdmCapture *capture, const char *buf, size_t len, uint64_t timestamp)
+{
+    uint32_t record_len;
+    uint64_t record_timestamp;
+    char *p;
+    int err;
+
+    if (capture->out_fd < 0)
+        return 0;
+
+    if (capture->outbuf_len + QCDM_CAPTURE_RECORD_LEN + len > OUTBUF_SIZE) {
+        err = qcdm_capture_flush (capture);
+        if (err < 0)
+            return err;
+    }
+
+    p = capture->outbuf + capture->outbuf_len;
+    record_len = htole32 ((uint32_t) len);
+    record_timestamp = htole64 (timestamp);
+    memcpy (p, &record_len, sizeof (record_len));
+    memcpy (p + 4, &record_timestamp, sizeof (record_timestamp));
+    memcpy (p + QCDM_CAPTURE_RECORD_LEN, buf, len);
+    capture->outbuf_len += QCDM_CAPTURE_RECORD_LEN + len;
+    return 0;
+}
+
+static void
+dispatch_log_item (QcdmCapture *capture, const char *buf, size_t len)
+{
+    const DMCmdLog *log_cmd = (const DMCmdLog *) buf;
+    uint16_t log_code;
+    uint64_t timestamp;
+    size_t i;
+
+    if (len < sizeof (DMCmdLog) || buf[0] != DIAG_CMD_LOG)
+        return;
+
+    log_code = le16toh (log_cmd->log_code);
+    if (!(capture->log_mask[log_code / 8] & (1 << (log_code % 8))))
+        return;
+
+    timestamp = le64toh (log_cmd->timestamp);
+    capture->stats.log_items++;
+    for (i = 0; i < capture->n_handlers; i++) {
+        if (capture->handlers[i].log_code == log_code)
+            capture->handlers[i].func (log_code, timestamp, buf, len, capture->handlers[i].user_data);
+    }
+}
+
+static int
+process_input (QcdmCapture *capture, uint64_t timestamp)
+{
+    const char *ctrl;
+    const char *frame;
+    size_t frame_len;
+    size_t decap_len = 0;
+    size_t used = 0;
+    qcdmbool more = FALSE;
+    int err;
+
+    while (capture->start < capture->end) {
+        frame = capture->inbuf + capture->start;
+        ctrl = memchr (capture->inbuf + capture->scanned,
+                       DIAG_CONTROL_CHAR,
+                       capture->end - capture->scanned);
+        if (!ctrl) {
+            capture->scanned = capture->end;
+            /* Too long to be a frame; resynchronize on the next control char */
+            if (capture->end - capture->start > QCDM_CAPTURE_MAX_FRAME_LEN) {
+                qcdm_warn (0, "discarding %zu bytes without frame boundary",
+                           capture->end - capture->start);
+                capture->stats.bytes_dropped += capture->end - capture->start;
+                capture->start = capture->end;
+            }
+            break;
+        }
+
+        frame_len = ctrl - frame + 1;
+        capture->start += frame_len;
+        capture->scanned = capture->start;
+
+        /* A bare control character is a leading or repeated flag, not an
+         * empty frame */
+        if (frame_len == 1)
+            continue;
+
+        /* Only a single frame is given, so a successful decapsulation always
+         * uses all of it; asking for more data means the frame is too short
+         * or ends in an escape character, which is just as invalid. */
+        if (frame_len > QCDM_CAPTURE_MAX_FRAME_LEN ||
+            !dm_decapsulate_buffer (frame, frame_len,
+                                    capture->frame, sizeof (capture->frame),
+                                    &decap_len, &used, &more) ||
+            more ||
+            decap_len == 0) {
+            capture->stats.bad_frames++;
+            continue;
+        }
+
+        capture->stats.frames++;
+        err = store_frame (capture, capture->frame, decap_len, timestamp);
+        if (err < 0)
+            return err;
+        dispatch_log_item (capture, capture->frame, decap_len);
+    }
+
+    /* Move any partial frame to the start of the buffer */
+    if (capture->start == capture->end)
+        capture->start = capture->scanned = capture->end = 0;
+    else if (capture->start > 0) {
+        memmove (capture->inbuf,
+                 capture->inbuf + capture->start,
+                 capture->end - capture->start);
+        capture->end -= capture->start;
+        capture->scanned -= capture->start;
+        capture->start = 0;
+    }
+
+    return 0;
+}
+
+/**********************************************************************/
+
+QcdmCapture *
+qcdm_capture_new (int out_fd, int *out_error)
+{
+    QcdmCapture *capture;
+    uint32_t version;
+
+    capture = calloc (1, sizeof (QcdmCapture));
+    if (!capture)
+        goto oom;
+    capture->out_fd = out_fd;
+
+    capture->inbuf = malloc (INBUF_SIZE);
+    if (!capture->inbuf)
+        goto oom;
+
+    if (out_fd >= 0) {
+        capture->outbuf = malloc (OUTBUF_SIZE);
+        if (!capture->outbuf)
+            goto oom;
+
+        memset (capture->outbuf, 0, QCDM_CAPTURE_HEADER_LEN);
+        memcpy (capture->outbuf, QCDM_CAPTURE_MAGIC, QCDM_CAPTURE_MAGIC_LEN);
+        version = htole32 (QCDM_CAPTURE_VERSION);
+        memcpy (capture->outbuf + QCDM_CAPTURE_MAGIC_LEN, &version, sizeof (version));
+        capture->outbuf_len = QCDM_CAPTURE_HEADER_LEN;
+
+        /* Write the header right away so that even an empty capture is valid */
+        if (qcdm_capture_flush (capture) < 0) {
+            if (out_error)
+                *out_error = -QCDM_ERROR_WRITE_FAILED;
+            qcdm_capture_free (capture);
+            return NULL;
+        }
+    }
+
+    return capture;
+
+oom:
+    qcdm_err (0, "failed to allocate capture buffers");
+    if (out_error)
+        *out_error = -QCDM_ERROR_NO_MEMORY;
+    qcdm_capture_free (capture);
+    return NULL;
+}
+
+int
+qcdm_capture_free (QcdmCapture *capture)
+{
+    int err = 0;
+
+    if (!capture)
+        return 0;
+
+    if (capture->outbuf)
+        err = qcdm_capture_flush (capture);
+
+    free (capture->handlers);
+    free (capture->outbuf);
+    free (capture->inbuf);
+    free (capture);
+    return err;
+}
+
+qcdmbool
+qcdm_capture_add_log_handler (QcdmCapture *capture,
+                              uint16_t log_code,
+                              QcdmCaptureLogFunc func,
+                              void *user_data)
+{
+    LogHandler *handlers;
+
+    qcdm_return_val_if_fail (capture != NULL, FALSE);
+    qcdm_return_val_if_fail (func != NULL, FALSE);
+
+    handlers = realloc (capture->handlers, (capture->n_handlers + 1) * sizeof (LogHandler));
+    if (!handlers)
+        return FALSE;
+
+    handlers[capture->n_handlers].log_code = log_code;
+    handlers[capture->n_handlers].func = func;
+    handlers[capture->n_handlers].user_data = user_data;
+    capture->handlers = handlers;
+    capture->n_handlers++;
+    capture->log_mask[log_code / 8] |= 1 << (log_code % 8);
+    return TRUE;
+}
+
+ssize_t
+qcdm_capture_read (QcdmCapture *capture, int port_fd)
+{
+    ssize_t n;
+
+    qcdm_return_val_if_fail (capture != NULL, -1);
+
+    do {
+        n = read (port_fd, capture->inbuf + capture->end, INBUF_SIZE - capture->end);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0)
+        return n;
+
+    capture->end += n;
+    capture->stats.bytes_read += n;
+    if (process_input (capture, now_usecs ()) < 0)
+        return -1;
+    return n;
+}
+
+int
+qcdm_capture_feed (QcdmCapture *capture,
+                   const char *buf,
+                   size_t len,
+                   uint64_t timestamp)
+{
+    size_t chunk;
+    int err;
+
+    qcdm_return_val_if_fail (capture != NULL, -QCDM_ERROR_INVALID_ARGUMENTS);
+    qcdm_return_val_if_fail (buf != NULL || len == 0, -QCDM_ERROR_INVALID_ARGUMENTS);
+
+    while (len > 0) {
+        chunk = INBUF_SIZE - capture->end;
+        if (chunk > len)
+            chunk = len;
+
+        memcpy (capture->inbuf + capture->end, buf, chunk);
+        capture->end += chunk;
+        capture->stats.bytes_read += chunk;
+        buf += chunk;
+        len -= chunk;
+
+        err = process_input (capture, timestamp);
+        if (err < 0)
+            return err;
+    }
+
+    return 0;
+}
+
+void
+qcdm_capture_get_stats (QcdmCapture *capture, QcdmCaptureStats *out_stats)
+{
+    qcdm_return_if_fail (capture != NULL);
+    qcdm_return_if_fail (out_stats != NULL);
+
+    *out_stats = capture->stats;
+}
@@ -0,0 +1,96 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBQCDM_CAPTURE_H
+#define LIBQCDM_CAPTURE_H
+
+#include <sys/types.h>
+
+#include "utils.h"
+
+/* Capture files start with an 8-byte magic followed by the little-endian
+ * 32-bit format version and 32 reserved bits.  Each decapsulated frame is
+ * then stored as a record made of its little-endian 32-bit length, the
+ * little-endian 64-bit host receive time in microseconds since the epoch,
+ * and the frame itself (without CRC or trailing control character).
+ */
+#define QCDM_CAPTURE_MAGIC       "QCDMCAP"
+#define QCDM_CAPTURE_MAGIC_LEN   8
+#define QCDM_CAPTURE_VERSION     1
+#define QCDM_CAPTURE_HEADER_LEN  16
+#define QCDM_CAPTURE_RECORD_LEN  12
+
+/* Largest escaped frame accepted; longer runs of data without a control
+ * character are discarded.
+ */
+#define QCDM_CAPTURE_MAX_FRAME_LEN 16384
+
+typedef struct QcdmCapture QcdmCapture;
+
+typedef struct {
+    uint64_t bytes_read;     /* raw bytes received from the port */
+    uint64_t bytes_dropped;  /* raw bytes discarded while resynchronizing */
+    uint64_t frames;         /* valid frames decapsulated */
+    uint64_t bad_frames;     /* malformed frames or CRC failures */
+    uint64_t log_items;      /* DIAG_CMD_LOG frames passed to a handler */
+    uint64_t bytes_written;  /* bytes stored in the capture file */
+} QcdmCaptureStats;
+
+/* Called with the whole DIAG_CMD_LOG frame, so that it can be given as is to
+ * the qcdm_log_item_*_new() parsers; @timestamp is the one reported by the
+ * modem in the log item header.  Handlers run in the capture path and should
+ * return quickly.
+ */
+typedef void (*QcdmCaptureLogFunc) (uint16_t log_code,
+                                    uint64_t timestamp,
+                                    const char *buf,
+                                    size_t len,
+                                    void *user_data);
+
+/* @out_fd may be -1 to only decode log items without storing them; on
+ * failure @out_error is set to -QCDM_ERROR_NO_MEMORY or, if the capture file
+ * header can't be written, -QCDM_ERROR_WRITE_FAILED.
+ */
+QcdmCapture *qcdm_capture_new             (int out_fd, int *out_error);
+
+/* Flushes any pending record and frees the capture; the file descriptor is
+ * not closed.
+ */
+int          qcdm_capture_free            (QcdmCapture *capture);
+
+qcdmbool     qcdm_capture_add_log_handler (QcdmCapture *capture,
+                                           uint16_t log_code,
+                                           QcdmCaptureLogFunc func,
+                                           void *user_data);
+
+/* Reads whatever is available in the QCDM port and processes every complete
+ * frame, all of them stamped with the current time.  Returns the number of
+ * bytes read, 0 on EOF or -1 with errno set if either reading the port or
+ * writing the capture file failed.
+ */
+ssize_t      qcdm_capture_read            (QcdmCapture *capture, int port_fd);
+
+/* Processes already received data; returns 0 or a negative QCDM error */
+int          qcdm_capture_feed            (QcdmCapture *capture,
+                                           const char *buf,
+                                           size_t len,
+                                           uint64_t timestamp);
+
+int          qcdm_capture_flush           (QcdmCapture *capture);
+
+void         qcdm_capture_get_stats       (QcdmCapture *capture,
+                                           QcdmCaptureStats *out_stats);
+
+#endif  /* LIBQCDM_CAPTURE_H */
@@ -53,6 +53,8 @@ enum {
     QCDM_ERROR_NV_ERROR_BAD_PARAMETER = 18,
     QCDM_ERROR_NV_ERROR_READ_ONLY = 19, /* NV location is read-only */
     QCDM_ERROR_RESPONSE_FAILED = 20,    /* command-specific failure */
+    QCDM_ERROR_WRITE_FAILED = 21,       /* storing captured data failed */
+    QCDM_ERROR_NO_MEMORY = 22,          /* memory allocation failed */
 };
 
 #define qcdm_assert assert
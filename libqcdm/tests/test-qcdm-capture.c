@@ -0,0 +1,281 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <endian.h>
+
+#include "test-qcdm-capture.h"
+#include "capture.h"
+#include "utils.h"
+#include "dm-commands.h"
+
+#define TEST_LOG_CODE     0x108B
+#define TEST_OTHER_CODE   0x1234
+#define TEST_N_FRAMES     2000
+#define TEST_MAX_PAYLOAD  600
+
+typedef struct {
+    GByteArray *frame;
+    gsize       end;       /* offset right after the frame in the stream */
+    guint64     timestamp; /* host timestamp when the frame was completed */
+} Expected;
+
+typedef struct {
+    GArray *expected;
+    guint   n_calls;
+} HandlerData;
+
+/* Appends the encapsulated frame to the stream */
+static void
+append_frame (GByteArray *stream, const guint8 *frame, gsize len, gboolean corrupt)
+{
+    char inbuf[TEST_MAX_PAYLOAD + 64];
+    char outbuf[(TEST_MAX_PAYLOAD + 64) * 2];
+    gsize encap_len;
+
+    g_assert (len + 2 <= sizeof (inbuf));
+    memcpy (inbuf, frame, len);
+    encap_len = dm_encapsulate_buffer (inbuf, len, sizeof (inbuf), outbuf, sizeof (outbuf));
+    g_assert (encap_len > 0);
+
+    /* The command code is never escaped, so flipping its lowest bit just
+     * breaks the CRC */
+    if (corrupt)
+        outbuf[0] ^= 0x01;
+
+    g_byte_array_append (stream, (const guint8 *) outbuf, encap_len);
+}
+
+static GByteArray *
+build_frame (GRand *rand, guint i)
+{
+    /* Plenty of control and escape characters to exercise unescaping */
+    static const guint8 bytes[] = { 0x7E, 0x7D, 0x5E, 0x5D, 0x00, 0xFF, 0x10, 0x42 };
+    GByteArray *frame;
+    DMCmdLog log_cmd;
+    guint payload_len;
+    guint j;
+    guint8 b;
+
+    frame = g_byte_array_new ();
+    payload_len = g_rand_int_range (rand, 1, TEST_MAX_PAYLOAD);
+
+    if (i % 3 == 2) {
+        b = DIAG_CMD_STATUS;
+        g_byte_array_append (frame, &b, 1);
+    } else {
+        memset (&log_cmd, 0, sizeof (log_cmd));
+        log_cmd.code = DIAG_CMD_LOG;
+        log_cmd.len = htole16 (payload_len + 12);
+        log_cmd._unknown2 = log_cmd.len;
+        log_cmd.log_code = htole16 (i % 3 == 0 ? TEST_LOG_CODE : TEST_OTHER_CODE);
+        log_cmd.timestamp = htole64 (i);
+        g_byte_array_append (frame, (const guint8 *) &log_cmd, sizeof (log_cmd));
+    }
+
+    for (j = 0; j < payload_len; j++) {
+        b = bytes[g_rand_int_range (rand, 0, G_N_ELEMENTS (bytes))];
+        g_byte_array_append (frame, &b, 1);
+    }
+
+    return frame;
+}
+
+static void
+log_handler (uint16_t log_code,
+             uint64_t timestamp,
+             const char *buf,
+             size_t len,
+             void *user_data)
+{
+    HandlerData *data = user_data;
+    Expected *e;
+
+    g_assert_cmpuint (log_code, ==, TEST_LOG_CODE);
+
+    /* Frames were built with their index as modem timestamp */
+    g_assert_cmpuint (timestamp, <, data->expected->len);
+    e = &g_array_index (data->expected, Expected, timestamp);
+    g_assert_cmpuint (len, ==, e->frame->len);
+    g_assert (memcmp (buf, e->frame->data, len) == 0);
+    data->n_calls++;
+}
+
+void
+test_capture_replay (void *f, void *data)
+{
+    GRand *rand;
+    GByteArray *stream;
+    GArray *expected;
+    HandlerData handler_data = { NULL, 0 };
+    QcdmCapture *capture;
+    QcdmCaptureStats stats;
+    gchar *path = NULL;
+    gchar *contents = NULL;
+    gsize contents_len = 0;
+    gsize offset;
+    gsize next;
+    gsize chunk;
+    guint64 ts;
+    guint n_bad = 0;
+    guint n_logs = 0;
+    guint i;
+    guint e_idx;
+    int fd;
+    int err = 0;
+
+    rand = g_rand_new_with_seed (1234);
+    stream = g_byte_array_new ();
+    expected = g_array_new (FALSE, TRUE, sizeof (Expected));
+
+    for (i = 0; i < TEST_N_FRAMES; i++) {
+        Expected e = { NULL, 0, 0 };
+
+        /* Corrupted frames must be skipped without losing the next one */
+        if (i % 97 == 0) {
+            GByteArray *bad;
+
+            bad = build_frame (rand, i);
+            append_frame (stream, bad->data, bad->len, TRUE);
+            g_byte_array_unref (bad);
+            n_bad++;
+        }
+
+        e.frame = build_frame (rand, i);
+        append_frame (stream, e.frame->data, e.frame->len, FALSE);
+        e.end = stream->len;
+        g_array_append_val (expected, e);
+        if (i % 3 == 0)
+            n_logs++;
+    }
+
+    fd = g_file_open_tmp ("test-qcdm-capture-XXXXXX", &path, NULL);
+    g_assert (fd >= 0);
+
+    capture = qcdm_capture_new (fd, &err);
+    g_assert (capture);
+    g_assert_cmpint (err, ==, 0);
+
+    handler_data.expected = expected;
+    g_assert (qcdm_capture_add_log_handler (capture, TEST_LOG_CODE, log_handler, &handler_data));
+
+    /* Replay the stream in random chunks, each one with its own timestamp */
+    for (offset = 0, ts = 1000, e_idx = 0; offset < stream->len; offset = next, ts++) {
+        chunk = g_rand_int_range (rand, 1, 8192);
+        next = MIN (offset + chunk, stream->len);
+        g_assert_cmpint (qcdm_capture_feed (capture, (const char *) stream->data + offset, next - offset, ts), ==, 0);
+        for (; e_idx < expected->len && g_array_index (expected, Expected, e_idx).end <= next; e_idx++)
+            g_array_index (expected, Expected, e_idx).timestamp = ts;
+    }
+    g_assert_cmpuint (e_idx, ==, expected->len);
+
+    qcdm_capture_get_stats (capture, &stats);
+    g_assert_cmpuint (stats.bytes_read, ==, stream->len);
+    g_assert_cmpuint (stats.bytes_dropped, ==, 0);
+    g_assert_cmpuint (stats.frames, ==, TEST_N_FRAMES);
+    g_assert_cmpuint (stats.bad_frames, ==, n_bad);
+    g_assert_cmpuint (stats.log_items, ==, n_logs);
+    g_assert_cmpuint (handler_data.n_calls, ==, n_logs);
+
+    g_assert_cmpint (qcdm_capture_free (capture), ==, 0);
+    close (fd);
+
+    /* Every valid frame must be in the capture file, in order */
+    g_assert (g_file_get_contents (path, &contents, &contents_len, NULL));
+    g_assert_cmpuint (contents_len, >=, QCDM_CAPTURE_HEADER_LEN);
+    g_assert (memcmp (contents, QCDM_CAPTURE_MAGIC, QCDM_CAPTURE_MAGIC_LEN) == 0);
+    g_assert_cmpuint (le32toh (*(guint32 *) (contents + QCDM_CAPTURE_MAGIC_LEN)), ==, QCDM_CAPTURE_VERSION);
+
+    offset = QCDM_CAPTURE_HEADER_LEN;
+    for (i = 0; i < expected->len; i++) {
+        Expected *e = &g_array_index (expected, Expected, i);
+        guint32 record_len;
+        guint64 record_ts;
+
+        g_assert_cmpuint (offset + QCDM_CAPTURE_RECORD_LEN, <=, contents_len);
+        memcpy (&record_len, contents + offset, sizeof (record_len));
+        memcpy (&record_ts, contents + offset + 4, sizeof (record_ts));
+        g_assert_cmpuint (le32toh (record_len), ==, e->frame->len);
+        g_assert_cmpuint (le64toh (record_ts), ==, e->timestamp);
+        offset += QCDM_CAPTURE_RECORD_LEN;
+
+        g_assert_cmpuint (offset + e->frame->len, <=, contents_len);
+        g_assert (memcmp (contents + offset, e->frame->data, e->frame->len) == 0);
+        offset += e->frame->len;
+    }
+    g_assert_cmpuint (offset, ==, contents_len);
+
+    g_unlink (path);
+    g_free (path);
+    g_free (contents);
+    for (i = 0; i < expected->len; i++)
+        g_byte_array_unref (g_array_index (expected, Expected, i).frame);
+    g_array_unref (expected);
+    g_byte_array_unref (stream);
+    g_rand_free (rand);
+}
+
+void
+test_capture_resync (void *f, void *data)
+{
+    static const guint8 status[] = { DIAG_CMD_STATUS, 0x01, 0x02, 0x03 };
+    static const guint8 truncated[] = { 0x01, 0x02, 0x03, 0x7D, 0x7E };
+    static const guint8 control = 0x7E;
+    QcdmCapture *capture;
+    QcdmCaptureStats stats;
+    GByteArray *stream;
+    guint8 junk[4096];
+    guint i;
+
+    stream = g_byte_array_new ();
+
+    /* A leading flag is not a frame */
+    g_byte_array_append (stream, &control, 1);
+
+    /* More data than any frame could hold without a control character */
+    memset (junk, 0x01, sizeof (junk));
+    for (i = 0; i < (QCDM_CAPTURE_MAX_FRAME_LEN / sizeof (junk)) + 2; i++)
+        g_byte_array_append (stream, junk, sizeof (junk));
+    g_byte_array_append (stream, &control, 1);
+    append_frame (stream, status, sizeof (status), FALSE);
+
+    /* A frame ending in an escape character can never be completed */
+    g_byte_array_append (stream, truncated, sizeof (truncated));
+
+    /* Neither are back-to-back flags */
+    g_byte_array_append (stream, &control, 1);
+    g_byte_array_append (stream, &control, 1);
+    append_frame (stream, status, sizeof (status), FALSE);
+
+    capture = qcdm_capture_new (-1, NULL);
+    g_assert (capture);
+
+    for (i = 0; i < stream->len; i += sizeof (junk))
+        g_assert_cmpint (qcdm_capture_feed (capture, (const char *) stream->data + i, MIN (sizeof (junk), stream->len - i), 0), ==, 0);
+
+    qcdm_capture_get_stats (capture, &stats);
+    g_assert_cmpuint (stats.bytes_read, ==, stream->len);
+    g_assert_cmpuint (stats.bytes_dropped, >, QCDM_CAPTURE_MAX_FRAME_LEN);
+    g_assert_cmpuint (stats.frames, ==, 2);
+    g_assert_cmpuint (stats.bad_frames, ==, 2);
+    g_assert_cmpuint (stats.log_items, ==, 0);
+    g_assert_cmpuint (stats.bytes_written, ==, 0);
+
+    g_assert_cmpint (qcdm_capture_free (capture), ==, 0);
+    g_byte_array_unref (stream);
+}
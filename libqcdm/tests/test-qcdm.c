@@ -23,6 +23,7 @@
 #include "test-qcdm-com.h"
 #include "test-qcdm-result.h"
 #include "test-qcdm-utils.h"
+#include "test-qcdm-capture.h"
 
 typedef struct {
     gpointer com_data;
@@ -90,6 +91,8 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_result_uint32, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_uint8, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_uint8_array, NULL));
+    g_test_suite_add (suite, TESTCASE (test_capture_replay, NULL));
+    g_test_suite_add (suite, TESTCASE (test_capture_resync, NULL));
 
     /* Live tests */
     if (port) {
@@ -21,6 +21,7 @@
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
 
+#include "mm-modem-helpers.h"
 #include "mm-modem-helpers-altair-lte.h"
 
 #define MM_ALTAIR_IMS_PDN_CID           1
@@ -86,9 +87,9 @@ mm_altair_parse_ceer_response (const gchar *response,
     /* The response we are interested in looks so:
      * +CEER: EPS_AND_NON_EPS_SERVICES_NOT_ALLOWED
      */
-    r = g_regex_new ("\\+CEER:\\s*(\\w*)?",
-                     G_REGEX_RAW,
-                     0, NULL);
+    r = mm_regex_cache_get ("\\+CEER:\\s*(\\w*)?",
+                            G_REGEX_RAW,
+                            0, NULL);
     g_assert (r != NULL);
 
     if (!g_regex_match (r, response, 0, &match_info)) {
@@ -115,7 +116,7 @@ mm_altair_parse_cid (const gchar *response, GError **error)
     mm_autoptr(GMatchInfo) match_info = NULL;
     guint cid = -1;
 
-    regex = g_regex_new ("\\%CGINFO:\\s*(\\d+)", G_REGEX_RAW, 0, NULL);
+    regex = mm_regex_cache_get ("\\%CGINFO:\\s*(\\d+)", G_REGEX_RAW, 0, NULL);
     g_assert (regex);
     if (!g_regex_match_full (regex, response, strlen (response), 0, 0, &match_info, error)) {
         return -1;
@@ -150,9 +151,9 @@ mm_altair_parse_vendor_pco_info (const gchar *pco_info, GError **error)
      *     Solicited response: %PCOINFO:<mode>,<cid>[,<pcoid>[,<payload>]]
      *     Unsolicited response: %PCOINFO:<cid>,<pcoid>[,<payload>]
      */
-    regex = g_regex_new ("\\%PCOINFO:(?:\\s*\\d+\\s*,)?(\\d+)\\s*(,([^,\\)]*),([0-9A-Fa-f]*))?",
-                         G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                         0, NULL);
+    regex = mm_regex_cache_get ("\\%PCOINFO:(?:\\s*\\d+\\s*,)?(\\d+)\\s*(,([^,\\)]*),([0-9A-Fa-f]*))?",
+                                G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
+                                0, NULL);
     g_assert (regex);
     if (!g_regex_match_full (regex, pco_info, strlen (pco_info), 0, 0, &match_info, error)) {
         return NULL;
@@ -533,8 +533,8 @@ modem_power_off (MMIfaceModem        *self,
 
     ctx = g_slice_new0 (PowerOffContext);
     ctx->port = mm_base_modem_get_port_primary (MM_BASE_MODEM (self));
-    ctx->shutdown_regex = g_regex_new ("\\r\\n\\^SHUTDOWN\\r\\n",
-                                       G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    ctx->shutdown_regex = mm_regex_cache_get ("\\r\\n\\^SHUTDOWN\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     ctx->timeout_id = g_timeout_add_seconds (MAX_POWER_OFF_WAIT_TIME_SECS,
                                              (GSourceFunc)power_off_timeout_cb,
                                              task);
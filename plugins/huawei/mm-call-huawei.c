@@ -25,6 +25,7 @@
 #include <libmm-glib.h>
 
 #include "mm-log.h"
+#include "mm-modem-helpers.h"
 #include "mm-base-modem-at.h"
 #include "mm-broadband-modem-huawei.h"
 #include "mm-call-huawei.h"
@@ -257,17 +258,17 @@ common_setup_cleanup_unsolicited_events (MMCallHuawei  *self,
     GList       *ports, *l;
 
     if (G_UNLIKELY (!self->priv->conf_regex))
-        self->priv->conf_regex = g_regex_new ("\\r\\n\\^CONF:\\s*(\\d+)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        self->priv->conf_regex = mm_regex_cache_get ("\\r\\n\\^CONF:\\s*(\\d+)\\r\\n",
+                                                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     if (G_UNLIKELY (!self->priv->conn_regex))
-        self->priv->conn_regex = g_regex_new ("\\r\\n\\^CONN:\\s*(\\d+),(\\d+)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        self->priv->conn_regex = mm_regex_cache_get ("\\r\\n\\^CONN:\\s*(\\d+),(\\d+)\\r\\n",
+                                                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     if (G_UNLIKELY (!self->priv->cend_regex))
-        self->priv->cend_regex = g_regex_new ("\\r\\n\\^CEND:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),?\\s*(\\d*)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        self->priv->cend_regex = mm_regex_cache_get ("\\r\\n\\^CEND:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),?\\s*(\\d*)\\r\\n",
+                                                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     if (G_UNLIKELY (!self->priv->ddtmf_regex))
-        self->priv->ddtmf_regex = g_regex_new ("\\r\\n\\^DDTMF:\\s*([0-9A-D\\*\\#])\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        self->priv->ddtmf_regex = mm_regex_cache_get ("\\r\\n\\^DDTMF:\\s*([0-9A-D\\*\\#])\\r\\n",
+                                                      G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 
     g_object_get (self,
                   MM_BASE_CALL_MODEM, &modem,
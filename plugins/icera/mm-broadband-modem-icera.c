@@ -133,8 +133,8 @@ load_supported_modes_finish (MMIfaceModem *self,
      * %IPSYS: (0-3,5),(0-3)
      */
 
-    r = g_regex_new ("\\%IPSYS:\\s*\\((.*)\\)\\s*,\\((.*)\\)",
-                     G_REGEX_RAW, 0, NULL);
+    r = mm_regex_cache_get ("\\%IPSYS:\\s*\\((.*)\\)\\s*,\\((.*)\\)",
+                            G_REGEX_RAW, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, response, 0, &match_info);
@@ -1125,9 +1125,9 @@ parse_bands (const gchar *response, guint32 *out_len)
      *   ...
      * with 1 and 0 indicating whether the particular band is enabled or not.
      */
-    r = g_regex_new ("^\"(\\w+)\": (\\d)",
-                     G_REGEX_MULTILINE, G_REGEX_MATCH_NEWLINE_ANY,
-                     NULL);
+    r = mm_regex_cache_get ("^\"(\\w+)\": (\\d)",
+                            G_REGEX_MULTILINE, G_REGEX_MATCH_NEWLINE_ANY,
+                            NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, response, 0, &info);
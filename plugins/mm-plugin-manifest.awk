@@ -0,0 +1,196 @@
+# -*- Mode: awk; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#
+# Generates the plugin manifest from the plugin sources. The manifest lists the
+# pre-probing filters of each plugin, as given in its mm_plugin_create(), so
+# that the plugin manager only loads the plugins that may support the ports
+# found in the system.
+#
+# Usage:
+#   awk -f mm-plugin-manifest.awk lib=<library> <sources...> [lib=<library> <sources...>]...
+#
+# Plugins whose filters can't be fully parsed (e.g. arrays using macros) are
+# flagged to be always loaded.
+
+function strip_quotes(str) {
+    sub(/^"/, "", str)
+    sub(/"$/, "", str)
+    return str
+}
+
+function is_zero(str) {
+    sub(/^0[xX]/, "", str)
+    gsub(/0/, "", str)
+    return (str == "")
+}
+
+# Whether the array only has literals matching the given regex, besides
+# braces, commas and the NULL terminator; arrays with macros or any other
+# expression can't be parsed here
+function only_literals(array, literal) {
+    gsub(literal, "", array)
+    gsub(/NULL|[{},[:space:]]/, "", array)
+    return (array == "")
+}
+
+# Builds a keyfile string list out of the string literals in the array
+function string_list(array,    out) {
+    out = ""
+    while (match(array, STRING_LITERAL)) {
+        out = out strip_quotes(substr(array, RSTART, RLENGTH)) ";"
+        array = substr(array, RSTART + RLENGTH)
+    }
+    return out
+}
+
+# Builds a keyfile string list out of the integers in the array, grouping them
+# in tuples of the given size, until the all-zero terminator is found
+function id_list(array, tuple_size,    out, tuple, n, all_zero, token) {
+    out = ""
+    tuple = ""
+    n = 0
+    all_zero = 1
+    while (match(array, ID_LITERAL)) {
+        token = tolower(substr(array, RSTART, RLENGTH))
+        array = substr(array, RSTART + RLENGTH)
+        tuple = (n ? tuple ":" : "") token
+        if (!is_zero(token))
+            all_zero = 0
+        if (++n < tuple_size)
+            continue
+        if (all_zero)
+            break
+        out = out tuple ";"
+        tuple = ""
+        n = 0
+        all_zero = 1
+    }
+    return out
+}
+
+function process(lib, body,    rest, decl, name, depth, i, c, prop, key, value, eager, out, list) {
+    # Remove comments
+    gsub(/\/\*([^*]|\*+[^*\/])*\*+\//, "", body)
+
+    # Collect the static arrays defined in the method
+    split("", arrays)
+    rest = body
+    while (match(rest, /static const [A-Za-z0-9_]+[ *]+[A-Za-z0-9_]+ *\[\] *= *\{/)) {
+        decl = substr(rest, RSTART, RLENGTH)
+        rest = substr(rest, RSTART + RLENGTH)
+        name = decl
+        sub(/ *\[\].*$/, "", name)
+        sub(/^.*[ *]/, "", name)
+        depth = 1
+        for (i = 1; i <= length(rest) && depth > 0; i++) {
+            c = substr(rest, i, 1)
+            if (c == "{")
+                depth++
+            else if (c == "}")
+                depth--
+        }
+        arrays[name] = substr(rest, 1, i - 2)
+        rest = substr(rest, i)
+    }
+
+    # Collect the plugin properties
+    split("", props)
+    rest = body
+    while (match(rest, /MM_PLUGIN_[A-Z_]+ *, *[^,]+/)) {
+        prop = substr(rest, RSTART, RLENGTH)
+        rest = substr(rest, RSTART + RLENGTH)
+        key = prop
+        sub(/ *,.*$/, "", key)
+        value = prop
+        sub(/^[^,]*, */, "", value)
+        sub(/ *$/, "", value)
+        props[key] = value
+    }
+
+    eager = 0
+    out = ""
+
+    if (("MM_PLUGIN_NAME" in props) && props["MM_PLUGIN_NAME"] ~ /^".*"$/)
+        out = out "name=" strip_quotes(props["MM_PLUGIN_NAME"]) "\n"
+    else
+        eager = 1
+
+    if ("MM_PLUGIN_ALLOWED_SUBSYSTEMS" in props) {
+        if ((props["MM_PLUGIN_ALLOWED_SUBSYSTEMS"] in arrays) &&
+            only_literals(arrays[props["MM_PLUGIN_ALLOWED_SUBSYSTEMS"]], STRING_LITERAL))
+            out = out "subsystems=" string_list(arrays[props["MM_PLUGIN_ALLOWED_SUBSYSTEMS"]]) "\n"
+        else
+            eager = 1
+    }
+    if ("MM_PLUGIN_ALLOWED_DRIVERS" in props) {
+        if ((props["MM_PLUGIN_ALLOWED_DRIVERS"] in arrays) &&
+            only_literals(arrays[props["MM_PLUGIN_ALLOWED_DRIVERS"]], STRING_LITERAL))
+            out = out "drivers=" string_list(arrays[props["MM_PLUGIN_ALLOWED_DRIVERS"]]) "\n"
+        else
+            eager = 1
+    }
+    if ("MM_PLUGIN_ALLOWED_UDEV_TAGS" in props) {
+        if ((props["MM_PLUGIN_ALLOWED_UDEV_TAGS"] in arrays) &&
+            only_literals(arrays[props["MM_PLUGIN_ALLOWED_UDEV_TAGS"]], STRING_LITERAL))
+            out = out "udev-tags=" string_list(arrays[props["MM_PLUGIN_ALLOWED_UDEV_TAGS"]]) "\n"
+        else
+            eager = 1
+    }
+    if ("MM_PLUGIN_ALLOWED_VENDOR_IDS" in props) {
+        list = ""
+        if ((props["MM_PLUGIN_ALLOWED_VENDOR_IDS"] in arrays) &&
+            only_literals(arrays[props["MM_PLUGIN_ALLOWED_VENDOR_IDS"]], ID_LITERAL))
+            list = id_list(arrays[props["MM_PLUGIN_ALLOWED_VENDOR_IDS"]], 1)
+        # An empty list would never match, so the plugin wouldn't be loaded
+        if (list != "")
+            out = out "vendor-ids=" list "\n"
+        else
+            eager = 1
+    }
+    if ("MM_PLUGIN_ALLOWED_PRODUCT_IDS" in props) {
+        list = ""
+        if ((props["MM_PLUGIN_ALLOWED_PRODUCT_IDS"] in arrays) &&
+            only_literals(arrays[props["MM_PLUGIN_ALLOWED_PRODUCT_IDS"]], ID_LITERAL))
+            list = id_list(arrays[props["MM_PLUGIN_ALLOWED_PRODUCT_IDS"]], 2)
+        if (list != "")
+            out = out "product-ids=" list "\n"
+        else
+            eager = 1
+    }
+
+    # Vendor and product IDs aren't mandatory if strings may be matched instead
+    if (("MM_PLUGIN_ALLOWED_VENDOR_STRINGS" in props) ||
+        ("MM_PLUGIN_ALLOWED_PRODUCT_STRINGS" in props) ||
+        ("MM_PLUGIN_FORBIDDEN_PRODUCT_STRINGS" in props))
+        out = out "strings=true\n"
+
+    if (eager)
+        out = out "eager=true\n"
+
+    printf "\n[%s]\n%s", lib, out
+}
+
+BEGIN {
+    STRING_LITERAL = "\"[^\"]*\""
+    ID_LITERAL = "0[xX][0-9A-Fa-f]+|[0-9]+"
+    print "# Generated by mm-plugin-manifest.awk, do not edit"
+}
+
+FNR == 1 {
+    in_create = 0
+}
+
+/^mm_plugin_create/ {
+    in_create = 1
+    body = ""
+    next
+}
+
+in_create {
+    line = $0
+    sub(/\/\/.*$/, "", line)
+    body = body " " line
+    if (line ~ /^}/) {
+        in_create = 0
+        process(lib, body)
+    }
+}
@@ -83,7 +83,7 @@ load_unlock_retries_ready (MMBaseModem *self,
         return;
     }
 
-    r = g_regex_new (
+    r = mm_regex_cache_get (
             "\\+EPINC:\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+)",
             0,
             0,
@@ -196,7 +196,7 @@ get_supported_modes_ready (MMBaseModem *self,
         return;
     }
 
-    r = g_regex_new ("\\+EGMR:\\s*\"MT([0-9]+)",
+    r = mm_regex_cache_get ("\\+EGMR:\\s*\"MT([0-9]+)",
             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (r != NULL);
 
@@ -324,7 +324,7 @@ load_current_modes_finish (MMIfaceModem *self,
     if (!response)
         return result;
 
-    r = g_regex_new (
+    r = mm_regex_cache_get (
                 "\\+ERAT:\\s*[0-9]+,\\s*[0-9]+,\\s*([0-9]+),\\s*([0-9]+)",
                 0,
                 0,
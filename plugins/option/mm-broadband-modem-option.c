@@ -367,7 +367,7 @@ parse_ossys_response (const gchar *response,
     gboolean success = FALSE;
 
     p = mm_strip_tag (response, "_OSSYS:");
-    r = g_regex_new ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, p, 0, &match_info);
@@ -450,7 +450,7 @@ parse_octi_response (const gchar *response,
     gboolean success = FALSE;
 
     p = mm_strip_tag (response, "_OCTI:");
-    r = g_regex_new ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, p, 0, &match_info);
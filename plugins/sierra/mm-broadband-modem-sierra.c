@@ -657,7 +657,7 @@ selrat_query_ready (MMBaseModem *self,
     result = g_new0 (LoadCurrentModesResult, 1);
 
     /* Example response: !SELRAT: 03, UMTS 3G Preferred */
-    r = g_regex_new ("!SELRAT:\\s*(\\d+).*$", 0, 0, NULL);
+    r = mm_regex_cache_get ("!SELRAT:\\s*(\\d+).*$", 0, 0, NULL);
     g_assert (r != NULL);
 
     if (g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &error)) {
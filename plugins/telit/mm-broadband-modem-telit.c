@@ -216,7 +216,7 @@ telit_qss_enable_ready (MMBaseModem *self,
         goto next_step;
     }
 
-    pattern = g_regex_new ("#QSS:\\s*([0-3])\\r\\n", G_REGEX_RAW, 0, NULL);
+    pattern = mm_regex_cache_get ("#QSS:\\s*([0-3])\\r\\n", G_REGEX_RAW, 0, NULL);
     g_assert (pattern);
     mm_port_serial_at_add_unsolicited_msg_handler (
         port,
@@ -0,0 +1,78 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <locale.h>
+
+/* The plugins can only be loaded by the daemon, as they use its symbols, so
+ * let the daemon itself compare the filters each built plugin reports with
+ * the ones in the generated manifest */
+
+/************************************************************/
+
+static void
+test_manifest (void)
+{
+    gchar    *plugin_dir;
+    gchar    *plugin_dir_arg;
+    gchar    *manifest_arg;
+    gchar    *std_out = NULL;
+    gchar    *std_err = NULL;
+    gint      status = 0;
+    GError   *error = NULL;
+    gboolean  ret;
+
+    /* libtool leaves the built modules in .libs */
+    plugin_dir = g_build_filename (TEST_PLUGIN_BUILDDIR, ".libs", NULL);
+    if (!g_file_test (TEST_DAEMON, G_FILE_TEST_IS_EXECUTABLE) ||
+        !g_file_test (plugin_dir, G_FILE_TEST_IS_DIR)) {
+        g_test_message ("daemon or plugins not built, skipping");
+        g_free (plugin_dir);
+        return;
+    }
+
+    plugin_dir_arg = g_strdup_printf ("--test-plugin-dir=%s", plugin_dir);
+    manifest_arg = g_strdup_printf ("--test-check-plugin-manifest=%s/mm-plugins.manifest", TEST_PLUGIN_BUILDDIR);
+    {
+        gchar *argv[] = { (gchar *) TEST_DAEMON, (gchar *) "--debug", plugin_dir_arg, manifest_arg, NULL };
+
+        ret = g_spawn_sync (NULL, argv, NULL, 0, NULL, NULL, &std_out, &std_err, &status, &error);
+    }
+    g_assert_no_error (error);
+    g_assert (ret);
+
+    if (!g_spawn_check_exit_status (status, &error)) {
+        g_printerr ("%s%s", std_out, std_err);
+        g_assert_no_error (error);
+    }
+
+    g_free (std_out);
+    g_free (std_err);
+    g_free (manifest_arg);
+    g_free (plugin_dir_arg);
+    g_free (plugin_dir);
+}
+
+/************************************************************/
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/plugin-manifest/filters", test_manifest);
+
+    return g_test_run ();
+}
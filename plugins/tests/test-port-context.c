@@ -33,6 +33,8 @@ struct _TestPortContext {
     GSocketService *socket_service;
     GList *clients;
     GHashTable *commands;
+    GPtrArray *replay;
+    gboolean replay_timed;
 };
 
 /*****************************************************************************/
@@ -122,6 +124,127 @@ process_next_command (TestPortContext *ctx,
     return response ? response : error_response;
 }
 
+/*****************************************************************************/
+/* Replay files
+ *
+ * Each line not empty and not starting with '#' has the format:
+ *   <direction> <delay-ms> <data>
+ * where direction is '>' for data expected from the host, and '<' for data
+ * sent to the host after waiting delay-ms (only in timed replays). Data may
+ * include the \r, \n, \t, \\ and \xHH escape sequences; leading and
+ * trailing whitespace must be escaped.
+ */
+
+static void
+replay_entry_free (TestPortReplayEntry *entry)
+{
+    g_byte_array_unref (entry->data);
+    g_slice_free (TestPortReplayEntry, entry);
+}
+
+static GByteArray *
+replay_data_decode (const gchar *str)
+{
+    GByteArray *data;
+
+    data = g_byte_array_sized_new (strlen (str));
+    while (*str) {
+        guint8 c;
+
+        if (*str != '\\' || !str[1]) {
+            c = (guint8) *str++;
+            g_byte_array_append (data, &c, 1);
+            continue;
+        }
+
+        str++;
+        switch (*str) {
+        case 'r':
+            c = '\r';
+            break;
+        case 'n':
+            c = '\n';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'x':
+            if (g_ascii_isxdigit (str[1]) && g_ascii_isxdigit (str[2])) {
+                c = (g_ascii_xdigit_value (str[1]) << 4) | g_ascii_xdigit_value (str[2]);
+                str += 2;
+                break;
+            }
+            /* fall through */
+        default:
+            c = (guint8) *str;
+            break;
+        }
+        str++;
+        g_byte_array_append (data, &c, 1);
+    }
+
+    return data;
+}
+
+GPtrArray *
+test_port_replay_load (const gchar *file)
+{
+    GError *error = NULL;
+    GPtrArray *replay;
+    gchar *contents;
+    gchar **lines;
+    guint i;
+
+    if (!g_file_get_contents (file, &contents, NULL, &error))
+        g_error ("Couldn't load replay file '%s': %s",
+                 g_filename_display_name (file),
+                 error->message);
+
+    replay = g_ptr_array_new_with_free_func ((GDestroyNotify) replay_entry_free);
+
+    lines = g_strsplit (contents, "\n", -1);
+    for (i = 0; lines[i]; i++) {
+        TestPortReplayEntry *entry;
+        gchar *current;
+        gchar *end;
+
+        current = g_strstrip (lines[i]);
+        if (current[0] == '\0' || current[0] == '#')
+            continue;
+
+        if (current[0] != '<' && current[0] != '>')
+            g_error ("Invalid direction in replay file '%s', line %u",
+                     g_filename_display_name (file), i + 1);
+
+        entry = g_slice_new0 (TestPortReplayEntry);
+        entry->from_host = (current[0] == '>');
+        entry->delay_ms = (guint) g_ascii_strtoull (current + 1, &end, 10);
+        if (end == current + 1 || *end != ' ')
+            g_error ("Invalid delay in replay file '%s', line %u",
+                     g_filename_display_name (file), i + 1);
+        while (*end == ' ')
+            end++;
+        entry->data = replay_data_decode (end);
+
+        g_ptr_array_add (replay, entry);
+    }
+
+    g_strfreev (lines);
+    g_free (contents);
+    return replay;
+}
+
+void
+test_port_context_set_replay (TestPortContext *self,
+                              GPtrArray *replay,
+                              gboolean timed)
+{
+    if (self->replay)
+        g_ptr_array_unref (self->replay);
+    self->replay = g_ptr_array_ref (replay);
+    self->replay_timed = timed;
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -129,6 +252,10 @@ typedef struct {
     GSocketConnection *connection;
     GSource *connection_readable_source;
     GByteArray *buffer;
+    /* Replay state */
+    guint replay_index;
+    gboolean replay_delay_done;
+    GSource *replay_delay_source;
 } Client;
 
 static void
@@ -136,6 +263,10 @@ client_free (Client *client)
 {
     g_source_destroy (client->connection_readable_source);
     g_source_unref (client->connection_readable_source);
+    if (client->replay_delay_source) {
+        g_source_destroy (client->replay_delay_source);
+        g_source_unref (client->replay_delay_source);
+    }
     g_output_stream_close (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)), NULL, NULL);
     if (client->buffer)
         g_byte_array_unref (client->buffer);
@@ -150,11 +281,77 @@ connection_close (Client *client)
     client_free (client);
 }
 
+static gboolean client_replay_delay_cb (Client *client);
+
+static void
+client_replay (Client *client)
+{
+    TestPortContext *ctx = client->ctx;
+
+    while (client->replay_index < ctx->replay->len) {
+        TestPortReplayEntry *entry;
+
+        entry = g_ptr_array_index (ctx->replay, client->replay_index);
+
+        if (entry->from_host) {
+            /* Wait until we get all the data expected from the host */
+            if (!client->buffer || client->buffer->len < entry->data->len)
+                return;
+
+            if (memcmp (client->buffer->data, entry->data->data, entry->data->len) != 0)
+                g_warning ("Unexpected data from client in replay entry %u", client->replay_index);
+            g_byte_array_remove_range (client->buffer, 0, entry->data->len);
+        } else {
+            GError *error = NULL;
+
+            if (ctx->replay_timed && entry->delay_ms > 0 && !client->replay_delay_done) {
+                if (!client->replay_delay_source) {
+                    client->replay_delay_source = g_timeout_source_new (entry->delay_ms);
+                    g_source_set_callback (client->replay_delay_source,
+                                           (GSourceFunc)client_replay_delay_cb,
+                                           client,
+                                           NULL);
+                    g_source_attach (client->replay_delay_source, ctx->context);
+                }
+                return;
+            }
+            client->replay_delay_done = FALSE;
+
+            if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)),
+                                            entry->data->data,
+                                            entry->data->len,
+                                            NULL, /* bytes_written */
+                                            NULL, /* cancellable */
+                                            &error)) {
+                g_warning ("Cannot send replay data to client: %s", error->message);
+                g_error_free (error);
+            }
+        }
+
+        client->replay_index++;
+    }
+}
+
+static gboolean
+client_replay_delay_cb (Client *client)
+{
+    g_source_unref (client->replay_delay_source);
+    client->replay_delay_source = NULL;
+    client->replay_delay_done = TRUE;
+    client_replay (client);
+    return G_SOURCE_REMOVE;
+}
+
 static void
 client_parse_request (Client *client)
 {
     const gchar *response;
 
+    if (client->ctx->replay) {
+        client_replay (client);
+        return;
+    }
+
     do {
         response = process_next_command (client->ctx, client->buffer);
         if (response) {
@@ -254,6 +451,10 @@ incoming_cb (GSocketService *service,
 
     client = client_new (self, connection);
     self->clients = g_list_append (self->clients, client);
+
+    /* Replays may start by sending data to the client */
+    if (self->replay)
+        client_replay (client);
 }
 
 static void
@@ -390,6 +591,8 @@ test_port_context_free (TestPortContext *self)
 
     if (self->commands)
         g_hash_table_unref (self->commands);
+    if (self->replay)
+        g_ptr_array_unref (self->replay);
     g_list_free_full (self->clients, (GDestroyNotify)client_free);
     if (self->socket) {
         GError *error = NULL;
@@ -32,4 +32,17 @@ void             test_port_context_set_command   (TestPortContext *self,
 void             test_port_context_load_commands (TestPortContext *self,
                                                   const gchar *commands_file);
 
+/* Replay of captured traffic, instead of the command/response table */
+typedef struct {
+    gboolean    from_host;
+    guint       delay_ms;
+    GByteArray *data;
+} TestPortReplayEntry;
+
+GPtrArray       *test_port_replay_load           (const gchar *replay_file);
+
+void             test_port_context_set_replay    (TestPortContext *self,
+                                                  GPtrArray *replay,
+                                                  gboolean timed);
+
 #endif /* TEST_PORT_CONTEXT_H */
@@ -0,0 +1,833 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+/*
+ * Replays captured AT, QCDM and NMEA traffic through a TestPortContext into
+ * real MMPortSerialAt, MMPortSerialQcdm and MMPortSerialGps instances, and
+ * reports the parse throughput, the per-command latency percentiles and the
+ * number of allocations per command.
+ *
+ * By default each replay file is just run once, as fast as possible, to check
+ * that the ports parse it, and nothing is measured. Run with '-m perf' to get
+ * more iterations and the performance results reported by GTest; '--timed'
+ * honours the delays recorded in the replay files instead.
+ * Other captures may be given with '--at-replay', '--qcdm-replay' and
+ * '--gps-replay'.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-port-serial-at.h"
+#include "mm-port-serial-qcdm.h"
+#include "mm-port-serial-gps.h"
+#include "mm-serial-parsers.h"
+#include "mm-log.h"
+
+#include "test-port-context.h"
+
+#define REPLAY_TIMEOUT_SECS 60
+
+static gboolean  timed;
+static gint      iterations;
+static gchar    *at_replay_file;
+static gchar    *qcdm_replay_file;
+static gchar    *gps_replay_file;
+
+static GOptionEntry entries[] = {
+    { "timed", 0, 0, G_OPTION_ARG_NONE, &timed,
+      "Honour the delays recorded in the replay files",
+      NULL
+    },
+    { "iterations", 0, 0, G_OPTION_ARG_INT, &iterations,
+      "Number of times each replay file is run",
+      "[N]"
+    },
+    { "at-replay", 0, 0, G_OPTION_ARG_FILENAME, &at_replay_file,
+      "AT replay file",
+      "[PATH]"
+    },
+    { "qcdm-replay", 0, 0, G_OPTION_ARG_FILENAME, &qcdm_replay_file,
+      "QCDM replay file",
+      "[PATH]"
+    },
+    { "gps-replay", 0, 0, G_OPTION_ARG_FILENAME, &gps_replay_file,
+      "NMEA replay file",
+      "[PATH]"
+    },
+    { NULL }
+};
+
+/*****************************************************************************/
+/* Allocation counting
+ *
+ * This program provides its own malloc(), calloc() and realloc(), which take
+ * precedence over the ones in the C library for GLib and for the ports as
+ * well, and then call the real ones. Only the allocations done in the main
+ * thread are counted, so that the ones done by the port context thread are
+ * left out. The real allocator can only be reached this way with glibc;
+ * allocations aren't counted with other C libraries.
+ */
+
+static pthread_t         allocations_thread;
+static volatile gboolean allocations_enabled;
+static guint64           allocations;
+
+#if defined __GLIBC__
+
+extern void *__libc_malloc  (size_t size);
+extern void *__libc_calloc  (size_t n_blocks, size_t n_block_bytes);
+extern void *__libc_realloc (void *mem, size_t size);
+
+#define ALLOCATIONS_COUNTED TRUE
+
+#define COUNT_ALLOCATION() do {                                             \
+        if (allocations_enabled && pthread_equal (pthread_self (), allocations_thread)) \
+            allocations++;                                                  \
+    } while (0)
+
+void *
+malloc (size_t size)
+{
+    COUNT_ALLOCATION ();
+    return __libc_malloc (size);
+}
+
+void *
+calloc (size_t n_blocks,
+        size_t n_block_bytes)
+{
+    COUNT_ALLOCATION ();
+    return __libc_calloc (n_blocks, n_block_bytes);
+}
+
+void *
+realloc (void   *mem,
+         size_t  size)
+{
+    COUNT_ALLOCATION ();
+    return __libc_realloc (mem, size);
+}
+
+#else
+
+#define ALLOCATIONS_COUNTED FALSE
+
+#endif
+
+static void
+allocations_start (void)
+{
+    allocations_thread = pthread_self ();
+    allocations = 0;
+    allocations_enabled = TRUE;
+}
+
+static gboolean
+allocations_stop (guint64 *n_allocations)
+{
+    allocations_enabled = FALSE;
+    *n_allocations = allocations;
+    return ALLOCATIONS_COUNTED;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GMainLoop  *loop;
+    GPtrArray  *replay;
+    MMPort     *port;
+    guint       index;
+    /* Results */
+    GArray     *latencies;
+    GArray     *command_starts;
+    guint       n_commands_done;
+    guint       n_errors;
+    guint       n_unsolicited;
+    guint       n_traces;
+    guint       n_traces_expected;
+} ReplayRun;
+
+static gboolean
+replay_timeout_cb (ReplayRun *run)
+{
+    g_error ("Replay didn't finish in %u seconds (entry %u)", REPLAY_TIMEOUT_SECS, run->index);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+replay_command_sent (ReplayRun *run)
+{
+    gint64 now;
+
+    now = g_get_monotonic_time ();
+    g_array_append_val (run->command_starts, now);
+}
+
+/* Commands are always completed in the same order they were sent */
+static void
+replay_command_done (ReplayRun *run)
+{
+    gint64 latency;
+
+    g_assert_cmpuint (run->n_commands_done, <, run->command_starts->len);
+    latency = g_get_monotonic_time () - g_array_index (run->command_starts, gint64, run->n_commands_done++);
+    g_array_append_val (run->latencies, latency);
+}
+
+/* Returns the next entry with data sent by the host, if any */
+static TestPortReplayEntry *
+replay_next_command (ReplayRun *run)
+{
+    while (run->index < run->replay->len) {
+        TestPortReplayEntry *entry;
+
+        entry = g_ptr_array_index (run->replay, run->index++);
+        if (entry->from_host)
+            return entry;
+    }
+    return NULL;
+}
+
+static gsize
+replay_bytes_from_device (GPtrArray *replay)
+{
+    gsize n_bytes = 0;
+    guint i;
+
+    for (i = 0; i < replay->len; i++) {
+        TestPortReplayEntry *entry;
+
+        entry = g_ptr_array_index (replay, i);
+        if (!entry->from_host)
+            n_bytes += entry->data->len;
+    }
+    return n_bytes;
+}
+
+static gint
+latency_cmp (const gint64 *a,
+             const gint64 *b)
+{
+    return (*a > *b) - (*a < *b);
+}
+
+static gint64
+latency_percentile (GArray *latencies,
+                    guint   percentile)
+{
+    return g_array_index (latencies, gint64, ((latencies->len - 1) * percentile) / 100);
+}
+
+/*****************************************************************************/
+/* AT */
+
+static gboolean at_send_next_command (ReplayRun *run);
+
+static void
+at_command_check_result (MMPortSerialAt *port,
+                         GAsyncResult   *res,
+                         ReplayRun      *run)
+{
+    GError *error = NULL;
+
+    replay_command_done (run);
+
+    /* Error responses are part of the replay as well, just count them */
+    if (!mm_port_serial_at_command_finish (port, res, &error)) {
+        g_assert (error->domain != MM_SERIAL_ERROR);
+        run->n_errors++;
+        g_error_free (error);
+    }
+}
+
+static void
+at_command_ready (MMPortSerialAt *port,
+                  GAsyncResult   *res,
+                  ReplayRun      *run)
+{
+    at_command_check_result (port, res, run);
+    if (!at_send_next_command (run))
+        g_main_loop_quit (run->loop);
+}
+
+static void
+at_command_pipelined_ready (MMPortSerialAt *port,
+                            GAsyncResult   *res,
+                            ReplayRun      *run)
+{
+    at_command_check_result (port, res, run);
+    if (run->n_commands_done == run->command_starts->len)
+        g_main_loop_quit (run->loop);
+}
+
+static gboolean
+at_send_command (ReplayRun           *run,
+                 GAsyncReadyCallback  callback)
+{
+    TestPortReplayEntry *entry;
+    gchar               *command;
+
+    entry = replay_next_command (run);
+    if (!entry)
+        return FALSE;
+
+    /* Raw commands, so that the exact recorded bytes are sent */
+    command = g_strndup ((const gchar *) entry->data->data, entry->data->len);
+    replay_command_sent (run);
+    mm_port_serial_at_command (MM_PORT_SERIAL_AT (run->port),
+                               command,
+                               10,
+                               TRUE,  /* raw */
+                               FALSE, /* allow_cached */
+                               NULL,
+                               callback,
+                               run);
+    g_free (command);
+    return TRUE;
+}
+
+static gboolean
+at_send_next_command (ReplayRun *run)
+{
+    return at_send_command (run, (GAsyncReadyCallback) at_command_ready);
+}
+
+static void
+at_start (ReplayRun *run)
+{
+    if (!at_send_next_command (run))
+        g_main_loop_quit (run->loop);
+}
+
+/* All commands are queued right away, and sent without waiting for the
+ * previous responses */
+static void
+at_start_pipelined (ReplayRun *run)
+{
+    g_object_set (run->port, MM_PORT_SERIAL_PIPELINE, TRUE, NULL);
+    while (at_send_command (run, (GAsyncReadyCallback) at_command_pipelined_ready));
+    if (!run->command_starts->len)
+        g_main_loop_quit (run->loop);
+}
+
+static void
+at_unsolicited_cb (MMPortSerialAt *port,
+                   GMatchInfo     *match_info,
+                   ReplayRun      *run)
+{
+    run->n_unsolicited++;
+}
+
+static MMPort *
+at_port_new (const gchar *name,
+             gboolean     parser_v2,
+             ReplayRun   *run)
+{
+    MMPortSerialAt *port;
+    GRegex         *regex;
+
+    port = mm_port_serial_at_new (name, MM_PORT_SUBSYS_UNIX);
+    if (parser_v2)
+        mm_port_serial_at_set_response_parser (port,
+                                               mm_serial_parser_v2_parse,
+                                               mm_serial_parser_v2_new (),
+                                               mm_serial_parser_v2_destroy);
+    else
+        mm_port_serial_at_set_response_parser (port,
+                                               mm_serial_parser_v1_parse,
+                                               mm_serial_parser_v1_new (),
+                                               mm_serial_parser_v1_destroy);
+
+    regex = g_regex_new ("\\r\\n\\+C(G|E)?REG: (.*)\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    mm_port_serial_at_add_unsolicited_msg_handler (port,
+                                                   regex,
+                                                   (MMPortSerialAtUnsolicitedMsgFn) at_unsolicited_cb,
+                                                   run,
+                                                   NULL);
+    g_regex_unref (regex);
+
+    return MM_PORT (port);
+}
+
+/*****************************************************************************/
+/* QCDM */
+
+static void qcdm_send_next_command (ReplayRun *run);
+
+static void
+qcdm_command_ready (MMPortSerialQcdm *port,
+                    GAsyncResult     *res,
+                    ReplayRun        *run)
+{
+    GError     *error = NULL;
+    GByteArray *response;
+
+    replay_command_done (run);
+
+    response = mm_port_serial_qcdm_command_finish (port, res, &error);
+    g_assert_no_error (error);
+    g_assert (response != NULL);
+    g_byte_array_unref (response);
+
+    qcdm_send_next_command (run);
+}
+
+static void
+qcdm_send_next_command (ReplayRun *run)
+{
+    TestPortReplayEntry *entry;
+
+    entry = replay_next_command (run);
+    if (!entry) {
+        g_main_loop_quit (run->loop);
+        return;
+    }
+
+    replay_command_sent (run);
+    mm_port_serial_qcdm_command (MM_PORT_SERIAL_QCDM (run->port),
+                                 entry->data,
+                                 10,
+                                 NULL,
+                                 (GAsyncReadyCallback) qcdm_command_ready,
+                                 run);
+}
+
+static MMPort *
+qcdm_port_new (const gchar *name,
+               gboolean     unused,
+               ReplayRun   *run)
+{
+    return MM_PORT (g_object_new (MM_TYPE_PORT_SERIAL_QCDM,
+                                  MM_PORT_DEVICE, name,
+                                  MM_PORT_SUBSYS, MM_PORT_SUBSYS_UNIX,
+                                  MM_PORT_TYPE, MM_PORT_TYPE_QCDM,
+                                  MM_PORT_SERIAL_SEND_DELAY, (guint64) 0,
+                                  NULL));
+}
+
+/*****************************************************************************/
+/* GPS */
+
+static void
+gps_trace_cb (MMPortSerialGps *port,
+              const gchar     *trace,
+              ReplayRun       *run)
+{
+    run->n_traces++;
+    if (run->n_traces == run->n_traces_expected)
+        g_main_loop_quit (run->loop);
+}
+
+/* There are no commands sent to GPS ports, just wait for all traces */
+static void
+gps_start (ReplayRun *run)
+{
+    guint i;
+
+    for (i = 0; i < run->replay->len; i++) {
+        TestPortReplayEntry *entry;
+        guint                j;
+
+        entry = g_ptr_array_index (run->replay, i);
+        g_assert (!entry->from_host);
+        for (j = 0; j < entry->data->len; j++) {
+            if (entry->data->data[j] == '$')
+                run->n_traces_expected++;
+        }
+    }
+    g_assert_cmpuint (run->n_traces_expected, >, 0);
+}
+
+static MMPort *
+gps_port_new (const gchar *name,
+              gboolean     unused,
+              ReplayRun   *run)
+{
+    MMPortSerialGps *port;
+
+    port = MM_PORT_SERIAL_GPS (g_object_new (MM_TYPE_PORT_SERIAL_GPS,
+                                             MM_PORT_DEVICE, name,
+                                             MM_PORT_SUBSYS, MM_PORT_SUBSYS_UNIX,
+                                             MM_PORT_TYPE, MM_PORT_TYPE_GPS,
+                                             NULL));
+    mm_port_serial_gps_add_trace_handler (port,
+                                          (MMPortSerialGpsTraceFn) gps_trace_cb,
+                                          run,
+                                          NULL);
+    return MM_PORT (port);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    const gchar  *name;
+    const gchar **replay_file;
+    const gchar  *default_replay_file;
+    gboolean      parser_v2;
+    MMPort     *(* port_new) (const gchar *name, gboolean parser_v2, ReplayRun *run);
+    void        (* start) (ReplayRun *run);
+} ReplayTest;
+
+static void
+test_replay (const ReplayTest *test)
+{
+    TestPortContext *ctx;
+    GPtrArray       *replay;
+    gchar           *name;
+    gchar           *replay_file;
+    GArray          *latencies;
+    GTimer          *timer = NULL;
+    gdouble          elapsed = 0.0;
+    gboolean         measure;
+    guint64          n_allocations = 0;
+    gboolean         allocations_counted = FALSE;
+    gsize            n_bytes;
+    guint            n_runs;
+    guint            i;
+
+    replay_file = (*test->replay_file ?
+                   g_strdup (*test->replay_file) :
+                   g_build_filename (TEST_REPLAY_DIR, test->default_replay_file, NULL));
+    replay = test_port_replay_load (replay_file);
+    n_bytes = replay_bytes_from_device (replay);
+
+    /* Timings and allocations are only looked at in performance mode */
+    measure = g_test_perf ();
+    n_runs = (iterations > 0 ? iterations : (measure ? 100 : 1));
+    latencies = g_array_new (FALSE, FALSE, sizeof (gint64));
+    if (measure) {
+        timer = g_timer_new ();
+        g_timer_stop (timer);
+    }
+
+    /* Add process ID so that multiple runs of this test in the same system
+     * don't clash with each other */
+    name = g_strdup_printf ("abstract:replay:%s:%ld", test->name, (glong) getpid ());
+    ctx = test_port_context_new (name);
+    test_port_context_set_replay (ctx, replay, timed);
+    test_port_context_start (ctx);
+
+    for (i = 0; i < n_runs; i++) {
+        ReplayRun  run;
+        GError    *error = NULL;
+        guint      timeout_id;
+        guint64    run_allocations = 0;
+
+        memset (&run, 0, sizeof (run));
+        run.loop = g_main_loop_new (NULL, FALSE);
+        run.replay = replay;
+        run.latencies = latencies;
+        run.command_starts = g_array_new (FALSE, FALSE, sizeof (gint64));
+        run.port = test->port_new (name, test->parser_v2, &run);
+
+        timeout_id = g_timeout_add_seconds (REPLAY_TIMEOUT_SECS, (GSourceFunc) replay_timeout_cb, &run);
+
+        /* The replay starts as soon as the port connects to the context */
+        if (measure) {
+            allocations_start ();
+            g_timer_continue (timer);
+        }
+        if (!mm_port_serial_open (MM_PORT_SERIAL (run.port), &error))
+            g_error ("Couldn't open port '%s': %s", name, error->message);
+        test->start (&run);
+        g_main_loop_run (run.loop);
+        if (measure) {
+            g_timer_stop (timer);
+            allocations_counted = allocations_stop (&run_allocations);
+            n_allocations += run_allocations;
+        }
+
+        g_source_remove (timeout_id);
+
+        if (run.n_errors || run.n_unsolicited)
+            g_debug ("replay run %u: %u error responses, %u unsolicited messages",
+                     i, run.n_errors, run.n_unsolicited);
+
+        mm_port_serial_close (MM_PORT_SERIAL (run.port));
+        g_object_unref (run.port);
+        g_main_loop_unref (run.loop);
+        g_array_unref (run.command_starts);
+    }
+
+    test_port_context_stop (ctx);
+    test_port_context_free (ctx);
+
+    if (!measure)
+        goto out;
+
+    elapsed = g_timer_elapsed (timer, NULL);
+    if (elapsed > 0) {
+        g_test_message ("%s: %u runs, %.1f KiB/s parsed", test->name, n_runs, (n_bytes * n_runs) / elapsed / 1024.0);
+        g_test_maximized_result ((n_bytes * n_runs) / elapsed, "%s parse throughput: %.0f bytes/s", test->name, (n_bytes * n_runs) / elapsed);
+    }
+
+    if (latencies->len > 0) {
+        g_array_sort (latencies, (GCompareFunc) latency_cmp);
+        g_test_message ("%s: %u commands, latency p50 %" G_GINT64_FORMAT "us, p90 %" G_GINT64_FORMAT "us, p99 %" G_GINT64_FORMAT "us, max %" G_GINT64_FORMAT "us",
+                        test->name,
+                        latencies->len,
+                        latency_percentile (latencies, 50),
+                        latency_percentile (latencies, 90),
+                        latency_percentile (latencies, 99),
+                        latency_percentile (latencies, 100));
+        g_test_minimized_result ((gdouble) latency_percentile (latencies, 99) / G_USEC_PER_SEC,
+                                 "%s p99 command latency: %" G_GINT64_FORMAT "us",
+                                 test->name, latency_percentile (latencies, 99));
+        if (allocations_counted)
+            g_test_message ("%s: %.1f allocations per command",
+                            test->name, (gdouble) n_allocations / latencies->len);
+    } else if (allocations_counted)
+        g_test_message ("%s: %.1f allocations per run", test->name, (gdouble) n_allocations / n_runs);
+
+    g_timer_destroy (timer);
+
+out:
+    g_array_unref (latencies);
+    g_ptr_array_unref (replay);
+    g_free (replay_file);
+    g_free (name);
+}
+
+/*****************************************************************************/
+/* Pipelined commands aborted when the first one fails */
+
+#define PIPELINE_ABORT_N_COMMANDS 5
+
+typedef struct _PipelineAbortRun PipelineAbortRun;
+
+typedef struct {
+    PipelineAbortRun *run;
+    const gchar      *command;
+    gchar            *response;
+    GError           *error;
+} PipelineAbortCommand;
+
+struct _PipelineAbortRun {
+    GMainLoop            *loop;
+    MMPort               *port;
+    GCancellable         *cancellable;
+    guint                 n_done;
+    PipelineAbortCommand  commands[PIPELINE_ABORT_N_COMMANDS];
+};
+
+static void
+pipeline_abort_command_ready (MMPortSerialAt       *port,
+                              GAsyncResult         *res,
+                              PipelineAbortCommand *command)
+{
+    const gchar *response;
+
+    response = mm_port_serial_at_command_finish (port, res, &command->error);
+    if (response)
+        command->response = g_strstrip (g_strdup (response));
+
+    if (++command->run->n_done == PIPELINE_ABORT_N_COMMANDS)
+        g_main_loop_quit (command->run->loop);
+}
+
+static void
+pipeline_abort_send (PipelineAbortRun *run,
+                     guint             i,
+                     guint             timeout,
+                     GCancellable     *cancellable)
+{
+    gchar *command;
+
+    command = g_strdup_printf ("%s\r", run->commands[i].command);
+    mm_port_serial_at_command (MM_PORT_SERIAL_AT (run->port),
+                               command,
+                               timeout,
+                               TRUE,  /* raw */
+                               FALSE, /* allow_cached */
+                               cancellable,
+                               (GAsyncReadyCallback) pipeline_abort_command_ready,
+                               &run->commands[i]);
+    g_free (command);
+}
+
+static gboolean
+pipeline_abort_cancel_cb (PipelineAbortRun *run)
+{
+    g_cancellable_cancel (run->cancellable);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+pipeline_abort_timeout_cb (PipelineAbortRun *run)
+{
+    g_error ("Pipeline abort test didn't finish in %u seconds (%u commands done)",
+             REPLAY_TIMEOUT_SECS, run->n_done);
+    return G_SOURCE_REMOVE;
+}
+
+/* Sent once the late responses to the aborted commands were received */
+static gboolean
+pipeline_abort_send_next_cb (PipelineAbortRun *run)
+{
+    pipeline_abort_send (run, 3, 10, NULL);
+    pipeline_abort_send (run, 4, 10, NULL);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+test_pipeline_abort (gconstpointer data)
+{
+    static const gchar *commands[PIPELINE_ABORT_N_COMMANDS] = {
+        "AT+A", "AT+B", "AT+C", "AT+D", "AT+E"
+    };
+    gboolean          cancel = GPOINTER_TO_UINT (data);
+    TestPortContext  *ctx;
+    GPtrArray        *replay;
+    PipelineAbortRun  run;
+    gchar            *replay_file;
+    gchar            *name;
+    GError           *error = NULL;
+    guint             timeout_id;
+    guint             i;
+
+    replay_file = g_build_filename (TEST_REPLAY_DIR, "at-pipeline-abort.replay", NULL);
+    replay = test_port_replay_load (replay_file);
+
+    name = g_strdup_printf ("abstract:replay:pipeline-abort:%ld", (glong) getpid ());
+    ctx = test_port_context_new (name);
+    test_port_context_set_replay (ctx, replay, TRUE);
+    test_port_context_start (ctx);
+
+    memset (&run, 0, sizeof (run));
+    run.loop = g_main_loop_new (NULL, FALSE);
+    run.port = MM_PORT (mm_port_serial_at_new (name, MM_PORT_SUBSYS_UNIX));
+    mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (run.port),
+                                           mm_serial_parser_v2_parse,
+                                           mm_serial_parser_v2_new (),
+                                           mm_serial_parser_v2_destroy);
+    run.cancellable = g_cancellable_new ();
+    for (i = 0; i < PIPELINE_ABORT_N_COMMANDS; i++) {
+        run.commands[i].run = &run;
+        run.commands[i].command = commands[i];
+    }
+
+    g_object_set (run.port, MM_PORT_SERIAL_PIPELINE, TRUE, NULL);
+    if (!mm_port_serial_open (MM_PORT_SERIAL (run.port), &error))
+        g_error ("Couldn't open port '%s': %s", name, error->message);
+
+    /* The first command either times out or is cancelled before its response
+     * arrives, with the other two already written */
+    pipeline_abort_send (&run, 0, 1, run.cancellable);
+    pipeline_abort_send (&run, 1, 10, NULL);
+    pipeline_abort_send (&run, 2, 10, NULL);
+    if (cancel)
+        g_timeout_add (200, (GSourceFunc) pipeline_abort_cancel_cb, &run);
+    g_timeout_add (2500, (GSourceFunc) pipeline_abort_send_next_cb, &run);
+
+    timeout_id = g_timeout_add_seconds (REPLAY_TIMEOUT_SECS, (GSourceFunc) pipeline_abort_timeout_cb, &run);
+    g_main_loop_run (run.loop);
+    g_source_remove (timeout_id);
+    g_assert_cmpuint (run.n_done, ==, PIPELINE_ABORT_N_COMMANDS);
+
+    if (cancel)
+        g_assert_error (run.commands[0].error, MM_CORE_ERROR, MM_CORE_ERROR_CANCELLED);
+    else
+        g_assert_error (run.commands[0].error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT);
+    g_assert_error (run.commands[1].error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT);
+    g_assert_error (run.commands[2].error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT);
+
+    /* The commands sent afterwards get their own responses */
+    g_assert_no_error (run.commands[3].error);
+    g_assert_cmpstr (run.commands[3].response, ==, "D");
+    g_assert_no_error (run.commands[4].error);
+    g_assert_cmpstr (run.commands[4].response, ==, "E");
+
+    for (i = 0; i < PIPELINE_ABORT_N_COMMANDS; i++) {
+        g_clear_error (&run.commands[i].error);
+        g_free (run.commands[i].response);
+    }
+
+    mm_port_serial_close (MM_PORT_SERIAL (run.port));
+    g_object_unref (run.port);
+    g_object_unref (run.cancellable);
+    g_main_loop_unref (run.loop);
+
+    test_port_context_stop (ctx);
+    test_port_context_free (ctx);
+    g_ptr_array_unref (replay);
+    g_free (replay_file);
+    g_free (name);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    static const ReplayTest tests[] = {
+        { "at-v1",          (const gchar **) &at_replay_file,   "at-generic.replay", FALSE, at_port_new,   at_start               },
+        { "at-v2",          (const gchar **) &at_replay_file,   "at-generic.replay", TRUE,  at_port_new,   at_start               },
+        { "at-v2-pipeline", (const gchar **) &at_replay_file,   "at-generic.replay", TRUE,  at_port_new,   at_start_pipelined     },
+        { "qcdm",           (const gchar **) &qcdm_replay_file, "qcdm.replay",       FALSE, qcdm_port_new, qcdm_send_next_command },
+        { "gps",            (const gchar **) &gps_replay_file,  "nmea.replay",       FALSE, gps_port_new,  gps_start              },
+    };
+    GOptionContext *context;
+    GError         *error = NULL;
+    guint           i;
+
+    context = g_option_context_new ("- serial port replay benchmark");
+    g_option_context_add_main_entries (context, entries, NULL);
+    g_option_context_set_ignore_unknown_options (context, TRUE);
+    g_option_context_set_help_enabled (context, FALSE);
+    if (!g_option_context_parse (context, &argc, &argv, &error))
+        g_error ("Couldn't parse options: %s", error->message);
+    g_option_context_free (context);
+
+    g_test_init (&argc, &argv, NULL);
+
+    for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+        gchar *path;
+
+        path = g_strdup_printf ("/MM/Port/Replay/%s", tests[i].name);
+        g_test_add_data_func (path, &tests[i], (GTestDataFunc) test_replay);
+        g_free (path);
+    }
+
+    g_test_add_data_func ("/MM/Port/Replay/at-pipeline-timeout", GUINT_TO_POINTER (FALSE), test_pipeline_abort);
+    g_test_add_data_func ("/MM/Port/Replay/at-pipeline-cancel",  GUINT_TO_POINTER (TRUE),  test_pipeline_abort);
+
+    return g_test_run ();
+}
@@ -31,6 +31,7 @@
 #include "mm-broadband-modem-ublox.h"
 #include "mm-broadband-bearer-ublox.h"
 #include "mm-sim-ublox.h"
+#include "mm-modem-helpers.h"
 #include "mm-modem-helpers-ublox.h"
 #include "mm-ublox-enums-types.h"
 #include "mm-call-ublox.h"
@@ -1396,8 +1397,8 @@ mm_broadband_modem_ublox_init (MMBroadbandModemUblox *self)
     self->priv->support_config.method   = SETTINGS_UPDATE_METHOD_UNKNOWN;
     self->priv->support_config.uact     = FEATURE_SUPPORT_UNKNOWN;
     self->priv->support_config.ubandsel = FEATURE_SUPPORT_UNKNOWN;
-    self->priv->pbready_regex = g_regex_new ("\\r\\n\\+PBREADY\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->pbready_regex = mm_regex_cache_get ("\\r\\n\\+PBREADY\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 }
 
 static void
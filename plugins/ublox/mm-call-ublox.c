@@ -25,6 +25,7 @@
 #include <libmm-glib.h>
 
 #include "mm-log.h"
+#include "mm-modem-helpers.h"
 #include "mm-base-modem-at.h"
 #include "mm-broadband-modem-ublox.h"
 #include "mm-call-ublox.h"
@@ -110,7 +111,7 @@ common_setup_cleanup_unsolicited_events (MMCallUblox  *self,
     MMPortSerialAt *port;
 
     if (G_UNLIKELY (!self->priv->ucallstat_regex))
-        self->priv->ucallstat_regex = g_regex_new ("\\r\\n\\+UCALLSTAT:\\s*(\\d+),(\\d+)\\r\\n",
+        self->priv->ucallstat_regex = mm_regex_cache_get ("\\r\\n\\+UCALLSTAT:\\s*(\\d+),(\\d+)\\r\\n",
 						   G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 
     g_object_get (self,
@@ -20,6 +20,7 @@
 #include <libmm-glib.h>
 
 #include "mm-log.h"
+#include "mm-modem-helpers.h"
 #include "mm-serial-parsers.h"
 #include "mm-broadband-modem-ublox.h"
 #include "mm-plugin-ublox.h"
@@ -217,8 +218,8 @@ ublox_custom_init (MMPortProbe         *probe,
     ctx = g_slice_new0 (CustomInitContext);
     ctx->wait_timeout_secs = wait_timeout_secs;
     ctx->port = g_object_ref (port);
-    ctx->ready_regex = g_regex_new ("\\r\\n\\+AT:\\s*READY\\r\\n",
-                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    ctx->ready_regex = mm_regex_cache_get ("\\r\\n\\+AT:\\s*READY\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_task_set_task_data (task, ctx, (GDestroyNotify) custom_init_context_free);
 
     /* If the device hasn't been plugged in right away, we assume it was already
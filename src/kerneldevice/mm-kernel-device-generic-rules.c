@@ -27,11 +27,35 @@
 #include "mm-log.h"
 #include "mm-kernel-device-generic-rules.h"
 
+/* Runs of at least this number of consecutive rules requiring a specific
+ * vendor id are indexed by vid/pid */
+#define RULE_INDEX_MIN_RULES 8
+
+#define RULE_INDEX_KEY(vid, pid) GUINT_TO_POINTER (((guint) (vid) << 16) | (guint) (pid))
+
+struct _MMUdevRuleIndex {
+    /* Index of the first rule after the run */
+    guint       end;
+    /* Ascending rule indices requiring a vid and pid, or just a vid */
+    GHashTable *by_vid_pid;
+    GHashTable *by_vid;
+};
+
+static void
+udev_rule_index_free (MMUdevRuleIndex *index)
+{
+    g_hash_table_unref (index->by_vid_pid);
+    g_hash_table_unref (index->by_vid);
+    g_slice_free (MMUdevRuleIndex, index);
+}
+
 static void
 udev_rule_match_clear (MMUdevRuleMatch *rule_match)
 {
     g_free (rule_match->parameter);
     g_free (rule_match->value);
+    g_free (rule_match->pattern.text);
+    g_free (rule_match->devpath_prefix_pattern.text);
 }
 
 static void
@@ -53,6 +77,151 @@ udev_rule_clear (MMUdevRule *rule)
 
     if (rule->conditions)
         g_array_unref (rule->conditions);
+    if (rule->index)
+        udev_rule_index_free (rule->index);
+}
+
+/*****************************************************************************/
+
+static void
+pattern_init (MMUdevRulePattern *pattern,
+              const gchar       *str)
+{
+    gsize    len;
+    gboolean open_prefix;
+    gboolean open_suffix;
+
+    len = strlen (str);
+    open_prefix = (len > 0 && str[0] == '*');
+    open_suffix = (len > (open_prefix ? 1 : 0) && str[len - 1] == '*');
+
+    if (open_prefix && open_suffix)
+        pattern->type = MM_UDEV_RULE_PATTERN_TYPE_CONTAINS;
+    else if (open_prefix)
+        pattern->type = MM_UDEV_RULE_PATTERN_TYPE_SUFFIX;
+    else if (open_suffix)
+        pattern->type = MM_UDEV_RULE_PATTERN_TYPE_PREFIX;
+    else
+        pattern->type = MM_UDEV_RULE_PATTERN_TYPE_EXACT;
+
+    pattern->text = g_strndup (str + (open_prefix ? 1 : 0),
+                               len - (open_prefix ? 1 : 0) - (open_suffix ? 1 : 0));
+}
+
+static gboolean
+pattern_match (const MMUdevRulePattern *pattern,
+               const gchar             *str)
+{
+    switch (pattern->type) {
+    case MM_UDEV_RULE_PATTERN_TYPE_EXACT:
+        return g_str_equal (str, pattern->text);
+    case MM_UDEV_RULE_PATTERN_TYPE_PREFIX:
+        return g_str_has_prefix (str, pattern->text);
+    case MM_UDEV_RULE_PATTERN_TYPE_SUFFIX:
+        return g_str_has_suffix (str, pattern->text);
+    case MM_UDEV_RULE_PATTERN_TYPE_CONTAINS:
+        return !!strstr (str, pattern->text);
+    }
+
+    g_assert_not_reached ();
+    return FALSE;
+}
+
+static gchar *
+get_braced_name (const gchar *str)
+{
+    gchar *name;
+
+    name = g_strdup (str);
+    g_strdelimit (name, "{}", ' ');
+    return g_strstrip (name);
+}
+
+static void
+compile_rule_match (MMUdevRuleMatch *rule_match)
+{
+    const gchar *parameter = rule_match->parameter;
+
+    if (g_str_equal (parameter, "ACTION")) {
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_ACTION;
+        return;
+    }
+
+    if (g_str_equal (parameter, "SUBSYSTEMS") || g_str_equal (parameter, "SUBSYSTEM")) {
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM;
+        return;
+    }
+
+    if (g_str_equal (parameter, "DRIVER") || g_str_equal (parameter, "DRIVERS")) {
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_DRIVER;
+        return;
+    }
+
+    if (g_str_equal (parameter, "KERNEL")) {
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_KERNEL;
+        pattern_init (&rule_match->pattern, rule_match->value);
+        return;
+    }
+
+    if (g_str_equal (parameter, "DEVPATH")) {
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH;
+        pattern_init (&rule_match->pattern, rule_match->value);
+
+        /* If not already doing a prefix match, do an implicit one. This is so that
+         * we can add properties to the usb_device owning all ports, and then apply
+         * the property to all ports individually processed. */
+        if (rule_match->value[0] && !g_str_has_suffix (rule_match->value, "*")) {
+            gchar *prefix;
+
+            prefix = g_strdup_printf ("%s/*", rule_match->value);
+            pattern_init (&rule_match->devpath_prefix_pattern, prefix);
+            g_free (prefix);
+        }
+        return;
+    }
+
+    if (g_str_has_prefix (parameter, "ATTRS")) {
+        gchar *attribute;
+
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_ATTRS;
+
+        attribute = get_braced_name (&parameter[5]);
+        if (g_str_equal (attribute, "idVendor"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_VENDOR;
+        else if (g_str_equal (attribute, "idProduct"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_PRODUCT;
+        else if (g_str_equal (attribute, "manufacturer"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_MANUFACTURER;
+        else if (g_str_equal (attribute, "product"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_PRODUCT;
+        else if (g_str_equal (attribute, "bInterfaceClass"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_CLASS;
+        else if (g_str_equal (attribute, "bInterfaceSubClass"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_SUBCLASS;
+        else if (g_str_equal (attribute, "bInterfaceProtocol"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_PROTOCOL;
+        else if (g_str_equal (attribute, "bInterfaceNumber"))
+            rule_match->attribute_id = MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_NUMBER;
+        else
+            mm_warn ("Unknown attribute: %s", attribute);
+        g_free (attribute);
+
+        rule_match->value_any = g_str_equal (rule_match->value, "?*");
+        rule_match->value_uint_valid = mm_get_uint_from_hex_str (rule_match->value, &rule_match->value_uint);
+        return;
+    }
+
+    if (g_str_has_prefix (parameter, "ENV")) {
+        gchar *property;
+
+        rule_match->parameter_id = MM_UDEV_RULE_MATCH_PARAMETER_ENV;
+        property = get_braced_name (&parameter[3]);
+        rule_match->env_quark = g_quark_from_string (property);
+        g_free (property);
+        return;
+    }
+
+    mm_warn ("Unknown match condition parameter: %s", parameter);
 }
 
 static gboolean
@@ -153,6 +322,17 @@ load_rule_result (MMUdevRuleResult  *rule_result,
         rule_result->type = MM_UDEV_RULE_RESULT_TYPE_PROPERTY;
         rule_result->content.property.name = g_strndup (left + 4, left_len - 5);
         rule_result->content.property.value = right;
+        rule_result->content.property.name_quark = g_quark_from_string (rule_result->content.property.name);
+        if (g_str_equal (right, "$attr{bInterfaceClass}"))
+            rule_result->content.property.value_type = MM_UDEV_RULE_RESULT_VALUE_INTERFACE_CLASS;
+        else if (g_str_equal (right, "$attr{bInterfaceSubClass}"))
+            rule_result->content.property.value_type = MM_UDEV_RULE_RESULT_VALUE_INTERFACE_SUBCLASS;
+        else if (g_str_equal (right, "$attr{bInterfaceProtocol}"))
+            rule_result->content.property.value_type = MM_UDEV_RULE_RESULT_VALUE_INTERFACE_PROTOCOL;
+        else if (g_str_equal (right, "$attr{bInterfaceNumber}"))
+            rule_result->content.property.value_type = MM_UDEV_RULE_RESULT_VALUE_INTERFACE_NUMBER;
+        else
+            rule_result->content.property.value_type = MM_UDEV_RULE_RESULT_VALUE_STRING;
         right = NULL;
         goto out;
     }
@@ -202,6 +382,7 @@ load_rule_match (MMUdevRuleMatch  *rule_match,
     g_free (operator);
     rule_match->parameter = left;
     rule_match->value     = right;
+    compile_rule_match (rule_match);
     return TRUE;
 }
 
@@ -397,6 +578,108 @@ list_rule_files (const gchar *rules_dir_path)
     return g_list_sort (children, (GCompareFunc) g_strcmp0);
 }
 
+static gboolean
+rule_get_index_key (const MMUdevRule *rule,
+                    guint            *out_vid,
+                    gint             *out_pid)
+{
+    guint i;
+    gint  vid = -1;
+    gint  pid = -1;
+
+    /* Labels are jump targets, so never indexed */
+    if (rule->result.type != MM_UDEV_RULE_RESULT_TYPE_PROPERTY &&
+        rule->result.type != MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX)
+        return FALSE;
+
+    if (!rule->conditions)
+        return FALSE;
+
+    for (i = 0; i < rule->conditions->len; i++) {
+        MMUdevRuleMatch *match;
+
+        match = &g_array_index (rule->conditions, MMUdevRuleMatch, i);
+        if (match->type != MM_UDEV_RULE_MATCH_TYPE_EQUAL ||
+            match->parameter_id != MM_UDEV_RULE_MATCH_PARAMETER_ATTRS ||
+            !match->value_uint_valid ||
+            match->value_uint > G_MAXUINT16)
+            continue;
+
+        if (match->attribute_id == MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_VENDOR && vid < 0)
+            vid = (gint) match->value_uint;
+        else if (match->attribute_id == MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_PRODUCT && pid < 0)
+            pid = (gint) match->value_uint;
+    }
+
+    if (vid < 0)
+        return FALSE;
+
+    *out_vid = (guint) vid;
+    *out_pid = pid;
+    return TRUE;
+}
+
+static void
+rule_index_add (GHashTable *table,
+                gpointer    key,
+                guint       rule_i)
+{
+    GArray *indices;
+
+    indices = g_hash_table_lookup (table, key);
+    if (!indices) {
+        indices = g_array_new (FALSE, FALSE, sizeof (guint));
+        g_hash_table_insert (table, key, indices);
+    }
+    g_array_append_val (indices, rule_i);
+}
+
+static void
+build_rule_indices (GArray *rules)
+{
+    guint i = 0;
+    guint n_indices = 0;
+    guint n_indexed = 0;
+
+    while (i < rules->len) {
+        MMUdevRuleIndex *index;
+        guint            end;
+        guint            j;
+        guint            vid = 0;
+        gint             pid = -1;
+
+        for (end = i; end < rules->len; end++) {
+            if (!rule_get_index_key (&g_array_index (rules, MMUdevRule, end), &vid, &pid))
+                break;
+        }
+
+        if (end - i < RULE_INDEX_MIN_RULES) {
+            i = MAX (end, i + 1);
+            continue;
+        }
+
+        index = g_slice_new (MMUdevRuleIndex);
+        index->end = end;
+        index->by_vid_pid = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_array_unref);
+        index->by_vid = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_array_unref);
+
+        for (j = i; j < end; j++) {
+            rule_get_index_key (&g_array_index (rules, MMUdevRule, j), &vid, &pid);
+            if (pid >= 0)
+                rule_index_add (index->by_vid_pid, RULE_INDEX_KEY (vid, pid), j);
+            else
+                rule_index_add (index->by_vid, GUINT_TO_POINTER (vid), j);
+        }
+
+        g_array_index (rules, MMUdevRule, i).index = index;
+        n_indices++;
+        n_indexed += (end - i);
+        i = end;
+    }
+
+    mm_dbg ("[rules] %u rules indexed by vid/pid in %u runs", n_indexed, n_indices);
+}
+
 GArray *
 mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
                                      GError      **error)
@@ -432,6 +715,8 @@ mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
 
     mm_dbg ("[rules] %u loaded", rules->len);
 
+    build_rule_indices (rules);
+
 out:
     if (rule_files)
         g_list_free_full (rule_files, g_free);
@@ -444,3 +729,234 @@ out:
 
     return rules;
 }
+
+/*****************************************************************************/
+
+static gboolean
+check_condition (const MMUdevRuleMatch  *match,
+                 const MMUdevRuleDevice *device)
+{
+    gboolean condition_equal;
+
+    condition_equal = (match->type == MM_UDEV_RULE_MATCH_TYPE_EQUAL);
+
+    switch (match->parameter_id) {
+    case MM_UDEV_RULE_MATCH_PARAMETER_ACTION:
+        /* We only apply 'add' rules */
+        return ((!!strstr (match->value, "add")) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM:
+        /* We look for the subsystem string in the whole sysfs path.
+         *
+         * Note that we're not really making a difference between "SUBSYSTEMS"
+         * (where the whole device tree is checked) and "SUBSYSTEM" (where just one
+         * single device is checked), because a lot of the MM udev rules are meant
+         * to just tag the physical device (e.g. with ID_MM_DEVICE_IGNORE) instead
+         * of the single ports. In our case with the custom parsing, we do tag all
+         * independent ports.
+         */
+        return ((device->sysfs_path && !!strstr (device->sysfs_path, match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVER:
+        /* Exact DRIVER match? We also include the check for DRIVERS, even if we
+         * only apply it to this port driver. */
+        return ((!g_strcmp0 (match->value, device->driver)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_KERNEL:
+        /* Device name checks */
+        return ((device->name && pattern_match (&match->pattern, device->name)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH: {
+        gboolean prefix_match;
+
+        /* If sysfs path invalid (e.g. path doesn't exist), no match */
+        if (!device->sysfs_path)
+            return FALSE;
+
+        /* We allow both a direct match and a prefix match */
+        prefix_match = (match->devpath_prefix_pattern.text != NULL);
+        if ((pattern_match (&match->pattern, device->sysfs_path) == condition_equal) ||
+            (prefix_match && pattern_match (&match->devpath_prefix_pattern, device->sysfs_path) == condition_equal))
+            return TRUE;
+        if (g_str_has_prefix (device->sysfs_path, "/sys") &&
+            ((pattern_match (&match->pattern, &device->sysfs_path[4]) == condition_equal) ||
+             (prefix_match && pattern_match (&match->devpath_prefix_pattern, &device->sysfs_path[4]) == condition_equal)))
+            return TRUE;
+        return FALSE;
+    }
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_ATTRS:
+        switch (match->attribute_id) {
+        /* VID/PID directly from our API */
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_VENDOR:
+            return (match->value_uint_valid && ((device->vid == match->value_uint) == condition_equal));
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_PRODUCT:
+            return (match->value_uint_valid && ((device->pid == match->value_uint) == condition_equal));
+        /* manufacturer and product in the physdev */
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_MANUFACTURER:
+            return ((device->manufacturer && g_str_equal (device->manufacturer, match->value)) == condition_equal);
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_PRODUCT:
+            return ((device->product && g_str_equal (device->product, match->value)) == condition_equal);
+        /* interface class/subclass/protocol/number in the interface */
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_CLASS:
+            return (match->value_any || (match->value_uint_valid && ((device->interface_class == match->value_uint) == condition_equal)));
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_SUBCLASS:
+            return (match->value_any || (match->value_uint_valid && ((device->interface_subclass == match->value_uint) == condition_equal)));
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_PROTOCOL:
+            return (match->value_any || (match->value_uint_valid && ((device->interface_protocol == match->value_uint) == condition_equal)));
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_NUMBER:
+            return (match->value_any || (match->value_uint_valid && ((device->interface_number == match->value_uint) == condition_equal)));
+        case MM_UDEV_RULE_MATCH_ATTRIBUTE_UNKNOWN:
+            /* Already warned when loading */
+            return FALSE;
+        }
+        break;
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_ENV:
+        /* Previously set property checks */
+        return ((!g_strcmp0 ((const gchar *) device->get_property (match->env_quark, device->user_data), match->value)) == condition_equal);
+
+    case MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN:
+        /* Already warned when loading */
+        return FALSE;
+    }
+
+    g_assert_not_reached ();
+    return FALSE;
+}
+
+static guint
+check_rule (GArray                 *rules,
+            guint                   rule_i,
+            const MMUdevRuleDevice *device)
+{
+    MMUdevRule *rule;
+    gboolean    apply = TRUE;
+
+    g_assert (rule_i < rules->len);
+
+    rule = &g_array_index (rules, MMUdevRule, rule_i);
+    if (rule->conditions) {
+        guint condition_i;
+
+        for (condition_i = 0; condition_i < rule->conditions->len; condition_i++) {
+            if (!check_condition (&g_array_index (rule->conditions, MMUdevRuleMatch, condition_i), device)) {
+                apply = FALSE;
+                break;
+            }
+        }
+    }
+
+    if (apply) {
+        switch (rule->result.type) {
+        case MM_UDEV_RULE_RESULT_TYPE_PROPERTY: {
+            MMUdevRuleResultProperty *property;
+            gchar                    *property_value_read = NULL;
+
+            property = &rule->result.content.property;
+            switch (property->value_type) {
+            case MM_UDEV_RULE_RESULT_VALUE_INTERFACE_CLASS:
+                property_value_read = g_strdup_printf ("%02x", device->interface_class);
+                break;
+            case MM_UDEV_RULE_RESULT_VALUE_INTERFACE_SUBCLASS:
+                property_value_read = g_strdup_printf ("%02x", device->interface_subclass);
+                break;
+            case MM_UDEV_RULE_RESULT_VALUE_INTERFACE_PROTOCOL:
+                property_value_read = g_strdup_printf ("%02x", device->interface_protocol);
+                break;
+            case MM_UDEV_RULE_RESULT_VALUE_INTERFACE_NUMBER:
+                property_value_read = g_strdup_printf ("%02x", device->interface_number);
+                break;
+            case MM_UDEV_RULE_RESULT_VALUE_STRING:
+                break;
+            }
+
+            /* add new property */
+            mm_dbg ("(%s/%s) property added: %s=%s",
+                    device->subsystem,
+                    device->name,
+                    property->name,
+                    property_value_read ? property_value_read : property->value);
+
+            if (!property_value_read)
+                /* NOTE: the caller keeps a reference to the list of rules, so it
+                 * isn't an issue if we re-use the same string (i.e. without
+                 * g_strdup-ing it) as a property value. */
+                device->set_property (property->name_quark, property->value, NULL, device->user_data);
+            else
+                device->set_property (property->name_quark, property_value_read, g_free, device->user_data);
+            break;
+        }
+
+        case MM_UDEV_RULE_RESULT_TYPE_LABEL:
+            /* noop */
+            break;
+
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX:
+            /* Jump to a new index */
+            return rule->result.content.index;
+
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_TAG:
+        case MM_UDEV_RULE_RESULT_TYPE_UNKNOWN:
+            g_assert_not_reached ();
+        }
+    }
+
+    /* Go to the next rule */
+    return rule_i + 1;
+}
+
+static guint
+check_rule_index (GArray                 *rules,
+                  guint                   rule_i,
+                  const MMUdevRuleDevice *device)
+{
+    MMUdevRuleIndex *index;
+    GArray          *by_vid_pid;
+    GArray          *by_vid;
+    guint            vid_pid_i = 0;
+    guint            vid_i = 0;
+
+    index = g_array_index (rules, MMUdevRule, rule_i).index;
+    by_vid_pid = g_hash_table_lookup (index->by_vid_pid, RULE_INDEX_KEY (device->vid, device->pid));
+    by_vid = g_hash_table_lookup (index->by_vid, GUINT_TO_POINTER (device->vid));
+
+    /* Only the rules that may apply to the device vid/pid are checked, still
+     * in the original order, as they may depend on each other */
+    while ((by_vid_pid && vid_pid_i < by_vid_pid->len) || (by_vid && vid_i < by_vid->len)) {
+        guint candidate_i;
+        guint next_rule;
+
+        if (!by_vid || vid_i == by_vid->len ||
+            (by_vid_pid && vid_pid_i < by_vid_pid->len &&
+             g_array_index (by_vid_pid, guint, vid_pid_i) < g_array_index (by_vid, guint, vid_i)))
+            candidate_i = g_array_index (by_vid_pid, guint, vid_pid_i++);
+        else
+            candidate_i = g_array_index (by_vid, guint, vid_i++);
+
+        /* Jumps always go out of the indexed run, as labels aren't indexed */
+        next_rule = check_rule (rules, candidate_i, device);
+        if (next_rule != candidate_i + 1)
+            return next_rule;
+    }
+
+    return index->end;
+}
+
+void
+mm_kernel_device_generic_rules_apply (GArray                 *rules,
+                                      const MMUdevRuleDevice *device)
+{
+    guint i = 0;
+
+    g_return_if_fail (rules != NULL);
+    g_return_if_fail (device != NULL);
+    g_return_if_fail (device->get_property != NULL && device->set_property != NULL);
+
+    while (i < rules->len) {
+        if (g_array_index (rules, MMUdevRule, i).index)
+            i = check_rule_index (rules, i, device);
+        else
+            i = check_rule (rules, i, device);
+    }
+}
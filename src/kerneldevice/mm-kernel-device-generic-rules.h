@@ -23,10 +23,57 @@ typedef enum {
     MM_UDEV_RULE_MATCH_TYPE_NOT_EQUAL,
 } MMUdevRuleMatchType;
 
+/* Parameters and patterns of the match conditions are parsed once when
+ * loading the rules, so that evaluating them on each port is cheap. */
+typedef enum {
+    MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN,
+    MM_UDEV_RULE_MATCH_PARAMETER_ACTION,
+    MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM,
+    MM_UDEV_RULE_MATCH_PARAMETER_DRIVER,
+    MM_UDEV_RULE_MATCH_PARAMETER_KERNEL,
+    MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH,
+    MM_UDEV_RULE_MATCH_PARAMETER_ATTRS,
+    MM_UDEV_RULE_MATCH_PARAMETER_ENV,
+} MMUdevRuleMatchParameter;
+
+typedef enum {
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_UNKNOWN,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_VENDOR,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_ID_PRODUCT,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_MANUFACTURER,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_PRODUCT,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_CLASS,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_SUBCLASS,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_PROTOCOL,
+    MM_UDEV_RULE_MATCH_ATTRIBUTE_INTERFACE_NUMBER,
+} MMUdevRuleMatchAttribute;
+
+typedef enum {
+    MM_UDEV_RULE_PATTERN_TYPE_EXACT,
+    MM_UDEV_RULE_PATTERN_TYPE_PREFIX,   /* "text*" */
+    MM_UDEV_RULE_PATTERN_TYPE_SUFFIX,   /* "*text" */
+    MM_UDEV_RULE_PATTERN_TYPE_CONTAINS, /* "*text*" */
+} MMUdevRulePatternType;
+
+typedef struct {
+    MMUdevRulePatternType  type;
+    gchar                 *text;
+} MMUdevRulePattern;
+
 typedef struct {
-    MMUdevRuleMatchType  type;
-    gchar               *parameter;
-    gchar               *value;
+    MMUdevRuleMatchType       type;
+    gchar                    *parameter;
+    gchar                    *value;
+
+    /* Precompiled */
+    MMUdevRuleMatchParameter  parameter_id;
+    MMUdevRuleMatchAttribute  attribute_id;
+    GQuark                    env_quark;
+    MMUdevRulePattern         pattern;
+    MMUdevRulePattern         devpath_prefix_pattern;
+    gboolean                  value_any;
+    gboolean                  value_uint_valid;
+    guint                     value_uint;
 } MMUdevRuleMatch;
 
 typedef enum {
@@ -37,9 +84,20 @@ typedef enum {
     MM_UDEV_RULE_RESULT_TYPE_GOTO_TAG, /* internal use only */
 } MMUdevRuleResultType;
 
+typedef enum {
+    MM_UDEV_RULE_RESULT_VALUE_STRING,
+    MM_UDEV_RULE_RESULT_VALUE_INTERFACE_CLASS,
+    MM_UDEV_RULE_RESULT_VALUE_INTERFACE_SUBCLASS,
+    MM_UDEV_RULE_RESULT_VALUE_INTERFACE_PROTOCOL,
+    MM_UDEV_RULE_RESULT_VALUE_INTERFACE_NUMBER,
+} MMUdevRuleResultValue;
+
 typedef struct {
-    gchar *name;
-    gchar *value;
+    gchar                 *name;
+    gchar                 *value;
+    /* Precompiled */
+    GQuark                 name_quark;
+    MMUdevRuleResultValue  value_type;
 } MMUdevRuleResultProperty;
 
 typedef struct {
@@ -51,12 +109,45 @@ typedef struct {
     } content;
 } MMUdevRuleResult;
 
+typedef struct _MMUdevRuleIndex MMUdevRuleIndex;
+
 typedef struct {
     GArray           *conditions;
     MMUdevRuleResult  result;
+    /* Only set in the first rule of a run of consecutive rules that require
+     * a specific vendor id, e.g. the per-device port type tags. */
+    MMUdevRuleIndex  *index;
 } MMUdevRule;
 
 GArray *mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
                                              GError      **error);
 
+/* Device the rules are applied to. Properties are kept by the caller, and
+ * the ones set by the rules may be checked by ENV conditions afterwards. */
+typedef struct {
+    const gchar *subsystem;
+    const gchar *name;
+    const gchar *sysfs_path;
+    const gchar *driver;
+    guint16      vid;
+    guint16      pid;
+    const gchar *manufacturer;
+    const gchar *product;
+    guint8       interface_class;
+    guint8       interface_subclass;
+    guint8       interface_protocol;
+    guint8       interface_number;
+
+    gconstpointer (* get_property) (GQuark          name,
+                                    gpointer        user_data);
+    void          (* set_property) (GQuark          name,
+                                    gpointer        value,
+                                    GDestroyNotify  value_free,
+                                    gpointer        user_data);
+    gpointer         user_data;
+} MMUdevRuleDevice;
+
+void mm_kernel_device_generic_rules_apply (GArray                 *rules,
+                                           const MMUdevRuleDevice *device);
+
 G_END_DECLS
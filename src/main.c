@@ -27,6 +27,7 @@
 #include "ModemManager.h"
 
 #include "mm-base-manager.h"
+#include "mm-plugin-manager.h"
 #include "mm-log.h"
 #include "mm-context.h"
 
@@ -145,12 +146,26 @@ main (int argc, char *argv[])
                        mm_context_get_log_journal (),
                        mm_context_get_log_timestamps (),
                        mm_context_get_log_relative_timestamps (),
+                       mm_context_get_log_async (),
+                       mm_context_get_log_history (),
                        &err)) {
         g_warning ("Failed to set up logging: %s", err->message);
         g_error_free (err);
         exit (1);
     }
 
+    /* Only check the plugin manifest, don't run the daemon */
+    if (mm_context_get_test_check_plugin_manifest ()) {
+        if (!mm_plugin_manager_check_manifest (mm_context_get_test_plugin_dir (),
+                                               mm_context_get_test_check_plugin_manifest (),
+                                               &err)) {
+            g_warning ("Plugin manifest check failed: %s", err->message);
+            g_error_free (err);
+            exit (1);
+        }
+        exit (0);
+    }
+
     g_unix_signal_add (SIGTERM, quit_cb, NULL);
     g_unix_signal_add (SIGINT, quit_cb, NULL);
 
@@ -36,8 +36,11 @@
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
 #include "mm-log.h"
+#include "mm-scheduler.h"
 #include "mm-modem-helpers.h"
 #include "mm-bearer-stats.h"
+#include "mm-netlink-stats.h"
+#include "mm-context.h"
 
 /* We require up to 20s to get a proper IP when using PPP */
 #define BEARER_IP_TIMEOUT_DEFAULT 20
@@ -114,12 +117,28 @@ struct _MMBaseBearerPrivate {
 
     /* The stats object to expose */
     MMBearerStats *stats;
-    /* Handler id for the stats update timeout */
+    /* Handler id for the stats update job in the scheduler */
     guint stats_update_id;
+    /* Handler id for the stats update timeout, for sub-second intervals */
+    guint stats_update_timeout_id;
     /* Timer to measure the duration of the connection */
     GTimer *duration_timer;
     /* Flag to specify whether reloading stats is supported or not */
     gboolean reload_stats_unsupported;
+    /* Kernel counters of the data interface when the connection started, if
+     * stats are read from the interface instead of from the modem */
+    gboolean kernel_stats;
+    guint64  kernel_rx_bytes_start;
+    guint64  kernel_tx_bytes_start;
+    /* Last kernel counters read, to detect resets */
+    guint64  kernel_rx_bytes;
+    guint64  kernel_tx_bytes;
+    /* Totals accumulated before the last counter reset */
+    guint64  kernel_rx_bytes_base;
+    guint64  kernel_tx_bytes_base;
+    /* Connection attempt counters, kept across connections */
+    guint connection_attempts;
+    guint failed_connection_attempts;
 };
 
 /*****************************************************************************/
@@ -152,7 +171,7 @@ static void
 connection_monitor_stop (MMBaseBearer *self)
 {
     if (self->priv->connection_monitor_id) {
-        g_source_remove (self->priv->connection_monitor_id);
+        mm_scheduler_remove (mm_scheduler_get (), self->priv->connection_monitor_id);
         self->priv->connection_monitor_id = 0;
     }
 }
@@ -208,9 +227,12 @@ initial_connection_monitor_cb (MMBaseBearer *self)
         NULL);
 
     /* Add new monitor timeout at a higher rate */
-    self->priv->connection_monitor_id = g_timeout_add_seconds (BEARER_CONNECTION_MONITOR_TIMEOUT,
-                                                               (GSourceFunc) connection_monitor_cb,
-                                                               self);
+    self->priv->connection_monitor_id = mm_scheduler_add (mm_scheduler_get (),
+                                                          G_OBJECT (self),
+                                                          "connection-monitor",
+                                                          BEARER_CONNECTION_MONITOR_TIMEOUT,
+                                                          (GSourceFunc) connection_monitor_cb,
+                                                          self);
 
     /* Remove the initial connection monitor timeout as we added a new one */
     return G_SOURCE_REMOVE;
@@ -229,9 +251,12 @@ connection_monitor_start (MMBaseBearer *self)
 
     /* Schedule initial check */
     g_assert (!self->priv->connection_monitor_id);
-    self->priv->connection_monitor_id = g_timeout_add_seconds (BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT,
-                                                               (GSourceFunc) initial_connection_monitor_cb,
-                                                               self);
+    self->priv->connection_monitor_id = mm_scheduler_add (mm_scheduler_get (),
+                                                          G_OBJECT (self),
+                                                          "connection-monitor",
+                                                          BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT,
+                                                          (GSourceFunc) initial_connection_monitor_cb,
+                                                          self);
 }
 
 /*****************************************************************************/
@@ -247,8 +272,88 @@ bearer_update_interface_stats (MMBaseBearer *self)
 static void
 bearer_reset_interface_stats (MMBaseBearer *self)
 {
+    /* Everything but the connection attempt counters is reset */
     g_clear_object (&self->priv->stats);
-    mm_gdbus_bearer_set_stats (MM_GDBUS_BEARER (self), NULL);
+    self->priv->stats = mm_bearer_stats_new ();
+    mm_bearer_stats_set_attempts (self->priv->stats, self->priv->connection_attempts);
+    mm_bearer_stats_set_failed_attempts (self->priv->stats, self->priv->failed_connection_attempts);
+    bearer_update_interface_stats (self);
+}
+
+static void
+bearer_stats_add_sample (MMBaseBearer *self,
+                         guint64       rx_bytes,
+                         guint64       tx_bytes)
+{
+    MMBearerStats *stats = self->priv->stats;
+    guint64        timestamp;
+    guint64        last_timestamp;
+    guint64        last_rx_bytes;
+    guint64        last_tx_bytes;
+    guint          n_samples;
+
+    timestamp = (guint64) (g_timer_elapsed (self->priv->duration_timer, NULL) * 1000);
+
+    /* Throughput since the previous sample; counters going backwards (e.g.
+     * after a reset) don't count as traffic */
+    n_samples = mm_bearer_stats_get_n_samples (stats);
+    if (n_samples > 0 &&
+        mm_bearer_stats_get_sample (stats, n_samples - 1, &last_timestamp, &last_rx_bytes, &last_tx_bytes) &&
+        timestamp > last_timestamp) {
+        guint64 elapsed;
+        guint64 rx_rate;
+        guint64 tx_rate;
+
+        elapsed = timestamp - last_timestamp;
+        rx_rate = (rx_bytes > last_rx_bytes) ? ((rx_bytes - last_rx_bytes) * 1000 / elapsed) : 0;
+        tx_rate = (tx_bytes > last_tx_bytes) ? ((tx_bytes - last_tx_bytes) * 1000 / elapsed) : 0;
+        mm_bearer_stats_set_rx_rate (stats, rx_rate);
+        mm_bearer_stats_set_tx_rate (stats, tx_rate);
+        mm_bearer_stats_set_peak_rx_rate (stats, MAX (mm_bearer_stats_get_peak_rx_rate (stats), rx_rate));
+        mm_bearer_stats_set_peak_tx_rate (stats, MAX (mm_bearer_stats_get_peak_tx_rate (stats), tx_rate));
+    }
+
+    mm_bearer_stats_add_sample (stats, timestamp, rx_bytes, tx_bytes);
+    mm_bearer_stats_set_duration (stats, (guint32) (timestamp / 1000));
+    mm_bearer_stats_set_rx_bytes (stats, rx_bytes);
+    mm_bearer_stats_set_tx_bytes (stats, tx_bytes);
+    bearer_update_interface_stats (self);
+}
+
+static gboolean stats_update_cb (MMBaseBearer *self);
+
+static void
+bearer_stats_unschedule (MMBaseBearer *self)
+{
+    if (self->priv->stats_update_id) {
+        mm_scheduler_remove (mm_scheduler_get (), self->priv->stats_update_id);
+        self->priv->stats_update_id = 0;
+    }
+    if (self->priv->stats_update_timeout_id) {
+        g_source_remove (self->priv->stats_update_timeout_id);
+        self->priv->stats_update_timeout_id = 0;
+    }
+}
+
+static void
+bearer_stats_schedule (MMBaseBearer *self,
+                       guint         interval_ms)
+{
+    bearer_stats_unschedule (self);
+
+    /* Whole seconds go through the scheduler, so that they're run together
+     * with other periodic jobs */
+    if (interval_ms % 1000 == 0)
+        self->priv->stats_update_id = mm_scheduler_add (mm_scheduler_get (),
+                                                        G_OBJECT (self),
+                                                        "stats-update",
+                                                        interval_ms / 1000,
+                                                        (GSourceFunc) stats_update_cb,
+                                                        self);
+    else
+        self->priv->stats_update_timeout_id = g_timeout_add (interval_ms,
+                                                             (GSourceFunc) stats_update_cb,
+                                                             self);
 }
 
 static void
@@ -261,10 +366,14 @@ bearer_stats_stop (MMBaseBearer *self)
         self->priv->duration_timer = NULL;
     }
 
-    if (self->priv->stats_update_id) {
-        g_source_remove (self->priv->stats_update_id);
-        self->priv->stats_update_id = 0;
-    }
+    if (self->priv->stats && mm_bearer_stats_get_n_samples (self->priv->stats) > 1)
+        mm_dbg ("Bearer '%s' peak throughput: rx %" G_GUINT64_FORMAT " bytes/s, tx %" G_GUINT64_FORMAT " bytes/s",
+                self->priv->path,
+                mm_bearer_stats_get_peak_rx_rate (self->priv->stats),
+                mm_bearer_stats_get_peak_tx_rate (self->priv->stats));
+    self->priv->kernel_stats = FALSE;
+
+    bearer_stats_unschedule (self);
 }
 
 static void
@@ -287,21 +396,63 @@ reload_stats_ready (MMBaseBearer *self,
          * the error and update oly the duration timer. */
         mm_dbg ("Reloading stats is unsupported by the device");
         self->priv->reload_stats_unsupported = TRUE;
-        rx_bytes = 0;
-        tx_bytes = 0;
         g_error_free (error);
+        mm_bearer_stats_set_duration (self->priv->stats, (guint32) g_timer_elapsed (self->priv->duration_timer, NULL));
+        mm_bearer_stats_set_tx_bytes (self->priv->stats, 0);
+        mm_bearer_stats_set_rx_bytes (self->priv->stats, 0);
+        bearer_update_interface_stats (self);
+        return;
     }
 
     /* We only update stats if they were retrieved properly */
-    mm_bearer_stats_set_duration (self->priv->stats, (guint32) g_timer_elapsed (self->priv->duration_timer, NULL));
-    mm_bearer_stats_set_tx_bytes (self->priv->stats, tx_bytes);
-    mm_bearer_stats_set_rx_bytes (self->priv->stats, rx_bytes);
-    bearer_update_interface_stats (self);
+    bearer_stats_add_sample (self, rx_bytes, tx_bytes);
+}
+
+static gboolean
+kernel_stats_update (MMBaseBearer *self)
+{
+    GError  *error = NULL;
+    guint64  rx_bytes = 0;
+    guint64  tx_bytes = 0;
+
+    if (!mm_netlink_stats_read (mm_gdbus_bearer_get_interface (MM_GDBUS_BEARER (self)), &rx_bytes, &tx_bytes, &error)) {
+        mm_dbg ("Reading stats from the network interface failed, querying the modem instead: %s", error->message);
+        g_error_free (error);
+        return FALSE;
+    }
+
+    /* Counters reset, e.g. if the interface was re-created; keep the totals
+     * reported so far as base so that they never go backwards */
+    if (rx_bytes < self->priv->kernel_rx_bytes) {
+        self->priv->kernel_rx_bytes_base += self->priv->kernel_rx_bytes - self->priv->kernel_rx_bytes_start;
+        self->priv->kernel_rx_bytes_start = 0;
+    }
+    if (tx_bytes < self->priv->kernel_tx_bytes) {
+        self->priv->kernel_tx_bytes_base += self->priv->kernel_tx_bytes - self->priv->kernel_tx_bytes_start;
+        self->priv->kernel_tx_bytes_start = 0;
+    }
+
+    self->priv->kernel_rx_bytes = rx_bytes;
+    self->priv->kernel_tx_bytes = tx_bytes;
+
+    bearer_stats_add_sample (self,
+                             self->priv->kernel_rx_bytes_base + rx_bytes - self->priv->kernel_rx_bytes_start,
+                             self->priv->kernel_tx_bytes_base + tx_bytes - self->priv->kernel_tx_bytes_start);
+    return TRUE;
 }
 
 static gboolean
 stats_update_cb (MMBaseBearer *self)
 {
+    /* If reading the interface counters, no need to query the modem. If that
+     * fails, fallback to querying the modem at the default interval. */
+    if (self->priv->kernel_stats) {
+        if (kernel_stats_update (self))
+            return G_SOURCE_CONTINUE;
+        self->priv->kernel_stats = FALSE;
+        bearer_stats_schedule (self, BEARER_STATS_UPDATE_TIMEOUT * 1000);
+    }
+
     /* If the implementation knows how to update stat values, run it */
     if (!self->priv->reload_stats_unsupported &&
         MM_BASE_BEARER_GET_CLASS (self)->reload_stats &&
@@ -324,20 +475,42 @@ stats_update_cb (MMBaseBearer *self)
 static void
 bearer_stats_start (MMBaseBearer *self)
 {
+    const gchar *interface;
+    guint        interval_ms;
+
     /* Allocate new stats object. If there was one already created from a
      * previous run, deallocate it */
-    g_assert (!self->priv->stats);
-    self->priv->stats = mm_bearer_stats_new ();
+    bearer_reset_interface_stats (self);
 
     /* Start duration timer */
     g_assert (!self->priv->duration_timer);
     self->priv->duration_timer = g_timer_new ();
 
+    /* If requested, read stats from the data interface counters, which only
+     * count from the moment the connection is started */
+    interval_ms = mm_context_get_bearer_stats_interval ();
+    interface = mm_gdbus_bearer_get_interface (MM_GDBUS_BEARER (self));
+    self->priv->kernel_stats = FALSE;
+    if (interval_ms && interface) {
+        GError *error = NULL;
+
+        if (mm_netlink_stats_read (interface, &self->priv->kernel_rx_bytes_start, &self->priv->kernel_tx_bytes_start, &error)) {
+            self->priv->kernel_stats = TRUE;
+            self->priv->kernel_rx_bytes = self->priv->kernel_rx_bytes_start;
+            self->priv->kernel_tx_bytes = self->priv->kernel_tx_bytes_start;
+            self->priv->kernel_rx_bytes_base = 0;
+            self->priv->kernel_tx_bytes_base = 0;
+        } else {
+            mm_dbg ("Couldn't read stats from network interface '%s', querying the modem instead: %s",
+                    interface, error->message);
+            g_error_free (error);
+        }
+    }
+
     /* Schedule */
-    g_assert (!self->priv->stats_update_id);
-    self->priv->stats_update_id = g_timeout_add_seconds (BEARER_STATS_UPDATE_TIMEOUT,
-                                                         (GSourceFunc) stats_update_cb,
-                                                         self);
+    g_assert (!self->priv->stats_update_id && !self->priv->stats_update_timeout_id);
+    bearer_stats_schedule (self, self->priv->kernel_stats ? interval_ms : BEARER_STATS_UPDATE_TIMEOUT * 1000);
+
     /* Load initial values */
     stats_update_cb (self);
 }
@@ -749,9 +922,12 @@ connect_ready (MMBaseBearer *self,
 
     g_clear_object (&self->priv->connect_cancellable);
 
-    if (error)
+    if (error) {
+        self->priv->failed_connection_attempts++;
+        mm_bearer_stats_set_failed_attempts (self->priv->stats, self->priv->failed_connection_attempts);
+        bearer_update_interface_stats (self);
         g_task_return_error (task, error);
-    else
+    } else
         g_task_return_boolean (task, TRUE);
 
     g_object_unref (task);
@@ -847,6 +1023,7 @@ mm_base_bearer_connect (MMBaseBearer *self,
     mm_dbg ("Connecting bearer '%s'", self->priv->path);
     self->priv->connect_cancellable = g_cancellable_new ();
     bearer_update_status (self, MM_BEARER_STATUS_CONNECTING);
+    self->priv->connection_attempts++;
     bearer_reset_interface_stats (self);
     MM_BASE_BEARER_GET_CLASS (self)->connect (
         self,
@@ -44,7 +44,9 @@
 #include "mm-auth.h"
 #include "mm-plugin.h"
 #include "mm-filter.h"
+#include "mm-scheduler.h"
 #include "mm-log.h"
+#include "mm-log-history.h"
 
 static void initable_iface_init (GInitableIface *iface);
 
@@ -89,6 +91,8 @@ struct _MMBaseManagerPrivate {
     GDBusObjectManagerServer *object_manager;
     /* The map of inhibited devices */
     GHashTable *inhibited_devices;
+    /* The scheduler of periodic jobs */
+    MMScheduler *scheduler;
 
     /* The Test interface support */
     MmGdbusTest *test_skeleton;
@@ -1251,6 +1255,75 @@ handle_inhibit_device (MmGdbusOrgFreedesktopModemManager1 *manager,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Log history */
+
+typedef struct {
+    MMBaseManager         *self;
+    GDBusMethodInvocation *invocation;
+    gchar                 *uid;
+} GetLogHistoryContext;
+
+static void
+get_log_history_context_free (GetLogHistoryContext *ctx)
+{
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->self);
+    g_free (ctx->uid);
+    g_slice_free (GetLogHistoryContext, ctx);
+}
+
+static void
+get_log_history_auth_ready (MMAuthProvider       *authp,
+                            GAsyncResult         *res,
+                            GetLogHistoryContext *ctx)
+{
+    GError  *error = NULL;
+    gchar  **lines;
+
+    if (!mm_auth_provider_authorize_finish (authp, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        get_log_history_context_free (ctx);
+        return;
+    }
+
+    lines = mm_log_history_get (ctx->uid);
+    if (!lines) {
+        g_dbus_method_invocation_return_error (ctx->invocation, MM_CORE_ERROR, MM_CORE_ERROR_NOT_FOUND,
+                                               "No log history found for uid '%s'", ctx->uid);
+        get_log_history_context_free (ctx);
+        return;
+    }
+
+    mm_gdbus_org_freedesktop_modem_manager1_complete_get_log_history (
+        MM_GDBUS_ORG_FREEDESKTOP_MODEM_MANAGER1 (ctx->self),
+        ctx->invocation,
+        (const gchar *const *) lines);
+    g_strfreev (lines);
+    get_log_history_context_free (ctx);
+}
+
+static gboolean
+handle_get_log_history (MmGdbusOrgFreedesktopModemManager1 *manager,
+                        GDBusMethodInvocation              *invocation,
+                        const gchar                        *uid)
+{
+    GetLogHistoryContext *ctx;
+
+    ctx = g_slice_new0 (GetLogHistoryContext);
+    ctx->self = g_object_ref (manager);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->uid = g_strdup (uid);
+
+    mm_auth_provider_authorize (ctx->self->priv->authp,
+                                invocation,
+                                MM_AUTHORIZATION_MANAGER_CONTROL,
+                                ctx->self->priv->authp_cancellable,
+                                (GAsyncReadyCallback)get_log_history_auth_ready,
+                                ctx);
+    return TRUE;
+}
+
 /*****************************************************************************/
 /* Test profile setup */
 
@@ -1315,6 +1388,20 @@ out:
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Test scheduled jobs */
+
+static gboolean
+handle_get_scheduled_jobs (MmGdbusTest *skeleton,
+                           GDBusMethodInvocation *invocation,
+                           MMBaseManager *self)
+{
+    mm_gdbus_test_complete_get_scheduled_jobs (skeleton,
+                                               invocation,
+                                               mm_scheduler_get_jobs (self->priv->scheduler));
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 MMBaseManager *
@@ -1463,6 +1550,11 @@ mm_base_manager_init (MMBaseManager *manager)
     /* By default, no test interface */
     priv->enable_test = FALSE;
 
+    /* Setup the scheduler of periodic jobs, so that the ones run for all
+     * the modems are batched together */
+    priv->scheduler = g_object_ref (mm_scheduler_get ());
+    mm_scheduler_set_slack (priv->scheduler, mm_context_get_periodic_slack ());
+
     /* Setup Object Manager Server */
     priv->object_manager = g_dbus_object_manager_server_new (MM_DBUS_PATH);
 
@@ -1472,6 +1564,7 @@ mm_base_manager_init (MMBaseManager *manager)
                       "signal::handle-scan-devices",        G_CALLBACK (handle_scan_devices),        NULL,
                       "signal::handle-report-kernel-event", G_CALLBACK (handle_report_kernel_event), NULL,
                       "signal::handle-inhibit-device",      G_CALLBACK (handle_inhibit_device),      NULL,
+                      "signal::handle-get-log-history",     G_CALLBACK (handle_get_log_history),     NULL,
                       NULL);
 }
 
@@ -1516,6 +1609,10 @@ initable_init (GInitable *initable,
                           "handle-set-profile",
                           G_CALLBACK (handle_set_profile),
                           initable);
+        g_signal_connect (priv->test_skeleton,
+                          "handle-get-scheduled-jobs",
+                          G_CALLBACK (handle_get_scheduled_jobs),
+                          initable);
         if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (priv->test_skeleton),
                                                priv->connection,
                                                MM_DBUS_PATH,
@@ -1549,6 +1646,9 @@ finalize (GObject *object)
     if (priv->plugin_manager)
         g_object_unref (priv->plugin_manager);
 
+    if (priv->scheduler)
+        g_object_unref (priv->scheduler);
+
     if (priv->object_manager)
         g_object_unref (priv->object_manager);
 
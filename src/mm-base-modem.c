@@ -142,6 +142,21 @@ serial_port_timed_out_cb (MMPortSerial *port,
                  n_consecutive_timeouts);
 }
 
+static void
+set_common_response_parser (MMPortSerialAt *port)
+{
+    if (mm_context_get_serial_parser_v2 ())
+        mm_port_serial_at_set_response_parser (port,
+                                               mm_serial_parser_v2_parse,
+                                               mm_serial_parser_v2_new (),
+                                               mm_serial_parser_v2_destroy);
+    else
+        mm_port_serial_at_set_response_parser (port,
+                                               mm_serial_parser_v1_parse,
+                                               mm_serial_parser_v1_new (),
+                                               mm_serial_parser_v1_destroy);
+}
+
 gboolean
 mm_base_modem_grab_port (MMBaseModem         *self,
                          MMKernelDevice      *kernel_device,
@@ -211,10 +226,7 @@ mm_base_modem_grab_port (MMBaseModem         *self,
             port = MM_PORT (mm_port_serial_at_new (name, MM_PORT_SUBSYS_TTY));
 
             /* Set common response parser */
-            mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (port),
-                                                   mm_serial_parser_v1_parse,
-                                                   mm_serial_parser_v1_new (),
-                                                   mm_serial_parser_v1_destroy);
+            set_common_response_parser (MM_PORT_SERIAL_AT (port));
             /* Prefer plugin-provided flags to the generic ones */
             if (at_pflags == MM_PORT_SERIAL_AT_FLAG_NONE) {
                 if (mm_kernel_device_get_property_as_boolean (kernel_device, ID_MM_PORT_TYPE_AT_PRIMARY)) {
@@ -229,6 +241,13 @@ mm_base_modem_grab_port (MMBaseModem         *self,
                 }
             }
             mm_port_serial_at_set_flags (MM_PORT_SERIAL_AT (port), at_pflags);
+
+            /* Let queued commands be sent without waiting for the previous
+             * responses, if the port is known to handle it */
+            if (mm_kernel_device_get_property_as_boolean (kernel_device, ID_MM_PORT_AT_PIPELINE)) {
+                mm_dbg ("AT port '%s/%s' allows pipelining commands", subsys, name);
+                g_object_set (port, MM_PORT_SERIAL_PIPELINE, TRUE, NULL);
+            }
         } else if (ptype == MM_PORT_TYPE_GPS) {
             /* Raw GPS port */
             port = MM_PORT (mm_port_serial_gps_new (name));
@@ -298,12 +317,16 @@ mm_base_modem_grab_port (MMBaseModem         *self,
             port = MM_PORT (mm_port_serial_at_new (name, MM_PORT_SUBSYS_USB));
 
             /* Set common response parser */
-            mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (port),
-                                                   mm_serial_parser_v1_parse,
-                                                   mm_serial_parser_v1_new (),
-                                                   mm_serial_parser_v1_destroy);
+            set_common_response_parser (MM_PORT_SERIAL_AT (port));
             /* Store flags already */
             mm_port_serial_at_set_flags (MM_PORT_SERIAL_AT (port), at_pflags);
+
+            /* Let queued commands be sent without waiting for the previous
+             * responses, if the port is known to handle it */
+            if (mm_kernel_device_get_property_as_boolean (kernel_device, ID_MM_PORT_AT_PIPELINE)) {
+                mm_dbg ("AT port '%s/%s' allows pipelining commands", subsys, name);
+                g_object_set (port, MM_PORT_SERIAL_PIPELINE, TRUE, NULL);
+            }
         }
 
         if (!port) {
@@ -322,10 +345,7 @@ mm_base_modem_grab_port (MMBaseModem         *self,
         port = MM_PORT (mm_port_serial_at_new (name, MM_PORT_SUBSYS_UNIX));
 
         /* Set common response parser */
-        mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (port),
-                                               mm_serial_parser_v1_parse,
-                                               mm_serial_parser_v1_new (),
-                                               mm_serial_parser_v1_destroy);
+        set_common_response_parser (MM_PORT_SERIAL_AT (port));
         /* Store flags already */
         mm_port_serial_at_set_flags (MM_PORT_SERIAL_AT (port), at_pflags);
     }
@@ -90,6 +90,9 @@ struct _MMBroadbandModemQmiPrivate {
     guint signal_info_indication_id;
 #endif /* WITH_NEWEST_QMI_COMMANDS */
 
+    /* Signal helpers */
+    gboolean signal_thresholds_setup;
+
     /* New devices may not support the legacy DMS UIM commands */
     gboolean dms_uim_deprecated;
 
@@ -4793,13 +4796,14 @@ config_signal_info_ready (QmiClientNas *client,
     common_enable_disable_unsolicited_events_signal_info (task);
 }
 
+/* RSSI values go between -105 and -60 for 3GPP technologies,
+ * and from -105 to -90 in 3GPP2 technologies (approx). */
+static const gint8 default_rssi_thresholds[] = { -100, -97, -95, -92, -90, -85, -80, -75, -70, -65 };
+
 static void
 common_enable_disable_unsolicited_events_signal_info_config (GTask *task)
 {
     EnableUnsolicitedEventsContext *ctx;
-    /* RSSI values go between -105 and -60 for 3GPP technologies,
-     * and from -105 to -90 in 3GPP2 technologies (approx). */
-    static const gint8 thresholds_data[] = { -100, -97, -95, -92, -90, -85, -80, -75, -70, -65 };
     QmiMessageNasConfigSignalInfoInput *input;
     GArray *thresholds;
 
@@ -4814,8 +4818,8 @@ common_enable_disable_unsolicited_events_signal_info_config (GTask *task)
     input = qmi_message_nas_config_signal_info_input_new ();
 
     /* Prepare thresholds, separated 20 each */
-    thresholds = g_array_sized_new (FALSE, FALSE, sizeof (gint8), G_N_ELEMENTS (thresholds_data));
-    g_array_append_vals (thresholds, thresholds_data, G_N_ELEMENTS (thresholds_data));
+    thresholds = g_array_sized_new (FALSE, FALSE, sizeof (gint8), G_N_ELEMENTS (default_rssi_thresholds));
+    g_array_append_vals (thresholds, default_rssi_thresholds, G_N_ELEMENTS (default_rssi_thresholds));
 
     qmi_message_nas_config_signal_info_input_set_rssi_threshold (
         input,
@@ -4991,6 +4995,9 @@ event_report_indication_cb (QmiClientNas *client,
 
 #if defined WITH_NEWEST_QMI_COMMANDS
 
+static void signal_info_indication_update_values (MMBroadbandModemQmi *self,
+                                                  QmiIndicationNasSignalInfoOutput *output);
+
 static void
 signal_info_indication_cb (QmiClientNas *client,
                            QmiIndicationNasSignalInfoOutput *output,
@@ -5023,6 +5030,11 @@ signal_info_indication_cb (QmiClientNas *client,
             act,
             (MM_IFACE_MODEM_3GPP_ALL_ACCESS_TECHNOLOGIES_MASK | MM_IFACE_MODEM_CDMA_ALL_ACCESS_TECHNOLOGIES_MASK));
     }
+
+    /* Extended signal information only reported by indications once the
+     * Signal interface has setup the thresholds */
+    if (self->priv->signal_thresholds_setup)
+        signal_info_indication_update_values (self, output);
 }
 
 #endif /* WITH_NEWEST_QMI_COMMANDS */
@@ -8185,6 +8197,198 @@ signal_load_values (MMIfaceModemSignal *self,
     signal_load_values_context_step (task);
 }
 
+#if defined WITH_NEWEST_QMI_COMMANDS
+
+static void
+signal_info_indication_update_values (MMBroadbandModemQmi *self,
+                                      QmiIndicationNasSignalInfoOutput *output)
+{
+    MMSignal *cdma = NULL;
+    MMSignal *evdo = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gint8 rssi;
+    gint16 ecio;
+    QmiNasEvdoSinrLevel sinr_level;
+    gint32 io;
+    gint8 rsrq;
+    gint16 rsrp;
+    gint16 snr;
+
+    /* Same conversions as when loading the values with Get Signal Info */
+    if (qmi_indication_nas_signal_info_output_get_cdma_signal_strength (output, &rssi, &ecio, NULL)) {
+        cdma = mm_signal_new ();
+        mm_signal_set_rssi (cdma, (gdouble)rssi);
+        mm_signal_set_ecio (cdma, ((gdouble)ecio) * (-0.5));
+    }
+
+    if (qmi_indication_nas_signal_info_output_get_hdr_signal_strength (output, &rssi, &ecio, &sinr_level, &io, NULL)) {
+        evdo = mm_signal_new ();
+        mm_signal_set_rssi (evdo, (gdouble)rssi);
+        mm_signal_set_ecio (evdo, ((gdouble)ecio) * (-0.5));
+        mm_signal_set_sinr (evdo, get_db_from_sinr_level (sinr_level));
+        mm_signal_set_io (evdo, (gdouble)io);
+    }
+
+    if (qmi_indication_nas_signal_info_output_get_gsm_signal_strength (output, &rssi, NULL)) {
+        gsm = mm_signal_new ();
+        mm_signal_set_rssi (gsm, (gdouble)rssi);
+    }
+
+    if (qmi_indication_nas_signal_info_output_get_wcdma_signal_strength (output, &rssi, &ecio, NULL)) {
+        umts = mm_signal_new ();
+        mm_signal_set_rssi (umts, (gdouble)rssi);
+        mm_signal_set_ecio (umts, ((gdouble)ecio) * (-0.5));
+    }
+
+    if (qmi_indication_nas_signal_info_output_get_lte_signal_strength (output, &rssi, &rsrq, &rsrp, &snr, NULL)) {
+        lte = mm_signal_new ();
+        mm_signal_set_rssi (lte, (gdouble)rssi);
+        mm_signal_set_rsrq (lte, (gdouble)rsrq);
+        mm_signal_set_rsrp (lte, (gdouble)rsrp);
+        mm_signal_set_snr (lte, (0.1) * ((gdouble)snr));
+    }
+
+    mm_iface_modem_signal_update (MM_IFACE_MODEM_SIGNAL (self), cdma, evdo, gsm, umts, lte);
+
+    g_clear_object (&cdma);
+    g_clear_object (&evdo);
+    g_clear_object (&gsm);
+    g_clear_object (&umts);
+    g_clear_object (&lte);
+}
+
+/*****************************************************************************/
+/* Setup thresholds (Signal interface) */
+
+/* Reporting bands for each of the values; the modem sends a Signal Info
+ * indication whenever any of them moves to a different band, so these
+ * steps are the minimum changes reported. */
+static const gint8   signal_rssi_thresholds[]    = { -110, -106, -102, -98, -94, -90, -86, -82, -78, -74, -70, -66, -62, -58, -54, -50 }; /* dBm */
+static const gint8   signal_rsrq_thresholds[]    = { -20, -19, -18, -17, -16, -15, -14, -13, -12, -11, -10, -9, -8, -7, -6, -5 };         /* dB */
+static const gint16  signal_rsrp_thresholds[]    = { -140, -135, -130, -125, -120, -115, -110, -105, -100, -95, -90, -85, -80, -75, -70, -65 }; /* dBm */
+static const gint16  signal_lte_snr_thresholds[] = { -100, -80, -60, -40, -20, 0, 20, 40, 60, 80, 100, 120, 140, 160, 180, 200 };   /* 0.1 dB */
+static const guint8  signal_sinr_thresholds[]    = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };                                                  /* EV-DO SINR levels */
+
+static GArray *
+thresholds_array_new (gconstpointer data,
+                      guint element_size,
+                      guint n_elements)
+{
+    GArray *array;
+
+    array = g_array_sized_new (FALSE, FALSE, element_size, n_elements);
+    g_array_append_vals (array, data, n_elements);
+    return array;
+}
+
+static gboolean
+signal_setup_thresholds_finish (MMIfaceModemSignal *self,
+                                GAsyncResult *res,
+                                GError **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+signal_setup_thresholds_config_ready (QmiClientNas *client,
+                                      GAsyncResult *res,
+                                      GTask *task)
+{
+    MMBroadbandModemQmi *self;
+    QmiMessageNasConfigSignalInfoOutput *output;
+    GError *error = NULL;
+
+    self = g_task_get_source_object (task);
+
+    output = qmi_client_nas_config_signal_info_finish (client, res, &error);
+    if (!output || !qmi_message_nas_config_signal_info_output_get_result (output, &error)) {
+        g_prefix_error (&error, "Couldn't config signal info: ");
+        g_task_return_error (task, error);
+    } else {
+        self->priv->signal_thresholds_setup = GPOINTER_TO_UINT (g_task_get_task_data (task));
+        g_task_return_boolean (task, TRUE);
+    }
+
+    if (output)
+        qmi_message_nas_config_signal_info_output_unref (output);
+    g_object_unref (task);
+}
+
+static void
+signal_setup_thresholds (MMIfaceModemSignal *_self,
+                         gboolean enable,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
+{
+    MMBroadbandModemQmi *self = MM_BROADBAND_MODEM_QMI (_self);
+    QmiMessageNasConfigSignalInfoInput *input;
+    QmiClient *client = NULL;
+    GArray *thresholds;
+    GTask *task;
+
+    if (!mm_shared_qmi_ensure_client (MM_SHARED_QMI (self),
+                                      QMI_SERVICE_NAS, &client,
+                                      callback, user_data))
+        return;
+
+    task = g_task_new (self, NULL, callback, user_data);
+    g_task_set_task_data (task, GUINT_TO_POINTER (enable), NULL);
+
+    /* Stop processing the values in the indications right away */
+    if (!enable)
+        self->priv->signal_thresholds_setup = FALSE;
+    else if (!qmi_client_check_version (client, 1, 8) || !self->priv->signal_info_indication_id) {
+        /* Signal info introduced in NAS 1.8 */
+        g_task_return_new_error (task,
+                                 MM_CORE_ERROR,
+                                 MM_CORE_ERROR_UNSUPPORTED,
+                                 "Signal info indications not available");
+        g_object_unref (task);
+        return;
+    }
+
+    input = qmi_message_nas_config_signal_info_input_new ();
+
+    /* When resetting, go back to the RSSI thresholds used for the signal
+     * quality only */
+    if (!enable)
+        thresholds = thresholds_array_new (default_rssi_thresholds, sizeof (gint8), G_N_ELEMENTS (default_rssi_thresholds));
+    else
+        thresholds = thresholds_array_new (signal_rssi_thresholds, sizeof (gint8), G_N_ELEMENTS (signal_rssi_thresholds));
+    qmi_message_nas_config_signal_info_input_set_rssi_threshold (input, thresholds, NULL);
+    g_array_unref (thresholds);
+
+    if (enable) {
+        thresholds = thresholds_array_new (signal_rsrq_thresholds, sizeof (gint8), G_N_ELEMENTS (signal_rsrq_thresholds));
+        qmi_message_nas_config_signal_info_input_set_rsrq_threshold (input, thresholds, NULL);
+        g_array_unref (thresholds);
+
+        thresholds = thresholds_array_new (signal_rsrp_thresholds, sizeof (gint16), G_N_ELEMENTS (signal_rsrp_thresholds));
+        qmi_message_nas_config_signal_info_input_set_rsrp_threshold (input, thresholds, NULL);
+        g_array_unref (thresholds);
+
+        thresholds = thresholds_array_new (signal_lte_snr_thresholds, sizeof (gint16), G_N_ELEMENTS (signal_lte_snr_thresholds));
+        qmi_message_nas_config_signal_info_input_set_lte_snr_threshold (input, thresholds, NULL);
+        g_array_unref (thresholds);
+
+        thresholds = thresholds_array_new (signal_sinr_thresholds, sizeof (guint8), G_N_ELEMENTS (signal_sinr_thresholds));
+        qmi_message_nas_config_signal_info_input_set_sinr_threshold (input, thresholds, NULL);
+        g_array_unref (thresholds);
+    }
+
+    qmi_client_nas_config_signal_info (QMI_CLIENT_NAS (client),
+                                       input,
+                                       5,
+                                       NULL,
+                                       (GAsyncReadyCallback)signal_setup_thresholds_config_ready,
+                                       task);
+    qmi_message_nas_config_signal_info_input_unref (input);
+}
+
+#endif /* WITH_NEWEST_QMI_COMMANDS */
+
 /*****************************************************************************/
 /* First enabling step */
 
@@ -8769,6 +8973,10 @@ iface_modem_signal_init (MMIfaceModemSignal *iface)
     iface->check_support_finish = signal_check_support_finish;
     iface->load_values = signal_load_values;
     iface->load_values_finish = signal_load_values_finish;
+#if defined WITH_NEWEST_QMI_COMMANDS
+    iface->setup_thresholds = signal_setup_thresholds;
+    iface->setup_thresholds_finish = signal_setup_thresholds_finish;
+#endif /* WITH_NEWEST_QMI_COMMANDS */
 }
 
 static void
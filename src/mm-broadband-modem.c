@@ -6892,8 +6892,19 @@ modem_messaging_enable_unsolicited_events (MMIfaceModemMessaging *self,
 
 typedef struct {
     MMSmsStorage list_storage;
+    /* +CMGL response being processed, record by record */
+    gchar *response;
+    gsize response_len;
+    gsize response_offset;
 } ListPartsContext;
 
+static void
+list_parts_context_free (ListPartsContext *ctx)
+{
+    g_free (ctx->response);
+    g_free (ctx);
+}
+
 static gboolean
 modem_messaging_load_initial_sms_parts_finish (MMIfaceModemMessaging *self,
                                                GAsyncResult *res,
@@ -6951,8 +6962,8 @@ sms_text_part_list_ready (MMBroadbandModem *self,
     }
 
     /* +CMGL: <index>,<stat>,<oa/da>,[alpha],<scts><CR><LF><data><CR><LF> */
-    r = g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)",
-                     0, 0, NULL);
+    r = mm_regex_cache_get ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)",
+                            0, 0, NULL);
     g_assert (r);
 
     if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, NULL)) {
@@ -7063,6 +7074,63 @@ sms_state_from_index (guint index)
     }
 }
 
+static gboolean
+sms_pdu_part_list_process_next (GTask *task)
+{
+    MMBroadbandModem *self;
+    ListPartsContext *ctx;
+    MM3gppPduInfo *info;
+    MMSmsPart *part;
+    GError *error = NULL;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    info = mm_3gpp_parse_pdu_cmgl_response_next (ctx->response,
+                                                 ctx->response_len,
+                                                 &ctx->response_offset,
+                                                 &error);
+    if (error) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (!info) {
+        /* We consider all done */
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+        return G_SOURCE_REMOVE;
+    }
+
+    part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, &error);
+    if (part) {
+        mm_dbg ("Correctly parsed PDU (%d)", info->index);
+        mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
+                                            part,
+                                            sms_state_from_index (info->status),
+                                            ctx->list_storage);
+    } else {
+        /* Don't treat the error as critical */
+        mm_dbg ("Error parsing PDU (%d): %s", info->index, error->message);
+        g_error_free (error);
+    }
+    mm_3gpp_pdu_info_free (info);
+
+    /* Drop the records already processed once they take most of the buffer,
+     * so that memory is released as the listing goes on; halving keeps the
+     * total amount of data moved linear in the response length */
+    if (ctx->response_offset > ctx->response_len / 2) {
+        ctx->response_len -= ctx->response_offset;
+        memmove (ctx->response, ctx->response + ctx->response_offset, ctx->response_len + 1);
+        ctx->response = g_realloc (ctx->response, ctx->response_len + 1);
+        ctx->response_offset = 0;
+    }
+
+    /* Yield to the main loop before the next record */
+    return G_SOURCE_CONTINUE;
+}
+
 static void
 sms_pdu_part_list_ready (MMBroadbandModem *self,
                          GAsyncResult *res,
@@ -7071,8 +7139,6 @@ sms_pdu_part_list_ready (MMBroadbandModem *self,
     ListPartsContext *ctx;
     const gchar *response;
     GError *error = NULL;
-    GList *info_list;
-    GList *l;
 
     /* Always always always unlock mem1 storage. Warned you've been. */
     mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
@@ -7084,38 +7150,15 @@ sms_pdu_part_list_ready (MMBroadbandModem *self,
         return;
     }
 
-    info_list = mm_3gpp_parse_pdu_cmgl_response (response, &error);
-    if (error) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
-    }
-
+    /* Storages may hold hundreds of parts, so instead of building all of
+     * them at once, process the response one record at a time. The response
+     * is owned by the AT command result, which is gone once we return, so
+     * keep a copy whose processed records are dropped as we go */
     ctx = g_task_get_task_data (task);
-
-    for (l = info_list; l; l = g_list_next (l)) {
-        MM3gppPduInfo *info = l->data;
-        MMSmsPart *part;
-
-        part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, &error);
-        if (part) {
-            mm_dbg ("Correctly parsed PDU (%d)", info->index);
-            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
-                                                part,
-                                                sms_state_from_index (info->status),
-                                                ctx->list_storage);
-        } else {
-            /* Don't treat the error as critical */
-            mm_dbg ("Error parsing PDU (%d): %s", info->index, error->message);
-            g_clear_error (&error);
-        }
-    }
-
-    mm_3gpp_pdu_info_list_free (info_list);
-
-    /* We consider all done */
-    g_task_return_boolean (task, TRUE);
-    g_object_unref (task);
+    ctx->response_len = strlen (response);
+    ctx->response = g_strdup (response);
+    ctx->response_offset = 0;
+    g_idle_add ((GSourceFunc) sms_pdu_part_list_process_next, task);
 }
 
 static void
@@ -7158,11 +7201,11 @@ modem_messaging_load_initial_sms_parts (MMIfaceModemMessaging *self,
     ListPartsContext *ctx;
     GTask *task;
 
-    ctx = g_new (ListPartsContext, 1);
+    ctx = g_new0 (ListPartsContext, 1);
     ctx->list_storage = storage;
 
     task = g_task_new (self, NULL, callback, user_data);
-    g_task_set_task_data (task, ctx, g_free);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) list_parts_context_free);
 
     mm_dbg ("Listing SMS parts in storage '%s'",
             mm_sms_storage_get_string (storage));
@@ -8032,7 +8075,7 @@ css_query_ready (MMIfaceModemCdma *self,
         GMatchInfo *match_info;
 
         /* Format is "<band_class>,<band>,<sid>" */
-        r = g_regex_new ("\\s*([^,]*?)\\s*,\\s*([^,]*?)\\s*,\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        r = mm_regex_cache_get ("\\s*([^,]*?)\\s*,\\s*([^,]*?)\\s*,\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
         g_assert (r);
 
         g_regex_match (r, result, 0, &match_info);
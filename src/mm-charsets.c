@@ -26,12 +26,22 @@
 #include "mm-charsets.h"
 #include "mm-log.h"
 
+/* Conversions done with iconv, whose descriptors are cached */
+typedef enum {
+    CHARSET_CONVERSION_FROM_UTF8,        /* UTF-8 to charset, transliterating */
+    CHARSET_CONVERSION_FROM_UTF8_STRICT, /* UTF-8 to charset */
+    CHARSET_CONVERSION_TO_UTF8,          /* charset to UTF-8, transliterating */
+    CHARSET_CONVERSION_LAST
+} CharsetConversion;
+
 typedef struct {
     const char *gsm_name;
     const char *other_name;
     const char *iconv_from_name;
     const char *iconv_to_name;
     MMModemCharset charset;
+    /* Opened on first use; (GIConv) -1 if not supported */
+    GIConv iconv[CHARSET_CONVERSION_LAST];
 } CharsetEntry;
 
 static CharsetEntry charset_map[] = {
@@ -46,6 +56,9 @@ static CharsetEntry charset_map[] = {
     { NULL,      NULL,     NULL,        NULL,                  MM_MODEM_CHARSET_UNKNOWN }
 };
 
+static guint8 *utf8_to_unpacked_gsm (const char *utf8, gssize len, gboolean strict, guint32 *out_len);
+static gchar  *gsm_unpacked_to_utf8 (const guint8 *gsm, guint32 len);
+
 const char *
 mm_modem_charset_to_string (MMModemCharset charset)
 {
@@ -79,8 +92,8 @@ mm_modem_charset_from_string (const char *string)
     return MM_MODEM_CHARSET_UNKNOWN;
 }
 
-static const char *
-charset_iconv_to (MMModemCharset charset)
+static CharsetEntry *
+charset_entry_get (MMModemCharset charset)
 {
     CharsetEntry *iter = &charset_map[0];
 
@@ -88,27 +101,94 @@ charset_iconv_to (MMModemCharset charset)
 
     while (iter->gsm_name) {
         if (iter->charset == charset)
-            return iter->iconv_to_name;
+            return iter;
         iter++;
     }
     g_warn_if_reached ();
     return NULL;
 }
 
-static const char *
-charset_iconv_from (MMModemCharset charset)
+/* Converts with the cached iconv descriptor for the given charset and
+ * conversion; same semantics as g_convert(). The GSM charset isn't handled
+ * by iconv, but with the GSM 03.38 tables below. */
+static gchar *
+charset_convert (MMModemCharset charset,
+                 CharsetConversion conversion,
+                 const gchar *str,
+                 gssize len,
+                 gsize *bytes_written,
+                 GError **error)
 {
-    CharsetEntry *iter = &charset_map[0];
+    CharsetEntry *entry;
+    const gchar *to = NULL;
+    const gchar *from = NULL;
 
-    g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
+    if (len < 0)
+        len = strlen (str);
 
-    while (iter->gsm_name) {
-        if (iter->charset == charset)
-            return iter->iconv_from_name;
-        iter++;
+    if (charset == MM_MODEM_CHARSET_GSM) {
+        guint8 *gsm;
+        guint32 gsm_len = 0;
+        gchar *utf8;
+
+        if (conversion != CHARSET_CONVERSION_TO_UTF8) {
+            gsm = utf8_to_unpacked_gsm (str, len,
+                                        (conversion == CHARSET_CONVERSION_FROM_UTF8_STRICT),
+                                        &gsm_len);
+            if (!gsm) {
+                g_set_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+                             "Input cannot be represented in the GSM alphabet");
+                return NULL;
+            }
+            if (bytes_written)
+                *bytes_written = gsm_len;
+            return (gchar *) gsm;
+        }
+
+        utf8 = gsm_unpacked_to_utf8 ((const guint8 *) str, len);
+        if (bytes_written)
+            *bytes_written = strlen (utf8);
+        return utf8;
     }
-    g_warn_if_reached ();
-    return NULL;
+
+    entry = charset_entry_get (charset);
+    if (!entry || !entry->iconv_from_name) {
+        g_set_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_NO_CONVERSION,
+                     "Conversion to or from character set '%s' is not supported",
+                     entry ? entry->gsm_name : "unknown");
+        return NULL;
+    }
+
+    if (!entry->iconv[conversion]) {
+        switch (conversion) {
+        case CHARSET_CONVERSION_FROM_UTF8:
+            to = entry->iconv_to_name;
+            from = "UTF-8";
+            break;
+        case CHARSET_CONVERSION_FROM_UTF8_STRICT:
+            to = entry->iconv_from_name;
+            from = "UTF-8";
+            break;
+        case CHARSET_CONVERSION_TO_UTF8:
+            to = "UTF-8//TRANSLIT";
+            from = entry->iconv_from_name;
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+        entry->iconv[conversion] = g_iconv_open (to, from);
+    }
+
+    if (entry->iconv[conversion] == (GIConv) -1) {
+        g_set_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_NO_CONVERSION,
+                     "Conversion to or from character set '%s' is not supported",
+                     entry->iconv_from_name);
+        return NULL;
+    }
+
+    /* Reset the shift state, in case the last conversion failed halfway */
+    g_iconv (entry->iconv[conversion], NULL, NULL, NULL, NULL);
+    return g_convert_with_iconv (str, len, entry->iconv[conversion], NULL, bytes_written, error);
 }
 
 gboolean
@@ -117,7 +197,6 @@ mm_modem_charset_byte_array_append (GByteArray *array,
                                     gboolean quoted,
                                     MMModemCharset charset)
 {
-    const char *iconv_to;
     char *converted;
     GError *error = NULL;
     gsize written = 0;
@@ -125,14 +204,11 @@ mm_modem_charset_byte_array_append (GByteArray *array,
     g_return_val_if_fail (array != NULL, FALSE);
     g_return_val_if_fail (utf8 != NULL, FALSE);
 
-    iconv_to = charset_iconv_to (charset);
-    g_return_val_if_fail (iconv_to != NULL, FALSE);
-
-    converted = g_convert (utf8, -1, iconv_to, "UTF-8", NULL, &written, &error);
+    converted = charset_convert (charset, CHARSET_CONVERSION_FROM_UTF8, utf8, -1, &written, &error);
     if (!converted) {
         if (error) {
             mm_warn ("failed to convert '%s' to %s character set: (%d) %s",
-                     utf8, iconv_to, error->code, error->message);
+                     utf8, mm_modem_charset_to_string (charset), error->code, error->message);
             g_error_free (error);
         }
         return FALSE;
@@ -153,18 +229,14 @@ mm_modem_charset_byte_array_to_utf8 (GByteArray     *array,
                                      MMModemCharset  charset)
 {
     char *converted;
-    const char *iconv_from;
     GError *error = NULL;
 
     g_return_val_if_fail (array != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    iconv_from = charset_iconv_from (charset);
-    g_return_val_if_fail (iconv_from != NULL, FALSE);
-
-    converted = g_convert ((const gchar *)array->data, array->len,
-                           "UTF-8//TRANSLIT", iconv_from,
-                           NULL, NULL, &error);
+    converted = charset_convert (charset, CHARSET_CONVERSION_TO_UTF8,
+                                 (const gchar *)array->data, array->len,
+                                 NULL, &error);
     if (!converted || error) {
         g_clear_error (&error);
         converted = NULL;
@@ -177,16 +249,12 @@ char *
 mm_modem_charset_hex_to_utf8 (const char *src, MMModemCharset charset)
 {
     char *unconverted, *converted;
-    const char *iconv_from;
     gsize unconverted_len = 0;
     GError *error = NULL;
 
     g_return_val_if_fail (src != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    iconv_from = charset_iconv_from (charset);
-    g_return_val_if_fail (iconv_from != NULL, FALSE);
-
     unconverted = mm_utils_hexstr2bin (src, &unconverted_len);
     if (!unconverted)
         return NULL;
@@ -194,9 +262,9 @@ mm_modem_charset_hex_to_utf8 (const char *src, MMModemCharset charset)
     if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
         return unconverted;
 
-    converted = g_convert (unconverted, unconverted_len,
-                           "UTF-8//TRANSLIT", iconv_from,
-                           NULL, NULL, &error);
+    converted = charset_convert (charset, CHARSET_CONVERSION_TO_UTF8,
+                                 unconverted, unconverted_len,
+                                 NULL, &error);
     if (!converted || error) {
         g_clear_error (&error);
         converted = NULL;
@@ -212,22 +280,18 @@ mm_modem_charset_utf8_to_hex (const char *src, MMModemCharset charset)
 {
     gsize converted_len = 0;
     char *converted;
-    const char *iconv_to;
     GError *error = NULL;
     gchar *hex;
 
     g_return_val_if_fail (src != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    iconv_to = charset_iconv_from (charset);
-    g_return_val_if_fail (iconv_to != NULL, FALSE);
-
     if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
         return g_strdup (src);
 
-    converted = g_convert (src, strlen (src),
-                           iconv_to, "UTF-8//TRANSLIT",
-                           NULL, &converted_len, &error);
+    converted = charset_convert (charset, CHARSET_CONVERSION_FROM_UTF8_STRICT,
+                                 src, -1,
+                                 &converted_len, &error);
     if (!converted || error) {
         g_clear_error (&error);
         g_free (converted);
@@ -337,25 +401,6 @@ gsm_def_char_to_utf8 (const guint8 gsm, guint8 out_utf8[2])
     return gsm_def_utf8_alphabet[gsm].len;
 }
 
-static gboolean
-utf8_to_gsm_def_char (const char *utf8, guint32 len, guint8 *out_gsm)
-{
-    int i;
-
-    if (len > 0 && len < 4) {
-        for (i = 0; i < GSM_DEF_ALPHABET_SIZE; i++) {
-            if (gsm_def_utf8_alphabet[i].len == len) {
-                if (memcmp (&gsm_def_utf8_alphabet[i].chars[0], utf8, len) == 0) {
-                    *out_gsm = i;
-                    return TRUE;
-                }
-            }
-        }
-    }
-    return FALSE;
-}
-
-
 #define EONE(a, g)        { {a, 0x00, 0x00}, 1, g }
 #define ETHR(a, b, c, g)  { {a, b,    c},    3, g }
 
@@ -376,115 +421,254 @@ static const GsmUtf8Mapping gsm_ext_utf8_alphabet[GSM_EXT_ALPHABET_SIZE] = {
 
 #define GSM_ESCAPE_CHAR 0x1b
 
-static guint8
-gsm_ext_char_to_utf8 (const guint8 gsm, guint8 out_utf8[3])
+/* Reverse mappings, from UTF-8 to GSM, built out of the alphabets on first
+ * use. Characters below U+0100 are looked up directly; the few others (greek
+ * capital letters and the euro sign) with a linear search. */
+#define GSM_NO_CHAR 0xFF
+
+typedef struct {
+    gunichar c;
+    guint8   def;
+    guint8   ext;
+} GsmReverseMapping;
+
+static GsmReverseMapping gsm_reverse_latin1[0x100];
+static GsmReverseMapping gsm_reverse_other[16];
+static guint             gsm_reverse_n_other;
+/* Index in gsm_ext_utf8_alphabet of each extended char */
+static guint8            gsm_ext_index[GSM_DEF_ALPHABET_SIZE];
+
+static GsmReverseMapping *
+gsm_reverse_mapping_get (gunichar c,
+                         gboolean create)
 {
-    int i;
+    guint i;
+
+    if (c < G_N_ELEMENTS (gsm_reverse_latin1))
+        return &gsm_reverse_latin1[c];
+
+    for (i = 0; i < gsm_reverse_n_other; i++) {
+        if (gsm_reverse_other[i].c == c)
+            return &gsm_reverse_other[i];
+    }
+
+    if (!create)
+        return NULL;
+
+    g_assert (gsm_reverse_n_other < G_N_ELEMENTS (gsm_reverse_other));
+    gsm_reverse_other[gsm_reverse_n_other].c = c;
+    gsm_reverse_other[gsm_reverse_n_other].def = GSM_NO_CHAR;
+    gsm_reverse_other[gsm_reverse_n_other].ext = GSM_NO_CHAR;
+    return &gsm_reverse_other[gsm_reverse_n_other++];
+}
+
+static void
+gsm_tables_init (void)
+{
+    static gsize initialized = 0;
+    guint i;
+
+    if (!g_once_init_enter (&initialized))
+        return;
+
+    for (i = 0; i < G_N_ELEMENTS (gsm_reverse_latin1); i++) {
+        gsm_reverse_latin1[i].c = i;
+        gsm_reverse_latin1[i].def = GSM_NO_CHAR;
+        gsm_reverse_latin1[i].ext = GSM_NO_CHAR;
+    }
+    memset (gsm_ext_index, GSM_NO_CHAR, sizeof (gsm_ext_index));
+
+    /* Chars not being valid UTF-8 (i.e. the escape code) are never matched;
+     * if more than one GSM char maps to the same one, the first one wins */
+    for (i = 0; i < GSM_DEF_ALPHABET_SIZE; i++) {
+        gunichar c;
+
+        c = g_utf8_get_char_validated (gsm_def_utf8_alphabet[i].chars, gsm_def_utf8_alphabet[i].len);
+        if (c < (gunichar) -2 && g_unichar_to_utf8 (c, NULL) == gsm_def_utf8_alphabet[i].len) {
+            GsmReverseMapping *mapping;
+
+            mapping = gsm_reverse_mapping_get (c, TRUE);
+            if (mapping->def == GSM_NO_CHAR)
+                mapping->def = i;
+        }
+    }
 
     for (i = 0; i < GSM_EXT_ALPHABET_SIZE; i++) {
-        if (gsm == gsm_ext_utf8_alphabet[i].gsm) {
-            memcpy (&out_utf8[0], &gsm_ext_utf8_alphabet[i].chars[0], gsm_ext_utf8_alphabet[i].len);
-            return gsm_ext_utf8_alphabet[i].len;
+        gunichar c;
+
+        gsm_ext_index[gsm_ext_utf8_alphabet[i].gsm] = i;
+        c = g_utf8_get_char_validated (gsm_ext_utf8_alphabet[i].chars, gsm_ext_utf8_alphabet[i].len);
+        if (c < (gunichar) -2 && g_unichar_to_utf8 (c, NULL) == gsm_ext_utf8_alphabet[i].len) {
+            GsmReverseMapping *mapping;
+
+            mapping = gsm_reverse_mapping_get (c, TRUE);
+            if (mapping->ext == GSM_NO_CHAR)
+                mapping->ext = gsm_ext_utf8_alphabet[i].gsm;
         }
     }
-    return 0;
+
+    g_once_init_leave (&initialized, 1);
+}
+
+static const GsmReverseMapping *
+utf8_to_gsm_mapping (const char *utf8, guint32 len)
+{
+    gunichar c;
+
+    if (len == 0 || len > 3)
+        return NULL;
+
+    gsm_tables_init ();
+
+    /* Single byte chars are the most usual ones */
+    if (len == 1)
+        return ((guint8) utf8[0] < 0x80) ? &gsm_reverse_latin1[(guint8) utf8[0]] : NULL;
+
+    c = g_utf8_get_char_validated (utf8, len);
+    if (c >= (gunichar) -2 || (guint32) g_unichar_to_utf8 (c, NULL) != len)
+        return NULL;
+
+    return gsm_reverse_mapping_get (c, FALSE);
+}
+
+static gboolean
+utf8_to_gsm_def_char (const char *utf8, guint32 len, guint8 *out_gsm)
+{
+    const GsmReverseMapping *mapping;
+
+    mapping = utf8_to_gsm_mapping (utf8, len);
+    if (!mapping || mapping->def == GSM_NO_CHAR)
+        return FALSE;
+    *out_gsm = mapping->def;
+    return TRUE;
 }
 
 static gboolean
 utf8_to_gsm_ext_char (const char *utf8, guint32 len, guint8 *out_gsm)
 {
-    int i;
+    const GsmReverseMapping *mapping;
 
-    if (len > 0 && len < 4) {
-        for (i = 0; i < GSM_EXT_ALPHABET_SIZE; i++) {
-            if (gsm_ext_utf8_alphabet[i].len == len) {
-                if (memcmp (&gsm_ext_utf8_alphabet[i].chars[0], utf8, len) == 0) {
-                    *out_gsm = gsm_ext_utf8_alphabet[i].gsm;
-                    return TRUE;
-                }
-            }
-        }
-    }
-    return FALSE;
+    mapping = utf8_to_gsm_mapping (utf8, len);
+    if (!mapping || mapping->ext == GSM_NO_CHAR)
+        return FALSE;
+    *out_gsm = mapping->ext;
+    return TRUE;
 }
 
-guint8 *
-mm_charset_gsm_unpacked_to_utf8 (const guint8 *gsm, guint32 len)
+static guint8
+gsm_ext_char_to_utf8 (const guint8 gsm, guint8 out_utf8[3])
 {
-    int i;
-    GByteArray *utf8;
+    guint8 i;
 
-    g_return_val_if_fail (gsm != NULL, NULL);
-    g_return_val_if_fail (len < 4096, NULL);
+    gsm_tables_init ();
 
-    /* worst case initial length */
-    utf8 = g_byte_array_sized_new (len * 2 + 1);
+    if (gsm >= GSM_DEF_ALPHABET_SIZE || gsm_ext_index[gsm] == GSM_NO_CHAR)
+        return 0;
+
+    i = gsm_ext_index[gsm];
+    memcpy (&out_utf8[0], &gsm_ext_utf8_alphabet[i].chars[0], gsm_ext_utf8_alphabet[i].len);
+    return gsm_ext_utf8_alphabet[i].len;
+}
+
+static gchar *
+gsm_unpacked_to_utf8 (const guint8 *gsm, guint32 len)
+{
+    guint32 i;
+    guint8 *utf8;
+    guint8 *out;
+
+    /* Worst case length: each GSM char takes up to 2 bytes in UTF-8, and
+     * extended ones take 2 GSM chars and up to 3 bytes */
+    utf8 = g_malloc (len * 2 + 1);
+    out = utf8;
 
     for (i = 0; i < len; i++) {
-        guint8 uchars[4];
         guint8 ulen;
 
         if (gsm[i] == GSM_ESCAPE_CHAR) {
             /* Extended alphabet, decode next char */
-            ulen = gsm_ext_char_to_utf8 (gsm[i+1], uchars);
+            ulen = (i + 1 < len) ? gsm_ext_char_to_utf8 (gsm[i+1], out) : 0;
             if (ulen)
                 i += 1;
-        } else {
+        } else if (gsm[i] < GSM_DEF_ALPHABET_SIZE) {
             /* Default alphabet */
-            ulen = gsm_def_char_to_utf8 (gsm[i], uchars);
-        }
+            ulen = gsm_def_utf8_alphabet[gsm[i]].len;
+            memcpy (out, &gsm_def_utf8_alphabet[gsm[i]].chars[0], ulen);
+        } else
+            ulen = 0;
 
         if (ulen)
-            g_byte_array_append (utf8, &uchars[0], ulen);
+            out += ulen;
         else
-            g_byte_array_append (utf8, (guint8 *) "?", 1);
+            *out++ = '?';
     }
 
-    g_byte_array_append (utf8, (guint8 *) "\0", 1);  /* NULL terminator */
-    return g_byte_array_free (utf8, FALSE);
+    *out = '\0';
+    return (gchar *) utf8;
 }
 
 guint8 *
-mm_charset_utf8_to_unpacked_gsm (const char *utf8, guint32 *out_len)
+mm_charset_gsm_unpacked_to_utf8 (const guint8 *gsm, guint32 len)
 {
-    GByteArray *gsm;
-    const char *c = utf8, *next = c;
-    static const guint8 gesc = GSM_ESCAPE_CHAR;
-    int i = 0;
+    g_return_val_if_fail (gsm != NULL, NULL);
+    g_return_val_if_fail (len < 4096, NULL);
 
-    g_return_val_if_fail (utf8 != NULL, NULL);
-    g_return_val_if_fail (out_len != NULL, NULL);
-    g_return_val_if_fail (g_utf8_validate (utf8, -1, NULL), NULL);
+    return (guint8 *) gsm_unpacked_to_utf8 (gsm, len);
+}
 
-    /* worst case initial length */
-    gsm = g_byte_array_sized_new (g_utf8_strlen (utf8, -1) * 2 + 1);
+static guint8 *
+utf8_to_unpacked_gsm (const char *utf8, gssize len, gboolean strict, guint32 *out_len)
+{
+    guint8 *gsm;
+    guint8 *out;
+    const char *c;
+    const char *end;
 
-    if (*utf8 == 0x00) {
-        /* Zero-length string */
-        g_byte_array_append (gsm, (guint8 *) "\0", 1);
-        *out_len = 0;
-        return g_byte_array_free (gsm, FALSE);
-    }
+    if (len < 0)
+        len = strlen (utf8);
+
+    if (!g_utf8_validate (utf8, len, NULL))
+        return NULL;
+
+    /* Worst case length: all extended chars, 2 GSM chars each */
+    gsm = g_malloc (len * 2 + 1);
+    out = gsm;
 
-    while (next && *next) {
-        guint8 gch = 0x3f;  /* 0x3f == '?' */
+    for (c = utf8, end = utf8 + len; c < end; ) {
+        const GsmReverseMapping *mapping;
+        const char *next;
 
         next = g_utf8_next_char (c);
 
-        /* Try escaped chars first, then default alphabet */
-        if (utf8_to_gsm_ext_char (c, next - c, &gch)) {
-            /* Add the escape char */
-            g_byte_array_append (gsm, &gesc, 1);
-            g_byte_array_append (gsm, &gch, 1);
-        } else if (utf8_to_gsm_def_char (c, next - c, &gch))
-            g_byte_array_append (gsm, &gch, 1);
+        /* Try escaped chars first, then default alphabet; chars not in
+         * any of them are skipped, unless in strict mode */
+        mapping = utf8_to_gsm_mapping (c, next - c);
+        if (mapping && mapping->ext != GSM_NO_CHAR) {
+            *out++ = GSM_ESCAPE_CHAR;
+            *out++ = mapping->ext;
+        } else if (mapping && mapping->def != GSM_NO_CHAR)
+            *out++ = mapping->def;
+        else if (strict) {
+            g_free (gsm);
+            return NULL;
+        }
 
         c = next;
-        i++;
     }
 
-    *out_len = gsm->len;
-    return g_byte_array_free (gsm, FALSE);
+    *out_len = out - gsm;
+    *out = 0x00;
+    return gsm;
+}
+
+guint8 *
+mm_charset_utf8_to_unpacked_gsm (const char *utf8, guint32 *out_len)
+{
+    g_return_val_if_fail (utf8 != NULL, NULL);
+    g_return_val_if_fail (out_len != NULL, NULL);
+    g_return_val_if_fail (g_utf8_validate (utf8, -1, NULL), NULL);
+
+    return utf8_to_unpacked_gsm (utf8, -1, FALSE, out_len);
 }
 
 static gboolean
@@ -643,18 +827,41 @@ mm_charset_can_convert_to (const char *utf8,
     return TRUE;
 }
 
+/* Septets are processed in groups of 8, which take exactly 7 bytes (56 bits)
+ * when packed; with a bit offset, they span up to 8 bytes, which still fit in
+ * a 64-bit integer. Only the remaining septets are processed one by one. */
+#define GSM_SEPTETS_PER_GROUP 8
+#define GSM_GROUP_BITS        (GSM_SEPTETS_PER_GROUP * 7)
+
 guint8 *
 mm_charset_gsm_unpack (const guint8 *gsm,
                        guint32 num_septets,
                        guint8 start_offset,  /* in _bits_ */
                        guint32 *out_unpacked_len)
 {
-    GByteArray *unpacked;
-    int i;
+    guint8 *unpacked;
+    guint32 i;
 
-    unpacked = g_byte_array_sized_new (num_septets + 1);
+    unpacked = g_malloc (num_septets + 1);
 
-    for (i = 0; i < num_septets; i++) {
+    for (i = 0; i + GSM_SEPTETS_PER_GROUP <= num_septets; i += GSM_SEPTETS_PER_GROUP) {
+        guint64 bits = 0;
+        guint32 start_bit, first, last, j;
+
+        start_bit = start_offset + (i * 7);
+        first = start_bit / 8;
+        last = (start_bit + GSM_GROUP_BITS - 1) / 8;
+
+        /* Load all bytes with bits of the group, and drop the offset */
+        for (j = first; j <= last; j++)
+            bits |= ((guint64) gsm[j]) << ((j - first) * 8);
+        bits >>= (start_bit % 8);
+
+        for (j = 0; j < GSM_SEPTETS_PER_GROUP; j++)
+            unpacked[i + j] = (guint8) ((bits >> (j * 7)) & 0x7F);
+    }
+
+    for (; i < num_septets; i++) {
         guint8 bits_here, bits_in_next, octet, offset, c;
         guint32 start_bit;
 
@@ -672,11 +879,11 @@ mm_charset_gsm_unpack (const guint8 *gsm,
             octet = gsm[(start_bit / 8) + 1];
             c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
         }
-        g_byte_array_append (unpacked, &c, 1);
+        unpacked[i] = c;
     }
 
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
+    *out_unpacked_len = num_septets;
+    return unpacked;
 }
 
 guint8 *
@@ -686,8 +893,7 @@ mm_charset_gsm_pack (const guint8 *src,
                      guint32 *out_packed_len)
 {
     guint8 *packed;
-    guint octet = 0, lshift, plen;
-    int i = 0;
+    guint32 plen, i;
 
     g_return_val_if_fail (start_offset < 8, NULL);
 
@@ -698,16 +904,38 @@ mm_charset_gsm_pack (const guint8 *src,
 
     packed = g_malloc0 (plen);
 
-    for (i = 0, lshift = start_offset; i < src_len; i++) {
-        packed[octet] |= (src[i] & 0x7F) << lshift;
-        if (lshift > 1) {
+    for (i = 0; i + GSM_SEPTETS_PER_GROUP <= src_len; i += GSM_SEPTETS_PER_GROUP) {
+        guint64 bits = 0;
+        guint32 start_bit, first, last, j;
+
+        for (j = 0; j < GSM_SEPTETS_PER_GROUP; j++)
+            bits |= ((guint64) (src[i + j] & 0x7F)) << (j * 7);
+
+        start_bit = start_offset + (i * 7);
+        first = start_bit / 8;
+        last = (start_bit + GSM_GROUP_BITS - 1) / 8;
+        g_assert (last < plen);
+
+        /* The first byte may be shared with the previous group */
+        bits <<= (start_bit % 8);
+        for (j = first; j <= last; j++)
+            packed[j] |= (guint8) (bits >> ((j - first) * 8));
+    }
+
+    for (; i < src_len; i++) {
+        guint32 start_bit;
+        guint8 offset, c;
+
+        start_bit = start_offset + (i * 7);
+        offset = start_bit % 8;
+        c = src[i] & 0x7F;
+
+        packed[start_bit / 8] |= (guint8) (c << offset);
+        if (offset > 1) {
             /* Grab the lost bits and add to next octet */
-            g_assert (octet + 1 < plen);
-            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
+            g_assert ((start_bit / 8) + 1 < plen);
+            packed[(start_bit / 8) + 1] |= c >> (8 - offset);
         }
-        if (lshift)
-            octet++;
-        lshift = lshift ? lshift - 1 : 7;
     }
 
     if (out_packed_len)
@@ -742,13 +970,11 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
     case MM_MODEM_CHARSET_8859_1:
     case MM_MODEM_CHARSET_PCCP437:
     case MM_MODEM_CHARSET_PCDN: {
-        const gchar *iconv_from;
         GError *error = NULL;
 
-        iconv_from = charset_iconv_from (charset);
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", iconv_from,
-                          NULL, NULL, &error);
+        utf8 = charset_convert (charset, CHARSET_CONVERSION_TO_UTF8,
+                                str, -1,
+                                NULL, &error);
         if (!utf8 || error) {
             g_clear_error (&error);
             utf8 = NULL;
@@ -865,32 +1091,38 @@ mm_utf8_take_and_convert_to_charset (gchar *str,
     case MM_MODEM_CHARSET_8859_1:
     case MM_MODEM_CHARSET_PCCP437:
     case MM_MODEM_CHARSET_PCDN: {
-        const gchar *iconv_to;
+        gsize encoded_len = 0;
         GError *error = NULL;
 
-        iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, NULL, &error);
+        encoded = charset_convert (charset, CHARSET_CONVERSION_FROM_UTF8_STRICT,
+                                   str, -1,
+                                   &encoded_len, &error);
         if (!encoded || error) {
             g_clear_error (&error);
             encoded = NULL;
         }
 
+        /* '@' is 0x00 in the GSM alphabet, which can't be returned in a
+         * NUL-terminated string without truncating it */
+        if (encoded && memchr (encoded, '\0', encoded_len)) {
+            mm_dbg ("Cannot convert '%s' to charset %s: embedded NUL",
+                    str, mm_modem_charset_to_string (charset));
+            g_free (encoded);
+            encoded = NULL;
+        }
+
         g_free (str);
         break;
     }
 
     case MM_MODEM_CHARSET_UCS2: {
-        const gchar *iconv_to;
         gsize encoded_len = 0;
         GError *error = NULL;
         gchar *hex;
 
-        iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, &encoded_len, &error);
+        encoded = charset_convert (charset, CHARSET_CONVERSION_FROM_UTF8_STRICT,
+                                   str, -1,
+                                   &encoded_len, &error);
         if (!encoded || error) {
             g_clear_error (&error);
             encoded = NULL;
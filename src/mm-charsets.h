@@ -78,6 +78,9 @@ guint8 *mm_charset_gsm_pack (const guint8 *src,
 
 gchar *mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset);
 
+/* Returns NULL if the string can't be represented in the charset, or if
+ * the result would have embedded NULs, as '@' has in the GSM alphabet; use
+ * mm_modem_charset_byte_array_append() for those. */
 gchar *mm_utf8_take_and_convert_to_charset (gchar *str,
                                             MMModemCharset charset);
 
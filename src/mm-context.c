@@ -41,6 +41,11 @@ static gboolean      debug;
 static MMFilterRule  filter_policy = MM_FILTER_POLICY_DEFAULT;
 static gboolean      no_auto_scan = NO_AUTO_SCAN_DEFAULT;
 static const gchar  *initial_kernel_events;
+static gboolean      serial_parser_v2;
+static gint          periodic_slack;
+static const gchar  *probe_cache;
+static gboolean      shared_probing;
+static gint          bearer_stats_interval;
 
 static gboolean
 filter_policy_option_arg (const gchar  *option_name,
@@ -90,6 +95,31 @@ static const GOptionEntry entries[] = {
         "Path to initial kernel events file",
         "[PATH]"
     },
+    {
+        "serial-parser-v2", 0, 0, G_OPTION_ARG_NONE, &serial_parser_v2,
+        "Use the single-pass AT response parser",
+        NULL
+    },
+    {
+        "periodic-slack", 0, 0, G_OPTION_ARG_INT, &periodic_slack,
+        "Delay periodic modem checks up to this many seconds, so that they run together (default: 0, disabled)",
+        "[SECONDS]"
+    },
+    {
+        "probe-cache", 0, 0, G_OPTION_ARG_FILENAME, &probe_cache,
+        "Path to the file where port probing results are cached across restarts",
+        "[PATH]"
+    },
+    {
+        "shared-probing", 0, 0, G_OPTION_ARG_NONE, &shared_probing,
+        "Probe each port once for all candidate plugins, before checking support with them",
+        NULL
+    },
+    {
+        "bearer-stats-interval", 0, 0, G_OPTION_ARG_INT, &bearer_stats_interval,
+        "Read bearer statistics from the network interface every this many milliseconds, instead of querying the modem",
+        "[MSECS]"
+    },
     {
         "debug", 0, 0, G_OPTION_ARG_NONE, &debug,
         "Run with extended debugging capabilities",
@@ -132,6 +162,36 @@ mm_context_get_filter_policy (void)
     return filter_policy;
 }
 
+gboolean
+mm_context_get_serial_parser_v2 (void)
+{
+    return serial_parser_v2;
+}
+
+guint
+mm_context_get_periodic_slack (void)
+{
+    return (guint) MAX (periodic_slack, 0);
+}
+
+const gchar *
+mm_context_get_probe_cache (void)
+{
+    return probe_cache;
+}
+
+gboolean
+mm_context_get_shared_probing (void)
+{
+    return shared_probing;
+}
+
+guint
+mm_context_get_bearer_stats_interval (void)
+{
+    return (guint) MAX (bearer_stats_interval, 0);
+}
+
 /*****************************************************************************/
 /* Log context */
 
@@ -140,6 +200,8 @@ static const gchar *log_file;
 static gboolean     log_journal;
 static gboolean     log_show_ts;
 static gboolean     log_rel_ts;
+static gboolean     log_async;
+static gint         log_history;
 
 static const GOptionEntry log_entries[] = {
     {
@@ -169,6 +231,16 @@ static const GOptionEntry log_entries[] = {
         "Use relative timestamps (from MM start)",
         NULL
     },
+    {
+        "log-async", 0, 0, G_OPTION_ARG_NONE, &log_async,
+        "Write the log file from a separate thread, syncing it periodically",
+        NULL
+    },
+    {
+        "log-history", 0, 0, G_OPTION_ARG_INT, &log_history,
+        "Number of lines logged at any level to keep in memory for each modem (default: 0, disabled)",
+        "[LINES]"
+    },
     { NULL }
 };
 
@@ -216,12 +288,25 @@ mm_context_get_log_relative_timestamps (void)
     return log_rel_ts;
 }
 
+gboolean
+mm_context_get_log_async (void)
+{
+    return log_async;
+}
+
+guint
+mm_context_get_log_history (void)
+{
+    return (guint) MAX (log_history, 0);
+}
+
 /*****************************************************************************/
 /* Test context */
 
 static gboolean  test_session;
 static gboolean  test_enable;
 static gchar    *test_plugin_dir;
+static gchar    *test_check_plugin_manifest;
 
 static const GOptionEntry test_entries[] = {
     {
@@ -239,6 +324,11 @@ static const GOptionEntry test_entries[] = {
         "Path to look for plugins",
         "[PATH]"
     },
+    {
+        "test-check-plugin-manifest", 0, 0, G_OPTION_ARG_FILENAME, &test_check_plugin_manifest,
+        "Check the given plugin manifest against the plugins, and exit",
+        "[PATH]"
+    },
     { NULL }
 };
 
@@ -274,6 +364,12 @@ mm_context_get_test_plugin_dir (void)
     return test_plugin_dir ? test_plugin_dir : PLUGINDIR;
 }
 
+const gchar *
+mm_context_get_test_check_plugin_manifest (void)
+{
+    return test_check_plugin_manifest;
+}
+
 /*****************************************************************************/
 
 static void
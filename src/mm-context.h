@@ -35,16 +35,32 @@ gboolean     mm_context_get_no_auto_scan          (void);
 /* Filter support */
 MMFilterRule mm_context_get_filter_policy (void);
 
+/* Serial port support */
+gboolean     mm_context_get_serial_parser_v2 (void);
+
+/* Periodic jobs support */
+guint        mm_context_get_periodic_slack (void);
+
+/* Port probing support */
+const gchar *mm_context_get_probe_cache    (void);
+gboolean     mm_context_get_shared_probing (void);
+
+/* Bearer support */
+guint        mm_context_get_bearer_stats_interval (void);
+
 /* Logging support */
 const gchar *mm_context_get_log_level               (void);
 const gchar *mm_context_get_log_file                (void);
 gboolean     mm_context_get_log_journal             (void);
 gboolean     mm_context_get_log_timestamps          (void);
 gboolean     mm_context_get_log_relative_timestamps (void);
+gboolean     mm_context_get_log_async               (void);
+guint        mm_context_get_log_history             (void);
 
 /* Testing support */
-gboolean     mm_context_get_test_session    (void);
-gboolean     mm_context_get_test_enable     (void);
-const gchar *mm_context_get_test_plugin_dir (void);
+gboolean     mm_context_get_test_session               (void);
+gboolean     mm_context_get_test_enable                (void);
+const gchar *mm_context_get_test_plugin_dir            (void);
+const gchar *mm_context_get_test_check_plugin_manifest (void);
 
 #endif /* MM_CONTEXT_H */
@@ -26,6 +26,7 @@
 #include "mm-device.h"
 #include "mm-plugin.h"
 #include "mm-log.h"
+#include "mm-log-history.h"
 
 G_DEFINE_TYPE (MMDevice, mm_device, G_TYPE_OBJECT);
 
@@ -154,6 +155,29 @@ add_port_driver (MMDevice       *self,
     self->priv->drivers[n_items + 1] = NULL;
 }
 
+/* Log lines mentioning the device or any of its ports are kept in the log
+ * history of the device, if enabled; this is set up as soon as the device is
+ * created and updated whenever ports are grabbed or released, so that the
+ * port probing logs are also kept */
+static void
+setup_log_history (MMDevice *self)
+{
+    GPtrArray *keys;
+    GList     *l;
+    guint      i;
+
+    keys = g_ptr_array_new ();
+    g_ptr_array_add (keys, self->priv->uid);
+    for (l = self->priv->port_probes; l; l = g_list_next (l))
+        g_ptr_array_add (keys, (gpointer) mm_port_probe_get_port_name (MM_PORT_PROBE (l->data)));
+    for (i = 0; self->priv->virtual_ports && self->priv->virtual_ports[i]; i++)
+        g_ptr_array_add (keys, self->priv->virtual_ports[i]);
+    g_ptr_array_add (keys, NULL);
+
+    mm_log_history_add (self->priv->uid, self, (const gchar *const *) keys->pdata);
+    g_ptr_array_unref (keys);
+}
+
 void
 mm_device_grab_port (MMDevice       *self,
                      MMKernelDevice *kernel_port)
@@ -177,6 +201,7 @@ mm_device_grab_port (MMDevice       *self,
     /* Create and store new port probe */
     probe = mm_port_probe_new (self, kernel_port);
     self->priv->port_probes = g_list_prepend (self->priv->port_probes, probe);
+    setup_log_history (self);
 
     /* Notify about the grabbed port */
     g_signal_emit (self, signals[SIGNAL_PORT_GRABBED], 0, kernel_port);
@@ -197,6 +222,7 @@ mm_device_release_port (MMDevice       *self,
             self->priv->ignored_port_probes = g_list_remove (self->priv->ignored_port_probes, probe);
         else
             g_assert_not_reached ();
+        setup_log_history (self);
         g_signal_emit (self, signals[SIGNAL_PORT_RELEASED], 0, mm_port_probe_peek_port (probe));
         g_object_unref (probe);
     }
@@ -625,6 +651,7 @@ mm_device_virtual_grab_ports (MMDevice *self,
 
     /* Keep virtual port names */
     self->priv->virtual_ports = g_strdupv ((gchar **)ports);
+    setup_log_history (self);
 }
 
 const gchar **
@@ -676,6 +703,7 @@ set_property (GObject *object,
     case PROP_UID:
         /* construct only */
         self->priv->uid = g_value_dup_string (value);
+        setup_log_history (self);
         break;
     case PROP_PLUGIN:
         g_clear_object (&(self->priv->plugin));
@@ -754,6 +782,9 @@ finalize (GObject *object)
 {
     MMDevice *self = MM_DEVICE (object);
 
+    if (self->priv->uid)
+        mm_log_history_remove (self->priv->uid, self);
+
     g_free (self->priv->uid);
     g_strfreev (self->priv->drivers);
     g_strfreev (self->priv->virtual_ports);
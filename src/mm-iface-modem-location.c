@@ -24,6 +24,7 @@
 #include "mm-modem-helpers.h"
 
 #define MM_LOCATION_GPS_REFRESH_TIME_SECS 30
+#define MM_LOCATION_GPS_FIX_RATE_MSECS    1000
 
 #define LOCATION_CONTEXT_TAG "location-context-tag"
 
@@ -47,6 +48,15 @@ typedef struct {
     MMLocationGpsNmea *location_gps_nmea;
     time_t location_gps_raw_last_time;
     MMLocationGpsRaw *location_gps_raw;
+    /* Decoded GPS fix; rate limited in monotonic ms */
+    gint64 location_gps_fix_last_time;
+    MMLocationGpsFix *location_gps_fix;
+    /* GPS location updates to notify once the current burst of traces is
+     * processed */
+    guint location_gps_update_id;
+    gboolean location_gps_nmea_updated;
+    gboolean location_gps_raw_updated;
+    gboolean location_gps_fix_updated;
     /* CDMA BS location */
     MMLocationCdmaBs *location_cdma_bs;
 } LocationContext;
@@ -54,12 +64,16 @@ typedef struct {
 static void
 location_context_free (LocationContext *ctx)
 {
+    if (ctx->location_gps_update_id)
+        g_source_remove (ctx->location_gps_update_id);
     if (ctx->location_3gpp)
         g_object_unref (ctx->location_3gpp);
     if (ctx->location_gps_nmea)
         g_object_unref (ctx->location_gps_nmea);
     if (ctx->location_gps_raw)
         g_object_unref (ctx->location_gps_raw);
+    if (ctx->location_gps_fix)
+        g_object_unref (ctx->location_gps_fix);
     if (ctx->location_cdma_bs)
         g_object_unref (ctx->location_cdma_bs);
     g_free (ctx);
@@ -109,12 +123,14 @@ build_location_dictionary (GVariant *previous,
                            MMLocation3gpp *location_3gpp,
                            MMLocationGpsNmea *location_gps_nmea,
                            MMLocationGpsRaw *location_gps_raw,
-                           MMLocationCdmaBs *location_cdma_bs)
+                           MMLocationCdmaBs *location_cdma_bs,
+                           MMLocationGpsFix *location_gps_fix)
 {
     GVariant *location_3gpp_value = NULL;
     GVariant *location_gps_nmea_value = NULL;
     GVariant *location_gps_raw_value = NULL;
     GVariant *location_cdma_bs_value = NULL;
+    GVariant *location_gps_fix_value = NULL;
     GVariantBuilder builder;
 
     /* If a previous dictionary given, parse its values */
@@ -138,6 +154,9 @@ build_location_dictionary (GVariant *previous,
             case MM_MODEM_LOCATION_SOURCE_CDMA_BS:
                 location_cdma_bs_value = value;
                 break;
+            case MM_MODEM_LOCATION_SOURCE_GPS_FIX:
+                location_gps_fix_value = value;
+                break;
             case MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED:
                 g_assert_not_reached ();
             case MM_MODEM_LOCATION_SOURCE_AGPS:
@@ -205,6 +224,19 @@ build_location_dictionary (GVariant *previous,
                                MM_MODEM_LOCATION_SOURCE_CDMA_BS,
                                location_cdma_bs_value);
 
+    /* If a new one given, use it */
+    if (location_gps_fix) {
+        if (location_gps_fix_value)
+            g_variant_unref (location_gps_fix_value);
+        location_gps_fix_value = mm_location_gps_fix_get_bytes_variant (location_gps_fix);
+    }
+
+    if (location_gps_fix_value)
+        g_variant_builder_add (&builder,
+                               "{uv}",
+                               MM_MODEM_LOCATION_SOURCE_GPS_FIX,
+                               location_gps_fix_value);
+
     return g_variant_builder_end (&builder);
 }
 
@@ -214,7 +246,8 @@ static void
 notify_gps_location_update (MMIfaceModemLocation *self,
                             MmGdbusModemLocation *skeleton,
                             MMLocationGpsNmea *location_gps_nmea,
-                            MMLocationGpsRaw *location_gps_raw)
+                            MMLocationGpsRaw *location_gps_raw,
+                            MMLocationGpsFix *location_gps_fix)
 {
     const gchar *dbus_path;
 
@@ -231,7 +264,38 @@ notify_gps_location_update (MMIfaceModemLocation *self,
                                        NULL,
                                        location_gps_nmea,
                                        location_gps_raw,
-                                       NULL));
+                                       NULL,
+                                       location_gps_fix));
+}
+
+static gboolean
+gps_location_update_cb (MMIfaceModemLocation *self)
+{
+    MmGdbusModemLocation *skeleton;
+    LocationContext *ctx;
+    MMLocationGpsNmea *location_gps_nmea;
+    MMLocationGpsRaw *location_gps_raw;
+    MMLocationGpsFix *location_gps_fix;
+
+    ctx = get_location_context (self);
+    ctx->location_gps_update_id = 0;
+
+    /* Sources may have been disabled in the meantime */
+    location_gps_nmea = ctx->location_gps_nmea_updated ? ctx->location_gps_nmea : NULL;
+    location_gps_raw = ctx->location_gps_raw_updated ? ctx->location_gps_raw : NULL;
+    location_gps_fix = ctx->location_gps_fix_updated ? ctx->location_gps_fix : NULL;
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_LOCATION_DBUS_SKELETON, &skeleton,
+                  NULL);
+    if (skeleton && (location_gps_nmea || location_gps_raw || location_gps_fix))
+        notify_gps_location_update (self, skeleton, location_gps_nmea, location_gps_raw, location_gps_fix);
+    g_clear_object (&skeleton);
+
+    ctx->location_gps_nmea_updated = FALSE;
+    ctx->location_gps_raw_updated = FALSE;
+    ctx->location_gps_fix_updated = FALSE;
+    return G_SOURCE_REMOVE;
 }
 
 void
@@ -242,6 +306,7 @@ mm_iface_modem_location_gps_update (MMIfaceModemLocation *self,
     LocationContext *ctx;
     gboolean update_nmea = FALSE;
     gboolean update_raw = FALSE;
+    gboolean update_fix = FALSE;
 
     ctx = get_location_context (self);
     g_object_get (self,
@@ -270,11 +335,28 @@ mm_iface_modem_location_gps_update (MMIfaceModemLocation *self,
         }
     }
 
-    if (update_nmea || update_raw)
-        notify_gps_location_update (self,
-                                    skeleton,
-                                    update_nmea ? ctx->location_gps_nmea : NULL,
-                                    update_raw ? ctx->location_gps_raw : NULL);
+    if (mm_gdbus_modem_location_get_enabled (skeleton) & MM_MODEM_LOCATION_SOURCE_GPS_FIX) {
+        gint64 now;
+
+        g_assert (ctx->location_gps_fix != NULL);
+        now = g_get_monotonic_time () / 1000;
+        if (mm_location_gps_fix_add_trace (ctx->location_gps_fix, nmea_trace) &&
+            (ctx->location_gps_fix_last_time == 0 ||
+             now - ctx->location_gps_fix_last_time >= mm_gdbus_modem_location_get_gps_fix_rate (skeleton))) {
+            ctx->location_gps_fix_last_time = now;
+            update_fix = TRUE;
+        }
+    }
+
+    /* Traces usually come in bursts, several per fix, so the location is
+     * only rebuilt once the whole burst has been processed */
+    if (update_nmea || update_raw || update_fix) {
+        ctx->location_gps_nmea_updated |= update_nmea;
+        ctx->location_gps_raw_updated |= update_raw;
+        ctx->location_gps_fix_updated |= update_fix;
+        if (!ctx->location_gps_update_id)
+            ctx->location_gps_update_id = g_idle_add ((GSourceFunc) gps_location_update_cb, self);
+    }
 
     g_object_unref (skeleton);
 }
@@ -306,7 +388,7 @@ notify_3gpp_location_update (MMIfaceModemLocation *self,
             build_location_dictionary (mm_gdbus_modem_location_get_location (skeleton),
                                        location_3gpp,
                                        NULL, NULL,
-                                       NULL));
+                                       NULL, NULL));
 }
 
 void
@@ -415,7 +497,7 @@ notify_cdma_bs_location_update (MMIfaceModemLocation *self,
             build_location_dictionary (mm_gdbus_modem_location_get_location (skeleton),
                                        NULL,
                                        NULL, NULL,
-                                       location_cdma_bs));
+                                       location_cdma_bs, NULL));
 }
 
 void
@@ -498,6 +580,15 @@ update_location_source_status (MMIfaceModemLocation *self,
         } else
             g_clear_object (&ctx->location_gps_raw);
         break;
+    case MM_MODEM_LOCATION_SOURCE_GPS_FIX:
+        if (enabled) {
+            if (!ctx->location_gps_fix)
+                ctx->location_gps_fix = mm_location_gps_fix_new ();
+        } else {
+            g_clear_object (&ctx->location_gps_fix);
+            ctx->location_gps_fix_last_time = 0;
+        }
+        break;
     case MM_MODEM_LOCATION_SOURCE_CDMA_BS:
         if (enabled) {
             if (!ctx->location_cdma_bs)
@@ -519,6 +610,12 @@ update_location_source_status (MMIfaceModemLocation *self,
 
 /*****************************************************************************/
 
+/* GPS sources whose location is built out of the NMEA traces reported by the
+ * modem */
+#define MANAGED_GPS_SOURCES (MM_MODEM_LOCATION_SOURCE_GPS_RAW  | \
+                             MM_MODEM_LOCATION_SOURCE_GPS_NMEA | \
+                             MM_MODEM_LOCATION_SOURCE_GPS_FIX)
+
 typedef struct {
     MmGdbusModemLocation *skeleton;
     MMModemLocationSource to_enable;
@@ -605,6 +702,25 @@ disable_location_gathering_ready (MMIfaceModemLocation *self,
     setup_gathering_step (task);
 }
 
+/* The GPS fix is decoded from the same traces as the raw GPS location, so
+ * plugins are only asked to gather raw GPS, and only when the first of the two
+ * sources gets enabled or the last one gets disabled. Must be called once the
+ * new status of the source is already set in the interface. */
+static MMModemLocationSource
+get_plugin_gathering_source (MmGdbusModemLocation  *skeleton,
+                             MMModemLocationSource  source)
+{
+    MMModemLocationSource shared = (MM_MODEM_LOCATION_SOURCE_GPS_RAW | MM_MODEM_LOCATION_SOURCE_GPS_FIX);
+
+    if (!(source & shared))
+        return source;
+
+    if (mm_gdbus_modem_location_get_enabled (skeleton) & shared & ~source)
+        return MM_MODEM_LOCATION_SOURCE_NONE;
+
+    return MM_MODEM_LOCATION_SOURCE_GPS_RAW;
+}
+
 static void
 setup_gathering_step (GTask *task)
 {
@@ -622,7 +738,8 @@ setup_gathering_step (GTask *task)
         return;
     }
 
-    while (ctx->current <= MM_MODEM_LOCATION_SOURCE_AGPS) {
+    while (ctx->current <= MM_MODEM_LOCATION_SOURCE_GPS_FIX) {
+        MMModemLocationSource plugin_source;
         gchar *source_str;
 
         if (ctx->to_enable & ctx->current) {
@@ -636,11 +753,13 @@ setup_gathering_step (GTask *task)
             update_location_source_status (self, ctx->current, TRUE);
 
             /* Plugins can run custom actions to enable location gathering */
-            if (MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->enable_location_gathering &&
+            plugin_source = get_plugin_gathering_source (ctx->skeleton, ctx->current);
+            if (plugin_source != MM_MODEM_LOCATION_SOURCE_NONE &&
+                MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->enable_location_gathering &&
                 MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->enable_location_gathering_finish) {
                 MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->enable_location_gathering (
                     MM_IFACE_MODEM_LOCATION (self),
-                    ctx->current,
+                    plugin_source,
                     (GAsyncReadyCallback)enable_location_gathering_ready,
                     task);
                 return;
@@ -656,11 +775,13 @@ setup_gathering_step (GTask *task)
             update_location_source_status (self, ctx->current, FALSE);
 
             /* Plugins can run custom actions to disable location gathering */
-            if (MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->disable_location_gathering &&
+            plugin_source = get_plugin_gathering_source (ctx->skeleton, ctx->current);
+            if (plugin_source != MM_MODEM_LOCATION_SOURCE_NONE &&
+                MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->disable_location_gathering &&
                 MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->disable_location_gathering_finish) {
                 MM_IFACE_MODEM_LOCATION_GET_INTERFACE (self)->disable_location_gathering (
                     MM_IFACE_MODEM_LOCATION (self),
-                    ctx->current,
+                    plugin_source,
                     (GAsyncReadyCallback)disable_location_gathering_ready,
                     task);
                 return;
@@ -719,7 +840,7 @@ setup_gathering (MMIfaceModemLocation *self,
 
     /* Loop through all known bits in the bitmask to enable/disable specific location sources */
     for (source = MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI;
-         source <= MM_MODEM_LOCATION_SOURCE_AGPS;
+         source <= MM_MODEM_LOCATION_SOURCE_GPS_FIX;
          source = source << 1) {
         /* skip unsupported sources */
         if (!(mm_gdbus_modem_location_get_capabilities (ctx->skeleton) & source))
@@ -747,10 +868,10 @@ setup_gathering (MMIfaceModemLocation *self,
     /* When standard GPS retrieval (RAW/NMEA) is enabled, we cannot enable the
      * UNMANAGED setup, and viceversa. */
     if ((ctx->to_enable & MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED &&
-         currently_enabled & (MM_MODEM_LOCATION_SOURCE_GPS_RAW | MM_MODEM_LOCATION_SOURCE_GPS_NMEA)) ||
-        (ctx->to_enable & (MM_MODEM_LOCATION_SOURCE_GPS_RAW | MM_MODEM_LOCATION_SOURCE_GPS_NMEA) &&
+         currently_enabled & MANAGED_GPS_SOURCES) ||
+        (ctx->to_enable & MANAGED_GPS_SOURCES &&
          currently_enabled & MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED) ||
-        (ctx->to_enable & (MM_MODEM_LOCATION_SOURCE_GPS_RAW | MM_MODEM_LOCATION_SOURCE_GPS_NMEA) &&
+        (ctx->to_enable & MANAGED_GPS_SOURCES &&
          ctx->to_enable & MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED)) {
         g_task_return_new_error (task,
                                  MM_CORE_ERROR,
@@ -870,11 +991,12 @@ handle_setup_auth_ready (MMBaseModem *self,
                                            location_ctx->location_3gpp,
                                            location_ctx->location_gps_nmea,
                                            location_ctx->location_gps_raw,
-                                           location_ctx->location_cdma_bs));
+                                           location_ctx->location_cdma_bs,
+                                           location_ctx->location_gps_fix));
         else
             mm_gdbus_modem_location_set_location (
                 ctx->skeleton,
-                build_location_dictionary (NULL, NULL, NULL, NULL, NULL));
+                build_location_dictionary (NULL, NULL, NULL, NULL, NULL, NULL));
     }
 
     str = mm_modem_location_source_build_string_from_mask (ctx->sources);
@@ -1222,6 +1344,75 @@ handle_set_gps_refresh_rate (MmGdbusModemLocation *skeleton,
 
 /*****************************************************************************/
 
+typedef struct {
+    MmGdbusModemLocation *skeleton;
+    GDBusMethodInvocation *invocation;
+    MMIfaceModemLocation *self;
+    guint rate;
+} HandleSetGpsFixRateContext;
+
+static void
+handle_set_gps_fix_rate_context_free (HandleSetGpsFixRateContext *ctx)
+{
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->self);
+    g_slice_free (HandleSetGpsFixRateContext, ctx);
+}
+
+static void
+handle_set_gps_fix_rate_auth_ready (MMBaseModem *self,
+                                    GAsyncResult *res,
+                                    HandleSetGpsFixRateContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_set_gps_fix_rate_context_free (ctx);
+        return;
+    }
+
+    /* If the GPS fix is NOT supported, set error */
+    if (!(mm_gdbus_modem_location_get_capabilities (ctx->skeleton) & MM_MODEM_LOCATION_SOURCE_GPS_FIX)) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_UNSUPPORTED,
+                                               "Cannot set GPS fix rate: GPS fix not supported");
+        handle_set_gps_fix_rate_context_free (ctx);
+        return;
+    }
+
+    /* Set the new rate in the interface, applies from the next fix on */
+    mm_gdbus_modem_location_set_gps_fix_rate (ctx->skeleton, ctx->rate);
+    mm_gdbus_modem_location_complete_set_gps_fix_rate (ctx->skeleton, ctx->invocation);
+    handle_set_gps_fix_rate_context_free (ctx);
+}
+
+static gboolean
+handle_set_gps_fix_rate (MmGdbusModemLocation *skeleton,
+                         GDBusMethodInvocation *invocation,
+                         guint rate,
+                         MMIfaceModemLocation *self)
+{
+    HandleSetGpsFixRateContext *ctx;
+
+    ctx = g_slice_new (HandleSetGpsFixRateContext);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->self = g_object_ref (self);
+    ctx->rate = rate;
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_DEVICE_CONTROL,
+                             (GAsyncReadyCallback)handle_set_gps_fix_rate_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 typedef struct {
     MmGdbusModemLocation *skeleton;
     GDBusMethodInvocation *invocation;
@@ -1274,7 +1465,8 @@ handle_get_location_auth_ready (MMBaseModem *self,
                                    location_ctx->location_3gpp,
                                    location_ctx->location_gps_nmea,
                                    location_ctx->location_gps_raw,
-                                   location_ctx->location_cdma_bs));
+                                   location_ctx->location_cdma_bs,
+                                   location_ctx->location_gps_fix));
     handle_get_location_context_free (ctx);
 }
 
@@ -1491,7 +1683,8 @@ interface_enabling_step (GTask *task)
         default_sources &= ~(MM_MODEM_LOCATION_SOURCE_GPS_RAW |
                              MM_MODEM_LOCATION_SOURCE_GPS_NMEA |
                              MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED |
-                             MM_MODEM_LOCATION_SOURCE_AGPS);
+                             MM_MODEM_LOCATION_SOURCE_AGPS |
+                             MM_MODEM_LOCATION_SOURCE_GPS_FIX);
 
         setup_gathering (self,
                          default_sources,
@@ -1659,6 +1852,10 @@ load_capabilities_ready (MMIfaceModemLocation *self,
         g_error_free (error);
     }
 
+    /* The GPS fix is decoded from the same traces as the raw location */
+    if (ctx->capabilities & MM_MODEM_LOCATION_SOURCE_GPS_RAW)
+        ctx->capabilities |= MM_MODEM_LOCATION_SOURCE_GPS_FIX;
+
     mm_gdbus_modem_location_set_capabilities (ctx->skeleton, ctx->capabilities);
 
     /* Go on to next step */
@@ -1766,6 +1963,9 @@ interface_initialization_step (GTask *task)
                                   MM_MODEM_LOCATION_SOURCE_GPS_NMEA)))
             /* Set the default rate in the interface */
             mm_gdbus_modem_location_set_gps_refresh_rate (ctx->skeleton, MM_LOCATION_GPS_REFRESH_TIME_SECS);
+        /* And the rate of the decoded GPS fix, if supported */
+        if (ctx->capabilities & MM_MODEM_LOCATION_SOURCE_GPS_FIX)
+            mm_gdbus_modem_location_set_gps_fix_rate (ctx->skeleton, MM_LOCATION_GPS_FIX_RATE_MSECS);
 
         /* Fall down to next step */
         ctx->step++;
@@ -1790,6 +1990,10 @@ interface_initialization_step (GTask *task)
                           "handle-set-gps-refresh-rate",
                           G_CALLBACK (handle_set_gps_refresh_rate),
                           self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-set-gps-fix-rate",
+                          G_CALLBACK (handle_set_gps_fix_rate),
+                          self);
         g_signal_connect (ctx->skeleton,
                           "handle-get-location",
                           G_CALLBACK (handle_get_location),
@@ -1838,7 +2042,7 @@ mm_iface_modem_location_initialize (MMIfaceModemLocation *self,
         mm_gdbus_modem_location_set_enabled (skeleton, MM_MODEM_LOCATION_SOURCE_NONE);
         mm_gdbus_modem_location_set_signals_location (skeleton, FALSE);
         mm_gdbus_modem_location_set_location (skeleton,
-                                              build_location_dictionary (NULL, NULL, NULL, NULL, NULL));
+                                              build_location_dictionary (NULL, NULL, NULL, NULL, NULL, NULL));
 
         g_object_set (self,
                       MM_IFACE_MODEM_LOCATION_DBUS_SKELETON, skeleton,
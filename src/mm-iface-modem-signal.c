@@ -19,15 +19,22 @@
 
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-signal.h"
+#include "mm-modem-helpers.h"
 #include "mm-log.h"
+#include "mm-scheduler.h"
 
-#define SUPPORT_CHECKED_TAG "signal-support-checked-tag"
-#define SUPPORTED_TAG       "signal-supported-tag"
-#define REFRESH_CONTEXT_TAG "signal-refresh-context-tag"
+#define SUPPORT_CHECKED_TAG  "signal-support-checked-tag"
+#define SUPPORTED_TAG        "signal-supported-tag"
+#define REFRESH_CONTEXT_TAG  "signal-refresh-context-tag"
+#define SAMPLING_CONTEXT_TAG "signal-sampling-context-tag"
 
 static GQuark support_checked_quark;
 static GQuark supported_quark;
 static GQuark refresh_context_quark;
+static GQuark sampling_context_quark;
+
+static void sampling_context_add (MMIfaceModemSignal  *self,
+                                  MMSignal           **signals);
 
 /*****************************************************************************/
 
@@ -42,13 +49,18 @@ mm_iface_modem_signal_bind_simple_status (MMIfaceModemSignal *self,
 typedef struct {
     guint rate;
     guint timeout_source;
+    /* When the modem reports values on its own as they cross the configured
+     * thresholds, there is no periodic refresh at all */
+    gboolean thresholds_setup;
+    gboolean thresholds_ongoing;
+    gboolean thresholds_rejected;
 } RefreshContext;
 
 static void
 refresh_context_free (RefreshContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_scheduler_remove (mm_scheduler_get (), ctx->timeout_source);
     g_slice_free (RefreshContext, ctx);
 }
 
@@ -71,32 +83,22 @@ clear_values (MMIfaceModemSignal *self)
     g_object_unref (skeleton);
 }
 
-static void
-load_values_ready (MMIfaceModemSignal *self,
-                   GAsyncResult *res)
+void
+mm_iface_modem_signal_update (MMIfaceModemSignal *self,
+                              MMSignal *cdma,
+                              MMSignal *evdo,
+                              MMSignal *gsm,
+                              MMSignal *umts,
+                              MMSignal *lte)
 {
     GVariant *dictionary;
-    GError *error = NULL;
-    MMSignal *cdma = NULL;
-    MMSignal *evdo = NULL;
-    MMSignal *gsm = NULL;
-    MMSignal *umts = NULL;
-    MMSignal *lte = NULL;
     MmGdbusModemSignal *skeleton;
 
-    if (!MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values_finish (
-            self,
-            res,
-            &cdma,
-            &evdo,
-            &gsm,
-            &umts,
-            &lte,
-            &error)) {
-        mm_warn ("Couldn't load extended signal information: %s", error->message);
-        g_error_free (error);
-        clear_values (self);
-        return;
+    /* Values published in the properties are also valid samples */
+    {
+        MMSignal *signals[] = { cdma, evdo, gsm, umts, lte };
+
+        sampling_context_add (self, signals);
     }
 
     g_object_get (self,
@@ -112,7 +114,6 @@ load_values_ready (MMIfaceModemSignal *self,
         dictionary = mm_signal_get_dictionary (cdma);
         mm_gdbus_modem_signal_set_cdma (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (cdma);
     } else
         mm_gdbus_modem_signal_set_cdma (skeleton, NULL);
 
@@ -120,7 +121,6 @@ load_values_ready (MMIfaceModemSignal *self,
         dictionary = mm_signal_get_dictionary (evdo);
         mm_gdbus_modem_signal_set_evdo (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (evdo);
     } else
         mm_gdbus_modem_signal_set_evdo (skeleton, NULL);
 
@@ -128,7 +128,6 @@ load_values_ready (MMIfaceModemSignal *self,
         dictionary = mm_signal_get_dictionary (gsm);
         mm_gdbus_modem_signal_set_gsm (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (gsm);
     } else
         mm_gdbus_modem_signal_set_gsm (skeleton, NULL);
 
@@ -136,7 +135,6 @@ load_values_ready (MMIfaceModemSignal *self,
         dictionary = mm_signal_get_dictionary (umts);
         mm_gdbus_modem_signal_set_umts (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (umts);
     } else
         mm_gdbus_modem_signal_set_umts (skeleton, NULL);
 
@@ -144,7 +142,6 @@ load_values_ready (MMIfaceModemSignal *self,
         dictionary = mm_signal_get_dictionary (lte);
         mm_gdbus_modem_signal_set_lte (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (lte);
     } else
         mm_gdbus_modem_signal_set_lte (skeleton, NULL);
 
@@ -154,9 +151,57 @@ load_values_ready (MMIfaceModemSignal *self,
     g_object_unref (skeleton);
 }
 
+static void
+load_values_ready (MMIfaceModemSignal *self,
+                   GAsyncResult *res)
+{
+    GError *error = NULL;
+    MMSignal *cdma = NULL;
+    MMSignal *evdo = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+
+    if (!MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values_finish (
+            self,
+            res,
+            &cdma,
+            &evdo,
+            &gsm,
+            &umts,
+            &lte,
+            &error)) {
+        mm_warn ("Couldn't load extended signal information: %s", error->message);
+        g_error_free (error);
+        clear_values (self);
+        return;
+    }
+
+    mm_iface_modem_signal_update (self, cdma, evdo, gsm, umts, lte);
+
+    if (cdma)
+        g_object_unref (cdma);
+    if (evdo)
+        g_object_unref (evdo);
+    if (gsm)
+        g_object_unref (gsm);
+    if (umts)
+        g_object_unref (umts);
+    if (lte)
+        g_object_unref (lte);
+}
+
 static gboolean
 refresh_context_cb (MMIfaceModemSignal *self)
 {
+    RefreshContext *ctx;
+
+    /* If the periodic signal quality check is due before our next refresh,
+     * run it now as well, so that both share the same wakeup */
+    ctx = g_object_get_qdata (G_OBJECT (self), refresh_context_quark);
+    if (ctx)
+        mm_iface_modem_coalesce_signal_check (MM_IFACE_MODEM (self), ctx->rate);
+
     MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values (
         self,
         NULL,
@@ -165,6 +210,19 @@ refresh_context_cb (MMIfaceModemSignal *self)
     return G_SOURCE_CONTINUE;
 }
 
+static void
+clear_refresh_context (MMIfaceModemSignal *self)
+{
+    RefreshContext *ctx;
+
+    /* Go back to the default reporting of the modem, if we changed it */
+    ctx = g_object_get_qdata (G_OBJECT (self), refresh_context_quark);
+    if (ctx && ctx->thresholds_setup)
+        MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->setup_thresholds (self, FALSE, NULL, NULL);
+
+    g_object_set_qdata (G_OBJECT (self), refresh_context_quark, NULL);
+}
+
 static void
 teardown_refresh_context (MMIfaceModemSignal *self)
 {
@@ -172,7 +230,64 @@ teardown_refresh_context (MMIfaceModemSignal *self)
     clear_values (self);
     if (G_UNLIKELY (!refresh_context_quark))
         refresh_context_quark  = g_quark_from_static_string (REFRESH_CONTEXT_TAG);
-    g_object_set_qdata (G_OBJECT (self), refresh_context_quark, NULL);
+    clear_refresh_context (self);
+}
+
+static void
+refresh_context_start_polling (MMIfaceModemSignal *self,
+                               RefreshContext *ctx)
+{
+    if (ctx->timeout_source)
+        mm_scheduler_remove (mm_scheduler_get (), ctx->timeout_source);
+    ctx->timeout_source = mm_scheduler_add (mm_scheduler_get (),
+                                            G_OBJECT (self),
+                                            "extended-signal-refresh",
+                                            ctx->rate,
+                                            (GSourceFunc) refresh_context_cb,
+                                            self);
+
+    /* Also launch right away */
+    refresh_context_cb (self);
+}
+
+static void
+setup_thresholds_ready (MMIfaceModemSignal *self,
+                        GAsyncResult *res)
+{
+    RefreshContext *ctx;
+    GError *error = NULL;
+    gboolean setup;
+
+    setup = MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->setup_thresholds_finish (self, res, &error);
+
+    ctx = g_object_get_qdata (G_OBJECT (self), refresh_context_quark);
+    if (!ctx || !ctx->thresholds_ongoing) {
+        /* Reporting disabled while we were setting it up */
+        if (setup && !(ctx && ctx->thresholds_setup))
+            MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->setup_thresholds (self, FALSE, NULL, NULL);
+        g_clear_error (&error);
+        return;
+    }
+    ctx->thresholds_ongoing = FALSE;
+
+    if (!setup) {
+        mm_dbg ("Couldn't setup extended signal information thresholds, polling instead: %s",
+                error->message);
+        g_error_free (error);
+        ctx->thresholds_rejected = TRUE;
+        refresh_context_start_polling (self, ctx);
+        return;
+    }
+
+    mm_dbg ("Extended signal information reported by the modem on threshold crossings");
+    ctx->thresholds_setup = TRUE;
+
+    /* Values are only reported when they change, so load the current ones */
+    MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values (
+        self,
+        NULL,
+        (GAsyncReadyCallback)load_values_ready,
+        NULL);
 }
 
 static gboolean
@@ -210,7 +325,7 @@ setup_refresh_context (MMIfaceModemSignal *self,
     if (new_rate == 0) {
         mm_dbg ("Extended signal information reporting disabled (rate: 0 seconds)");
         clear_values (self);
-        g_object_set_qdata (G_OBJECT (self), refresh_context_quark, NULL);
+        clear_refresh_context (self);
         return TRUE;
     }
 
@@ -238,16 +353,507 @@ setup_refresh_context (MMIfaceModemSignal *self,
     /* Update refresh context */
     mm_dbg ("Extended signal information reporting enabled (rate: %u seconds)", new_rate);
     ctx->rate = new_rate;
+
+    /* The rate doesn't apply when reported on threshold crossings */
+    if (ctx->thresholds_setup || ctx->thresholds_ongoing)
+        return TRUE;
+
+    /* Prefer the modem reporting values on its own, and only poll if it
+     * can't do that */
+    if (!ctx->thresholds_rejected &&
+        MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->setup_thresholds &&
+        MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->setup_thresholds_finish) {
+        ctx->thresholds_ongoing = TRUE;
+        MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->setup_thresholds (
+            self,
+            TRUE,
+            (GAsyncReadyCallback)setup_thresholds_ready,
+            NULL);
+        return TRUE;
+    }
+
+    refresh_context_start_polling (self, ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Sampling: values are loaded at sub-second intervals and kept in a bounded
+ * history of each access technology, never published as properties. */
+
+#define SAMPLING_HISTORY_SIZE    600
+#define SAMPLING_MIN_INTERVAL_MS 100
+#define SAMPLING_MAX_VALUES      4
+
+typedef enum {
+    SIGNAL_VALUE_RSSI,
+    SIGNAL_VALUE_RSCP,
+    SIGNAL_VALUE_ECIO,
+    SIGNAL_VALUE_SINR,
+    SIGNAL_VALUE_IO,
+    SIGNAL_VALUE_RSRQ,
+    SIGNAL_VALUE_RSRP,
+    SIGNAL_VALUE_SNR,
+} SignalValue;
+
+static const gchar *signal_value_names[] = {
+    [SIGNAL_VALUE_RSSI] = "rssi",
+    [SIGNAL_VALUE_RSCP] = "rscp",
+    [SIGNAL_VALUE_ECIO] = "ecio",
+    [SIGNAL_VALUE_SINR] = "sinr",
+    [SIGNAL_VALUE_IO]   = "io",
+    [SIGNAL_VALUE_RSRQ] = "rsrq",
+    [SIGNAL_VALUE_RSRP] = "rsrp",
+    [SIGNAL_VALUE_SNR]  = "snr",
+};
+
+typedef enum {
+    SIGNAL_TECH_CDMA,
+    SIGNAL_TECH_EVDO,
+    SIGNAL_TECH_GSM,
+    SIGNAL_TECH_UMTS,
+    SIGNAL_TECH_LTE,
+    SIGNAL_TECH_LAST
+} SignalTech;
+
+/* Measurements reported for each technology, as in the properties */
+static const struct {
+    const gchar *name;
+    guint        n_values;
+    SignalValue  values[SAMPLING_MAX_VALUES];
+} signal_techs[SIGNAL_TECH_LAST] = {
+    [SIGNAL_TECH_CDMA] = { "cdma", 2, { SIGNAL_VALUE_RSSI, SIGNAL_VALUE_ECIO } },
+    [SIGNAL_TECH_EVDO] = { "evdo", 4, { SIGNAL_VALUE_RSSI, SIGNAL_VALUE_ECIO, SIGNAL_VALUE_SINR, SIGNAL_VALUE_IO } },
+    [SIGNAL_TECH_GSM]  = { "gsm",  1, { SIGNAL_VALUE_RSSI } },
+    [SIGNAL_TECH_UMTS] = { "umts", 3, { SIGNAL_VALUE_RSSI, SIGNAL_VALUE_RSCP, SIGNAL_VALUE_ECIO } },
+    [SIGNAL_TECH_LTE]  = { "lte",  4, { SIGNAL_VALUE_RSSI, SIGNAL_VALUE_RSRQ, SIGNAL_VALUE_RSRP, SIGNAL_VALUE_SNR } },
+};
+
+typedef struct {
+    gint64  timestamp; /* monotonic, in microseconds */
+    gdouble values[SAMPLING_MAX_VALUES];
+} SignalSample;
+
+typedef struct {
+    /* Allocated on the first sample of the technology */
+    SignalSample *samples;
+    guint         first;
+    guint         n_samples;
+} SignalHistory;
+
+typedef struct {
+    guint         interval;
+    guint         timeout_source;
+    gboolean      loading;
+    guint         n_skipped;
+    SignalHistory history[SIGNAL_TECH_LAST];
+} SamplingContext;
+
+static void
+sampling_context_free (SamplingContext *ctx)
+{
+    guint i;
+
     if (ctx->timeout_source)
         g_source_remove (ctx->timeout_source);
-    ctx->timeout_source = g_timeout_add_seconds (ctx->rate, (GSourceFunc) refresh_context_cb, self);
+    for (i = 0; i < SIGNAL_TECH_LAST; i++)
+        g_free (ctx->history[i].samples);
+    g_slice_free (SamplingContext, ctx);
+}
+
+static gdouble
+signal_get_value (MMSignal    *signal,
+                  SignalValue  value)
+{
+    switch (value) {
+    case SIGNAL_VALUE_RSSI:
+        return mm_signal_get_rssi (signal);
+    case SIGNAL_VALUE_RSCP:
+        return mm_signal_get_rscp (signal);
+    case SIGNAL_VALUE_ECIO:
+        return mm_signal_get_ecio (signal);
+    case SIGNAL_VALUE_SINR:
+        return mm_signal_get_sinr (signal);
+    case SIGNAL_VALUE_IO:
+        return mm_signal_get_io (signal);
+    case SIGNAL_VALUE_RSRQ:
+        return mm_signal_get_rsrq (signal);
+    case SIGNAL_VALUE_RSRP:
+        return mm_signal_get_rsrp (signal);
+    case SIGNAL_VALUE_SNR:
+        return mm_signal_get_snr (signal);
+    }
+    g_assert_not_reached ();
+    return MM_SIGNAL_UNKNOWN;
+}
+
+static void
+sampling_context_add (MMIfaceModemSignal  *self,
+                      MMSignal           **signals)
+{
+    SamplingContext *ctx;
+    gint64           now;
+    guint            i;
+
+    if (G_UNLIKELY (!sampling_context_quark))
+        sampling_context_quark = g_quark_from_static_string (SAMPLING_CONTEXT_TAG);
+
+    ctx = g_object_get_qdata (G_OBJECT (self), sampling_context_quark);
+    if (!ctx || !ctx->interval)
+        return;
+
+    now = g_get_monotonic_time ();
+    for (i = 0; i < SIGNAL_TECH_LAST; i++) {
+        SignalHistory *history = &ctx->history[i];
+        SignalSample  *sample;
+        guint          j;
+
+        if (!signals[i])
+            continue;
+
+        if (!history->samples)
+            history->samples = g_new (SignalSample, SAMPLING_HISTORY_SIZE);
+
+        /* Overwrite the oldest sample once full */
+        if (history->n_samples < SAMPLING_HISTORY_SIZE)
+            sample = &history->samples[(history->first + history->n_samples++) % SAMPLING_HISTORY_SIZE];
+        else {
+            sample = &history->samples[history->first];
+            history->first = (history->first + 1) % SAMPLING_HISTORY_SIZE;
+        }
+
+        sample->timestamp = now;
+        for (j = 0; j < signal_techs[i].n_values; j++)
+            sample->values[j] = signal_get_value (signals[i], signal_techs[i].values[j]);
+    }
+}
+
+static void
+sampling_load_values_ready (MMIfaceModemSignal *self,
+                            GAsyncResult       *res)
+{
+    SamplingContext *ctx;
+    MMSignal        *signals[SIGNAL_TECH_LAST] = { NULL };
+    GError          *error = NULL;
+    guint            i;
+
+    ctx = g_object_get_qdata (G_OBJECT (self), sampling_context_quark);
+    if (ctx)
+        ctx->loading = FALSE;
+
+    if (!MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values_finish (
+            self,
+            res,
+            &signals[SIGNAL_TECH_CDMA],
+            &signals[SIGNAL_TECH_EVDO],
+            &signals[SIGNAL_TECH_GSM],
+            &signals[SIGNAL_TECH_UMTS],
+            &signals[SIGNAL_TECH_LTE],
+            &error)) {
+        mm_dbg ("Couldn't sample extended signal information: %s", error->message);
+        g_error_free (error);
+        return;
+    }
+
+    sampling_context_add (self, signals);
+
+    for (i = 0; i < SIGNAL_TECH_LAST; i++) {
+        if (signals[i])
+            g_object_unref (signals[i]);
+    }
+}
+
+static gboolean
+sampling_context_cb (MMIfaceModemSignal *self)
+{
+    SamplingContext *ctx;
+
+    ctx = g_object_get_qdata (G_OBJECT (self), sampling_context_quark);
+    g_assert (ctx);
+
+    /* Never queue more than one request; the modem sets the actual rate */
+    if (ctx->loading) {
+        if (!(ctx->n_skipped++ % 100))
+            mm_dbg ("Extended signal information sampling too fast for the modem (%u samples skipped)",
+                    ctx->n_skipped);
+        return G_SOURCE_CONTINUE;
+    }
+
+    ctx->loading = TRUE;
+    MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values (
+        self,
+        NULL,
+        (GAsyncReadyCallback)sampling_load_values_ready,
+        NULL);
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+teardown_sampling_context (MMIfaceModemSignal *self)
+{
+    if (G_UNLIKELY (!sampling_context_quark))
+        sampling_context_quark = g_quark_from_static_string (SAMPLING_CONTEXT_TAG);
+    g_object_set_qdata (G_OBJECT (self), sampling_context_quark, NULL);
+}
+
+static gboolean
+setup_sampling_context (MMIfaceModemSignal *self,
+                        gboolean update_interval,
+                        guint new_interval,
+                        GError **error)
+{
+    MmGdbusModemSignal *skeleton;
+    SamplingContext *ctx;
+    MMModemState modem_state;
+
+    if (G_UNLIKELY (!sampling_context_quark))
+        sampling_context_quark = g_quark_from_static_string (SAMPLING_CONTEXT_TAG);
+
+    if (update_interval && new_interval && new_interval < SAMPLING_MIN_INTERVAL_MS) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_INVALID_ARGS,
+                     "Sampling interval must be at least %u milliseconds",
+                     SAMPLING_MIN_INTERVAL_MS);
+        return FALSE;
+    }
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_SIGNAL_DBUS_SKELETON, &skeleton,
+                  MM_IFACE_MODEM_STATE, &modem_state,
+                  NULL);
+    if (!skeleton) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Couldn't get interface skeleton");
+        return FALSE;
+    }
+
+    if (update_interval)
+        mm_gdbus_modem_signal_set_sampling_interval (skeleton, new_interval);
+    else
+        new_interval = mm_gdbus_modem_signal_get_sampling_interval (skeleton);
+    g_object_unref (skeleton);
+
+    /* User disabling? */
+    if (new_interval == 0) {
+        mm_dbg ("Extended signal information sampling disabled");
+        g_object_set_qdata (G_OBJECT (self), sampling_context_quark, NULL);
+        return TRUE;
+    }
+
+    if (modem_state < MM_MODEM_STATE_ENABLING) {
+        mm_dbg ("Extended signal information sampling disabled (modem not yet enabled)");
+        return TRUE;
+    }
+
+    /* The history is kept when only the interval changes */
+    ctx = g_object_get_qdata (G_OBJECT (self), sampling_context_quark);
+    if (!ctx) {
+        ctx = g_slice_new0 (SamplingContext);
+        g_object_set_qdata_full (G_OBJECT (self),
+                                 sampling_context_quark,
+                                 ctx,
+                                 (GDestroyNotify)sampling_context_free);
+    }
+
+    if (ctx->interval == new_interval)
+        return TRUE;
+
+    mm_dbg ("Extended signal information sampling enabled (interval: %u ms)", new_interval);
+    ctx->interval = new_interval;
+    if (ctx->timeout_source)
+        g_source_remove (ctx->timeout_source);
+    ctx->timeout_source = g_timeout_add (ctx->interval, (GSourceFunc) sampling_context_cb, self);
 
     /* Also launch right away */
-    refresh_context_cb (self);
+    sampling_context_cb (self);
 
     return TRUE;
 }
 
+static GVariant *
+sampling_context_get_statistics (SamplingContext *ctx,
+                                 guint            window)
+{
+    GVariantBuilder builder;
+    gdouble         values[SAMPLING_HISTORY_SIZE];
+    gint64          since;
+    guint           i;
+
+    since = window ? (g_get_monotonic_time () - ((gint64) window * 1000)) : G_MININT64;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssudddddd)"));
+    for (i = 0; i < SIGNAL_TECH_LAST; i++) {
+        SignalHistory *history = &ctx->history[i];
+        guint          j;
+
+        for (j = 0; j < signal_techs[i].n_values; j++) {
+            MMSignalStatistics stats;
+            guint              n_values = 0;
+            guint              k;
+
+            /* Samples are in time order, so walk them backwards until
+             * the window start */
+            for (k = history->n_samples; k > 0; k--) {
+                SignalSample *sample;
+
+                sample = &history->samples[(history->first + k - 1) % SAMPLING_HISTORY_SIZE];
+                if (sample->timestamp < since)
+                    break;
+                if (sample->values[j] != MM_SIGNAL_UNKNOWN)
+                    values[n_values++] = sample->values[j];
+            }
+
+            if (!mm_signal_samples_get_statistics (values, n_values, &stats))
+                continue;
+
+            g_variant_builder_add (&builder,
+                                   "(ssudddddd)",
+                                   signal_techs[i].name,
+                                   signal_value_names[signal_techs[i].values[j]],
+                                   stats.n_samples,
+                                   stats.min,
+                                   stats.max,
+                                   stats.mean,
+                                   stats.p10,
+                                   stats.p50,
+                                   stats.p90);
+        }
+    }
+
+    return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GDBusMethodInvocation *invocation;
+    MmGdbusModemSignal *skeleton;
+    MMIfaceModemSignal *self;
+    guint interval;
+} HandleSetupSamplingContext;
+
+static void
+handle_setup_sampling_context_free (HandleSetupSamplingContext *ctx)
+{
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->self);
+    g_slice_free (HandleSetupSamplingContext, ctx);
+}
+
+static void
+handle_setup_sampling_auth_ready (MMBaseModem *self,
+                                  GAsyncResult *res,
+                                  HandleSetupSamplingContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error))
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+    else if (!setup_sampling_context (ctx->self, TRUE, ctx->interval, &error))
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+    else
+        mm_gdbus_modem_signal_complete_setup_sampling (ctx->skeleton, ctx->invocation);
+    handle_setup_sampling_context_free (ctx);
+}
+
+static gboolean
+handle_setup_sampling (MmGdbusModemSignal *skeleton,
+                       GDBusMethodInvocation *invocation,
+                       guint interval,
+                       MMIfaceModemSignal *self)
+{
+    HandleSetupSamplingContext *ctx;
+
+    ctx = g_slice_new (HandleSetupSamplingContext);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->self = g_object_ref (self);
+    ctx->interval = interval;
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_DEVICE_CONTROL,
+                             (GAsyncReadyCallback)handle_setup_sampling_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GDBusMethodInvocation *invocation;
+    MmGdbusModemSignal *skeleton;
+    MMIfaceModemSignal *self;
+    guint window;
+} HandleGetStatisticsContext;
+
+static void
+handle_get_statistics_context_free (HandleGetStatisticsContext *ctx)
+{
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->self);
+    g_slice_free (HandleGetStatisticsContext, ctx);
+}
+
+static void
+handle_get_statistics_auth_ready (MMBaseModem *self,
+                                  GAsyncResult *res,
+                                  HandleGetStatisticsContext *ctx)
+{
+    SamplingContext *sampling;
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_get_statistics_context_free (ctx);
+        return;
+    }
+
+    if (G_UNLIKELY (!sampling_context_quark))
+        sampling_context_quark = g_quark_from_static_string (SAMPLING_CONTEXT_TAG);
+
+    sampling = g_object_get_qdata (G_OBJECT (ctx->self), sampling_context_quark);
+    if (!sampling) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Extended signal information sampling not enabled");
+        handle_get_statistics_context_free (ctx);
+        return;
+    }
+
+    mm_gdbus_modem_signal_complete_get_statistics (ctx->skeleton,
+                                                   ctx->invocation,
+                                                   sampling_context_get_statistics (sampling, ctx->window));
+    handle_get_statistics_context_free (ctx);
+}
+
+static gboolean
+handle_get_statistics (MmGdbusModemSignal *skeleton,
+                       GDBusMethodInvocation *invocation,
+                       guint window,
+                       MMIfaceModemSignal *self)
+{
+    HandleGetStatisticsContext *ctx;
+
+    ctx = g_slice_new (HandleGetStatisticsContext);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->self = g_object_ref (self);
+    ctx->window = window;
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_DEVICE_CONTROL,
+                             (GAsyncReadyCallback)handle_get_statistics_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -322,6 +928,7 @@ mm_iface_modem_signal_disable (MMIfaceModemSignal *self,
     GTask *task;
 
     teardown_refresh_context (self);
+    teardown_sampling_context (self);
 
     task = g_task_new (self, NULL, callback, user_data);
     g_task_return_boolean (task, TRUE);
@@ -349,7 +956,8 @@ mm_iface_modem_signal_enable (MMIfaceModemSignal *self,
 
     task = g_task_new (self, cancellable, callback, user_data);
 
-    if (!setup_refresh_context (self, FALSE, 0, &error))
+    if (!setup_refresh_context (self, FALSE, 0, &error) ||
+        !setup_sampling_context (self, FALSE, 0, &error))
         g_task_return_error (task, error);
     else
         g_task_return_boolean (task, TRUE);
@@ -492,6 +1100,14 @@ interface_initialization_step (GTask *task)
                           "handle-setup",
                           G_CALLBACK (handle_setup),
                           self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-setup-sampling",
+                          G_CALLBACK (handle_setup_sampling),
+                          self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-get-statistics",
+                          G_CALLBACK (handle_get_statistics),
+                          self);
         /* Finally, export the new interface */
         mm_gdbus_object_skeleton_set_modem_signal (MM_GDBUS_OBJECT_SKELETON (self),
                                                    MM_GDBUS_MODEM_SIGNAL (ctx->skeleton));
@@ -541,8 +1157,9 @@ mm_iface_modem_signal_initialize (MMIfaceModemSignal *self,
 void
 mm_iface_modem_signal_shutdown (MMIfaceModemSignal *self)
 {
-    /* Teardown refresh context */
+    /* Teardown refresh and sampling contexts */
     teardown_refresh_context (self);
+    teardown_sampling_context (self);
 
     /* Unexport DBus interface and remove the skeleton */
     mm_gdbus_object_skeleton_set_modem_signal (MM_GDBUS_OBJECT_SKELETON (self), NULL);
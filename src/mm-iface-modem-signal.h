@@ -55,6 +55,17 @@ struct _MMIfaceModemSignal {
                                      MMSignal **umts,
                                      MMSignal **lte,
                                      GError **error);
+
+    /* Setup (or reset) the modem to report values on its own whenever they
+     * change enough, instead of being polled. Once setup, values are
+     * reported with mm_iface_modem_signal_update(). */
+    void     (* setup_thresholds)        (MMIfaceModemSignal *self,
+                                          gboolean enable,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data);
+    gboolean (* setup_thresholds_finish) (MMIfaceModemSignal *self,
+                                          GAsyncResult *res,
+                                          GError **error);
 };
 
 GType mm_iface_modem_signal_get_type (void);
@@ -88,6 +99,14 @@ gboolean mm_iface_modem_signal_disable_finish (MMIfaceModemSignal *self,
 /* Shutdown Signal interface */
 void mm_iface_modem_signal_shutdown (MMIfaceModemSignal *self);
 
+/* Update the values reported by the modem */
+void mm_iface_modem_signal_update (MMIfaceModemSignal *self,
+                                   MMSignal *cdma,
+                                   MMSignal *evdo,
+                                   MMSignal *gsm,
+                                   MMSignal *umts,
+                                   MMSignal *lte);
+
 /* Bind properties for simple GetStatus() */
 void mm_iface_modem_signal_bind_simple_status (MMIfaceModemSignal *self,
                                                MMSimpleStatus *status);
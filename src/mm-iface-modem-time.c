@@ -20,6 +20,7 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-time.h"
 #include "mm-log.h"
+#include "mm-scheduler.h"
 
 #define SUPPORT_CHECKED_TAG          "time-support-checked-tag"
 #define SUPPORTED_TAG                "time-supported-tag"
@@ -145,7 +146,7 @@ network_timezone_context_free (NetworkTimezoneContext *ctx)
      * in stop_network_timezone() when the logic is disabled (or will be done
      * automatically when the last modem object reference is dropped) */
     if (ctx->network_timezone_poll_id)
-        g_source_remove (ctx->network_timezone_poll_id);
+        mm_scheduler_remove (mm_scheduler_get (), ctx->network_timezone_poll_id);
     g_free (ctx);
 }
 
@@ -203,9 +204,12 @@ load_network_timezone_ready (MMIfaceModemTime *self,
         }
 
         /* Otherwise, relaunch timeout to query a bit later */
-        ctx->network_timezone_poll_id = g_timeout_add_seconds (NETWORK_TIMEZONE_POLL_INTERVAL_SEC,
-                                                               (GSourceFunc)network_timezone_poll_cb,
-                                                               self);
+        ctx->network_timezone_poll_id = mm_scheduler_add (mm_scheduler_get (),
+                                                          G_OBJECT (self),
+                                                          "network-timezone-poll",
+                                                          NETWORK_TIMEZONE_POLL_INTERVAL_SEC,
+                                                          (GSourceFunc)network_timezone_poll_cb,
+                                                          self);
         return;
     }
 
@@ -239,7 +243,12 @@ start_network_timezone_poll (MMIfaceModemTime *self)
 
     mm_dbg ("Network timezone polling started");
     ctx->network_timezone_poll_retries = NETWORK_TIMEZONE_POLL_RETRIES;
-    ctx->network_timezone_poll_id = g_timeout_add_seconds (NETWORK_TIMEZONE_POLL_INTERVAL_SEC, (GSourceFunc)network_timezone_poll_cb, self);
+    ctx->network_timezone_poll_id = mm_scheduler_add (mm_scheduler_get (),
+                                                      G_OBJECT (self),
+                                                      "network-timezone-poll",
+                                                      NETWORK_TIMEZONE_POLL_INTERVAL_SEC,
+                                                      (GSourceFunc)network_timezone_poll_cb,
+                                                      self);
 }
 
 static void
@@ -251,7 +260,7 @@ stop_network_timezone_poll (MMIfaceModemTime *self)
 
     if (ctx->network_timezone_poll_id) {
         mm_dbg ("Network timezone polling stopped");
-        g_source_remove (ctx->network_timezone_poll_id);
+        mm_scheduler_remove (mm_scheduler_get (), ctx->network_timezone_poll_id);
         ctx->network_timezone_poll_id = 0;
     }
 }
@@ -28,12 +28,14 @@
 #include "mm-bearer-list.h"
 #include "mm-log.h"
 #include "mm-context.h"
+#include "mm-scheduler.h"
 
 #define SIGNAL_QUALITY_RECENT_TIMEOUT_SEC 60
 
 #define SIGNAL_CHECK_INITIAL_RETRIES      5
 #define SIGNAL_CHECK_INITIAL_TIMEOUT_SEC  3
 #define SIGNAL_CHECK_TIMEOUT_SEC          30
+#define SIGNAL_CHECK_MAX_TIMEOUT_SEC      120
 
 #define STATE_UPDATE_CONTEXT_TAG          "state-update-context-tag"
 #define SIGNAL_QUALITY_UPDATE_CONTEXT_TAG "signal-quality-update-context-tag"
@@ -1004,6 +1006,7 @@ mm_iface_modem_update_access_technologies (MMIfaceModem *self,
 /*****************************************************************************/
 
 typedef struct {
+    guint recent_timeout;
     guint recent_timeout_source;
 } SignalQualityUpdateContext;
 
@@ -1038,9 +1041,10 @@ expire_signal_quality (MMIfaceModem *self)
 
         /* If value is already not recent, we're done */
         if (recent) {
+            ctx = g_object_get_qdata (G_OBJECT (self), signal_quality_update_context_quark);
             mm_dbg ("Signal quality value not updated in %us, "
                     "marking as not being recent",
-                    SIGNAL_QUALITY_RECENT_TIMEOUT_SEC);
+                    ctx->recent_timeout);
             mm_gdbus_modem_set_signal_quality (skeleton,
                                                g_variant_new ("(ub)",
                                                               signal_quality,
@@ -1056,22 +1060,10 @@ expire_signal_quality (MMIfaceModem *self)
     return G_SOURCE_REMOVE;
 }
 
-static void
-update_signal_quality (MMIfaceModem *self,
-                       guint signal_quality,
-                       gboolean expire)
+static SignalQualityUpdateContext *
+get_signal_quality_update_context (MMIfaceModem *self)
 {
     SignalQualityUpdateContext *ctx;
-    MmGdbusModem *skeleton = NULL;
-    const gchar *dbus_path;
-
-    g_object_get (self,
-                  MM_IFACE_MODEM_DBUS_SKELETON, &skeleton,
-                  NULL);
-
-    /* Don't process updates if the interface is shut down */
-    if (!skeleton)
-        return;
 
     if (G_UNLIKELY (!signal_quality_update_context_quark))
         signal_quality_update_context_quark = (g_quark_from_static_string (
@@ -1081,6 +1073,7 @@ update_signal_quality (MMIfaceModem *self,
     if (!ctx) {
         /* Create context and keep it as object data */
         ctx = g_new0 (SignalQualityUpdateContext, 1);
+        ctx->recent_timeout = SIGNAL_QUALITY_RECENT_TIMEOUT_SEC;
         g_object_set_qdata_full (
             G_OBJECT (self),
             signal_quality_update_context_quark,
@@ -1088,6 +1081,50 @@ update_signal_quality (MMIfaceModem *self,
             (GDestroyNotify)signal_quality_update_context_free);
     }
 
+    return ctx;
+}
+
+/* Polling less often than the default requires the value to be considered
+ * recent for longer; an already scheduled expiration is re-armed */
+static void
+set_signal_quality_recent_timeout (MMIfaceModem *self,
+                                   guint         recent_timeout)
+{
+    SignalQualityUpdateContext *ctx;
+
+    ctx = get_signal_quality_update_context (self);
+    if (ctx->recent_timeout == recent_timeout)
+        return;
+
+    ctx->recent_timeout = recent_timeout;
+    if (ctx->recent_timeout_source) {
+        g_source_remove (ctx->recent_timeout_source);
+        ctx->recent_timeout_source = (g_timeout_add_seconds (
+                                          ctx->recent_timeout,
+                                          (GSourceFunc)expire_signal_quality,
+                                          self));
+    }
+}
+
+static void
+update_signal_quality (MMIfaceModem *self,
+                       guint signal_quality,
+                       gboolean expire)
+{
+    SignalQualityUpdateContext *ctx;
+    MmGdbusModem *skeleton = NULL;
+    const gchar *dbus_path;
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_DBUS_SKELETON, &skeleton,
+                  NULL);
+
+    /* Don't process updates if the interface is shut down */
+    if (!skeleton)
+        return;
+
+    ctx = get_signal_quality_update_context (self);
+
     /* Note: we always set the new value, even if the signal quality level
      * is the same, in order to provide an up to date 'recent' flag.
      * The only exception being if 'expire' is FALSE; in that case we assume
@@ -1112,20 +1149,13 @@ update_signal_quality (MMIfaceModem *self,
     /* If we got a new expirable value, setup new timeout */
     if (expire)
         ctx->recent_timeout_source = (g_timeout_add_seconds (
-                                          SIGNAL_QUALITY_RECENT_TIMEOUT_SEC,
+                                          ctx->recent_timeout,
                                           (GSourceFunc)expire_signal_quality,
                                           self));
 
     g_object_unref (skeleton);
 }
 
-void
-mm_iface_modem_update_signal_quality (MMIfaceModem *self,
-                                      guint signal_quality)
-{
-    update_signal_quality (self, signal_quality, TRUE);
-}
-
 /*****************************************************************************/
 /* Signal info (quality and access technology) polling */
 
@@ -1148,19 +1178,36 @@ typedef struct {
     MMModemAccessTechnology access_technologies;
     guint                   access_technologies_mask;
 
+    /* Values polled in the previous iteration, to back off while stable */
+    guint                   last_signal_quality;
+    MMModemAccessTechnology last_access_technologies;
+
+    /* Last value reported by the modem on its own, and when */
+    guint  indicated_signal_quality;
+    gint64 indicated_time;
+
+    /* When the next check is scheduled, in monotonic time */
+    gint64 next_check_time;
+
     /* If both these are unset we'll automatically stop polling */
     gboolean signal_quality_polling_supported;
     gboolean access_technology_polling_supported;
 
     /* Steps triggered when polling active */
     SignalCheckStep running_step;
+
+    /* Statistics */
+    guint n_polls;
+    guint n_polls_skipped;
+    guint n_polls_saved;
+    guint n_checks_coalesced;
 } SignalCheckContext;
 
 static void
 signal_check_context_free (SignalCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_scheduler_remove (mm_scheduler_get (), ctx->timeout_source);
     g_slice_free (SignalCheckContext, ctx);
 }
 
@@ -1199,6 +1246,21 @@ get_signal_check_context (MMIfaceModem *self)
     return ctx;
 }
 
+void
+mm_iface_modem_update_signal_quality (MMIfaceModem *self,
+                                      guint signal_quality)
+{
+    SignalCheckContext *ctx;
+
+    /* Values not coming from the periodic checks were reported by the modem
+     * on its own; no need to poll while they keep on coming. */
+    ctx = get_signal_check_context (self);
+    ctx->indicated_signal_quality = signal_quality;
+    ctx->indicated_time = g_get_monotonic_time ();
+
+    update_signal_quality (self, signal_quality, TRUE);
+}
+
 static void     periodic_signal_check_disable (MMIfaceModem *self,
                                                gboolean      clear);
 static gboolean periodic_signal_check_cb      (MMIfaceModem *self);
@@ -1282,9 +1344,19 @@ peridic_signal_check_step (MMIfaceModem *self)
 
     case SIGNAL_CHECK_STEP_SIGNAL_QUALITY:
         if (ctx->enabled && ctx->signal_quality_polling_supported) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_signal_quality (
-                self, (GAsyncReadyCallback)signal_quality_check_ready, NULL);
-            return;
+            /* Skip polling if the modem reported the value on its own since
+             * the last check */
+            if (ctx->indicated_time &&
+                (g_get_monotonic_time () - ctx->indicated_time) < ((gint64) ctx->interval * G_USEC_PER_SEC)) {
+                mm_dbg ("Periodic signal quality poll skipped: value recently reported by the modem");
+                ctx->signal_quality = ctx->indicated_signal_quality;
+                ctx->n_polls_skipped++;
+            } else {
+                ctx->n_polls++;
+                MM_IFACE_MODEM_GET_INTERFACE (self)->load_signal_quality (
+                    self, (GAsyncReadyCallback)signal_quality_check_ready, NULL);
+                return;
+            }
         }
         /* Fall down to next step */
         ctx->running_step++;
@@ -1338,7 +1410,17 @@ peridic_signal_check_step (MMIfaceModem *self)
                               NULL);
                 ctx->interval = SIGNAL_CHECK_TIMEOUT_SEC;
             }
+        } else {
+            /* Back off exponentially while the values don't change, and go
+             * back to the default rate as soon as they do */
+            if (ctx->signal_quality == ctx->last_signal_quality &&
+                ctx->access_technologies == ctx->last_access_technologies)
+                ctx->interval = MIN (ctx->interval * 2, SIGNAL_CHECK_MAX_TIMEOUT_SEC);
+            else
+                ctx->interval = SIGNAL_CHECK_TIMEOUT_SEC;
         }
+        ctx->last_signal_quality      = ctx->signal_quality;
+        ctx->last_access_technologies = ctx->access_technologies;
 
         /* If both tasks are unsupported, implicitly disable. Do NOT clear the
          * values, because if we're told they are unsupported it may be that
@@ -1350,9 +1432,23 @@ peridic_signal_check_step (MMIfaceModem *self)
             return;
         }
 
+        /* Polls not run when backing off, compared to the default rate */
+        if (ctx->interval > SIGNAL_CHECK_TIMEOUT_SEC)
+            ctx->n_polls_saved += (ctx->interval / SIGNAL_CHECK_TIMEOUT_SEC) - 1;
+
+        /* The polled value must stay recent until the next check */
+        set_signal_quality_recent_timeout (self, MAX (SIGNAL_QUALITY_RECENT_TIMEOUT_SEC,
+                                                      ctx->interval + SIGNAL_CHECK_TIMEOUT_SEC));
+
         mm_dbg ("Periodic signal quality checks scheduled in %ds", ctx->interval);
         g_assert (!ctx->timeout_source);
-        ctx->timeout_source = g_timeout_add_seconds (ctx->interval, (GSourceFunc) periodic_signal_check_cb, self);
+        ctx->next_check_time = g_get_monotonic_time () + ((gint64) ctx->interval * G_USEC_PER_SEC);
+        ctx->timeout_source = mm_scheduler_add (mm_scheduler_get (),
+                                                G_OBJECT (self),
+                                                "signal-check",
+                                                ctx->interval,
+                                                (GSourceFunc) periodic_signal_check_cb,
+                                                self);
         return;
     }
 }
@@ -1401,7 +1497,7 @@ mm_iface_modem_refresh_signal (MMIfaceModem *self)
     /* Remove the scheduled timeout as we're going to refresh
      * right away */
     if (ctx->timeout_source) {
-        g_source_remove (ctx->timeout_source);
+        mm_scheduler_remove (mm_scheduler_get (), ctx->timeout_source);
         ctx->timeout_source = 0;
     }
 
@@ -1414,6 +1510,29 @@ mm_iface_modem_refresh_signal (MMIfaceModem *self)
     periodic_signal_check_cb (self);
 }
 
+void
+mm_iface_modem_coalesce_signal_check (MMIfaceModem *self,
+                                      guint         window)
+{
+    SignalCheckContext *ctx;
+
+    ctx = get_signal_check_context (self);
+    if (!ctx->enabled || ctx->running_step != SIGNAL_CHECK_STEP_NONE || !ctx->timeout_source)
+        return;
+
+    /* Not due soon enough, keep it as scheduled */
+    if ((ctx->next_check_time - g_get_monotonic_time ()) > ((gint64) window * G_USEC_PER_SEC))
+        return;
+
+    mm_dbg ("Periodic signal check run early, coalesced with another refresh");
+    mm_scheduler_remove (mm_scheduler_get (), ctx->timeout_source);
+    ctx->timeout_source = 0;
+    ctx->n_checks_coalesced++;
+
+    /* Start sequence, keeping the current rate */
+    periodic_signal_check_cb (self);
+}
+
 static void
 periodic_signal_check_disable (MMIfaceModem *self,
                                gboolean      clear)
@@ -1434,12 +1553,14 @@ periodic_signal_check_disable (MMIfaceModem *self,
 
     /* Remove scheduled timeout */
     if (ctx->timeout_source) {
-        g_source_remove (ctx->timeout_source);
+        mm_scheduler_remove (mm_scheduler_get (), ctx->timeout_source);
         ctx->timeout_source = 0;
     }
 
     ctx->enabled = FALSE;
-    mm_dbg ("Periodic signal checks disabled");
+    mm_dbg ("Periodic signal checks disabled "
+            "(polls run: %u, skipped due to reported values: %u, saved backing off: %u, coalesced: %u)",
+            ctx->n_polls, ctx->n_polls_skipped, ctx->n_polls_saved, ctx->n_checks_coalesced);
 }
 
 static void
@@ -477,6 +477,11 @@ void mm_iface_modem_update_signal_quality (MMIfaceModem *self,
 /* Allow requesting to refresh signal via polling */
 void mm_iface_modem_refresh_signal (MMIfaceModem *self);
 
+/* Run the next periodic signal check right away if it is due within the
+ * given number of seconds, so that it shares the wakeup with the caller */
+void mm_iface_modem_coalesce_signal_check (MMIfaceModem *self,
+                                           guint         window);
+
 /* Allow setting allowed modes */
 void     mm_iface_modem_set_current_modes        (MMIfaceModem *self,
                                                   MMModemMode allowed,
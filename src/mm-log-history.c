@@ -0,0 +1,215 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "mm-log-history.h"
+
+/* Per-modem history: the last lines logged about each modem, at any log
+ * level, kept in memory so that they can be retrieved on failure. Lines
+ * are assigned to a modem if they include any of its keys (e.g. the device
+ * uid, or the port names). */
+typedef struct {
+    gchar         *id;
+    gconstpointer  owner;
+    gchar        **keys;
+    gchar        **lines;
+    guint          first;
+    guint          n_lines;
+} LogHistory;
+
+static guint         history_size;
+static GMutex        history_mutex;
+static GList        *histories;
+static volatile gint n_histories;
+
+/*****************************************************************************/
+
+static LogHistory *
+history_find (const gchar *id)
+{
+    GList *l;
+
+    for (l = histories; l; l = g_list_next (l)) {
+        if (g_str_equal (((LogHistory *) l->data)->id, id))
+            return (LogHistory *) l->data;
+    }
+    return NULL;
+}
+
+static void
+history_free (LogHistory *history)
+{
+    guint i;
+
+    for (i = 0; i < history_size; i++)
+        g_free (history->lines[i]);
+    g_free (history->lines);
+    g_strfreev (history->keys);
+    g_free (history->id);
+    g_slice_free (LogHistory, history);
+}
+
+/* Keys must match whole words, and as they are device uids (sysfs paths) and
+ * port names, '.' and '/' are also part of words: e.g. uid .../1-1 must not
+ * match .../1-1.2, and ttyUSB1 must not match ttyUSB10. Still, a '.' may end
+ * a sentence, and port names may be given as tty/ttyUSB1. */
+static gboolean
+history_line_has_key (const gchar *line,
+                      const gchar *key)
+{
+    const gchar *match;
+    const gchar *end;
+    gsize        key_len;
+
+    key_len = strlen (key);
+    for (match = strstr (line, key); match; match = strstr (match + 1, key)) {
+        if (match > line && (g_ascii_isalnum (match[-1]) || match[-1] == '.'))
+            continue;
+        end = match + key_len;
+        if (g_ascii_isalnum (*end) || *end == '/' || (*end == '.' && g_ascii_isalnum (end[1])))
+            continue;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void
+mm_log_history_append (const gchar *line,
+                       gsize        length)
+{
+    GList *l;
+
+    g_mutex_lock (&history_mutex);
+    for (l = histories; l; l = g_list_next (l)) {
+        LogHistory *history = (LogHistory *) l->data;
+        guint       i;
+
+        for (i = 0; history->keys[i]; i++) {
+            if (history_line_has_key (line, history->keys[i]))
+                break;
+        }
+        if (!history->keys[i])
+            continue;
+
+        if (history->n_lines < history_size) {
+            history->lines[(history->first + history->n_lines) % history_size] = g_strndup (line, length);
+            history->n_lines++;
+        } else {
+            g_free (history->lines[history->first]);
+            history->lines[history->first] = g_strndup (line, length);
+            history->first = (history->first + 1) % history_size;
+        }
+    }
+    g_mutex_unlock (&history_mutex);
+}
+
+gboolean
+mm_log_history_is_active (void)
+{
+    return !!g_atomic_int_get (&n_histories);
+}
+
+/*****************************************************************************/
+
+void
+mm_log_history_add (const gchar        *id,
+                    gconstpointer       owner,
+                    const gchar *const *keys)
+{
+    LogHistory *history;
+
+    g_return_if_fail (id != NULL);
+    g_return_if_fail (keys != NULL);
+
+    if (!history_size)
+        return;
+
+    g_mutex_lock (&history_mutex);
+    history = history_find (id);
+    if (!history) {
+        history = g_slice_new0 (LogHistory);
+        history->id = g_strdup (id);
+        history->lines = g_new0 (gchar *, history_size);
+        histories = g_list_prepend (histories, history);
+        g_atomic_int_inc (&n_histories);
+    }
+    /* Lines already logged are kept when the keys change (e.g. when the
+     * modem is recreated), or when the owner changes (e.g. when the device
+     * is re-added before the previous object is gone) */
+    history->owner = owner;
+    g_strfreev (history->keys);
+    history->keys = g_strdupv ((gchar **) keys);
+    g_mutex_unlock (&history_mutex);
+}
+
+void
+mm_log_history_remove (const gchar   *id,
+                       gconstpointer  owner)
+{
+    LogHistory *history;
+
+    g_return_if_fail (id != NULL);
+
+    g_mutex_lock (&history_mutex);
+    history = history_find (id);
+    if (history && history->owner == owner) {
+        histories = g_list_remove (histories, history);
+        g_atomic_int_add (&n_histories, -1);
+        history_free (history);
+    }
+    g_mutex_unlock (&history_mutex);
+}
+
+gchar **
+mm_log_history_get (const gchar *id)
+{
+    LogHistory *history;
+    gchar     **lines = NULL;
+    guint       i;
+
+    g_return_val_if_fail (id != NULL, NULL);
+
+    g_mutex_lock (&history_mutex);
+    history = history_find (id);
+    if (history) {
+        lines = g_new0 (gchar *, history->n_lines + 1);
+        for (i = 0; i < history->n_lines; i++)
+            lines[i] = g_strdup (history->lines[(history->first + i) % history_size]);
+    }
+    g_mutex_unlock (&history_mutex);
+
+    return lines;
+}
+
+/*****************************************************************************/
+
+void
+mm_log_history_setup (guint size)
+{
+    g_mutex_lock (&history_mutex);
+    g_assert (!histories);
+    history_size = size;
+    g_mutex_unlock (&history_mutex);
+}
+
+void
+mm_log_history_shutdown (void)
+{
+    g_mutex_lock (&history_mutex);
+    g_list_free_full (histories, (GDestroyNotify) history_free);
+    histories = NULL;
+    g_atomic_int_set (&n_histories, 0);
+    g_mutex_unlock (&history_mutex);
+}
@@ -0,0 +1,39 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_LOG_HISTORY_H
+#define MM_LOG_HISTORY_H
+
+#include <glib.h>
+
+/* In-memory history of the last lines logged about each modem, at any log
+ * level, when enabled with a non-zero history size in mm_log_setup(). Lines
+ * including any of the given keys as a whole word are added to the history
+ * of the given id. The history is owned by the last one adding it, and only
+ * removed by that same owner, so that an object going away late doesn't
+ * remove the history of a newer one with the same id. */
+void    mm_log_history_add    (const gchar        *id,
+                               gconstpointer       owner,
+                               const gchar *const *keys);
+void    mm_log_history_remove (const gchar        *id,
+                               gconstpointer       owner);
+gchar **mm_log_history_get    (const gchar        *id);
+
+/* Used by the logging backend */
+void     mm_log_history_setup     (guint        size);
+void     mm_log_history_shutdown  (void);
+gboolean mm_log_history_is_active (void);
+void     mm_log_history_append    (const gchar *line,
+                                   gsize        length);
+
+#endif /* MM_LOG_HISTORY_H */
@@ -41,6 +41,7 @@
 #endif
 
 #include "mm-log.h"
+#include "mm-log-history.h"
 
 enum {
     TS_FLAG_NONE = 0,
@@ -76,6 +77,31 @@ static const LogDesc level_descs[] = {
 static GString *msgbuf = NULL;
 static volatile gsize msgbuf_once = 0;
 
+/* Asynchronous file logging: records are pushed to a lock-free LIFO list by
+ * the loggers, and the writer thread periodically takes the whole list at
+ * once, writing it in a single batch. The log file is synced at most once
+ * per interval, or right away after error messages. */
+#define ASYNC_WRITE_INTERVAL_MS 100
+#define ASYNC_SYNC_INTERVAL_MS  1000
+#define ASYNC_MAX_PENDING       10000
+
+typedef struct _LogRecord LogRecord;
+struct _LogRecord {
+    LogRecord *next;
+    gboolean   sync;
+    gsize      length;
+    gchar      message[1];
+};
+
+static LogRecord * volatile async_records;
+static volatile gint        async_n_pending;
+static volatile gint        async_n_dropped;
+static GThread             *async_thread;
+static GMutex               async_mutex;
+static GCond                async_cond;
+static gboolean             async_wakeup;
+static gboolean             async_quit;
+
 static int
 mm_to_syslog_priority (MMLogLevel level)
 {
@@ -143,6 +169,145 @@ log_backend_file (const char *loc,
     fsync (logfd);  /* Make sure output is dumped to disk immediately  */
 }
 
+static void
+async_wakeup_writer (void)
+{
+    g_mutex_lock (&async_mutex);
+    async_wakeup = TRUE;
+    g_cond_signal (&async_cond);
+    g_mutex_unlock (&async_mutex);
+}
+
+static void
+log_backend_file_async (const char *loc,
+                        const char *func,
+                        int syslog_level,
+                        const char *message,
+                        size_t length)
+{
+    LogRecord *record;
+    LogRecord *head;
+    gint       n_pending;
+
+    /* Never let the queue grow unbounded if the writer can't keep up */
+    if (g_atomic_int_get (&async_n_pending) >= ASYNC_MAX_PENDING) {
+        g_atomic_int_inc (&async_n_dropped);
+        return;
+    }
+
+    record = g_malloc (G_STRUCT_OFFSET (LogRecord, message) + length + 1);
+    record->sync = (syslog_level <= LOG_ERR);
+    record->length = length;
+    memcpy (record->message, message, length);
+    record->message[length] = '\0';
+
+    n_pending = g_atomic_int_add (&async_n_pending, 1) + 1;
+    do {
+        head = g_atomic_pointer_get (&async_records);
+        record->next = head;
+    } while (!g_atomic_pointer_compare_and_exchange (&async_records, head, record));
+
+    /* The writer wakes up by itself every interval; only errors and a
+     * queue getting full require waking it up earlier */
+    if (record->sync || n_pending == ASYNC_MAX_PENDING / 2)
+        async_wakeup_writer ();
+}
+
+static void
+async_write (const gchar *buffer,
+             gsize        length)
+{
+    while (length > 0) {
+        ssize_t written;
+
+        written = write (logfd, buffer, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            /* whatever; nowhere to report it */
+            return;
+        }
+        buffer += written;
+        length -= written;
+    }
+}
+
+static gpointer
+async_writer_thread (gpointer user_data)
+{
+    GString  *batch;
+    gint64    last_sync;
+    gboolean  unsynced = FALSE;
+    gboolean  quit = FALSE;
+
+    batch = g_string_sized_new (4096);
+    last_sync = g_get_monotonic_time ();
+
+    while (!quit) {
+        LogRecord *records;
+        LogRecord *fifo = NULL;
+        gboolean   sync = FALSE;
+        gint       n_records = 0;
+        gint       n_dropped;
+        gint64     now;
+
+        g_mutex_lock (&async_mutex);
+        if (!async_wakeup && !async_quit)
+            g_cond_wait_until (&async_cond, &async_mutex,
+                               g_get_monotonic_time () + (ASYNC_WRITE_INTERVAL_MS * G_TIME_SPAN_MILLISECOND));
+        async_wakeup = FALSE;
+        quit = async_quit;
+        g_mutex_unlock (&async_mutex);
+
+        /* Take all queued records at once, and put them back in order */
+        do {
+            records = g_atomic_pointer_get (&async_records);
+        } while (records && !g_atomic_pointer_compare_and_exchange (&async_records, records, NULL));
+
+        while (records) {
+            LogRecord *next = records->next;
+
+            records->next = fifo;
+            fifo = records;
+            records = next;
+        }
+
+        g_string_truncate (batch, 0);
+        while (fifo) {
+            LogRecord *next = fifo->next;
+
+            g_string_append_len (batch, fifo->message, fifo->length);
+            sync |= fifo->sync;
+            n_records++;
+            g_free (fifo);
+            fifo = next;
+        }
+        if (n_records)
+            g_atomic_int_add (&async_n_pending, -n_records);
+
+        do {
+            n_dropped = g_atomic_int_get (&async_n_dropped);
+        } while (n_dropped && !g_atomic_int_compare_and_exchange (&async_n_dropped, n_dropped, 0));
+        if (n_dropped)
+            g_string_append_printf (batch, "<warn>  %d log messages dropped\n", n_dropped);
+
+        if (batch->len) {
+            async_write (batch->str, batch->len);
+            unsynced = TRUE;
+        }
+
+        now = g_get_monotonic_time ();
+        if (unsynced && (sync || quit || (now - last_sync) >= (ASYNC_SYNC_INTERVAL_MS * G_TIME_SPAN_MILLISECOND))) {
+            fsync (logfd);
+            last_sync = now;
+            unsynced = FALSE;
+        }
+    }
+
+    g_string_free (batch, TRUE);
+    return NULL;
+}
+
 static void
 log_backend_syslog (const char *loc,
                     const char *func,
@@ -190,6 +355,8 @@ log_backend_systemd_journal (const char *loc,
 }
 #endif
 
+/*****************************************************************************/
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -199,8 +366,14 @@ _mm_log (const char *loc,
 {
     va_list args;
     GTimeVal tv;
-
-    if (!(log_level & level))
+    gboolean to_backend;
+    gboolean to_history;
+    gsize level_text_len;
+
+    /* When keeping history, messages are formatted at any level */
+    to_backend = !!(log_level & level);
+    to_history = mm_log_history_is_active ();
+    if (!to_backend && !to_history)
         return;
 
     if (g_once_init_enter (&msgbuf_once)) {
@@ -209,8 +382,10 @@ _mm_log (const char *loc,
     } else
         g_string_truncate (msgbuf, 0);
 
-    if (append_log_level_text)
-        g_string_append_printf (msgbuf, "%s ", log_level_description (level));
+    /* The level text is always kept in the history, even if the backend
+     * doesn't want it */
+    g_string_append_printf (msgbuf, "%s ", log_level_description (level));
+    level_text_len = append_log_level_text ? 0 : msgbuf->len;
 
     if (ts_flags == TS_FLAG_WALL) {
         g_get_current_time (&tv);
@@ -240,7 +415,14 @@ _mm_log (const char *loc,
 
     g_string_append_c (msgbuf, '\n');
 
-    log_backend (loc, func, mm_to_syslog_priority (level), msgbuf->str, msgbuf->len);
+    /* Lines are kept in the history without the trailing newline */
+    if (to_history)
+        mm_log_history_append (msgbuf->str, msgbuf->len - 1);
+
+    if (to_backend)
+        log_backend (loc, func, mm_to_syslog_priority (level),
+                     msgbuf->str + level_text_len,
+                     msgbuf->len - level_text_len);
 }
 
 static void
@@ -287,6 +469,8 @@ mm_log_setup (const char *level,
               gboolean log_journal,
               gboolean show_timestamps,
               gboolean rel_timestamps,
+              gboolean log_async,
+              guint history,
               GError **error)
 {
     /* levels */
@@ -301,6 +485,8 @@ mm_log_setup (const char *level,
     /* Grab start time for relative timestamps */
     g_get_current_time (&rel_start);
 
+    mm_log_history_setup (history);
+
 #if defined WITH_SYSTEMD_JOURNAL
     if (log_journal) {
         log_backend = log_backend_systemd_journal;
@@ -321,6 +507,16 @@ mm_log_setup (const char *level,
             return FALSE;
         }
         log_backend = log_backend_file;
+
+        if (log_async) {
+            async_thread = g_thread_try_new ("mm-log-writer", async_writer_thread, NULL, error);
+            if (!async_thread) {
+                close (logfd);
+                logfd = -1;
+                return FALSE;
+            }
+            log_backend = log_backend_file_async;
+        }
     }
 
     g_log_set_handler (G_LOG_DOMAIN,
@@ -348,6 +544,19 @@ mm_log_setup (const char *level,
 void
 mm_log_shutdown (void)
 {
+    /* Let the writer flush all pending records before closing */
+    if (async_thread) {
+        log_backend = log_backend_file;
+        g_mutex_lock (&async_mutex);
+        async_quit = TRUE;
+        g_cond_signal (&async_cond);
+        g_mutex_unlock (&async_mutex);
+        g_thread_join (async_thread);
+        async_thread = NULL;
+    }
+
+    mm_log_history_shutdown ();
+
     if (logfd < 0)
         closelog ();
     else
@@ -54,6 +54,8 @@ gboolean mm_log_setup (const char *level,
                        gboolean log_journal,
                        gboolean show_ts,
                        gboolean rel_ts,
+                       gboolean log_async,
+                       guint history,
                        GError **error);
 
 void mm_log_shutdown (void);
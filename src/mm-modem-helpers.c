@@ -514,6 +514,109 @@ mm_bcd_to_string (const guint8 *bcd, gsize bcd_len)
     return g_string_free (str, FALSE);
 }
 
+/*****************************************************************************/
+/* Process-wide cache of compiled regular expressions */
+
+typedef struct {
+    gchar              *pattern;
+    GRegexCompileFlags  compile_options;
+    GRegexMatchFlags    match_options;
+} RegexCacheKey;
+
+static guint
+regex_cache_key_hash (gconstpointer v)
+{
+    const RegexCacheKey *key = v;
+
+    return g_str_hash (key->pattern) ^ ((guint) key->compile_options * 31) ^ (guint) key->match_options;
+}
+
+static gboolean
+regex_cache_key_equal (gconstpointer a,
+                       gconstpointer b)
+{
+    const RegexCacheKey *key_a = a;
+    const RegexCacheKey *key_b = b;
+
+    return (key_a->compile_options == key_b->compile_options &&
+            key_a->match_options == key_b->match_options &&
+            g_str_equal (key_a->pattern, key_b->pattern));
+}
+
+static void
+regex_cache_key_free (RegexCacheKey *key)
+{
+    g_free (key->pattern);
+    g_slice_free (RegexCacheKey, key);
+}
+
+G_LOCK_DEFINE_STATIC (regex_cache);
+static GHashTable *regex_cache;
+static guint       regex_cache_n_compiled;
+
+GRegex *
+mm_regex_cache_get (const gchar         *pattern,
+                    GRegexCompileFlags   compile_options,
+                    GRegexMatchFlags     match_options,
+                    GError             **error)
+{
+    RegexCacheKey  lookup;
+    RegexCacheKey *key;
+    GRegex        *regex;
+
+    g_return_val_if_fail (pattern != NULL, NULL);
+
+    /* The lookup key just borrows the pattern */
+    lookup.pattern = (gchar *) pattern;
+    lookup.compile_options = compile_options;
+    lookup.match_options = match_options;
+
+    G_LOCK (regex_cache);
+
+    if (G_UNLIKELY (!regex_cache))
+        regex_cache = g_hash_table_new_full (regex_cache_key_hash,
+                                             regex_cache_key_equal,
+                                             (GDestroyNotify) regex_cache_key_free,
+                                             (GDestroyNotify) g_regex_unref);
+
+    regex = g_hash_table_lookup (regex_cache, &lookup);
+    if (!regex) {
+        /* Compile while holding the lock, so that concurrent users of the
+         * same pattern don't end up compiling it more than once */
+        regex = g_regex_new (pattern, compile_options, match_options, error);
+        if (!regex) {
+            G_UNLOCK (regex_cache);
+            return NULL;
+        }
+
+        key = g_slice_new (RegexCacheKey);
+        key->pattern = g_strdup (pattern);
+        key->compile_options = compile_options;
+        key->match_options = match_options;
+        g_hash_table_insert (regex_cache, key, regex);
+        regex_cache_n_compiled++;
+    }
+
+    /* A compiled GRegex is immutable, so it can be shared across threads */
+    g_regex_ref (regex);
+
+    G_UNLOCK (regex_cache);
+
+    return regex;
+}
+
+guint
+mm_regex_cache_get_n_compiled (void)
+{
+    guint n_compiled;
+
+    G_LOCK (regex_cache);
+    n_compiled = regex_cache_n_compiled;
+    G_UNLOCK (regex_cache);
+
+    return n_compiled;
+}
+
 /*****************************************************************************/
 
 GRegex *
@@ -522,10 +625,10 @@ mm_voice_ring_regex_get (void)
     /* Example:
      * <CR><LF>RING<CR><LF>
      */
-    return g_regex_new ("\\r\\nRING\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\nRING\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 GRegex *
@@ -535,10 +638,10 @@ mm_voice_cring_regex_get (void)
      * <CR><LF>+CRING: VOICE<CR><LF>
      * <CR><LF>+CRING: DATA<CR><LF>
      */
-    return g_regex_new ("\\r\\n\\+CRING:\\s*(\\S+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CRING:\\s*(\\S+)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 GRegex *
@@ -548,10 +651,10 @@ mm_voice_clip_regex_get (void)
      * <CR><LF>+CLIP: "+393351391306",145,,,,0<CR><LF>
      *                 \_ Number      \_ Type \_ Validity
      */
-    return g_regex_new ("\\r\\n\\+CLIP:\\s*(\\S+),\\s*(\\d+),\\s*,\\s*,\\s*,\\s*(\\d+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CLIP:\\s*(\\S+),\\s*(\\d+),\\s*,\\s*,\\s*,\\s*(\\d+)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -633,7 +736,7 @@ mm_parse_ifc_test_response (const gchar  *response,
     MMFlowControl  ta_mask     = MM_FLOW_CONTROL_UNKNOWN;
     MMFlowControl  mask        = MM_FLOW_CONTROL_UNKNOWN;
 
-    r = g_regex_new ("(?:\\+IFC:)?\\s*\\((.*)\\),\\((.*)\\)(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_cache_get ("(?:\\+IFC:)?\\s*\\((.*)\\),\\((.*)\\)(?:\\r\\n)?", 0, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
@@ -739,105 +842,105 @@ mm_3gpp_creg_regex_get (gboolean solicited)
 
     /* #1 */
     if (solicited)
-        regex = g_regex_new (CREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #2 */
     if (solicited)
-        regex = g_regex_new (CREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #3 */
     if (solicited)
-        regex = g_regex_new (CREG3 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG3 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG3 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG3 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #4 */
     if (solicited)
-        regex = g_regex_new (CREG4 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG4 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG4 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG4 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #5 */
     if (solicited)
-        regex = g_regex_new (CREG5 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG5 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG5 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG5 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #6 */
     if (solicited)
-        regex = g_regex_new (CREG6 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG6 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG6 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG6 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #7 */
     if (solicited)
-        regex = g_regex_new (CREG7 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG7 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG7 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG7 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #8 */
     if (solicited)
-        regex = g_regex_new (CREG8 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG8 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG8 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG8 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #9 */
     if (solicited)
-        regex = g_regex_new (CREG9 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG9 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG9 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG9 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #10 */
     if (solicited)
-        regex = g_regex_new (CREG10 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG10 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG10 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG10 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #11 */
     if (solicited)
-        regex = g_regex_new (CREG11 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG11 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG11 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG11 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* CEREG #1 */
     if (solicited)
-        regex = g_regex_new (CEREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CEREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CEREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CEREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* CEREG #2 */
     if (solicited)
-        regex = g_regex_new (CEREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CEREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CEREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CEREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
@@ -856,10 +959,10 @@ mm_3gpp_creg_regex_destroy (GPtrArray *array)
 GRegex *
 mm_3gpp_ciev_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -867,10 +970,10 @@ mm_3gpp_ciev_regex_get (void)
 GRegex *
 mm_3gpp_cgev_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CGEV:\\s*(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CGEV:\\s*(.*)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -878,10 +981,10 @@ mm_3gpp_cgev_regex_get (void)
 GRegex *
 mm_3gpp_cusd_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -889,10 +992,10 @@ mm_3gpp_cusd_regex_get (void)
 GRegex *
 mm_3gpp_cmti_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 GRegex *
@@ -901,10 +1004,10 @@ mm_3gpp_cds_regex_get (void)
     /* Example:
      * <CR><LF>+CDS: 24<CR><LF>07914356060013F10659098136395339F6219011707193802190117071938030<CR><LF>
      */
-    return g_regex_new ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -959,7 +1062,7 @@ mm_3gpp_parse_ws46_test_response (const gchar  *response,
     gboolean    supported_3g = FALSE;
     gboolean    supported_2g = FALSE;
 
-    r = g_regex_new ("(?:\\+WS46:)?\\s*\\((.*)\\)(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_cache_get ("(?:\\+WS46:)?\\s*\\((.*)\\)(?:\\r\\n)?", 0, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
@@ -1159,7 +1262,7 @@ mm_3gpp_parse_cops_test_response (const gchar *reply,
      *       +COPS: (2,"","T-Mobile","31026",0),(1,"AT&T","AT&T","310410"),0)
      */
 
-    r = g_regex_new ("\\((\\d),\"([^\"\\)]*)\",([^,\\)]*),([^,\\)]*)[\\)]?,(\\d)\\)", G_REGEX_UNGREEDY, 0, &inner_error);
+    r = mm_regex_cache_get ("\\((\\d),\"([^\"\\)]*)\",([^,\\)]*),([^,\\)]*)[\\)]?,(\\d)\\)", G_REGEX_UNGREEDY, 0, &inner_error);
     if (inner_error) {
         mm_err ("Invalid regular expression: %s", inner_error->message);
         g_error_free (inner_error);
@@ -1188,7 +1291,7 @@ mm_3gpp_parse_cops_test_response (const gchar *reply,
          *       +COPS: (2,"T - Mobile",,"31026"),(1,"Einstein PCS",,"31064"),(1,"Cingular",,"31041"),,(0,1,3),(0,2)
          */
 
-        r = g_regex_new ("\\((\\d),([^,\\)]*),([^,\\)]*),([^\\)]*)\\)", G_REGEX_UNGREEDY, 0, &inner_error);
+        r = mm_regex_cache_get ("\\((\\d),([^,\\)]*),([^,\\)]*),([^\\)]*)\\)", G_REGEX_UNGREEDY, 0, &inner_error);
         if (inner_error) {
             mm_err ("Invalid regular expression: %s", inner_error->message);
             g_error_free (inner_error);
@@ -1297,7 +1400,7 @@ mm_3gpp_parse_cops_read_response (const gchar              *response,
      * or:
      *   +COPS: <mode>,<format>,<oper>,<AcT>
      */
-    r = g_regex_new ("\\+COPS:\\s*(\\d+),(\\d+),([^,]*)(?:,(\\d+))?(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\+COPS:\\s*(\\d+),(\\d+),([^,]*)(?:,(\\d+))?(?:\\r\\n)?", 0, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
@@ -1430,9 +1533,9 @@ mm_3gpp_parse_cgdcont_test_response (const gchar *response,
         return NULL;
     }
 
-    r = g_regex_new ("\\+CGDCONT:\\s*\\(\\s*(\\d+)\\s*-?\\s*(\\d+)?[^\\)]*\\)\\s*,\\s*\\(?\"(\\S+)\"",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, &inner_error);
+    r = mm_regex_cache_get ("\\+CGDCONT:\\s*\\(\\s*(\\d+)\\s*-?\\s*(\\d+)?[^\\)]*\\)\\s*,\\s*\\(?\"(\\S+)\"",
+                            G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
+                            0, &inner_error);
     g_assert (r != NULL);
 
     g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
@@ -1518,9 +1621,9 @@ mm_3gpp_parse_cgdcont_read_response (const gchar *reply,
         return NULL;
 
     list = NULL;
-    r = g_regex_new ("\\+CGDCONT:\\s*(\\d+)\\s*,([^, \\)]*)\\s*,([^, \\)]*)\\s*,([^, \\)]*)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, &inner_error);
+    r = mm_regex_cache_get ("\\+CGDCONT:\\s*(\\d+)\\s*,([^, \\)]*)\\s*,([^, \\)]*)\\s*,([^, \\)]*)",
+                            G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
+                            0, &inner_error);
     if (r) {
         g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
 
@@ -1605,8 +1708,8 @@ mm_3gpp_parse_cgact_read_response (const gchar *reply,
         return NULL;
 
     list = NULL;
-    r = g_regex_new ("\\+CGACT:\\s*(\\d+),(\\d+)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW, 0, &inner_error);
+    r = mm_regex_cache_get ("\\+CGACT:\\s*(\\d+),(\\d+)",
+                            G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW, 0, &inner_error);
     g_assert (r);
 
     g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
@@ -1872,7 +1975,7 @@ mm_3gpp_parse_cmgf_test_response (const gchar *reply,
     while (isspace (*reply))
         reply++;
 
-    r = g_regex_new ("\\(?\\s*(\\d+)\\s*[-,]?\\s*(\\d+)?\\s*\\)?", 0, 0, error);
+    r = mm_regex_cache_get ("\\(?\\s*(\\d+)\\s*[-,]?\\s*(\\d+)?\\s*\\)?", 0, 0, error);
     if (!r)
         return FALSE;
 
@@ -1924,7 +2027,7 @@ mm_3gpp_parse_cmgr_read_response (const gchar *reply,
 
     /* +CMGR: <stat>,<alpha>,<length>(whitespace)<pdu> */
     /* The <alpha> and <length> fields are matched, but not currently used */
-    r = g_regex_new ("\\+CMGR:\\s*(\\d+)\\s*,([^,]*),\\s*(\\d+)\\s*([^\\r\\n]*)", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\+CMGR:\\s*(\\d+)\\s*,([^,]*),\\s*(\\d+)\\s*([^\\r\\n]*)", 0, 0, NULL);
     g_assert (r);
 
     if (!g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, NULL)) {
@@ -2005,8 +2108,8 @@ mm_3gpp_parse_crsm_response (const gchar *reply,
         return FALSE;
     }
 
-    r = g_regex_new ("\\+CRSM:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*\"?([0-9a-fA-F]+)\"?",
-                     G_REGEX_RAW, 0, NULL);
+    r = mm_regex_cache_get ("\\+CRSM:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*\"?([0-9a-fA-F]+)\"?",
+                            G_REGEX_RAW, 0, NULL);
     g_assert (r != NULL);
 
     if (g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, NULL) &&
@@ -2119,16 +2222,16 @@ mm_3gpp_parse_cgcontrdp_response (const gchar  *response,
      * The format of the response changed in TS 27.007 v9.4.0, we try to detect
      * both formats ('a' if >= v9.4.0, 'b' if < v9.4.0) with a single regex here.
      */
-    r = g_regex_new ("\\+CGCONTRDP: "
-                     "(\\d+),(\\d+),([^,]*)" /* cid, bearer id, apn */
-                     "(?:,([^,]*))?" /* (a)ip+mask        or (b)ip */
-                     "(?:,([^,]*))?" /* (a)gateway        or (b)mask */
-                     "(?:,([^,]*))?" /* (a)dns1           or (b)gateway */
-                     "(?:,([^,]*))?" /* (a)dns2           or (b)dns1 */
-                     "(?:,([^,]*))?" /* (a)p-cscf primary or (b)dns2 */
-                     "(?:,(.*))?"    /* others, ignored */
-                     "(?:\\r\\n)?",
-                     0, 0, NULL);
+    r = mm_regex_cache_get ("\\+CGCONTRDP: "
+                            "(\\d+),(\\d+),([^,]*)" /* cid, bearer id, apn */
+                            "(?:,([^,]*))?" /* (a)ip+mask        or (b)ip */
+                            "(?:,([^,]*))?" /* (a)gateway        or (b)mask */
+                            "(?:,([^,]*))?" /* (a)dns1           or (b)gateway */
+                            "(?:,([^,]*))?" /* (a)dns2           or (b)dns1 */
+                            "(?:,([^,]*))?" /* (a)p-cscf primary or (b)dns2 */
+                            "(?:,(.*))?"    /* others, ignored */
+                            "(?:\\r\\n)?",
+                            0, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
@@ -2243,7 +2346,7 @@ mm_3gpp_parse_cfun_query_response (const gchar  *response,
      * +CFUN: 1,0
      *   ..but we don't care about the second number
      */
-    r = g_regex_new ("\\+CFUN: (\\d+)(?:,(?:\\d+))?(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\+CFUN: (\\d+)(?:,(?:\\d+))?(?:\\r\\n)?", 0, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
@@ -2310,7 +2413,7 @@ mm_3gpp_parse_cesq_response (const gchar  *response,
     /* Response may be e.g.:
      * +CESQ: 99,99,255,255,20,80
      */
-    r = g_regex_new ("\\+CESQ: (\\d+),(\\d+),(\\d+),(\\d+),(\\d+),(\\d+)(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\+CESQ: (\\d+),(\\d+),(\\d+),(\\d+),(\\d+),(\\d+)(?:\\r\\n)?", 0, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
@@ -2637,7 +2740,7 @@ mm_3gpp_parse_cpms_test_response (const gchar *reply,
         return FALSE;
     }
 
-    r = g_regex_new ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
     g_assert (r);
 
     for (i = 0; i < N_EXPECTED_GROUPS; i++) {
@@ -2719,7 +2822,7 @@ mm_3gpp_parse_cpms_query_response (const gchar *reply,
     gboolean ret = FALSE;
     GMatchInfo *match_info = NULL;
 
-    r = g_regex_new (CPMS_QUERY_REGEX, G_REGEX_RAW, 0, NULL);
+    r = mm_regex_cache_get (CPMS_QUERY_REGEX, G_REGEX_RAW, 0, NULL);
 
     g_assert (r);
 
@@ -2808,7 +2911,7 @@ mm_3gpp_parse_cscs_test_response (const gchar *reply,
     }
 
     /* Now parse each charset */
-    r = g_regex_new ("\\s*([^,\\)]+)\\s*", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\s*([^,\\)]+)\\s*", 0, 0, NULL);
     if (!r)
         return FALSE;
 
@@ -2850,7 +2953,7 @@ mm_3gpp_parse_clck_test_response (const gchar *reply,
     reply = mm_strip_tag (reply, "+CLCK:");
 
     /* Now parse each facility */
-    r = g_regex_new ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
     g_assert (r != NULL);
 
     *out_facilities = MM_MODEM_3GPP_FACILITY_NONE;
@@ -2888,7 +2991,7 @@ mm_3gpp_parse_clck_write_response (const gchar *reply,
 
     reply = mm_strip_tag (reply, "+CLCK:");
 
-    r = g_regex_new ("\\s*([01])\\s*", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\s*([01])\\s*", 0, 0, NULL);
     g_assert (r != NULL);
 
     if (g_regex_match (r, reply, 0, &match_info)) {
@@ -2928,8 +3031,8 @@ mm_3gpp_parse_cnum_exec_response (const gchar *reply)
     if (!reply || !reply[0])
         return NULL;
 
-    r = g_regex_new ("\\+CNUM:\\s*((\"([^\"]|(\\\"))*\")|([^,]*)),\"(?<num>\\S+)\",\\d",
-                     G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("\\+CNUM:\\s*((\"([^\"]|(\\\"))*\")|([^,]*)),\"(?<num>\\S+)\",\\d",
+                            G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, reply, 0, &match_info);
@@ -3161,7 +3264,7 @@ mm_3gpp_parse_cind_test_response (const gchar *reply,
     while (isspace (*reply))
         reply++;
 
-    r = g_regex_new ("\\(([^,]*),\\((\\d+)[-,](\\d+).*\\)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("\\(([^,]*),\\((\\d+)[-,](\\d+).*\\)", G_REGEX_UNGREEDY, 0, NULL);
     if (!r) {
         g_set_error_literal (error,
                              MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
@@ -3225,7 +3328,7 @@ mm_3gpp_parse_cind_read_response (const gchar *reply,
 
     reply = mm_strip_tag (reply, CIND_TAG);
 
-    r = g_regex_new ("(\\d+)[^0-9]+", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("(\\d+)[^0-9]+", G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     if (!g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, NULL)) {
@@ -3385,11 +3488,11 @@ mm_3gpp_parse_cgev_indication_pdp (const gchar  *str,
               type == MM_3GPP_CGEV_NW_DEACT_PDP ||
               type == MM_3GPP_CGEV_ME_DEACT_PDP);
 
-    r = g_regex_new ("(?:"
-                     "REJECT|"
-                     "NW REACT|"
-                     "NW DEACT|ME DEACT"
-                     ")\\s*([^,]*),\\s*([^,]*)(?:,\\s*([0-9]+))?", 0, 0, NULL);
+    r = mm_regex_cache_get ("(?:"
+                            "REJECT|"
+                            "NW REACT|"
+                            "NW DEACT|ME DEACT"
+                            ")\\s*([^,]*),\\s*([^,]*)(?:,\\s*([0-9]+))?", 0, 0, NULL);
 
     str = mm_strip_tag (str, "+CGEV:");
     g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
@@ -3469,10 +3572,10 @@ mm_3gpp_parse_cgev_indication_primary (const gchar  *str,
               (type == MM_3GPP_CGEV_NW_DEACT_PRIMARY) ||
               (type == MM_3GPP_CGEV_ME_DEACT_PRIMARY));
 
-    r = g_regex_new ("(?:"
-                     "NW PDN ACT|ME PDN ACT|"
-                     "NW PDN DEACT|ME PDN DEACT|"
-                     ")\\s*([0-9]+)", 0, 0, NULL);
+    r = mm_regex_cache_get ("(?:"
+                            "NW PDN ACT|ME PDN ACT|"
+                            "NW PDN DEACT|ME PDN DEACT|"
+                            ")\\s*([0-9]+)", 0, 0, NULL);
 
     str = mm_strip_tag (str, "+CGEV:");
     g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
@@ -3530,10 +3633,10 @@ mm_3gpp_parse_cgev_indication_secondary (const gchar  *str,
               type == MM_3GPP_CGEV_NW_DEACT_SECONDARY ||
               type == MM_3GPP_CGEV_ME_DEACT_SECONDARY);
 
-    r = g_regex_new ("(?:"
-                     "NW ACT|ME ACT|"
-                     "NW DEACT|ME DEACT"
-                     ")\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+)", 0, 0, NULL);
+    r = mm_regex_cache_get ("(?:"
+                            "NW ACT|ME ACT|"
+                            "NW DEACT|ME DEACT"
+                            ")\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+)", 0, 0, NULL);
 
     str = mm_strip_tag (str, "+CGEV:");
     g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
@@ -3594,14 +3697,20 @@ mm_3gpp_pdu_info_list_free (GList *info_list)
     g_list_free_full (info_list, (GDestroyNotify)mm_3gpp_pdu_info_free);
 }
 
-GList *
-mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
-                                 GError **error)
+MM3gppPduInfo *
+mm_3gpp_parse_pdu_cmgl_response_next (const gchar *str,
+                                      gsize len,
+                                      gsize *offset,
+                                      GError **error)
 {
     GError *inner_error = NULL;
-    GList *list = NULL;
-    GMatchInfo *match_info;
+    GMatchInfo *match_info = NULL;
+    MM3gppPduInfo *info = NULL;
     GRegex *r;
+    gint end = 0;
+
+    if (*offset >= len)
+        return NULL;
 
     /*
      * +CMGL: <index>, <status>, [<alpha>], <length>
@@ -3610,22 +3719,21 @@ mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
      *
      * We just read <index>, <stat> and the PDU itself.
      */
-    r = g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,(.*)\\r\\n([^\\r\\n]*)(\\r\\n)?",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    r = mm_regex_cache_get ("\\+CMGL:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,(.*)\\r\\n([^\\r\\n]*)(\\r\\n)?",
+                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
-    while (!inner_error && g_match_info_matches (match_info)) {
-        MM3gppPduInfo *info;
-
+    if (g_regex_match_full (r, str, len, *offset, 0, &match_info, &inner_error)) {
         info = g_new0 (MM3gppPduInfo, 1);
         if (mm_get_int_from_match_info (match_info, 1, &info->index) &&
             mm_get_int_from_match_info (match_info, 2, &info->status) &&
-            (info->pdu = mm_get_string_unquoted_from_match_info (match_info, 4)) != NULL) {
-            /* Append to our list of results and keep on */
-            list = g_list_append (list, info);
-            g_match_info_next (match_info, &inner_error);
+            (info->pdu = mm_get_string_unquoted_from_match_info (match_info, 4)) != NULL &&
+            g_match_info_fetch_pos (match_info, 0, NULL, &end)) {
+            /* Keep on right after this record */
+            *offset = (gsize) end;
         } else {
+            mm_3gpp_pdu_info_free (info);
+            info = NULL;
             inner_error = g_error_new (MM_CORE_ERROR,
                                        MM_CORE_ERROR_FAILED,
                                        "Error parsing +CMGL response: '%s'",
@@ -3636,13 +3744,38 @@ mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
     g_match_info_free (match_info);
     g_regex_unref (r);
 
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return NULL;
+    }
+
+    /* No more records */
+    if (!info)
+        *offset = len;
+    return info;
+}
+
+GList *
+mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
+                                 GError **error)
+{
+    GError *inner_error = NULL;
+    GList *list = NULL;
+    MM3gppPduInfo *info;
+    gsize len;
+    gsize offset = 0;
+
+    len = strlen (str);
+    while ((info = mm_3gpp_parse_pdu_cmgl_response_next (str, len, &offset, &inner_error)) != NULL)
+        list = g_list_prepend (list, info);
+
     if (inner_error) {
         g_propagate_error (error, inner_error);
         mm_3gpp_pdu_info_list_free (list);
         return NULL;
     }
 
-    return list;
+    return g_list_reverse (list);
 }
 
 /*************************************************************************/
@@ -4289,9 +4422,9 @@ mm_cdma_parse_crm_test_response (const gchar *reply,
      *   <--- +CRM: (0-2)
      */
 
-    r = g_regex_new ("\\+CRM:\\s*\\((\\d+)-(\\d+)\\)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, error);
+    r = mm_regex_cache_get ("\\+CRM:\\s*\\((\\d+)-(\\d+)\\)",
+                            G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
+                            0, error);
     g_assert (r != NULL);
 
     if (g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &match_error)) {
@@ -4577,7 +4710,7 @@ mm_parse_cclk_response (const char *response,
      *  +CCLK: "15/03/05,14:14:26-32"
      *  +CCLK: 17/07/26,11:42:15+01
      */
-    r = g_regex_new ("\\+CCLK:\\s*\"?(\\d+)/(\\d+)/(\\d+),(\\d+):(\\d+):(\\d+)([-+]\\d+)?\"?", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\+CCLK:\\s*\"?(\\d+)/(\\d+)/(\\d+),(\\d+):(\\d+):(\\d+)([-+]\\d+)?\"?", 0, 0, NULL);
     g_assert (r != NULL);
 
     if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
@@ -4669,7 +4802,7 @@ mm_parse_csim_response (const gchar *response,
     guint hex_code;
     GError *inner_error = NULL;
 
-    r = g_regex_new ("\\+CSIM:\\s*[0-9]+,\\s*\".*([0-9a-fA-F]{4})\"", G_REGEX_RAW, 0, NULL);
+    r = mm_regex_cache_get ("\\+CSIM:\\s*[0-9]+,\\s*\".*([0-9a-fA-F]{4})\"", G_REGEX_RAW, 0, NULL);
     g_regex_match (r, response, 0, &match_info);
 
     if (!g_match_info_matches (match_info)) {
@@ -4795,3 +4928,135 @@ out:
     g_strfreev (split);
     return valid;
 }
+
+/*****************************************************************************/
+
+static gint
+signal_value_cmp (const gdouble *a,
+                  const gdouble *b)
+{
+    return (*a < *b) ? -1 : ((*a > *b) ? 1 : 0);
+}
+
+static gdouble
+signal_percentile (const gdouble *sorted,
+                   guint          n_values,
+                   guint          percentile)
+{
+    gdouble rank;
+    guint   low;
+    guint   high;
+
+    rank = (percentile * (n_values - 1)) / 100.0;
+    low = (guint) rank;
+    high = MIN (low + 1, n_values - 1);
+    return sorted[low] + ((rank - low) * (sorted[high] - sorted[low]));
+}
+
+gboolean
+mm_signal_samples_get_statistics (gdouble            *values,
+                                  guint               n_values,
+                                  MMSignalStatistics *out_stats)
+{
+    gdouble sum = 0.0;
+    guint   i;
+
+    g_return_val_if_fail (out_stats != NULL, FALSE);
+
+    if (!n_values)
+        return FALSE;
+
+    qsort (values, n_values, sizeof (gdouble), (GCompareFunc) signal_value_cmp);
+    for (i = 0; i < n_values; i++)
+        sum += values[i];
+
+    out_stats->n_samples = n_values;
+    out_stats->min = values[0];
+    out_stats->max = values[n_values - 1];
+    out_stats->mean = sum / n_values;
+    out_stats->p10 = signal_percentile (values, n_values, 10);
+    out_stats->p50 = signal_percentile (values, n_values, 50);
+    out_stats->p90 = signal_percentile (values, n_values, 90);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+static gint
+nmea_hex_value (gchar c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static gboolean
+nmea_sentence_checksum_valid (const gchar *sentence,
+                              gsize        len)
+{
+    const gchar *asterisk;
+    guint8       checksum = 0;
+    gint         high;
+    gint         low;
+    gsize        i;
+
+    /* The checksum is optional */
+    asterisk = memchr (sentence, '*', len);
+    if (!asterisk)
+        return TRUE;
+
+    /* When given, it's the last field, with two hex digits */
+    if ((gsize) (asterisk - sentence) + 3 != len)
+        return FALSE;
+    high = nmea_hex_value (asterisk[1]);
+    low = nmea_hex_value (asterisk[2]);
+    if (high < 0 || low < 0)
+        return FALSE;
+
+    /* XOR of everything between '$' and '*' */
+    for (i = 1; &sentence[i] < asterisk; i++)
+        checksum ^= (guint8) sentence[i];
+
+    return (checksum == ((high << 4) | low));
+}
+
+gboolean
+mm_nmea_sentence_find (const gchar *data,
+                       gsize        len,
+                       gsize        offset,
+                       gsize       *out_start,
+                       gsize       *out_end,
+                       gboolean    *out_valid)
+{
+    while (offset < len) {
+        const gchar *dollar;
+        gsize        start;
+        gsize        i;
+
+        dollar = memchr (&data[offset], '$', len - offset);
+        if (!dollar)
+            return FALSE;
+        start = dollar - data;
+
+        /* The sentence ends at the first line feed; a new '$' before it
+         * means this one was truncated */
+        for (i = start + 1; i < len && data[i] != '\n' && data[i] != '$'; i++);
+        if (i == len)
+            return FALSE;
+        if (data[i] == '$' || data[i - 1] != '\r') {
+            offset = i;
+            continue;
+        }
+
+        *out_start = start;
+        *out_end = i + 1;
+        *out_valid = nmea_sentence_checksum_valid (&data[start], i - 1 - start);
+        return TRUE;
+    }
+
+    return FALSE;
+}
@@ -90,6 +90,17 @@ GArray *mm_filter_supported_capabilities (MMModemCapability all,
 
 gchar *mm_bcd_to_string (const guint8 *bcd, gsize bcd_len);
 
+/* Same as g_regex_new(), but the compiled GRegex is kept in a process-wide
+ * cache shared by all callers using the same pattern and flags, so that it is
+ * compiled only once. Returns a new reference, to be released with
+ * g_regex_unref() as usual. Safe to call from any thread. */
+GRegex *mm_regex_cache_get            (const gchar         *pattern,
+                                       GRegexCompileFlags   compile_options,
+                                       GRegexMatchFlags     match_options,
+                                       GError             **error);
+/* Number of patterns compiled by the cache so far; for testing */
+guint   mm_regex_cache_get_n_compiled (void);
+
 /*****************************************************************************/
 /* VOICE specific helpers and utilities */
 /*****************************************************************************/
@@ -324,6 +335,14 @@ void   mm_3gpp_pdu_info_free           (MM3gppPduInfo *info);
 void   mm_3gpp_pdu_info_list_free      (GList *info_list);
 GList *mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
                                         GError **error);
+/* Incremental version of the above, to process large responses record by
+ * record: parses the first record found at or after 'offset' and updates
+ * 'offset' to point right after it. Returns NULL once there are no more
+ * records, or on error. */
+MM3gppPduInfo *mm_3gpp_parse_pdu_cmgl_response_next (const gchar *str,
+                                                     gsize len,
+                                                     gsize *offset,
+                                                     GError **error);
 
 /* AT+CMGR (Read message) response parser */
 MM3gppPduInfo *mm_3gpp_parse_cmgr_read_response (const gchar *reply,
@@ -483,4 +502,31 @@ gboolean mm_parse_supl_address (const gchar  *supl,
                                 guint16      *out_port,
                                 GError      **error);
 
+/* Statistics of a set of signal quality samples. The values are sorted in
+ * place; percentiles are interpolated linearly between the closest ranks. */
+typedef struct {
+    guint   n_samples;
+    gdouble min;
+    gdouble max;
+    gdouble mean;
+    gdouble p10;
+    gdouble p50;
+    gdouble p90;
+} MMSignalStatistics;
+
+gboolean mm_signal_samples_get_statistics (gdouble            *values,
+                                           guint               n_values,
+                                           MMSignalStatistics *out_stats);
+
+/* Finds the next complete NMEA sentence in @data, looking from @offset: from
+ * a '$' up to and including the "\r\n" ending it. Returns FALSE if there is
+ * none yet. Sentences with a checksum not matching their contents are also
+ * returned, but flagged as not valid. */
+gboolean mm_nmea_sentence_find (const gchar *data,
+                                gsize        len,
+                                gsize        offset,
+                                gsize       *out_start,
+                                gsize       *out_end,
+                                gboolean    *out_valid);
+
 #endif  /* MM_MODEM_HELPERS_H */
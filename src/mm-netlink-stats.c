@@ -0,0 +1,162 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-netlink-stats.h"
+
+/* Large enough for a single RTM_NEWLINK message */
+#define NETLINK_BUFFER_SIZE 32768
+
+static gboolean
+parse_link_message (struct nlmsghdr *hdr,
+                    guint64         *rx_bytes,
+                    guint64         *tx_bytes)
+{
+    struct ifinfomsg *ifi;
+    struct rtattr    *rta;
+    gint              len;
+    gboolean          found = FALSE;
+
+    ifi = NLMSG_DATA (hdr);
+    len = IFLA_PAYLOAD (hdr);
+    for (rta = IFLA_RTA (ifi); RTA_OK (rta, len); rta = RTA_NEXT (rta, len)) {
+        /* 64bit counters preferred, if available */
+        if (rta->rta_type == IFLA_STATS64 && RTA_PAYLOAD (rta) >= sizeof (struct rtnl_link_stats64)) {
+            struct rtnl_link_stats64 stats;
+
+            memcpy (&stats, RTA_DATA (rta), sizeof (stats));
+            *rx_bytes = stats.rx_bytes;
+            *tx_bytes = stats.tx_bytes;
+            return TRUE;
+        }
+
+        if (rta->rta_type == IFLA_STATS && RTA_PAYLOAD (rta) >= sizeof (struct rtnl_link_stats)) {
+            struct rtnl_link_stats stats;
+
+            memcpy (&stats, RTA_DATA (rta), sizeof (stats));
+            *rx_bytes = stats.rx_bytes;
+            *tx_bytes = stats.tx_bytes;
+            found = TRUE;
+        }
+    }
+
+    return found;
+}
+
+gboolean
+mm_netlink_stats_read (const gchar  *interface,
+                       guint64      *rx_bytes,
+                       guint64      *tx_bytes,
+                       GError      **error)
+{
+    struct {
+        struct nlmsghdr  hdr;
+        struct ifinfomsg ifi;
+    } request;
+    guint     ifindex;
+    gint      fd;
+    guint8   *buffer = NULL;
+    gboolean  found = FALSE;
+    gboolean  done = FALSE;
+
+    g_return_val_if_fail (interface != NULL, FALSE);
+
+    ifindex = if_nametoindex (interface);
+    if (!ifindex) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_NOT_FOUND,
+                     "Unknown network interface '%s'", interface);
+        return FALSE;
+    }
+
+    fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED,
+                     "Couldn't open netlink socket: %s", g_strerror (errno));
+        return FALSE;
+    }
+
+    memset (&request, 0, sizeof (request));
+    request.hdr.nlmsg_len = NLMSG_LENGTH (sizeof (struct ifinfomsg));
+    request.hdr.nlmsg_type = RTM_GETLINK;
+    request.hdr.nlmsg_flags = NLM_F_REQUEST;
+    request.hdr.nlmsg_seq = 1;
+    request.ifi.ifi_family = AF_UNSPEC;
+    request.ifi.ifi_index = (gint) ifindex;
+
+    if (send (fd, &request, request.hdr.nlmsg_len, 0) < 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Couldn't send netlink request: %s", g_strerror (errno));
+        goto out;
+    }
+
+    buffer = g_malloc (NETLINK_BUFFER_SIZE);
+    while (!done) {
+        struct nlmsghdr *hdr;
+        gssize           len;
+
+        len = recv (fd, buffer, NETLINK_BUFFER_SIZE, 0);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                         "Couldn't receive netlink response: %s", g_strerror (errno));
+            goto out;
+        }
+
+        for (hdr = (struct nlmsghdr *) buffer; NLMSG_OK (hdr, len); hdr = NLMSG_NEXT (hdr, len)) {
+            if (hdr->nlmsg_seq != request.hdr.nlmsg_seq)
+                continue;
+
+            if (hdr->nlmsg_type == NLMSG_ERROR) {
+                struct nlmsgerr *err = NLMSG_DATA (hdr);
+
+                g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                             "Netlink request failed: %s", g_strerror (-err->error));
+                goto out;
+            }
+
+            if (hdr->nlmsg_type == RTM_NEWLINK) {
+                found = parse_link_message (hdr, rx_bytes, tx_bytes);
+                done = TRUE;
+                break;
+            }
+
+            if (hdr->nlmsg_type == NLMSG_DONE) {
+                done = TRUE;
+                break;
+            }
+        }
+    }
+
+    if (!found)
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED,
+                     "No statistics reported for network interface '%s'", interface);
+
+out:
+    g_free (buffer);
+    close (fd);
+    return found;
+}
@@ -0,0 +1,27 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_NETLINK_STATS_H
+#define MM_NETLINK_STATS_H
+
+#include <glib.h>
+
+/* Reads the rx/tx byte counters of a network interface straight from the
+ * kernel, through rtnetlink, without involving the modem. The counters are
+ * the ones of the interface since it was created, not per connection. */
+gboolean mm_netlink_stats_read (const gchar  *interface,
+                                guint64      *rx_bytes,
+                                guint64      *tx_bytes,
+                                GError      **error);
+
+#endif /* MM_NETLINK_STATS_H */
@@ -27,6 +27,10 @@
 
 #include "mm-plugin-manager.h"
 #include "mm-plugin.h"
+#include "mm-port-probe-cache.h"
+#include "mm-private-boxed-types.h"
+#include "mm-context.h"
+#include "mm-daemon-enums-types.h"
 #include "mm-log.h"
 
 static void initable_iface_init (GInitableIface *iface);
@@ -54,14 +58,405 @@ struct _MMPluginManagerPrivate {
     GList *plugins;
     /* Last, the generic plugin. */
     MMPlugin *generic;
+    /* Plugins not loaded yet, to be loaded once a port matching their
+     * filters in the manifest is found */
+    GList *lazy_plugins;
+
+    /* Index of the plugins by the pre-probing filters every port must match
+     * for them to be supported. Values are GArrays with the positions of the
+     * plugins in the list above. */
+    guint       n_plugins;
+    GHashTable *index_by_vid;
+    GHashTable *index_by_vid_pid;
+    GHashTable *index_by_udev_tag;
+    GHashTable *index_by_driver;
+    /* Plugins without such filters, which are always candidates */
+    GArray     *index_unfiltered;
 
     /* List of ongoing device support checks */
     GList *device_contexts;
+
+    /* Cache of port probing results, if enabled */
+    MMPortProbeCache *probe_cache;
 };
 
+/*****************************************************************************/
+/* Lazy plugin loading */
+
+/* Manifest generated at build time, with the pre-probing filters of each
+ * plugin, see plugins/mm-plugin-manifest.awk */
+#define PLUGIN_MANIFEST_FILE "mm-plugins.manifest"
+
+typedef struct {
+    gchar  *path;
+    gchar  *name;
+    gchar **subsystems;
+    /* Only the mandatory filters, see mm_plugin_get_mandatory_filters() */
+    GArray *vendor_ids;
+    GArray *product_ids;
+    gchar **udev_tags;
+    gchar **drivers;
+} LazyPlugin;
+
+static MMPlugin *load_plugin (const gchar *path);
+
+static void
+lazy_plugin_free (LazyPlugin *lazy)
+{
+    g_free (lazy->path);
+    g_free (lazy->name);
+    g_strfreev (lazy->subsystems);
+    if (lazy->vendor_ids)
+        g_array_unref (lazy->vendor_ids);
+    if (lazy->product_ids)
+        g_array_unref (lazy->product_ids);
+    g_strfreev (lazy->udev_tags);
+    g_strfreev (lazy->drivers);
+    g_slice_free (LazyPlugin, lazy);
+}
+
+static gboolean
+strv_contains (gchar       **strv,
+               const gchar  *str)
+{
+    guint i;
+
+    for (i = 0; strv[i]; i++) {
+        if (g_str_equal (strv[i], str))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean
+parse_id (const gchar *str,
+          guint16     *id)
+{
+    guint64  value;
+    gchar   *end = NULL;
+
+    value = g_ascii_strtoull (str, &end, 0);
+    if (!end || *end || !value || value > G_MAXUINT16)
+        return FALSE;
+    *id = (guint16) value;
+    return TRUE;
+}
+
+static gboolean
+lazy_plugin_parse_ids (LazyPlugin  *lazy,
+                       gchar      **vendor_ids,
+                       gchar      **product_ids)
+{
+    guint i;
+
+    lazy->vendor_ids = g_array_new (FALSE, FALSE, sizeof (guint16));
+    for (i = 0; vendor_ids && vendor_ids[i]; i++) {
+        guint16 vid;
+
+        if (!parse_id (vendor_ids[i], &vid))
+            return FALSE;
+        g_array_append_val (lazy->vendor_ids, vid);
+    }
+
+    lazy->product_ids = g_array_new (FALSE, FALSE, sizeof (mm_uint16_pair));
+    for (i = 0; product_ids && product_ids[i]; i++) {
+        mm_uint16_pair   pair;
+        gchar          **split;
+        gboolean         valid;
+
+        split = g_strsplit (product_ids[i], ":", -1);
+        valid = (g_strv_length (split) == 2 && parse_id (split[0], &pair.l) && parse_id (split[1], &pair.r));
+        g_strfreev (split);
+        if (!valid)
+            return FALSE;
+        g_array_append_val (lazy->product_ids, pair);
+    }
+
+    /* Would never match, so the manifest can't be right */
+    return (lazy->vendor_ids->len > 0 || lazy->product_ids->len > 0);
+}
+
+/* Returns NULL if the plugin must be loaded right away */
+static LazyPlugin *
+lazy_plugin_new (GKeyFile    *manifest,
+                 const gchar *group,
+                 const gchar *path)
+{
+    LazyPlugin  *lazy;
+    gchar      **vendor_ids;
+    gchar      **product_ids;
+    gboolean     valid = TRUE;
+
+    if (!g_key_file_has_group (manifest, group) ||
+        g_key_file_get_boolean (manifest, group, "eager", NULL))
+        return NULL;
+
+    lazy = g_slice_new0 (LazyPlugin);
+    lazy->path = g_strdup (path);
+    lazy->name = g_key_file_get_string (manifest, group, "name", NULL);
+    lazy->subsystems = g_key_file_get_string_list (manifest, group, "subsystems", NULL, NULL);
+
+    /* Same precedence as in mm_plugin_get_mandatory_filters() */
+    vendor_ids = g_key_file_get_string_list (manifest, group, "vendor-ids", NULL, NULL);
+    product_ids = g_key_file_get_string_list (manifest, group, "product-ids", NULL, NULL);
+    if ((vendor_ids || product_ids) && !g_key_file_get_boolean (manifest, group, "strings", NULL))
+        valid = lazy_plugin_parse_ids (lazy, vendor_ids, product_ids);
+    else if (!(lazy->udev_tags = g_key_file_get_string_list (manifest, group, "udev-tags", NULL, NULL)))
+        lazy->drivers = g_key_file_get_string_list (manifest, group, "drivers", NULL, NULL);
+    g_strfreev (vendor_ids);
+    g_strfreev (product_ids);
+
+    /* The generic plugin and the ones without mandatory filters are always
+     * loaded; so are the ones supporting virtual ports, which report a fake
+     * driver */
+    if (!valid ||
+        !lazy->name ||
+        g_str_equal (lazy->name, MM_PLUGIN_GENERIC_NAME) ||
+        (!lazy->vendor_ids && !lazy->udev_tags && !lazy->drivers) ||
+        (lazy->drivers && strv_contains (lazy->drivers, "virtual"))) {
+        lazy_plugin_free (lazy);
+        return NULL;
+    }
+
+    return lazy;
+}
+
+static gboolean
+lazy_plugin_matches (LazyPlugin     *lazy,
+                     MMDevice       *device,
+                     MMKernelDevice *port)
+{
+    guint i;
+
+    /* Same subsystem filter as in the plugin */
+    if (lazy->subsystems) {
+        const gchar *subsys;
+
+        subsys = mm_kernel_device_get_subsystem (port);
+        for (i = 0; lazy->subsystems[i]; i++) {
+            if (g_str_equal (subsys, lazy->subsystems[i]) ||
+                (g_str_equal (lazy->subsystems[i], "usb") && g_str_equal (subsys, "usbmisc")))
+                break;
+        }
+        if (!lazy->subsystems[i])
+            return FALSE;
+    }
+
+    if (lazy->vendor_ids) {
+        guint16 vendor;
+        guint16 product;
+
+        vendor = mm_device_get_vendor (device);
+        product = mm_device_get_product (device);
+        for (i = 0; vendor && i < lazy->vendor_ids->len; i++) {
+            if (vendor == g_array_index (lazy->vendor_ids, guint16, i))
+                return TRUE;
+        }
+        for (i = 0; vendor && product && i < lazy->product_ids->len; i++) {
+            mm_uint16_pair *pair;
+
+            pair = &g_array_index (lazy->product_ids, mm_uint16_pair, i);
+            if (vendor == pair->l && product == pair->r)
+                return TRUE;
+        }
+        return FALSE;
+    }
+
+    if (lazy->udev_tags) {
+        for (i = 0; lazy->udev_tags[i]; i++) {
+            if (mm_kernel_device_get_global_property_as_boolean (port, lazy->udev_tags[i]))
+                return TRUE;
+        }
+        return FALSE;
+    }
+
+    if (lazy->drivers) {
+        const gchar **drivers;
+
+        drivers = mm_device_get_drivers (device);
+        for (i = 0; drivers && drivers[i]; i++) {
+            if (strv_contains (lazy->drivers, drivers[i]))
+                return TRUE;
+        }
+        return FALSE;
+    }
+
+    g_assert_not_reached ();
+}
+
+static void plugin_manager_add_plugin (MMPluginManager *self,
+                                       MMPlugin        *plugin);
+
+static MMPlugin *
+plugin_manager_load_lazy_plugin (MMPluginManager *self,
+                                 GList           *l)
+{
+    LazyPlugin *lazy;
+    MMPlugin   *plugin;
+
+    lazy = (LazyPlugin *) l->data;
+    self->priv->lazy_plugins = g_list_delete_link (self->priv->lazy_plugins, l);
+
+    plugin = load_plugin (lazy->path);
+    if (plugin) {
+        mm_dbg ("[plugin manager] loaded plugin '%s' on demand", mm_plugin_get_name (plugin));
+        plugin_manager_add_plugin (self, plugin);
+    }
+    lazy_plugin_free (lazy);
+
+    return plugin;
+}
+
+static void
+plugin_manager_load_lazy_plugins_for_port (MMPluginManager *self,
+                                           MMDevice        *device,
+                                           MMKernelDevice  *port)
+{
+    GList *l;
+    GList *next;
+
+    for (l = self->priv->lazy_plugins; l; l = next) {
+        next = g_list_next (l);
+        if (lazy_plugin_matches ((LazyPlugin *) l->data, device, port))
+            plugin_manager_load_lazy_plugin (self, l);
+    }
+}
+
 /*****************************************************************************/
 /* Build plugin list for a single port */
 
+#define VID_PID_KEY(vid,pid) GUINT_TO_POINTER (((guint)(vid) << 16) | (guint)(pid))
+
+static void
+plugin_index_add (GHashTable *index,
+                  gpointer    key,
+                  guint       position)
+{
+    GArray *positions;
+
+    positions = g_hash_table_lookup (index, key);
+    if (!positions) {
+        positions = g_array_new (FALSE, FALSE, sizeof (guint));
+        g_hash_table_insert (index, key, positions);
+    }
+    /* Same plugin may list the same key more than once */
+    if (!positions->len || g_array_index (positions, guint, positions->len - 1) != position)
+        g_array_append_val (positions, position);
+}
+
+static void
+plugin_manager_index_plugin (MMPluginManager *self,
+                             MMPlugin        *plugin)
+{
+    const guint16        *vendor_ids;
+    const mm_uint16_pair *product_ids;
+    const gchar * const  *udev_tags;
+    const gchar * const  *drivers;
+    guint                 position;
+    guint                 i;
+
+    /* Plugins are appended to the list, so the position is the last one */
+    position = self->priv->n_plugins++;
+
+    if (!mm_plugin_get_mandatory_filters (plugin, &vendor_ids, &product_ids, &udev_tags, &drivers)) {
+        g_array_append_val (self->priv->index_unfiltered, position);
+        return;
+    }
+
+    /* Keys are owned by the plugins, which outlive the index */
+    for (i = 0; vendor_ids && vendor_ids[i]; i++)
+        plugin_index_add (self->priv->index_by_vid, GUINT_TO_POINTER ((guint) vendor_ids[i]), position);
+    for (i = 0; product_ids && product_ids[i].l; i++)
+        plugin_index_add (self->priv->index_by_vid_pid, VID_PID_KEY (product_ids[i].l, product_ids[i].r), position);
+    for (i = 0; udev_tags && udev_tags[i]; i++)
+        plugin_index_add (self->priv->index_by_udev_tag, (gpointer) udev_tags[i], position);
+    for (i = 0; drivers && drivers[i]; i++)
+        plugin_index_add (self->priv->index_by_driver, (gpointer) drivers[i], position);
+}
+
+static void
+plugin_manager_build_index (MMPluginManager *self)
+{
+    GList *l;
+
+    self->priv->index_by_vid      = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_array_unref);
+    self->priv->index_by_vid_pid  = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_array_unref);
+    self->priv->index_by_udev_tag = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_array_unref);
+    self->priv->index_by_driver   = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_array_unref);
+    self->priv->index_unfiltered  = g_array_new (FALSE, FALSE, sizeof (guint));
+
+    for (l = self->priv->plugins; l; l = g_list_next (l))
+        plugin_manager_index_plugin (self, MM_PLUGIN (l->data));
+
+    mm_dbg ("[plugin manager] plugin index built: %u vendor IDs, %u product IDs, %u udev tags, %u drivers, %u unfiltered plugins",
+            g_hash_table_size (self->priv->index_by_vid),
+            g_hash_table_size (self->priv->index_by_vid_pid),
+            g_hash_table_size (self->priv->index_by_udev_tag),
+            g_hash_table_size (self->priv->index_by_driver),
+            self->priv->index_unfiltered->len);
+}
+
+static void
+plugin_manager_clear_index (MMPluginManager *self)
+{
+    g_clear_pointer (&self->priv->index_by_vid,      g_hash_table_unref);
+    g_clear_pointer (&self->priv->index_by_vid_pid,  g_hash_table_unref);
+    g_clear_pointer (&self->priv->index_by_udev_tag, g_hash_table_unref);
+    g_clear_pointer (&self->priv->index_by_driver,   g_hash_table_unref);
+    g_clear_pointer (&self->priv->index_unfiltered,  g_array_unref);
+    self->priv->n_plugins = 0;
+}
+
+static void
+mark_candidates (GArray   *positions,
+                 gboolean *candidates)
+{
+    guint i;
+
+    if (!positions)
+        return;
+    for (i = 0; i < positions->len; i++)
+        candidates[g_array_index (positions, guint, i)] = TRUE;
+}
+
+static void
+plugin_manager_lookup_candidates (MMPluginManager *self,
+                                  MMDevice        *device,
+                                  MMKernelDevice  *port,
+                                  gboolean        *candidates)
+{
+    GHashTableIter  iter;
+    gpointer        key;
+    gpointer        value;
+    const gchar   **drivers;
+    guint16         vendor;
+    guint16         product;
+    guint           i;
+
+    mark_candidates (self->priv->index_unfiltered, candidates);
+
+    vendor = mm_device_get_vendor (device);
+    product = mm_device_get_product (device);
+    if (vendor) {
+        mark_candidates (g_hash_table_lookup (self->priv->index_by_vid, GUINT_TO_POINTER ((guint) vendor)), candidates);
+        if (product)
+            mark_candidates (g_hash_table_lookup (self->priv->index_by_vid_pid, VID_PID_KEY (vendor, product)), candidates);
+    }
+
+    /* Virtual ports report a fake 'virtual' driver when filtering */
+    drivers = mm_device_get_drivers (device);
+    for (i = 0; drivers && drivers[i]; i++)
+        mark_candidates (g_hash_table_lookup (self->priv->index_by_driver, drivers[i]), candidates);
+    mark_candidates (g_hash_table_lookup (self->priv->index_by_driver, "virtual"), candidates);
+
+    /* There are just a few different udev tags, so check all */
+    g_hash_table_iter_init (&iter, self->priv->index_by_udev_tag);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        if (mm_kernel_device_get_global_property_as_boolean (port, (const gchar *) key))
+            mark_candidates ((GArray *) value, candidates);
+    }
+}
+
 static GList *
 plugin_manager_build_plugins_list (MMPluginManager *self,
                                    MMDevice        *device,
@@ -70,10 +465,30 @@ plugin_manager_build_plugins_list (MMPluginManager *self,
     GList *list = NULL;
     GList *l;
     gboolean supported_found = FALSE;
+    gboolean *candidates;
+    guint n_candidates = 0;
+    guint position;
+    gint64 start;
+
+    start = g_get_monotonic_time ();
 
-    for (l = self->priv->plugins; l && !supported_found; l = g_list_next (l)) {
+    /* Load the plugins that may support the port, if not loaded yet */
+    if (self->priv->lazy_plugins)
+        plugin_manager_load_lazy_plugins_for_port (self, device, port);
+
+    /* Only plugins whose mandatory filters match the port need to go through
+     * the full set of pre-probing filters */
+    candidates = g_new0 (gboolean, self->priv->n_plugins);
+    plugin_manager_lookup_candidates (self, device, port, candidates);
+
+    /* Candidates are checked in the same order as the plugin list */
+    for (l = self->priv->plugins, position = 0; l && !supported_found; l = g_list_next (l), position++) {
         MMPluginSupportsHint hint;
 
+        if (!candidates[position])
+            continue;
+        n_candidates++;
+
         hint = mm_plugin_discard_port_early (MM_PLUGIN (l->data), device, port);
         switch (hint) {
         case MM_PLUGIN_SUPPORTS_HINT_UNSUPPORTED:
@@ -101,14 +516,156 @@ plugin_manager_build_plugins_list (MMPluginManager *self,
             g_assert_not_reached ();
         }
     }
+    g_free (candidates);
 
     /* Add the generic plugin at the end of the list */
     if (self->priv->generic)
         list = g_list_append (list, g_object_ref (self->priv->generic));
 
+    mm_dbg ("[plugin manager] (%s/%s) plugin list built in %.3lf ms: %u candidates out of %u plugins, %u selected",
+            mm_kernel_device_get_subsystem (port),
+            mm_kernel_device_get_name (port),
+            (g_get_monotonic_time () - start) / 1000.0,
+            n_candidates,
+            self->priv->n_plugins,
+            g_list_length (list));
+
     return list;
 }
 
+/*****************************************************************************/
+/* Port probing results cache */
+
+static gboolean
+plugin_is_cacheable (MMPlugin *plugin)
+{
+    MMAsyncMethod *custom_init = NULL;
+
+    /* Plugins with a custom initialization may keep their own per-port or
+     * per-device state out of the probing results (e.g. port type hints), and
+     * that isn't cached, so ports handled by them are always fully probed */
+    g_object_get (plugin, MM_PLUGIN_CUSTOM_INIT, &custom_init, NULL);
+    if (custom_init) {
+        g_boxed_free (MM_TYPE_ASYNC_METHOD, custom_init);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static GList *
+plugin_manager_restore_cached_probe (MMPluginManager *self,
+                                     MMDevice        *device,
+                                     MMKernelDevice  *port,
+                                     GList           *plugins)
+{
+    MMPortProbe             *probe;
+    MMPortProbeCacheResults  results;
+    gchar                   *plugin_name;
+    GList                   *l;
+
+    probe = mm_device_peek_port_probe (device, port);
+    if (!probe)
+        return plugins;
+
+    plugin_name = mm_port_probe_cache_restore (self->priv->probe_cache, port, &results);
+    if (!plugin_name)
+        return plugins;
+
+    /* Restore in the same order as probed, as some results imply others */
+    if (results.flags & MM_PORT_PROBE_AT)
+        mm_port_probe_set_result_at (probe, results.is_at);
+    if (results.flags & MM_PORT_PROBE_AT_VENDOR)
+        mm_port_probe_set_result_at_vendor (probe, results.vendor);
+    if (results.flags & MM_PORT_PROBE_AT_PRODUCT)
+        mm_port_probe_set_result_at_product (probe, results.product);
+    if (results.flags & MM_PORT_PROBE_AT_ICERA)
+        mm_port_probe_set_result_at_icera (probe, results.is_icera);
+    if (results.flags & MM_PORT_PROBE_AT_XMM)
+        mm_port_probe_set_result_at_xmm (probe, results.is_xmm);
+    if (results.flags & MM_PORT_PROBE_QCDM)
+        mm_port_probe_set_result_qcdm (probe, results.is_qcdm);
+    if (results.flags & MM_PORT_PROBE_QMI)
+        mm_port_probe_set_result_qmi (probe, results.is_qmi);
+    if (results.flags & MM_PORT_PROBE_MBIM)
+        mm_port_probe_set_result_mbim (probe, results.is_mbim);
+    mm_port_probe_set_cached_results (probe);
+    mm_port_probe_cache_results_clear (&results);
+
+    /* Check support first with the plugin that handled the port last time, if
+     * any. The remaining ones are still tried if it doesn't support it */
+    for (l = plugins; l; l = g_list_next (l)) {
+        if (g_str_equal (mm_plugin_get_name (MM_PLUGIN (l->data)), plugin_name)) {
+            plugins = g_list_remove_link (plugins, l);
+            plugins = g_list_concat (l, plugins);
+            break;
+        }
+    }
+    g_free (plugin_name);
+
+    return plugins;
+}
+
+static void
+plugin_manager_store_cached_probe (MMPluginManager *self,
+                                   MMDevice        *device,
+                                   MMKernelDevice  *port,
+                                   MMPlugin        *best_plugin)
+{
+    MMPortProbe             *probe;
+    MMPortProbeCacheResults  results;
+
+    probe = mm_device_peek_port_probe (device, port);
+    if (!probe)
+        return;
+
+    if (best_plugin && !plugin_is_cacheable (best_plugin)) {
+        mm_port_probe_cache_invalidate (self->priv->probe_cache, port);
+        return;
+    }
+
+    if (mm_port_probe_get_cached_results_invalidated (probe))
+        mm_dbg ("[plugin manager] cached probing results for port %s were wrong, updating",
+                mm_kernel_device_get_name (port));
+
+    results.flags    = mm_port_probe_get_probed_flags (probe);
+    results.is_at    = mm_port_probe_is_at (probe);
+    results.vendor   = g_strdup (mm_port_probe_get_vendor (probe));
+    results.product  = g_strdup (mm_port_probe_get_product (probe));
+    results.is_icera = mm_port_probe_is_icera (probe);
+    results.is_xmm   = mm_port_probe_is_xmm (probe);
+    results.is_qcdm  = mm_port_probe_is_qcdm (probe);
+    results.is_qmi   = mm_port_probe_is_qmi (probe);
+    results.is_mbim  = mm_port_probe_is_mbim (probe);
+
+    /* Unsupported ports are also stored, so that they aren't probed again */
+    mm_port_probe_cache_store (self->priv->probe_cache, port, &results, best_plugin ? mm_plugin_get_name (best_plugin) : "");
+    mm_port_probe_cache_results_clear (&results);
+}
+
+static void
+plugin_manager_store_cached_device (MMPluginManager *self,
+                                    MMDevice        *device,
+                                    MMPlugin        *best_plugin)
+{
+    GList *probes;
+    GList *l;
+
+    probes = mm_device_peek_port_probe_list (device);
+    if (!probes)
+        return;
+
+    /* Only devices fully handled by a cacheable plugin are cached */
+    if (!best_plugin || !plugin_is_cacheable (best_plugin)) {
+        for (l = probes; l; l = g_list_next (l))
+            mm_port_probe_cache_invalidate (self->priv->probe_cache, mm_port_probe_peek_port (MM_PORT_PROBE (l->data)));
+        return;
+    }
+
+    mm_port_probe_cache_set_device_n_ports (self->priv->probe_cache,
+                                            mm_port_probe_peek_port (MM_PORT_PROBE (probes->data)),
+                                            g_list_length (probes));
+}
+
 /*****************************************************************************/
 /* Common context for async operations
  *
@@ -571,6 +1128,80 @@ port_context_cancel (PortContext *port_context)
     return TRUE;
 }
 
+static void
+port_context_shared_probing_ready (MMPortProbe  *probe,
+                                   GAsyncResult *res,
+                                   PortContext  *port_context)
+{
+    GError *error = NULL;
+
+    /* Not fatal, each plugin will anyway run the probing it needs */
+    if (!mm_port_probe_run_finish (probe, res, &error)) {
+        mm_dbg ("[plugin manager] task %s: shared probing failed: %s",
+                port_context->name, error->message);
+        g_error_free (error);
+    } else
+        mm_dbg ("[plugin manager] task %s: shared probing finished",
+                port_context->name);
+
+    /* All plugins now decide from the shared results */
+    port_context_next (port_context);
+    port_context_unref (port_context);
+}
+
+static gboolean
+port_context_run_shared_probing (PortContext *port_context)
+{
+    MMPortProbe     *probe;
+    MMPortProbeFlag  flags = MM_PORT_PROBE_NONE;
+    guint            n_plugins = 0;
+    GList           *l;
+    gchar           *flags_str;
+
+    probe = mm_device_peek_port_probe (port_context->device, port_context->port);
+    if (!probe)
+        return FALSE;
+
+    /* Plugins are checked in order, and the ones checked later reuse the
+     * results probed by the previous ones. So only the plugins before the
+     * first one with custom probing settings can share the probing, or that
+     * one would get results probed with different settings. */
+    for (l = port_context->current; l; l = g_list_next (l)) {
+        MMPortProbeFlag plugin_flags;
+
+        if (!mm_plugin_get_shared_probe_flags (MM_PLUGIN (l->data),
+                                               port_context->device,
+                                               port_context->port,
+                                               &plugin_flags))
+            break;
+        if (plugin_flags != MM_PORT_PROBE_NONE) {
+            flags |= plugin_flags;
+            n_plugins++;
+        }
+    }
+
+    /* Nothing to gain unless several plugins need probing */
+    if (n_plugins < 2)
+        return FALSE;
+
+    flags_str = mm_port_probe_flag_build_string_from_mask (flags);
+    mm_dbg ("[plugin manager] task %s: shared probing for %u plugins: '%s'",
+            port_context->name, n_plugins, flags_str);
+    g_free (flags_str);
+
+    mm_port_probe_run (probe,
+                       flags,
+                       MM_PLUGIN_DEFAULT_SEND_DELAY,
+                       MM_PLUGIN_DEFAULT_REMOVE_ECHO,
+                       MM_PLUGIN_DEFAULT_SEND_LF,
+                       NULL,
+                       NULL,
+                       port_context->cancellable,
+                       (GAsyncReadyCallback) port_context_shared_probing_ready,
+                       port_context_ref (port_context));
+    return TRUE;
+}
+
 static void
 port_context_run (MMPluginManager     *self,
                   PortContext         *port_context,
@@ -643,6 +1274,13 @@ port_context_run (MMPluginManager     *self,
 
     mm_dbg ("[plugin manager) task %s: started", port_context->name);
 
+    /* If requested, run the probing required by all plugins at once, unless
+     * we already know which plugin to check first */
+    if (mm_context_get_shared_probing () &&
+        !port_context->suggested_plugin &&
+        port_context_run_shared_probing (port_context))
+        return;
+
     /* Go probe with the first plugin */
     port_context_next (port_context);
 }
@@ -841,6 +1479,10 @@ device_context_complete (DeviceContext *device_context)
         device_context->min_probing_time_id = 0;
     }
 
+    /* Update the probing results cache */
+    if (device_context->self->priv->probe_cache && !g_cancellable_is_cancelled (device_context->cancellable))
+        plugin_manager_store_cached_device (device_context->self, device_context->device, device_context->best_plugin);
+
     /* Task completion */
     if (!device_context->best_plugin)
         g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED,
@@ -1034,11 +1676,15 @@ port_context_run_ready (MMPluginManager    *self,
         /* The only error we can ignore is UNSUPPORTED */
         if (g_error_matches (error, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED)) {
             /* This error is not critical */
+            if (self->priv->probe_cache)
+                plugin_manager_store_cached_probe (self, common->device_context->device, common->port_context->port, NULL);
             device_context_set_best_plugin (common->device_context, common->port_context, NULL);
         } else
             mm_warn ("[plugin manager] task %s: failed: %s", common->port_context->name, error->message);
         g_error_free (error);
     } else {
+        if (self->priv->probe_cache)
+            plugin_manager_store_cached_probe (self, common->device_context->device, common->port_context->port, best_plugin);
         /* Set the plugin as the best one in the device context */
         device_context_set_best_plugin (common->device_context, common->port_context, best_plugin);
         g_object_unref (best_plugin);
@@ -1087,6 +1733,10 @@ device_context_run_port_context (DeviceContext *device_context,
      * (so that per-driver filters work correctly) */
     plugins = plugin_manager_build_plugins_list (self, device_context->device, port_context->port);
 
+    /* Restore probing results from the cache, if any */
+    if (self->priv->probe_cache)
+        plugins = plugin_manager_restore_cached_probe (self, device_context->device, port_context->port, plugins);
+
     /* If we got one already set in the device context, it will be the first one,
      * unless it is the generic plugin */
     if (device_context->best_plugin &&
@@ -1141,6 +1791,29 @@ device_context_min_wait_time_elapsed (DeviceContext *device_context)
     return G_SOURCE_REMOVE;
 }
 
+static gboolean
+device_context_all_ports_cached (DeviceContext *device_context)
+{
+    MMPluginManager *self;
+    GList           *l;
+    guint            n_ports;
+
+    self = device_context->self;
+    if (!self->priv->probe_cache || !device_context->wait_port_contexts)
+        return FALSE;
+
+    n_ports = mm_port_probe_cache_get_device_n_ports (self->priv->probe_cache,
+                                                      ((PortContext *)(device_context->wait_port_contexts->data))->port);
+    if (!n_ports || g_list_length (device_context->wait_port_contexts) < n_ports)
+        return FALSE;
+
+    for (l = device_context->wait_port_contexts; l; l = g_list_next (l)) {
+        if (!mm_port_probe_cache_has (self->priv->probe_cache, ((PortContext *)(l->data))->port))
+            return FALSE;
+    }
+    return TRUE;
+}
+
 static void
 device_context_port_released (DeviceContext  *device_context,
                               MMKernelDevice *port)
@@ -1217,6 +1890,15 @@ device_context_port_grabbed (DeviceContext  *device_context,
                 port_context->name);
         /* Store the port reference in the list within the device */
         device_context->wait_port_contexts = g_list_prepend (device_context->wait_port_contexts, port_context);
+
+        /* If all the ports the device had last time are already exposed, and
+         * all of them are cached, there's no need to wait for more */
+        if (device_context_all_ports_cached (device_context)) {
+            mm_dbg ("[plugin manager] task %s: all ports found in the probe cache, not waiting any more",
+                    device_context->name);
+            g_source_remove (device_context->min_wait_time_id);
+            device_context_min_wait_time_elapsed (device_context);
+        }
         return;
     }
 
@@ -1491,6 +2173,11 @@ mm_plugin_manager_peek_plugin (MMPluginManager *self,
             return plugin;
     }
 
+    for (l = self->priv->lazy_plugins; l; l = g_list_next (l)) {
+        if (g_str_equal (plugin_name, ((LazyPlugin *) l->data)->name))
+            return plugin_manager_load_lazy_plugin (self, l);
+    }
+
     return NULL;
 }
 
@@ -1557,6 +2244,25 @@ out:
     return plugin;
 }
 
+static void
+plugin_manager_add_plugin (MMPluginManager *self,
+                           MMPlugin        *plugin)
+{
+    /* Generic plugin */
+    if (g_str_equal (mm_plugin_get_name (plugin), MM_PLUGIN_GENERIC_NAME)) {
+        self->priv->generic = plugin;
+        return;
+    }
+
+    /* Vendor specific plugin */
+    self->priv->plugins = g_list_append (self->priv->plugins, plugin);
+
+    /* Plugins loaded on demand are indexed right away; the ones loaded on
+     * startup get indexed all at once when done */
+    if (self->priv->index_unfiltered)
+        plugin_manager_index_plugin (self, plugin);
+}
+
 static gboolean
 load_plugins (MMPluginManager *self,
               GError **error)
@@ -1564,6 +2270,8 @@ load_plugins (MMPluginManager *self,
     GDir *dir = NULL;
     const gchar *fname;
     gchar *plugindir_display = NULL;
+    gchar *manifest_path;
+    GKeyFile *manifest = NULL;
 
     if (!g_module_supported ()) {
         g_set_error (error,
@@ -1587,6 +2295,15 @@ load_plugins (MMPluginManager *self,
         goto out;
     }
 
+    /* Load the manifest, if any, to know which plugins can be loaded later */
+    manifest_path = g_build_filename (self->priv->plugin_dir, PLUGIN_MANIFEST_FILE, NULL);
+    manifest = g_key_file_new ();
+    if (!g_key_file_load_from_file (manifest, manifest_path, G_KEY_FILE_NONE, NULL))
+        g_clear_pointer (&manifest, g_key_file_free);
+    else
+        mm_dbg ("[plugin manager] using plugin manifest, plugins will be loaded on demand");
+    g_free (manifest_path);
+
     while ((fname = g_dir_read_name (dir)) != NULL) {
         gchar *path;
         MMPlugin *plugin;
@@ -1595,6 +2312,23 @@ load_plugins (MMPluginManager *self,
             continue;
 
         path = g_module_build_path (self->priv->plugin_dir, fname);
+
+        /* Defer loading the plugin if possible */
+        if (manifest) {
+            LazyPlugin *lazy;
+            gchar      *group;
+
+            group = g_strndup (fname, strlen (fname) - strlen ("." G_MODULE_SUFFIX));
+            lazy = lazy_plugin_new (manifest, group, path);
+            g_free (group);
+            if (lazy) {
+                mm_dbg ("[plugin manager] plugin '%s' will be loaded on demand", lazy->name);
+                self->priv->lazy_plugins = g_list_append (self->priv->lazy_plugins, lazy);
+                g_free (path);
+                continue;
+            }
+        }
+
         plugin = load_plugin (path);
         g_free (path);
 
@@ -1602,13 +2336,7 @@ load_plugins (MMPluginManager *self,
             continue;
 
         mm_dbg ("[plugin manager] loaded plugin '%s'", mm_plugin_get_name (plugin));
-
-        if (g_str_equal (mm_plugin_get_name (plugin), MM_PLUGIN_GENERIC_NAME))
-            /* Generic plugin */
-            self->priv->generic = plugin;
-        else
-            /* Vendor specific plugin */
-            self->priv->plugins = g_list_append (self->priv->plugins, plugin);
+        plugin_manager_add_plugin (self, plugin);
     }
 
     /* Check the generic plugin once all looped */
@@ -1616,7 +2344,7 @@ load_plugins (MMPluginManager *self,
         mm_warn ("[plugin manager] generic plugin not loaded");
 
     /* Treat as error if we don't find any plugin */
-    if (!self->priv->plugins && !self->priv->generic) {
+    if (!self->priv->plugins && !self->priv->generic && !self->priv->lazy_plugins) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_NO_PLUGINS,
@@ -1625,16 +2353,183 @@ load_plugins (MMPluginManager *self,
         goto out;
     }
 
-    mm_dbg ("[plugin manager] successfully loaded %u plugins",
-            g_list_length (self->priv->plugins) + !!self->priv->generic);
+    mm_dbg ("[plugin manager] successfully loaded %u plugins (%u more to be loaded on demand)",
+            g_list_length (self->priv->plugins) + !!self->priv->generic,
+            g_list_length (self->priv->lazy_plugins));
+
+    /* Index the plugins for the pre-probing filtering */
+    plugin_manager_build_index (self);
 
 out:
+    if (manifest)
+        g_key_file_free (manifest);
     if (dir)
         g_dir_close (dir);
     g_free (plugindir_display);
 
     /* Return TRUE if at least one plugin found */
-    return (self->priv->plugins || self->priv->generic);
+    return (self->priv->plugins || self->priv->generic || self->priv->lazy_plugins);
+}
+
+/*****************************************************************************/
+/* Manifest check */
+
+static gboolean
+strv_equal (const gchar * const *a,
+            const gchar * const *b)
+{
+    guint i;
+
+    if (!a || !b)
+        return (a == b);
+
+    for (i = 0; a[i] && b[i]; i++) {
+        if (!g_str_equal (a[i], b[i]))
+            return FALSE;
+    }
+    return (!a[i] && !b[i]);
+}
+
+static gboolean
+vendor_ids_equal (GArray        *lazy_ids,
+                  const guint16 *ids)
+{
+    guint i;
+
+    for (i = 0; ids && ids[i]; i++) {
+        if (i >= lazy_ids->len || g_array_index (lazy_ids, guint16, i) != ids[i])
+            return FALSE;
+    }
+    return (i == lazy_ids->len);
+}
+
+static gboolean
+product_ids_equal (GArray               *lazy_ids,
+                   const mm_uint16_pair *ids)
+{
+    guint i;
+
+    for (i = 0; ids && ids[i].l; i++) {
+        mm_uint16_pair *pair;
+
+        if (i >= lazy_ids->len)
+            return FALSE;
+        pair = &g_array_index (lazy_ids, mm_uint16_pair, i);
+        if (pair->l != ids[i].l || pair->r != ids[i].r)
+            return FALSE;
+    }
+    return (i == lazy_ids->len);
+}
+
+/* Returns why the manifest entry doesn't match the loaded plugin, if so */
+static const gchar *
+lazy_plugin_check (LazyPlugin *lazy,
+                   MMPlugin   *plugin)
+{
+    gchar                 **subsystems = NULL;
+    gboolean                same;
+    const guint16          *vendor_ids;
+    const mm_uint16_pair   *product_ids;
+    const gchar * const    *udev_tags;
+    const gchar * const    *drivers;
+
+    if (g_strcmp0 (lazy->name, mm_plugin_get_name (plugin)) != 0)
+        return "name differs";
+
+    g_object_get (plugin, MM_PLUGIN_ALLOWED_SUBSYSTEMS, &subsystems, NULL);
+    same = strv_equal ((const gchar * const *) lazy->subsystems, (const gchar * const *) subsystems);
+    g_strfreev (subsystems);
+    if (!same)
+        return "subsystems differ";
+
+    if (!mm_plugin_get_mandatory_filters (plugin, &vendor_ids, &product_ids, &udev_tags, &drivers))
+        return "the plugin has no mandatory filters";
+
+    if (lazy->vendor_ids || vendor_ids || product_ids) {
+        if (!lazy->vendor_ids ||
+            !vendor_ids_equal (lazy->vendor_ids, vendor_ids) ||
+            !product_ids_equal (lazy->product_ids, product_ids))
+            return "vendor or product IDs differ";
+    }
+    if (!strv_equal ((const gchar * const *) lazy->udev_tags, udev_tags))
+        return "udev tags differ";
+    if (!strv_equal ((const gchar * const *) lazy->drivers, drivers))
+        return "drivers differ";
+
+    return NULL;
+}
+
+gboolean
+mm_plugin_manager_check_manifest (const gchar  *plugin_dir,
+                                  const gchar  *manifest_path,
+                                  GError      **error)
+{
+    GKeyFile    *manifest;
+    GDir        *dir;
+    const gchar *fname;
+    GString     *mismatches;
+    guint        n_lazy = 0;
+    gboolean     success;
+
+    manifest = g_key_file_new ();
+    if (!g_key_file_load_from_file (manifest, manifest_path, G_KEY_FILE_NONE, error)) {
+        g_key_file_free (manifest);
+        return FALSE;
+    }
+
+    dir = g_dir_open (plugin_dir, 0, error);
+    if (!dir) {
+        g_key_file_free (manifest);
+        return FALSE;
+    }
+
+    mismatches = g_string_new ("");
+    while ((fname = g_dir_read_name (dir)) != NULL) {
+        gchar       *path;
+        gchar       *group;
+        MMPlugin    *plugin;
+        LazyPlugin  *lazy = NULL;
+        const gchar *reason = NULL;
+
+        if (!g_str_has_suffix (fname, G_MODULE_SUFFIX))
+            continue;
+
+        path = g_module_build_path (plugin_dir, fname);
+        group = g_strndup (fname, strlen (fname) - strlen ("." G_MODULE_SUFFIX));
+
+        /* Plugins always loaded on startup don't depend on the manifest */
+        plugin = load_plugin (path);
+        if (!plugin)
+            reason = "couldn't be loaded";
+        else if ((lazy = lazy_plugin_new (manifest, group, path)) != NULL) {
+            reason = lazy_plugin_check (lazy, plugin);
+            n_lazy++;
+        }
+
+        if (reason)
+            g_string_append_printf (mismatches, "%s%s (%s)", mismatches->len ? ", " : "", group, reason);
+
+        if (lazy)
+            lazy_plugin_free (lazy);
+        if (plugin)
+            g_object_unref (plugin);
+        g_free (group);
+        g_free (path);
+    }
+    g_dir_close (dir);
+    g_key_file_free (manifest);
+
+    success = !mismatches->len;
+    if (!success)
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "plugin manifest '%s' doesn't match the plugins: %s",
+                     manifest_path, mismatches->str);
+    else
+        mm_info ("[plugin manager] plugin manifest '%s' matches the %u plugins loaded on demand",
+                 manifest_path, n_lazy);
+    g_string_free (mismatches, TRUE);
+
+    return success;
 }
 
 MMPluginManager *
@@ -1707,8 +2602,14 @@ initable_init (GInitable *initable,
                GCancellable *cancellable,
                GError **error)
 {
+    MMPluginManager *self = MM_PLUGIN_MANAGER (initable);
+
+    /* Setup the probing results cache, if requested */
+    if (mm_context_get_probe_cache ())
+        self->priv->probe_cache = mm_port_probe_cache_new (mm_context_get_probe_cache ());
+
     /* Load the list of plugins */
-    return load_plugins (MM_PLUGIN_MANAGER (initable), error);
+    return load_plugins (self, error);
 }
 
 static void
@@ -1716,7 +2617,14 @@ dispose (GObject *object)
 {
     MMPluginManager *self = MM_PLUGIN_MANAGER (object);
 
+    /* Cleanup the plugin index before the plugins owning its keys */
+    plugin_manager_clear_index (self);
+
     /* Cleanup list of plugins */
+    if (self->priv->lazy_plugins) {
+        g_list_free_full (self->priv->lazy_plugins, (GDestroyNotify) lazy_plugin_free);
+        self->priv->lazy_plugins = NULL;
+    }
     if (self->priv->plugins) {
         g_list_free_full (self->priv->plugins, g_object_unref);
         self->priv->plugins = NULL;
@@ -1727,6 +2635,7 @@ dispose (GObject *object)
     self->priv->plugin_dir = NULL;
 
     g_clear_object (&self->priv->filter);
+    g_clear_object (&self->priv->probe_cache);
 
     G_OBJECT_CLASS (mm_plugin_manager_parent_class)->dispose (object);
 }
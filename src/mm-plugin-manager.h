@@ -64,4 +64,10 @@ MMPlugin *       mm_plugin_manager_device_support_check_finish (MMPluginManager
 MMPlugin        *mm_plugin_manager_peek_plugin                 (MMPluginManager      *self,
                                                                 const gchar          *plugin_name);
 
+/* Checks that the plugins the manifest allows to load on demand report the
+ * same filters once loaded; used by the test suite */
+gboolean         mm_plugin_manager_check_manifest              (const gchar          *plugin_dir,
+                                                                const gchar          *manifest_path,
+                                                                GError              **error);
+
 #endif /* MM_PLUGIN_MANAGER_H */
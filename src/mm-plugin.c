@@ -710,6 +710,48 @@ mm_plugin_supports_port_finish (MMPlugin      *self,
     return (MMPluginSupportsResult)value;
 }
 
+static MMPortProbeFlag
+build_probe_run_flags (MMPlugin       *self,
+                       MMKernelDevice *port,
+                       gboolean        need_vendor_probing,
+                       gboolean        need_product_probing)
+{
+    MMPortProbeFlag probe_run_flags;
+
+    probe_run_flags = MM_PORT_PROBE_NONE;
+    if (!g_str_has_prefix (mm_kernel_device_get_name (port), "cdc-wdm")) {
+        /* Serial ports... */
+        if (self->priv->at)
+            probe_run_flags |= MM_PORT_PROBE_AT;
+        else if (self->priv->single_at)
+            probe_run_flags |= MM_PORT_PROBE_AT;
+        if (self->priv->qcdm)
+            probe_run_flags |= MM_PORT_PROBE_QCDM;
+    } else {
+        /* cdc-wdm ports... */
+        if (self->priv->qmi && !g_strcmp0 (mm_kernel_device_get_driver (port), "qmi_wwan"))
+            probe_run_flags |= MM_PORT_PROBE_QMI;
+        else if (self->priv->mbim && !g_strcmp0 (mm_kernel_device_get_driver (port), "cdc_mbim"))
+            probe_run_flags |= MM_PORT_PROBE_MBIM;
+        else
+            probe_run_flags |= MM_PORT_PROBE_AT;
+    }
+
+    /* For potential AT ports, check for more things */
+    if (probe_run_flags & MM_PORT_PROBE_AT) {
+        if (need_vendor_probing)
+            probe_run_flags |= MM_PORT_PROBE_AT_VENDOR;
+        if (need_product_probing)
+            probe_run_flags |= MM_PORT_PROBE_AT_PRODUCT;
+        if (self->priv->icera_probe || self->priv->allowed_icera || self->priv->forbidden_icera)
+            probe_run_flags |= MM_PORT_PROBE_AT_ICERA;
+        if (self->priv->xmm_probe || self->priv->allowed_xmm || self->priv->forbidden_xmm)
+            probe_run_flags |= MM_PORT_PROBE_AT_XMM;
+    }
+
+    return probe_run_flags;
+}
+
 void
 mm_plugin_supports_port (MMPlugin            *self,
                          MMDevice            *device,
@@ -771,36 +813,7 @@ mm_plugin_supports_port (MMPlugin            *self,
     }
 
     /* Build flags depending on what probing needed */
-    probe_run_flags = MM_PORT_PROBE_NONE;
-    if (!g_str_has_prefix (mm_kernel_device_get_name (port), "cdc-wdm")) {
-        /* Serial ports... */
-        if (self->priv->at)
-            probe_run_flags |= MM_PORT_PROBE_AT;
-        else if (self->priv->single_at)
-            probe_run_flags |= MM_PORT_PROBE_AT;
-        if (self->priv->qcdm)
-            probe_run_flags |= MM_PORT_PROBE_QCDM;
-    } else {
-        /* cdc-wdm ports... */
-        if (self->priv->qmi && !g_strcmp0 (mm_kernel_device_get_driver (port), "qmi_wwan"))
-            probe_run_flags |= MM_PORT_PROBE_QMI;
-        else if (self->priv->mbim && !g_strcmp0 (mm_kernel_device_get_driver (port), "cdc_mbim"))
-            probe_run_flags |= MM_PORT_PROBE_MBIM;
-        else
-            probe_run_flags |= MM_PORT_PROBE_AT;
-    }
-
-    /* For potential AT ports, check for more things */
-    if (probe_run_flags & MM_PORT_PROBE_AT) {
-        if (need_vendor_probing)
-            probe_run_flags |= MM_PORT_PROBE_AT_VENDOR;
-        if (need_product_probing)
-            probe_run_flags |= MM_PORT_PROBE_AT_PRODUCT;
-        if (self->priv->icera_probe || self->priv->allowed_icera || self->priv->forbidden_icera)
-            probe_run_flags |= MM_PORT_PROBE_AT_ICERA;
-        if (self->priv->xmm_probe || self->priv->allowed_xmm || self->priv->forbidden_xmm)
-            probe_run_flags |= MM_PORT_PROBE_AT_XMM;
-    }
+    probe_run_flags = build_probe_run_flags (self, port, need_vendor_probing, need_product_probing);
 
     /* If no explicit probing was required, just request to grab it without probing anything.
      * This may happen, e.g. with cdc-wdm ports which do not need QMI/MBIM probing. */
@@ -886,6 +899,75 @@ mm_plugin_discard_port_early (MMPlugin       *self,
     return MM_PLUGIN_SUPPORTS_HINT_MAYBE;
 }
 
+gboolean
+mm_plugin_get_shared_probe_flags (MMPlugin        *self,
+                                  MMDevice        *device,
+                                  MMKernelDevice  *port,
+                                  MMPortProbeFlag *flags)
+{
+    gboolean need_vendor_probing = FALSE;
+    gboolean need_product_probing = FALSE;
+
+    *flags = MM_PORT_PROBE_NONE;
+
+    /* Plugins that tweak how the AT probing is done can't share it. Neither
+     * can the ones expecting a single AT port, as they may skip the AT
+     * probing in some of the ports of the device. */
+    if (self->priv->custom_at_probe ||
+        self->priv->custom_init ||
+        self->priv->single_at ||
+        self->priv->send_delay != MM_PLUGIN_DEFAULT_SEND_DELAY ||
+        self->priv->remove_echo != MM_PLUGIN_DEFAULT_REMOVE_ECHO ||
+        self->priv->send_lf != MM_PLUGIN_DEFAULT_SEND_LF)
+        return FALSE;
+
+    /* Same logic as in mm_plugin_supports_port() */
+    if (apply_pre_probing_filters (self, device, port, &need_vendor_probing, &need_product_probing) ||
+        g_str_equal (mm_kernel_device_get_subsystem (port), "net"))
+        return TRUE;
+
+    *flags = build_probe_run_flags (self, port, need_vendor_probing, need_product_probing);
+    return TRUE;
+}
+
+gboolean
+mm_plugin_get_mandatory_filters (MMPlugin              *self,
+                                 const guint16        **vendor_ids,
+                                 const mm_uint16_pair **product_ids,
+                                 const gchar * const  **udev_tags,
+                                 const gchar * const  **drivers)
+{
+    *vendor_ids = NULL;
+    *product_ids = NULL;
+    *udev_tags = NULL;
+    *drivers = NULL;
+
+    /* Vendor and product IDs are the most selective ones, but they're only
+     * mandatory if there are no vendor/product strings to match instead, see
+     * apply_pre_probing_filters(). A port passes the filter if it matches
+     * either the vendor IDs or the product IDs. */
+    if ((self->priv->vendor_ids || self->priv->product_ids) &&
+        !self->priv->vendor_strings &&
+        !self->priv->product_strings &&
+        !self->priv->forbidden_product_strings) {
+        *vendor_ids = self->priv->vendor_ids;
+        *product_ids = self->priv->product_ids;
+        return TRUE;
+    }
+
+    if (self->priv->udev_tags) {
+        *udev_tags = (const gchar * const *) self->priv->udev_tags;
+        return TRUE;
+    }
+
+    if (self->priv->drivers) {
+        *drivers = (const gchar * const *) self->priv->drivers;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
 /*****************************************************************************/
 
 MMBaseModem *
@@ -1519,7 +1601,7 @@ mm_plugin_class_init (MMPluginClass *klass)
                               "Send delay",
                               "Send delay for characters in the AT port, "
                               "in microseconds",
-                              0, G_MAXUINT64, 100000,
+                              0, G_MAXUINT64, MM_PLUGIN_DEFAULT_SEND_DELAY,
                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 
     g_object_class_install_property
@@ -1527,7 +1609,7 @@ mm_plugin_class_init (MMPluginClass *klass)
          g_param_spec_boolean (MM_PLUGIN_REMOVE_ECHO,
                                "Remove echo",
                                "Remove echo out of the AT responses",
-                               TRUE,
+                               MM_PLUGIN_DEFAULT_REMOVE_ECHO,
                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 
     g_object_class_install_property
@@ -1535,6 +1617,6 @@ mm_plugin_class_init (MMPluginClass *klass)
          g_param_spec_boolean (MM_PLUGIN_SEND_LF,
                                "Send LF",
                                "Send line-feed at the end of each AT command sent",
-                               FALSE,
+                               MM_PLUGIN_DEFAULT_SEND_LF,
                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 }
@@ -26,6 +26,7 @@
 #include "mm-port-probe.h"
 #include "mm-device.h"
 #include "mm-kernel-device.h"
+#include "mm-private-boxed-types.h"
 
 #define MM_PLUGIN_GENERIC_NAME "Generic"
 #define MM_PLUGIN_MAJOR_VERSION 4
@@ -75,6 +76,11 @@
 #define MM_PLUGIN_REMOVE_ECHO               "remove-echo"
 #define MM_PLUGIN_SEND_LF                   "send-lf"
 
+/* Default AT port settings used during probing */
+#define MM_PLUGIN_DEFAULT_SEND_DELAY  100000
+#define MM_PLUGIN_DEFAULT_REMOVE_ECHO TRUE
+#define MM_PLUGIN_DEFAULT_SEND_LF     FALSE
+
 typedef enum {
     MM_PLUGIN_SUPPORTS_PORT_UNKNOWN = -1,
     MM_PLUGIN_SUPPORTS_PORT_UNSUPPORTED,
@@ -132,6 +138,25 @@ MMPluginSupportsHint mm_plugin_discard_port_early (MMPlugin       *plugin,
                                                    MMDevice       *device,
                                                    MMKernelDevice *port);
 
+/* Gets the probing that the plugin requires in the given port, so that it can
+ * be run once for several plugins, with the default AT port settings. Returns
+ * FALSE if the plugin doesn't allow sharing its probing; flags may be
+ * MM_PORT_PROBE_NONE if the plugin doesn't need any. */
+gboolean mm_plugin_get_shared_probe_flags (MMPlugin        *plugin,
+                                           MMDevice        *device,
+                                           MMKernelDevice  *port,
+                                           MMPortProbeFlag *flags);
+
+/* Gets the pre-probing filters that every port needs to match for the plugin
+ * to support it, so that plugins can be indexed by them. Only one kind of
+ * filter is given (vendor/product IDs, udev tags or drivers), the remaining
+ * outputs are set to NULL; returns FALSE if the plugin has none. */
+gboolean mm_plugin_get_mandatory_filters (MMPlugin              *plugin,
+                                          const guint16        **vendor_ids,
+                                          const mm_uint16_pair **product_ids,
+                                          const gchar * const  **udev_tags,
+                                          const gchar * const  **drivers);
+
 void                   mm_plugin_supports_port        (MMPlugin             *plugin,
                                                        MMDevice             *device,
                                                        MMKernelDevice       *port,
@@ -0,0 +1,421 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <gio/gio.h>
+
+#include "mm-port-probe-cache.h"
+#include "mm-log.h"
+
+G_DEFINE_TYPE (MMPortProbeCache, mm_port_probe_cache, G_TYPE_OBJECT)
+
+/* Delay writing to disk, so that all the ports of a device are written at once */
+#define SAVE_TIMEOUT_SECS 1
+
+#define KEY_FLAGS     "flags"
+#define KEY_AT        "at"
+#define KEY_VENDOR    "vendor"
+#define KEY_PRODUCT   "product"
+#define KEY_ICERA     "icera"
+#define KEY_XMM       "xmm"
+#define KEY_QCDM      "qcdm"
+#define KEY_QMI       "qmi"
+#define KEY_MBIM      "mbim"
+#define KEY_PLUGIN    "plugin"
+#define KEY_N_PORTS   "ports"
+#define KEY_DRIVER    "driver"
+#define KEY_INTERFACE "interface"
+
+struct _MMPortProbeCachePrivate {
+    gchar    *path;
+    GKeyFile *keyfile;
+    guint     save_id;
+};
+
+static void schedule_save (MMPortProbeCache *self);
+
+/*****************************************************************************/
+
+static gchar *
+build_device_group (MMKernelDevice *port)
+{
+    guint16 vid;
+    guint16 pid;
+
+    vid = mm_kernel_device_get_physdev_vid (port);
+    pid = mm_kernel_device_get_physdev_pid (port);
+    if (!vid && !pid)
+        return NULL;
+
+    return g_strdup_printf ("device %04x:%04x:%04x",
+                            vid, pid, mm_kernel_device_get_physdev_revision (port));
+}
+
+static gchar *
+build_port_group (MMKernelDevice *port)
+{
+    guint16      vid;
+    guint16      pid;
+    const gchar *interface_number;
+
+    vid = mm_kernel_device_get_physdev_vid (port);
+    pid = mm_kernel_device_get_physdev_pid (port);
+    if (!vid && !pid)
+        return NULL;
+
+    interface_number = mm_kernel_device_get_property (port, "ID_USB_INTERFACE_NUM");
+    if (!interface_number)
+        return NULL;
+
+    return g_strdup_printf ("port %04x:%04x:%04x:%s:%s",
+                            vid, pid, mm_kernel_device_get_physdev_revision (port),
+                            interface_number,
+                            mm_kernel_device_get_subsystem (port));
+}
+
+static const gchar *
+get_port_driver (MMKernelDevice *port)
+{
+    const gchar *driver;
+
+    driver = mm_kernel_device_get_driver (port);
+    return (driver ? driver : "");
+}
+
+/* Class, subclass and protocol of the USB interface */
+static gchar *
+build_port_interface (MMKernelDevice *port)
+{
+    return g_strdup_printf ("%d/%d/%d",
+                            mm_kernel_device_get_interface_class (port),
+                            mm_kernel_device_get_interface_subclass (port),
+                            mm_kernel_device_get_interface_protocol (port));
+}
+
+/* Returns the group of the results cached for the port, if any. Results
+ * stored while the port had a different driver or interface descriptor
+ * (e.g. after a kernel or firmware update) can't be trusted, so they're
+ * dropped instead. */
+static gchar *
+lookup_port_group (MMPortProbeCache *self,
+                   MMKernelDevice   *port)
+{
+    gchar       *group;
+    gchar       *cached_driver;
+    gchar       *cached_interface;
+    gchar       *interface;
+    const gchar *driver;
+
+    group = build_port_group (port);
+    if (!group)
+        return NULL;
+
+    if (!g_key_file_has_group (self->priv->keyfile, group)) {
+        g_free (group);
+        return NULL;
+    }
+
+    driver = get_port_driver (port);
+    interface = build_port_interface (port);
+    cached_driver = g_key_file_get_string (self->priv->keyfile, group, KEY_DRIVER, NULL);
+    cached_interface = g_key_file_get_string (self->priv->keyfile, group, KEY_INTERFACE, NULL);
+
+    if (g_strcmp0 (cached_driver, driver) != 0 || g_strcmp0 (cached_interface, interface) != 0) {
+        mm_dbg ("[probe cache] dropping probing results of port %s (%s): "
+                "stored for driver '%s' and interface %s, but now '%s' and %s",
+                mm_kernel_device_get_name (port), group,
+                cached_driver ? cached_driver : "", cached_interface ? cached_interface : "",
+                driver, interface);
+        g_key_file_remove_group (self->priv->keyfile, group, NULL);
+        schedule_save (self);
+        g_free (group);
+        group = NULL;
+    }
+
+    g_free (cached_interface);
+    g_free (cached_driver);
+    g_free (interface);
+    return group;
+}
+
+/*****************************************************************************/
+
+static gboolean
+save_cb (MMPortProbeCache *self)
+{
+    GError *error = NULL;
+    gchar  *dir;
+    gchar  *data;
+    gsize   len;
+
+    self->priv->save_id = 0;
+
+    dir = g_path_get_dirname (self->priv->path);
+    if (g_mkdir_with_parents (dir, 0755) < 0)
+        mm_warn ("[probe cache] couldn't create directory '%s': %s", dir, g_strerror (errno));
+    g_free (dir);
+
+    data = g_key_file_to_data (self->priv->keyfile, &len, NULL);
+    if (!g_file_set_contents (self->priv->path, data, len, &error)) {
+        mm_warn ("[probe cache] couldn't write '%s': %s", self->priv->path, error->message);
+        g_error_free (error);
+    } else
+        mm_dbg ("[probe cache] written to '%s'", self->priv->path);
+    g_free (data);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_save (MMPortProbeCache *self)
+{
+    if (!self->priv->save_id)
+        self->priv->save_id = g_timeout_add_seconds (SAVE_TIMEOUT_SECS, (GSourceFunc) save_cb, self);
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_port_probe_cache_has (MMPortProbeCache *self,
+                         MMKernelDevice   *port)
+{
+    gchar    *group;
+    gboolean  found;
+
+    g_return_val_if_fail (MM_IS_PORT_PROBE_CACHE (self), FALSE);
+
+    group = lookup_port_group (self, port);
+    found = (group && g_key_file_has_key (self->priv->keyfile, group, KEY_PLUGIN, NULL));
+    g_free (group);
+    return found;
+}
+
+void
+mm_port_probe_cache_results_clear (MMPortProbeCacheResults *results)
+{
+    g_free (results->vendor);
+    g_free (results->product);
+    memset (results, 0, sizeof (MMPortProbeCacheResults));
+}
+
+gchar *
+mm_port_probe_cache_restore (MMPortProbeCache        *self,
+                             MMKernelDevice          *port,
+                             MMPortProbeCacheResults *out_results)
+{
+    gchar *group;
+    gchar *plugin_name;
+
+    g_return_val_if_fail (MM_IS_PORT_PROBE_CACHE (self), NULL);
+    g_return_val_if_fail (out_results != NULL, NULL);
+
+    memset (out_results, 0, sizeof (MMPortProbeCacheResults));
+
+    group = lookup_port_group (self, port);
+    if (!group)
+        return NULL;
+
+    plugin_name = g_key_file_get_string (self->priv->keyfile, group, KEY_PLUGIN, NULL);
+    if (plugin_name) {
+        out_results->flags    = (guint32) g_key_file_get_integer (self->priv->keyfile, group, KEY_FLAGS, NULL);
+        out_results->is_at    = g_key_file_get_boolean (self->priv->keyfile, group, KEY_AT, NULL);
+        out_results->vendor   = g_key_file_get_string (self->priv->keyfile, group, KEY_VENDOR, NULL);
+        out_results->product  = g_key_file_get_string (self->priv->keyfile, group, KEY_PRODUCT, NULL);
+        out_results->is_icera = g_key_file_get_boolean (self->priv->keyfile, group, KEY_ICERA, NULL);
+        out_results->is_xmm   = g_key_file_get_boolean (self->priv->keyfile, group, KEY_XMM, NULL);
+        out_results->is_qcdm  = g_key_file_get_boolean (self->priv->keyfile, group, KEY_QCDM, NULL);
+        out_results->is_qmi   = g_key_file_get_boolean (self->priv->keyfile, group, KEY_QMI, NULL);
+        out_results->is_mbim  = g_key_file_get_boolean (self->priv->keyfile, group, KEY_MBIM, NULL);
+    }
+
+    g_free (group);
+    return plugin_name;
+}
+
+void
+mm_port_probe_cache_store (MMPortProbeCache              *self,
+                           MMKernelDevice                *port,
+                           const MMPortProbeCacheResults *results,
+                           const gchar                   *plugin_name)
+{
+    gchar *group;
+    gchar *interface;
+
+    g_return_if_fail (MM_IS_PORT_PROBE_CACHE (self));
+    g_return_if_fail (results != NULL);
+    g_return_if_fail (plugin_name != NULL);
+
+    group = build_port_group (port);
+    if (!group)
+        return;
+
+    /* Always start from scratch */
+    g_key_file_remove_group (self->priv->keyfile, group, NULL);
+
+    interface = build_port_interface (port);
+    g_key_file_set_string (self->priv->keyfile, group, KEY_DRIVER, get_port_driver (port));
+    g_key_file_set_string (self->priv->keyfile, group, KEY_INTERFACE, interface);
+    g_free (interface);
+
+    g_key_file_set_integer (self->priv->keyfile, group, KEY_FLAGS, (gint) results->flags);
+    g_key_file_set_boolean (self->priv->keyfile, group, KEY_AT, results->is_at);
+    if (results->vendor)
+        g_key_file_set_string (self->priv->keyfile, group, KEY_VENDOR, results->vendor);
+    if (results->product)
+        g_key_file_set_string (self->priv->keyfile, group, KEY_PRODUCT, results->product);
+    g_key_file_set_boolean (self->priv->keyfile, group, KEY_ICERA, results->is_icera);
+    g_key_file_set_boolean (self->priv->keyfile, group, KEY_XMM, results->is_xmm);
+    g_key_file_set_boolean (self->priv->keyfile, group, KEY_QCDM, results->is_qcdm);
+    g_key_file_set_boolean (self->priv->keyfile, group, KEY_QMI, results->is_qmi);
+    g_key_file_set_boolean (self->priv->keyfile, group, KEY_MBIM, results->is_mbim);
+    g_key_file_set_string (self->priv->keyfile, group, KEY_PLUGIN, plugin_name);
+
+    mm_dbg ("[probe cache] stored probing results of port %s (%s)",
+            mm_kernel_device_get_name (port), group);
+    g_free (group);
+
+    schedule_save (self);
+}
+
+void
+mm_port_probe_cache_invalidate (MMPortProbeCache *self,
+                                MMKernelDevice   *port)
+{
+    gchar *group;
+
+    g_return_if_fail (MM_IS_PORT_PROBE_CACHE (self));
+
+    group = build_port_group (port);
+    if (group && g_key_file_remove_group (self->priv->keyfile, group, NULL)) {
+        mm_dbg ("[probe cache] invalidated probing results of port %s (%s)",
+                mm_kernel_device_get_name (port), group);
+        schedule_save (self);
+    }
+    g_free (group);
+}
+
+/*****************************************************************************/
+
+guint
+mm_port_probe_cache_get_device_n_ports (MMPortProbeCache *self,
+                                        MMKernelDevice   *port)
+{
+    gchar *group;
+    gint   n_ports = 0;
+
+    g_return_val_if_fail (MM_IS_PORT_PROBE_CACHE (self), 0);
+
+    group = build_device_group (port);
+    if (group)
+        n_ports = g_key_file_get_integer (self->priv->keyfile, group, KEY_N_PORTS, NULL);
+    g_free (group);
+
+    return (guint) MAX (n_ports, 0);
+}
+
+void
+mm_port_probe_cache_set_device_n_ports (MMPortProbeCache *self,
+                                        MMKernelDevice   *port,
+                                        guint             n_ports)
+{
+    gchar *group;
+
+    g_return_if_fail (MM_IS_PORT_PROBE_CACHE (self));
+
+    group = build_device_group (port);
+    if (!group)
+        return;
+
+    if (g_key_file_get_integer (self->priv->keyfile, group, KEY_N_PORTS, NULL) != (gint) n_ports) {
+        g_key_file_set_integer (self->priv->keyfile, group, KEY_N_PORTS, (gint) n_ports);
+        schedule_save (self);
+    }
+    g_free (group);
+}
+
+/*****************************************************************************/
+
+MMPortProbeCache *
+mm_port_probe_cache_new (const gchar *path)
+{
+    MMPortProbeCache *self;
+    GError           *error = NULL;
+
+    g_return_val_if_fail (path != NULL, NULL);
+
+    self = g_object_new (MM_TYPE_PORT_PROBE_CACHE, NULL);
+    self->priv->path = g_strdup (path);
+
+    if (!g_key_file_load_from_file (self->priv->keyfile, path, G_KEY_FILE_NONE, &error)) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            mm_warn ("[probe cache] couldn't load '%s': %s", path, error->message);
+        g_error_free (error);
+    } else {
+        gchar **groups;
+        gsize   n_groups = 0;
+        guint   i;
+
+        /* Entries without driver, e.g. written by older versions, can't be
+         * validated, so just forget about them */
+        groups = g_key_file_get_groups (self->priv->keyfile, &n_groups);
+        for (i = 0; groups[i]; i++) {
+            if (g_str_has_prefix (groups[i], "port ") &&
+                !g_key_file_has_key (self->priv->keyfile, groups[i], KEY_DRIVER, NULL)) {
+                g_key_file_remove_group (self->priv->keyfile, groups[i], NULL);
+                n_groups--;
+            }
+        }
+        g_strfreev (groups);
+        mm_dbg ("[probe cache] loaded %" G_GSIZE_FORMAT " entries from '%s'", n_groups, path);
+    }
+
+    return self;
+}
+
+static void
+mm_port_probe_cache_init (MMPortProbeCache *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MM_TYPE_PORT_PROBE_CACHE, MMPortProbeCachePrivate);
+    self->priv->keyfile = g_key_file_new ();
+}
+
+static void
+finalize (GObject *object)
+{
+    MMPortProbeCache *self = MM_PORT_PROBE_CACHE (object);
+
+    /* Flush pending changes */
+    if (self->priv->save_id) {
+        g_source_remove (self->priv->save_id);
+        save_cb (self);
+    }
+
+    g_key_file_free (self->priv->keyfile);
+    g_free (self->priv->path);
+
+    G_OBJECT_CLASS (mm_port_probe_cache_parent_class)->finalize (object);
+}
+
+static void
+mm_port_probe_cache_class_init (MMPortProbeCacheClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMPortProbeCachePrivate));
+
+    object_class->finalize = finalize;
+}
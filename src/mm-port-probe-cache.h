@@ -0,0 +1,93 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_PORT_PROBE_CACHE_H
+#define MM_PORT_PROBE_CACHE_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "mm-kernel-device.h"
+
+#define MM_TYPE_PORT_PROBE_CACHE            (mm_port_probe_cache_get_type ())
+#define MM_PORT_PROBE_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_PORT_PROBE_CACHE, MMPortProbeCache))
+#define MM_PORT_PROBE_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  MM_TYPE_PORT_PROBE_CACHE, MMPortProbeCacheClass))
+#define MM_IS_PORT_PROBE_CACHE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MM_TYPE_PORT_PROBE_CACHE))
+#define MM_IS_PORT_PROBE_CACHE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_PORT_PROBE_CACHE))
+#define MM_PORT_PROBE_CACHE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_PORT_PROBE_CACHE, MMPortProbeCacheClass))
+
+typedef struct _MMPortProbeCache MMPortProbeCache;
+typedef struct _MMPortProbeCacheClass MMPortProbeCacheClass;
+typedef struct _MMPortProbeCachePrivate MMPortProbeCachePrivate;
+
+struct _MMPortProbeCache {
+    GObject parent;
+    MMPortProbeCachePrivate *priv;
+};
+
+struct _MMPortProbeCacheClass {
+    GObjectClass parent;
+};
+
+GType mm_port_probe_cache_get_type (void);
+
+/* Probing results of a port, as stored in the cache. The cache doesn't
+ * interpret them: 'flags' is the mask of MMPortProbeFlag values telling
+ * which of the results are available. */
+typedef struct {
+    guint32   flags;
+    gboolean  is_at;
+    gchar    *vendor;
+    gchar    *product;
+    gboolean  is_icera;
+    gboolean  is_xmm;
+    gboolean  is_qcdm;
+    gboolean  is_qmi;
+    gboolean  is_mbim;
+} MMPortProbeCacheResults;
+
+void mm_port_probe_cache_results_clear (MMPortProbeCacheResults *results);
+
+/* On-disk cache of the port probing results and the plugin that ended up
+ * handling each port. Ports are identified by the vid, pid and revision of
+ * the physical device, plus the interface number and subsystem of the port;
+ * ports without a vid/pid or interface number aren't cached. Results are
+ * dropped if the driver or the interface class, subclass or protocol of the
+ * port changed since they were stored; other than that, it's up to the user
+ * of the cache to validate them against the device. */
+MMPortProbeCache *mm_port_probe_cache_new (const gchar *path);
+
+/* Loads the cached results of the port, and returns the name of the plugin
+ * that handled it (empty if none did), or NULL if not cached. The results
+ * must be cleared with mm_port_probe_cache_results_clear(). */
+gchar    *mm_port_probe_cache_restore    (MMPortProbeCache              *self,
+                                          MMKernelDevice                *port,
+                                          MMPortProbeCacheResults       *out_results);
+gboolean  mm_port_probe_cache_has        (MMPortProbeCache              *self,
+                                          MMKernelDevice                *port);
+void      mm_port_probe_cache_store      (MMPortProbeCache              *self,
+                                          MMKernelDevice                *port,
+                                          const MMPortProbeCacheResults *results,
+                                          const gchar                   *plugin_name);
+void      mm_port_probe_cache_invalidate (MMPortProbeCache              *self,
+                                          MMKernelDevice                *port);
+
+/* Number of ports exposed by the physical device the port belongs to, when
+ * its support check was last completed; 0 if unknown. */
+guint mm_port_probe_cache_get_device_n_ports (MMPortProbeCache *self,
+                                              MMKernelDevice   *port);
+void  mm_port_probe_cache_set_device_n_ports (MMPortProbeCache *self,
+                                              MMKernelDevice   *port,
+                                              guint             n_ports);
+
+#endif /* MM_PORT_PROBE_CACHE_H */
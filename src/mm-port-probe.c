@@ -26,6 +26,7 @@
 
 #include <mm-errors-types.h>
 
+#include "mm-context.h"
 #include "mm-port-probe.h"
 #include "mm-log.h"
 #include "mm-port-serial-at.h"
@@ -98,6 +99,11 @@ struct _MMPortProbePrivate {
     gboolean maybe_at_ppp;
     gboolean maybe_qcdm;
 
+    /* Results restored from the probe cache, pending validation */
+    gboolean results_cached;
+    /* Restored results were found to be wrong */
+    gboolean cached_results_invalidated;
+
     /* Current probing task. Only one can be available at a time */
     GTask *task;
 };
@@ -354,11 +360,84 @@ mm_port_probe_set_result_mbim (MMPortProbe *self,
                 mm_kernel_device_get_name (self->priv->port));
 }
 
+void
+mm_port_probe_set_cached_results (MMPortProbe *self)
+{
+    g_return_if_fail (MM_IS_PORT_PROBE (self));
+
+    mm_dbg ("(%s/%s) probing results restored from cache",
+            mm_kernel_device_get_subsystem (self->priv->port),
+            mm_kernel_device_get_name (self->priv->port));
+    self->priv->results_cached = TRUE;
+    self->priv->cached_results_invalidated = FALSE;
+}
+
+gboolean
+mm_port_probe_get_cached_results_invalidated (MMPortProbe *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_PROBE (self), FALSE);
+
+    return self->priv->cached_results_invalidated;
+}
+
+guint32
+mm_port_probe_get_probed_flags (MMPortProbe *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_PROBE (self), MM_PORT_PROBE_NONE);
+
+    return self->priv->flags;
+}
+
+static void
+port_probe_reset_results (MMPortProbe *self)
+{
+    self->priv->flags = MM_PORT_PROBE_NONE;
+    self->priv->is_at = FALSE;
+    self->priv->is_qcdm = FALSE;
+    self->priv->is_qmi = FALSE;
+    self->priv->is_mbim = FALSE;
+    self->priv->is_icera = FALSE;
+    self->priv->is_xmm = FALSE;
+    g_clear_pointer (&self->priv->vendor, g_free);
+    g_clear_pointer (&self->priv->product, g_free);
+}
+
+static void
+port_probe_apply_udev_tags (MMPortProbe *self)
+{
+    /* If this is a port flagged as a GPS port, don't do any AT or QCDM probing */
+    if (self->priv->is_gps) {
+        mm_dbg ("(%s/%s) GPS port detected",
+                mm_kernel_device_get_subsystem (self->priv->port),
+                mm_kernel_device_get_name (self->priv->port));
+        mm_port_probe_set_result_at (self, FALSE);
+        mm_port_probe_set_result_qcdm (self, FALSE);
+    }
+
+    /* If this is a port flagged as being an AT port, don't do any QCDM probing */
+    if (self->priv->maybe_at_primary || self->priv->maybe_at_secondary || self->priv->maybe_at_ppp) {
+        mm_dbg ("(%s/%s) no QCDM probing in possible AT port",
+                mm_kernel_device_get_subsystem (self->priv->port),
+                mm_kernel_device_get_name (self->priv->port));
+        mm_port_probe_set_result_qcdm (self, FALSE);
+    }
+
+    /* If this is a port flagged as being a QCDM port, don't do any AT probing */
+    if (self->priv->maybe_qcdm) {
+        mm_dbg ("(%s/%s) no AT probing in possible QCDM port",
+                mm_kernel_device_get_subsystem (self->priv->port),
+                mm_kernel_device_get_name (self->priv->port));
+        mm_port_probe_set_result_at (self, FALSE);
+    }
+}
+
 /*****************************************************************************/
 
 typedef struct {
     /* ---- Generic task context ---- */
     guint32 flags;
+    /* Probings requested by the caller, including already available ones */
+    guint32 requested_flags;
     guint source_id;
     GCancellable *cancellable;
 
@@ -379,6 +458,8 @@ typedef struct {
     gboolean at_send_lf;
     /* Number of times we tried to open the AT port */
     guint at_open_tries;
+    /* Whether cached AT results need to be validated */
+    gboolean at_validate;
     /* Custom initialization setup */
     gboolean at_custom_init_run;
     MMPortProbeAtCustomInit at_custom_init;
@@ -1119,6 +1200,47 @@ static const MMPortProbeAtCommand xmm_probing[] = {
     { NULL }
 };
 
+/* Single command to check that a port restored from the cache is still AT */
+static const MMPortProbeAtCommand at_validation[] = {
+    { "AT", 3, mm_port_probe_response_processor_is_at },
+    { NULL }
+};
+
+static void
+serial_probe_at_validation_result_processor (MMPortProbe *self,
+                                             GVariant    *result)
+{
+    PortProbeRunContext *ctx;
+    guint32              i;
+
+    ctx = g_task_get_task_data (self->priv->task);
+    self->priv->results_cached = FALSE;
+
+    /* If AT probing was cancelled because some other port is already the
+     * expected single AT port, keep the cached results as they are */
+    if ((result && g_variant_get_boolean (result)) ||
+        g_cancellable_is_cancelled (ctx->at_probing_cancellable)) {
+        mm_dbg ("(%s/%s) cached probing results validated",
+                mm_kernel_device_get_subsystem (self->priv->port),
+                mm_kernel_device_get_name (self->priv->port));
+        return;
+    }
+
+    mm_dbg ("(%s/%s) cached probing results invalidated: port is not AT-capable any more",
+            mm_kernel_device_get_subsystem (self->priv->port),
+            mm_kernel_device_get_name (self->priv->port));
+    self->priv->cached_results_invalidated = TRUE;
+
+    /* Run again all the requested probings */
+    port_probe_reset_results (self);
+    port_probe_apply_udev_tags (self);
+    ctx->flags = MM_PORT_PROBE_NONE;
+    for (i = MM_PORT_PROBE_AT; i <= MM_PORT_PROBE_MBIM; i = (i << 1)) {
+        if ((ctx->requested_flags & i) && !(self->priv->flags & i))
+            ctx->flags += i;
+    }
+}
+
 static void
 at_custom_init_ready (MMPortProbe *self,
                       GAsyncResult *res)
@@ -1175,9 +1297,15 @@ serial_probe_schedule (MMPortProbe *self)
     ctx->at_commands           = NULL;
     ctx->at_commands_wait_secs = 0;
 
+    /* Cached results to validate? Do it before anything else */
+    if (ctx->at_validate) {
+        ctx->at_validate = FALSE;
+        ctx->at_result_processor = serial_probe_at_validation_result_processor;
+        ctx->at_commands = at_validation;
+    }
     /* AT check requested and not already probed? */
-    if ((ctx->flags & MM_PORT_PROBE_AT) &&
-        !(self->priv->flags & MM_PORT_PROBE_AT)) {
+    else if ((ctx->flags & MM_PORT_PROBE_AT) &&
+             !(self->priv->flags & MM_PORT_PROBE_AT)) {
         /* Prepare AT probing */
         if (ctx->at_custom_probe)
             ctx->at_commands = ctx->at_custom_probe;
@@ -1326,14 +1454,25 @@ serial_open_at (MMPortProbe *self)
 
         common_serial_port_setup (self, ctx->serial);
 
-        parser = mm_serial_parser_v1_new ();
-        mm_serial_parser_v1_add_filter (parser,
-                                        serial_parser_filter_cb,
-                                        NULL);
-        mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (ctx->serial),
-                                               mm_serial_parser_v1_parse,
-                                               parser,
-                                               mm_serial_parser_v1_destroy);
+        if (mm_context_get_serial_parser_v2 ()) {
+            parser = mm_serial_parser_v2_new ();
+            mm_serial_parser_v2_add_filter (parser,
+                                            serial_parser_filter_cb,
+                                            NULL);
+            mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (ctx->serial),
+                                                   mm_serial_parser_v2_parse,
+                                                   parser,
+                                                   mm_serial_parser_v2_destroy);
+        } else {
+            parser = mm_serial_parser_v1_new ();
+            mm_serial_parser_v1_add_filter (parser,
+                                            serial_parser_filter_cb,
+                                            NULL);
+            mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (ctx->serial),
+                                                   mm_serial_parser_v1_parse,
+                                                   parser,
+                                                   mm_serial_parser_v1_destroy);
+        }
     }
 
     /* Try to open the port */
@@ -1451,6 +1590,7 @@ mm_port_probe_run (MMPortProbe                *self,
     ctx->at_remove_echo = at_remove_echo;
     ctx->at_send_lf = at_send_lf;
     ctx->flags = MM_PORT_PROBE_NONE;
+    ctx->requested_flags = flags;
     ctx->at_custom_probe = at_custom_probe;
     ctx->at_custom_init = at_custom_init ? (MMPortProbeAtCustomInit)at_custom_init->async : NULL;
     ctx->at_custom_init_finish = at_custom_init ? (MMPortProbeAtCustomInitFinish)at_custom_init->finish : NULL;
@@ -1468,30 +1608,8 @@ mm_port_probe_run (MMPortProbe                *self,
         return;
     }
 
-    /* If this is a port flagged as a GPS port, don't do any AT or QCDM probing */
-    if (self->priv->is_gps) {
-        mm_dbg ("(%s/%s) GPS port detected",
-                mm_kernel_device_get_subsystem (self->priv->port),
-                mm_kernel_device_get_name (self->priv->port));
-        mm_port_probe_set_result_at (self, FALSE);
-        mm_port_probe_set_result_qcdm (self, FALSE);
-    }
-
-    /* If this is a port flagged as being an AT port, don't do any QCDM probing */
-    if (self->priv->maybe_at_primary || self->priv->maybe_at_secondary || self->priv->maybe_at_ppp) {
-        mm_dbg ("(%s/%s) no QCDM probing in possible AT port",
-                mm_kernel_device_get_subsystem (self->priv->port),
-                mm_kernel_device_get_name (self->priv->port));
-        mm_port_probe_set_result_qcdm (self, FALSE);
-    }
-
-    /* If this is a port flagged as being a QCDM port, don't do any AT probing */
-    if (self->priv->maybe_qcdm) {
-        mm_dbg ("(%s/%s) no AT probing in possible QCDM port",
-                mm_kernel_device_get_subsystem (self->priv->port),
-                mm_kernel_device_get_name (self->priv->port));
-        mm_port_probe_set_result_at (self, FALSE);
-    }
+    /* Apply the udev tags given to the port */
+    port_probe_apply_udev_tags (self);
 
     /* Check if we already have the requested probing results.
      * We will fix here the 'ctx->flags' so that we only request probing
@@ -1501,8 +1619,16 @@ mm_port_probe_run (MMPortProbe                *self,
             ctx->flags += i;
     }
 
+    /* AT results restored from the cache are checked with a single AT command,
+     * instead of running the whole AT probing sequence */
+    if (self->priv->results_cached &&
+        (flags & MM_PORT_PROBE_AT) &&
+        (self->priv->flags & MM_PORT_PROBE_AT) &&
+        self->priv->is_at)
+        ctx->at_validate = TRUE;
+
     /* All requested probings already available? If so, we're done */
-    if (!ctx->flags) {
+    if (!ctx->flags && !ctx->at_validate) {
         mm_dbg ("(%s/%s) port probing finished: no more probings needed",
                 mm_kernel_device_get_subsystem (self->priv->port),
                 mm_kernel_device_get_name (self->priv->port));
@@ -1512,14 +1638,16 @@ mm_port_probe_run (MMPortProbe                *self,
 
     /* Log the probes scheduled to be run */
     probe_list_str = mm_port_probe_flag_build_string_from_mask (ctx->flags);
-    mm_dbg ("(%s/%s) launching port probing: '%s'",
+    mm_dbg ("(%s/%s) launching port probing: '%s'%s",
             mm_kernel_device_get_subsystem (self->priv->port),
             mm_kernel_device_get_name (self->priv->port),
-            probe_list_str);
+            probe_list_str,
+            ctx->at_validate ? " (validating cached results)" : "");
     g_free (probe_list_str);
 
     /* If any AT probing is needed, start by opening as AT port */
-    if (ctx->flags & MM_PORT_PROBE_AT ||
+    if (ctx->at_validate ||
+        ctx->flags & MM_PORT_PROBE_AT ||
         ctx->flags & MM_PORT_PROBE_AT_VENDOR ||
         ctx->flags & MM_PORT_PROBE_AT_PRODUCT ||
         ctx->flags & MM_PORT_PROBE_AT_ICERA ||
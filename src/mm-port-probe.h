@@ -108,6 +108,13 @@ void mm_port_probe_set_result_qmi        (MMPortProbe *self,
 void mm_port_probe_set_result_mbim       (MMPortProbe *self,
                                           gboolean mbim);
 
+/* Probing results restored from the probe cache. AT results are validated
+ * with a single command the next time AT probing is run, and all the
+ * requested probings are run again if they're found to be wrong. */
+void     mm_port_probe_set_cached_results             (MMPortProbe *self);
+gboolean mm_port_probe_get_cached_results_invalidated (MMPortProbe *self);
+guint32  mm_port_probe_get_probed_flags               (MMPortProbe *self);
+
 /* Run probing */
 void     mm_port_probe_run        (MMPortProbe *self,
                                    MMPortProbeFlag flags,
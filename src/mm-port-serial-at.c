@@ -42,6 +42,16 @@ struct _MMPortSerialAtPrivate {
     GDestroyNotify response_parser_notify;
 
     GSList *unsolicited_msg_handlers;
+    /* Handlers indexed by the literal text that follows the leading <CR><LF>
+     * in their regex, and lengths of all those keys as a bitmask */
+    GHashTable *unsolicited_msg_handlers_index;
+    guint32 unsolicited_msg_handlers_key_lengths;
+    guint unsolicited_msg_handlers_generation;
+
+    /* Response string given to the parser, kept in sync with the contents of
+     * the port response buffer while no full response is found */
+    GString *response_string;
+    gboolean response_modified;
 
     MMPortSerialAtFlag flags;
 
@@ -116,6 +126,29 @@ mm_port_serial_at_remove_echo (GByteArray *response)
     }
 }
 
+static void
+string_free (GString *str)
+{
+    g_string_free (str, TRUE);
+}
+
+/* The parser may strip leading bytes (e.g. NULs) from the string even if no
+ * full response is found; if so, replace the first @len bytes of the response
+ * buffer, which the string was built from, with what the parser left. Returns
+ * the new length of that part of the buffer. */
+static gsize
+sync_response (GByteArray *response,
+               gsize len,
+               GString *string)
+{
+    if (string->len == len)
+        return len;
+
+    g_byte_array_remove_range (response, 0, len);
+    g_byte_array_prepend (response, (const guint8 *) string->str, string->len);
+    return string->len;
+}
+
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
                 GByteArray *response,
@@ -125,36 +158,123 @@ parse_response (MMPortSerial *port,
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
     GString *string;
     gsize parsed_len;
+    gsize scanned;
     GError *inner_error = NULL;
 
     g_return_val_if_fail (self->priv->response_parser_fn != NULL, FALSE);
 
     /* Remove echo */
-    if (self->priv->remove_echo)
+    if (self->priv->remove_echo) {
+        guint len = response->len;
+
         mm_port_serial_at_remove_echo (response);
+        if (response->len != len)
+            self->priv->response_modified = TRUE;
+    }
 
     /* If there's no response to receive, we're done; e.g. if we only got
      * unsolicited messages */
-    if (!response->len)
+    if (!response->len) {
+        g_clear_pointer (&self->priv->response_string, (GDestroyNotify) string_free);
         return MM_PORT_SERIAL_RESPONSE_NONE;
+    }
 
-    /* Construct the string that AT-parsing functions expect */
-    string = g_string_sized_new (response->len + 1);
-    g_string_append_len (string, (const char *) response->data, response->len);
+    /* When pipelining, the buffer may also have the responses to the commands
+     * sent afterwards, so only the bytes up to the end of the first line
+     * completing a response are consumed. The response string keeps the lines
+     * already checked, so that only the newly completed ones are given to the
+     * parser. */
+    if (mm_port_serial_get_pipeline (port)) {
+        gsize checked;
+        gsize i;
+
+        scanned = mm_port_serial_get_response_scanned (port);
+        if (!self->priv->response_string ||
+            self->priv->response_modified ||
+            scanned == 0 ||
+            self->priv->response_string->len > scanned) {
+            if (!self->priv->response_string)
+                self->priv->response_string = g_string_sized_new (response->len + 1);
+            else
+                g_string_truncate (self->priv->response_string, 0);
+        }
+        self->priv->response_modified = FALSE;
+        string = self->priv->response_string;
 
-    /* Fully cleanup the response array, we'll consider the contents we got
-     * as the full reply that the command may expect. */
-    g_byte_array_remove_range (response, 0, response->len);
+        for (i = string->len; i < response->len; i++) {
+            if (response->data[i] != '\n')
+                continue;
+
+            g_string_append_len (string, (const char *) &response->data[string->len], i + 1 - string->len);
+            if (self->priv->response_parser_fn (self->priv->response_parser_user_data, string, &inner_error)) {
+                g_byte_array_remove_range (response, 0, i + 1);
+                goto pipeline_parsed;
+            }
+            i = sync_response (response, i + 1, string) - 1;
+        }
+
+        /* Also check the trailing incomplete line, e.g. for the SMS prompt,
+         * without keeping it in the string as it may still grow */
+        checked = string->len;
+        if (checked < response->len) {
+            gsize len = response->len;
+
+            g_string_append_len (string, (const char *) &response->data[checked], len - checked);
+            if (self->priv->response_parser_fn (self->priv->response_parser_user_data, string, &inner_error)) {
+                g_byte_array_set_size (response, 0);
+                goto pipeline_parsed;
+            }
+            sync_response (response, len, string);
+            g_string_truncate (string, (checked > len - string->len) ? checked - (len - string->len) : 0);
+        }
+        return MM_PORT_SERIAL_RESPONSE_NONE;
+
+    pipeline_parsed:
+        self->priv->response_string = NULL;
+        goto parsed;
+    }
+
+    /* Construct the string that AT-parsing functions expect. If the response
+     * buffer wasn't modified since the last run, only the newly arrived bytes
+     * need to be added to the string we already had. */
+    scanned = mm_port_serial_get_response_scanned (port);
+    if (self->priv->response_string &&
+        !self->priv->response_modified &&
+        scanned > 0 &&
+        scanned <= response->len &&
+        self->priv->response_string->len == scanned) {
+        g_string_append_len (self->priv->response_string,
+                             (const char *) &response->data[scanned],
+                             response->len - scanned);
+    } else {
+        if (!self->priv->response_string)
+            self->priv->response_string = g_string_sized_new (response->len + 1);
+        else
+            g_string_truncate (self->priv->response_string, 0);
+        g_string_append_len (self->priv->response_string, (const char *) response->data, response->len);
+    }
+    self->priv->response_modified = FALSE;
+    string = self->priv->response_string;
 
     /* Parse it; returns FALSE if there is nothing we can do with this
      * response yet. */
     if (!self->priv->response_parser_fn (self->priv->response_parser_user_data, string, &inner_error)) {
-        /* Copy what we got back in the response buffer. */
-        g_byte_array_append (response, (const guint8 *) string->str, string->len);
-        g_string_free (string, TRUE);
+        /* The parser may have stripped some bytes (e.g. leading NULs) even if
+         * no full response was found; if so, copy what we got back in the
+         * response buffer. */
+        if (string->len != response->len) {
+            g_byte_array_set_size (response, 0);
+            g_byte_array_append (response, (const guint8 *) string->str, string->len);
+        }
         return MM_PORT_SERIAL_RESPONSE_NONE;
     }
 
+    /* Fully cleanup the response array, we'll consider the contents we got
+     * as the full reply that the command may expect. */
+    g_byte_array_set_size (response, 0);
+    self->priv->response_string = NULL;
+
+parsed:
     /* If we got an error, propagate it without any further response string */
     if (inner_error) {
         g_string_free (string, TRUE);
@@ -162,9 +282,12 @@ parse_response (MMPortSerial *port,
         return MM_PORT_SERIAL_RESPONSE_ERROR;
     }
 
-    /* Otherwise, build a new GByteArray considered as parsed response */
+    /* Otherwise, the string buffer becomes the parsed response, without any
+     * copy. The trailing NUL byte is kept within the array allocation so that
+     * the response can be given to the caller as a C string. */
     parsed_len = string->len;
-    *parsed_response = g_byte_array_new_take ((guint8 *) g_string_free (string, FALSE), parsed_len);
+    *parsed_response = g_byte_array_new_take ((guint8 *) g_string_free (string, FALSE), parsed_len + 1);
+    g_byte_array_set_size (*parsed_response, parsed_len);
     return MM_PORT_SERIAL_RESPONSE_BUFFER;
 }
 
@@ -176,8 +299,155 @@ typedef struct {
     gboolean enable;
     gpointer user_data;
     GDestroyNotify notify;
+    /* Literal text required right after <CR><LF> for the regex to match, if
+     * any; and index generation in which that text was last seen */
+    gchar *key;
+    guint generation;
 } MMAtUnsolicitedMsgHandler;
 
+/* Keys longer than this are truncated; must fit in the key lengths bitmask */
+#define UNSOLICITED_MSG_HANDLER_KEY_MAX_LEN 24
+
+/* Given a pattern like "\r\n\+CREG: (\d)\r\n", the literal key would be
+ * "+CREG: ". Patterns which don't start with <CR><LF>, or which have
+ * alternatives or flags changing how literals match, don't get a key, and
+ * their handlers are always run. */
+static gchar *
+unsolicited_msg_handler_build_key (GRegex *regex)
+{
+    const gchar *p;
+    GString *key;
+
+    if (g_regex_get_compile_flags (regex) & (G_REGEX_CASELESS | G_REGEX_EXTENDED))
+        return NULL;
+
+    p = g_regex_get_pattern (regex);
+    if (strchr (p, '|'))
+        return NULL;
+
+    if (g_str_has_prefix (p, "\\r\\n"))
+        p += 4;
+    else if (g_str_has_prefix (p, "\r\n"))
+        p += 2;
+    else
+        return NULL;
+
+    /* A leading capturing group is allowed, as long as it's not optional */
+    if (p[0] == '(' && p[1] != '?') {
+        const gchar *end;
+        guint level = 0;
+
+        for (end = p; *end; end++) {
+            if (*end == '\\' && *(end + 1))
+                end++;
+            else if (*end == '(')
+                level++;
+            else if (*end == ')' && --level == 0)
+                break;
+        }
+        if (!*end || end[1] == '?' || end[1] == '*' || end[1] == '{')
+            return NULL;
+        p++;
+    }
+
+    key = g_string_new (NULL);
+    while (*p && key->len < UNSOLICITED_MSG_HANDLER_KEY_MAX_LEN) {
+        gchar c;
+
+        if (*p == '\\') {
+            /* Escaped letters and digits are classes or special chars */
+            if (!p[1] || g_ascii_isalnum (p[1]))
+                break;
+            c = p[1];
+            p += 2;
+        } else if (strchr (".[]()?*+{}^$", *p))
+            break;
+        else
+            c = *p++;
+
+        /* If optional, it isn't required for the match */
+        if (*p == '?' || *p == '*' || *p == '{')
+            break;
+
+        g_string_append_c (key, c);
+
+        if (*p == '+')
+            break;
+    }
+
+    if (key->len < 2) {
+        g_string_free (key, TRUE);
+        return NULL;
+    }
+
+    return g_string_free (key, FALSE);
+}
+
+static void
+unsolicited_msg_handler_index_add (MMPortSerialAt *self,
+                                   MMAtUnsolicitedMsgHandler *handler)
+{
+    GSList *list;
+
+    handler->key = unsolicited_msg_handler_build_key (handler->regex);
+    if (!handler->key)
+        return;
+
+    if (G_UNLIKELY (!self->priv->unsolicited_msg_handlers_index))
+        self->priv->unsolicited_msg_handlers_index = g_hash_table_new_full (g_str_hash,
+                                                                            g_str_equal,
+                                                                            NULL,
+                                                                            (GDestroyNotify) g_slist_free);
+
+    /* The hash table key is owned by the first handler added with it, and
+     * handlers are never removed from the index */
+    list = g_hash_table_lookup (self->priv->unsolicited_msg_handlers_index, handler->key);
+    if (list)
+        list = g_slist_append (list, handler);
+    else
+        g_hash_table_insert (self->priv->unsolicited_msg_handlers_index,
+                             handler->key,
+                             g_slist_append (NULL, handler));
+
+    self->priv->unsolicited_msg_handlers_key_lengths |= (1 << strlen (handler->key));
+}
+
+/* Flags with the current generation all those handlers with a key found at
+ * the beginning of any line in the response */
+static void
+unsolicited_msg_handler_index_lookup (MMPortSerialAt *self,
+                                      GByteArray *response)
+{
+    gchar key[UNSOLICITED_MSG_HANDLER_KEY_MAX_LEN + 1];
+    guint i;
+
+    self->priv->unsolicited_msg_handlers_generation++;
+
+    if (!self->priv->unsolicited_msg_handlers_index || response->len < 2)
+        return;
+
+    for (i = 0; i < response->len - 1; i++) {
+        guint len;
+        guint start;
+
+        if (response->data[i] != '\r' || response->data[i + 1] != '\n')
+            continue;
+
+        start = i + 2;
+        for (len = 2; len <= UNSOLICITED_MSG_HANDLER_KEY_MAX_LEN && start + len <= response->len; len++) {
+            GSList *l;
+
+            if (!(self->priv->unsolicited_msg_handlers_key_lengths & (1 << len)))
+                continue;
+
+            memcpy (key, &response->data[start], len);
+            key[len] = '\0';
+            for (l = g_hash_table_lookup (self->priv->unsolicited_msg_handlers_index, key); l; l = g_slist_next (l))
+                ((MMAtUnsolicitedMsgHandler *) l->data)->generation = self->priv->unsolicited_msg_handlers_generation;
+        }
+    }
+}
+
 static gint
 unsolicited_msg_handler_cmp (MMAtUnsolicitedMsgHandler *handler,
                              GRegex *regex)
@@ -211,9 +481,10 @@ mm_port_serial_at_add_unsolicited_msg_handler (MMPortSerialAt *self,
         /* The new handler is always PREPENDED, so that e.g. plugins can provide
          * more specific matches for URCs that are also handled by the generic
          * plugin. */
-        handler = g_slice_new (MMAtUnsolicitedMsgHandler);
+        handler = g_slice_new0 (MMAtUnsolicitedMsgHandler);
         handler->regex = g_regex_ref (regex);
         self->priv->unsolicited_msg_handlers = g_slist_prepend (self->priv->unsolicited_msg_handlers, handler);
+        unsolicited_msg_handler_index_add (self, handler);
     }
 
     handler->callback = callback;
@@ -262,11 +533,17 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
     GSList *iter;
+    guint len;
+
+    len = response->len;
 
     /* Remove echo */
     if (self->priv->remove_echo)
         mm_port_serial_at_remove_echo (response);
 
+    /* Find which indexed handlers may match */
+    unsolicited_msg_handler_index_lookup (self, response);
+
     for (iter = self->priv->unsolicited_msg_handlers; iter; iter = iter->next) {
         MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) iter->data;
         GMatchInfo *match_info;
@@ -275,6 +552,10 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
         if (!handler->enable)
             continue;
 
+        /* Skip if the literal text required by the regex isn't in the response */
+        if (handler->key && handler->generation != self->priv->unsolicited_msg_handlers_generation)
+            continue;
+
         matches = g_regex_match_full (handler->regex,
                                       (const char *) response->data,
                                       response->len,
@@ -302,8 +583,16 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
             g_byte_array_remove_range (response, 0, response->len);
             g_byte_array_append (response, (const guint8 *) str, result_len);
             g_free (str);
+
+            /* Removing the matches may have left new lines in place, e.g.
+             * joining the text before and after the match */
+            unsolicited_msg_handler_index_lookup (self, response);
         }
     }
+
+    /* Let the response parser know it cannot reuse what it already had */
+    if (response->len != len)
+        self->priv->response_modified = TRUE;
 }
 
 /*****************************************************************************/
@@ -348,19 +637,13 @@ mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                   GAsyncResult *res,
                                   GError **error)
 {
-    GString *str;
+    GByteArray *response;
 
     if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
         return NULL;
 
-    str = (GString *)g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
-    return str->str;
-}
-
-static void
-string_free (GString *str)
-{
-    g_string_free (str, TRUE);
+    response = (GByteArray *)g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
+    return (const gchar *)response->data;
 }
 
 static void
@@ -370,7 +653,6 @@ serial_command_ready (MMPortSerial *port,
 {
     GByteArray *response_buffer;
     GError *error = NULL;
-    GString *response;
 
     response_buffer = mm_port_serial_command_finish (port, res, &error);
     if (!response_buffer) {
@@ -380,16 +662,17 @@ serial_command_ready (MMPortSerial *port,
         return;
     }
 
-    /* Build a GString just with the response we need, and clear the
-     * processed range from the response buffer */
-    response = g_string_new_len ((const gchar *)response_buffer->data, response_buffer->len);
-    if (response_buffer->len > 0)
-        g_byte_array_remove_range (response_buffer, 0, response_buffer->len);
-    g_byte_array_unref (response_buffer);
+    /* The response buffer is given to the caller as a C string, without
+     * copying it. Responses built by the parser already have the NUL byte
+     * right after the data, so this doesn't reallocate in that case. The
+     * buffer may be shared with the port reply cache, so its length is left
+     * untouched. */
+    g_byte_array_append (response_buffer, (const guint8 *) "", 1);
+    g_byte_array_set_size (response_buffer, response_buffer->len - 1);
 
     g_simple_async_result_set_op_res_gpointer (simple,
-                                               response,
-                                               (GDestroyNotify)string_free);
+                                               response_buffer,
+                                               (GDestroyNotify)g_byte_array_unref);
     g_simple_async_result_complete (simple);
     g_object_unref (simple);
 }
@@ -611,6 +894,9 @@ finalize (GObject *object)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (object);
 
+    if (self->priv->unsolicited_msg_handlers_index)
+        g_hash_table_unref (self->priv->unsolicited_msg_handlers_index);
+
     while (self->priv->unsolicited_msg_handlers) {
         MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) self->priv->unsolicited_msg_handlers->data;
 
@@ -618,6 +904,7 @@ finalize (GObject *object)
             handler->notify (handler->user_data);
 
         g_regex_unref (handler->regex);
+        g_free (handler->key);
         g_slice_free (MMAtUnsolicitedMsgHandler, handler);
         self->priv->unsolicited_msg_handlers = g_slist_delete_link (self->priv->unsolicited_msg_handlers,
                                                                     self->priv->unsolicited_msg_handlers);
@@ -626,6 +913,9 @@ finalize (GObject *object)
     if (self->priv->response_parser_notify)
         self->priv->response_parser_notify (self->priv->response_parser_user_data);
 
+    if (self->priv->response_string)
+        g_string_free (self->priv->response_string, TRUE);
+
     g_strfreev (self->priv->init_sequence);
 
     G_OBJECT_CLASS (mm_port_serial_at_parent_class)->finalize (object);
@@ -103,6 +103,9 @@ void         mm_port_serial_at_command        (MMPortSerialAt *self,
                                                GCancellable *cancellable,
                                                GAsyncReadyCallback callback,
                                                gpointer user_data);
+/* The returned string is not a copy: it is owned by the async result and may
+ * be shared with the reply cache, so it must not be modified or used once the
+ * callback returns */
 const gchar *mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                                GAsyncResult *res,
                                                GError **error);
@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "mm-port-serial-gps.h"
+#include "mm-modem-helpers.h"
 #include "mm-log.h"
 
 G_DEFINE_TYPE (MMPortSerialGps, mm_port_serial_gps, MM_TYPE_PORT_SERIAL)
@@ -28,9 +29,6 @@ struct _MMPortSerialGpsPrivate {
     MMPortSerialGpsTraceFn callback;
     gpointer user_data;
     GDestroyNotify notify;
-
-    /* Regex for all known traces */
-    GRegex *known_traces_regex;
 };
 
 /*****************************************************************************/
@@ -53,21 +51,6 @@ mm_port_serial_gps_add_trace_handler (MMPortSerialGps *self,
 
 /*****************************************************************************/
 
-static gboolean
-remove_eval_cb (const GMatchInfo *match_info,
-                GString *result,
-                gpointer user_data)
-{
-    int *result_len = (int *) user_data;
-    int start;
-    int end;
-
-    if (g_match_info_fetch_pos  (match_info, 0, &start, &end))
-        *result_len -= (end - start);
-
-    return FALSE;
-}
-
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
                 GByteArray *response,
@@ -75,61 +58,71 @@ parse_response (MMPortSerial *port,
                 GError **error)
 {
     MMPortSerialGps *self = MM_PORT_SERIAL_GPS (port);
-    gboolean matches;
-    GMatchInfo *match_info;
-    gchar *str;
-    gint result_len;
+    GByteArray *parsed = NULL;
+    gsize consumed = 0;
+    gsize offset;
+    gsize start;
+    gsize end;
+    gboolean valid;
     guint i;
 
+    /* No trace was found in the bytes already scanned, so a new one may only
+     * start after the last line feed found in them */
+    offset = mm_port_serial_get_response_scanned (port);
+    while (offset > 0 && response->data[offset - 1] != '\n')
+        offset--;
+
     for (i = 0; i < response->len; i++) {
         /* If there is any content before the first $,
          * assume it's garbage, and skip it */
         if (response->data[i] == '$') {
-            if (i > 0)
+            if (i > 0) {
                 g_byte_array_remove_range (response, 0, i);
+                offset = (offset > i ? offset - i : 0);
+            }
             /* else, good, we're already started with $ */
             break;
         }
     }
 
-    matches = g_regex_match_full (self->priv->known_traces_regex,
-                                  (const gchar *) response->data,
-                                  response->len,
-                                  0, 0, &match_info, NULL);
+    /* Keep a NUL byte right after the contents, so that each trace can be
+     * given to the handler in place, without copying it */
+    g_byte_array_append (response, (const guint8 *) "", 1);
+    g_byte_array_set_size (response, response->len - 1);
+
+    while (mm_nmea_sentence_find ((const gchar *) response->data, response->len, offset, &start, &end, &valid)) {
+        /* Whatever is found in between traces is not a trace */
+        if (start > consumed) {
+            if (!parsed)
+                parsed = g_byte_array_sized_new (start - consumed);
+            g_byte_array_append (parsed, &response->data[consumed], start - consumed);
+        }
 
-    if (self->priv->callback) {
-        while (g_match_info_matches (match_info)) {
-            gchar *trace;
+        if (!valid)
+            mm_dbg ("(%s): ignoring NMEA trace with invalid checksum",
+                    mm_port_get_device (MM_PORT (port)));
+        else if (self->priv->callback) {
+            guint8 next;
 
-            trace = g_match_info_fetch (match_info, 0);
-            if (trace) {
-                self->priv->callback (self, trace, self->priv->user_data);
-                g_free (trace);
-            }
-            g_match_info_next (match_info, NULL);
+            next = response->data[end];
+            response->data[end] = '\0';
+            self->priv->callback (self, (const gchar *) &response->data[start], self->priv->user_data);
+            response->data[end] = next;
         }
-    }
 
-    g_match_info_free (match_info);
+        consumed = offset = end;
+    }
 
-    if (!matches)
+    if (!consumed)
         return MM_PORT_SERIAL_RESPONSE_NONE;
 
-    /* Remove matches */
-    result_len = response->len;
-    str = g_regex_replace_eval (self->priv->known_traces_regex,
-                                (const char *) response->data,
-                                response->len,
-                                0, 0,
-                                remove_eval_cb, &result_len, NULL);
-
-    /* Cleanup response buffer */
-    g_byte_array_remove_range (response, 0, response->len);
+    /* An incomplete trace at the end is kept until the rest arrives */
+    g_byte_array_remove_range (response, 0, consumed);
 
     /* Build parsed response */
-    *parsed_response = g_byte_array_new_take ((guint8 *)str, result_len);
+    *parsed_response = (parsed ? parsed : g_byte_array_new ());
 
-    return TRUE;
+    return MM_PORT_SERIAL_RESPONSE_BUFFER;
 }
 
 /*****************************************************************************/
@@ -183,13 +176,6 @@ mm_port_serial_gps_init (MMPortSerialGps *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_PORT_SERIAL_GPS,
                                               MMPortSerialGpsPrivate);
-
-    /* We'll assume that all traces start with the dollar sign and end with \r\n */
-    self->priv->known_traces_regex =
-        g_regex_new ("\\$.*\\r\\n",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                     0,
-                     NULL);
 }
 
 static void
@@ -200,8 +186,6 @@ finalize (GObject *object)
     if (self->priv->notify)
         self->priv->notify (self->priv->user_data);
 
-    g_regex_unref (self->priv->known_traces_regex);
-
     G_OBJECT_CLASS (mm_port_serial_gps_parent_class)->finalize (object);
 }
 
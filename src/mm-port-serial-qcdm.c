@@ -33,14 +33,19 @@ G_DEFINE_TYPE (MMPortSerialQcdm, mm_port_serial_qcdm, MM_TYPE_PORT_SERIAL)
 
 struct _MMPortSerialQcdmPrivate {
     GSList *unsolicited_msg_handlers;
+
+    /* Length of the response buffer already scanned without finding a frame,
+     * and position of the last frame marker found in it */
+    gsize scan_end;
+    gssize scan_last;
 };
 
 /*****************************************************************************/
 
 static gboolean
-find_qcdm_start (GByteArray *response, gsize *start)
+find_qcdm_start (GByteArray *response, gsize from, gssize *last, gsize *start)
 {
-    int i, last = -1;
+    gsize i;
 
     /* Look for 3 bytes and a QCDM frame marker, ie enough data for a valid
      * frame.  There will usually be three cases here; (1) a QCDM frame
@@ -48,24 +53,25 @@ find_qcdm_start (GByteArray *response, gsize *start)
      * with 0x7E and ending with 0x7E, and (3) a non-QCDM frame that still
      * uses HDLC framing (like Sierra CnS) that starts and ends with 0x7E.
      */
-    for (i = 0; i < response->len; i++) {
+    for (i = from; i < response->len; i++) {
         if (response->data[i] == 0x7E) {
-            if (i > last + 3) {
+            if ((gssize) i > *last + 3) {
                 /* Got a full QCDM frame; 3 non-0x7E bytes and a terminator */
                 if (start)
-                    *start = last + 1;
+                    *start = *last + 1;
                 return TRUE;
             }
 
             /* Save position of the last QCDM frame marker */
-            last = i;
+            *last = i;
         }
     }
     return FALSE;
 }
 
 static MMPortSerialResponseType
-parse_qcdm (GByteArray *response,
+parse_qcdm (MMPortSerialQcdm *self,
+            GByteArray *response,
             gboolean want_log,
             GByteArray **parsed_response,
             GError **error)
@@ -75,15 +81,31 @@ parse_qcdm (GByteArray *response,
     gsize unescaped_len = 0;
     guint8 *unescaped_buffer;
     qcdmbool more = FALSE;
+    gsize scanned;
+
+    /* If no frame was found in the bytes already scanned and the buffer wasn't
+     * modified since then, only the newly arrived bytes need to be looked at */
+    scanned = mm_port_serial_get_response_scanned (MM_PORT_SERIAL (self));
+    if (scanned == 0 ||
+        self->priv->scan_end < scanned ||
+        self->priv->scan_end > response->len) {
+        self->priv->scan_end = 0;
+        self->priv->scan_last = -1;
+    }
 
     /* Get the offset into the buffer of where the QCDM frame starts */
-    if (!find_qcdm_start (response, &start)) {
+    if (!find_qcdm_start (response, self->priv->scan_end, &self->priv->scan_last, &start)) {
         /* Discard the unparsable data right away, we do need a QCDM
          * start, and anything that comes before it is unknown data
          * that we'll never use. */
+        self->priv->scan_end = response->len;
         return MM_PORT_SERIAL_RESPONSE_NONE;
     }
 
+    /* The buffer is about to be modified, so scan it all again next time */
+    self->priv->scan_end = 0;
+    self->priv->scan_last = -1;
+
     /* If there is anything before the start marker, remove it */
     g_byte_array_remove_range (response, 0, start);
     if (response->len == 0)
@@ -143,7 +165,7 @@ parse_response (MMPortSerial *port,
                 GByteArray **parsed_response,
                 GError **error)
 {
-    return parse_qcdm (response, FALSE, parsed_response, error);
+    return parse_qcdm (MM_PORT_SERIAL_QCDM (port), response, FALSE, parsed_response, error);
 }
 
 /*****************************************************************************/
@@ -293,7 +315,8 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
     GByteArray *log_buffer = NULL;
     GSList *iter;
 
-    if (parse_qcdm (response,
+    if (parse_qcdm (self,
+                    response,
                     TRUE,
                     &log_buffer,
                     NULL) != MM_PORT_SERIAL_RESPONSE_BUFFER) {
@@ -372,6 +395,7 @@ static void
 mm_port_serial_qcdm_init (MMPortSerialQcdm *self)
 {
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MM_TYPE_PORT_SERIAL_QCDM, MMPortSerialQcdmPrivate);
+    self->priv->scan_last = -1;
 }
 
 static void
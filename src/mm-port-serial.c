@@ -45,6 +45,7 @@ static void     port_serial_reopen_cancel          (MMPortSerial *self);
 static void     port_serial_set_cached_reply       (MMPortSerial *self,
                                                     const GByteArray *command,
                                                     const GByteArray *response);
+static void     port_serial_pipeline_commands      (MMPortSerial *self);
 
 G_DEFINE_TYPE (MMPortSerial, mm_port_serial, MM_TYPE_PORT)
 
@@ -59,6 +60,7 @@ enum {
     PROP_FD,
     PROP_SPEW_CONTROL,
     PROP_FLASH_OK,
+    PROP_PIPELINE,
 
     LAST_PROP
 };
@@ -82,6 +84,9 @@ struct _MMPortSerialPrivate {
     GHashTable *reply_cache;
     GQueue *queue;
     GByteArray *response;
+    /* Leading bytes of the response buffer already given to the parsers and
+     * left untouched by them */
+    gsize response_scanned;
 
     /* For real ports, iochannel, and we implement the eagain limit */
     GIOChannel *iochannel;
@@ -100,6 +105,10 @@ struct _MMPortSerialPrivate {
     guint64 send_delay;
     gboolean spew_control;
     gboolean flash_ok;
+    gboolean pipeline;
+    /* Set when commands already pipelined had to be aborted; no more commands
+     * are pipelined until one gets its response again */
+    gboolean pipeline_suspended;
 
     guint queue_id;
     guint timeout_id;
@@ -130,6 +139,8 @@ typedef struct {
     guint32 idx;
     gboolean started;
     gboolean done;
+    /* Sent before the previous command got its response */
+    gboolean pipelined;
 } CommandContext;
 
 static void
@@ -207,6 +218,10 @@ mm_port_serial_command (MMPortSerial *self,
 
     if (g_queue_get_length (self->priv->queue) == 1)
         port_serial_schedule_queue_process (self, 0);
+    else if (self->priv->timeout_id)
+        /* The command at the head of the queue is already waiting for its
+         * response, so if pipelining this one may be sent right away */
+        port_serial_pipeline_commands (self);
 }
 
 /*****************************************************************************/
@@ -672,14 +687,13 @@ port_serial_set_cached_reply (MMPortSerial *self,
     g_return_if_fail (MM_IS_PORT_SERIAL (self));
     g_return_if_fail (command != NULL);
 
-    if (response) {
-        GByteArray *cmd_copy = g_byte_array_sized_new (command->len);
-        GByteArray *rsp_copy = g_byte_array_sized_new (response->len);
-
-        g_byte_array_append (cmd_copy, command->data, command->len);
-        g_byte_array_append (rsp_copy, response->data, response->len);
-        g_hash_table_insert (self->priv->reply_cache, cmd_copy, rsp_copy);
-    } else
+    /* Neither the command nor the parsed response are modified once the
+     * command has been queued, so just keep a reference of them */
+    if (response)
+        g_hash_table_insert (self->priv->reply_cache,
+                             g_byte_array_ref ((GByteArray *) command),
+                             g_byte_array_ref ((GByteArray *) response));
+    else
         g_hash_table_remove (self->priv->reply_cache, command);
 }
 
@@ -744,7 +758,19 @@ port_serial_got_response (MMPortSerial *self,
             /* Complete the command context with the appropriate result */
             if (error)
                 g_simple_async_result_set_from_error (ctx->result, error);
+            else if (ctx->pipelined && ctx->cancellable && g_cancellable_is_cancelled (ctx->cancellable))
+                /* Pipelined commands don't stop waiting for the response when
+                 * cancelled, as it would be given to the next command */
+                g_simple_async_result_set_error (ctx->result,
+                                                 MM_CORE_ERROR,
+                                                 MM_CORE_ERROR_CANCELLED,
+                                                 "Waiting for the reply cancelled");
             else {
+                /* Responses are matched to commands again */
+                if (self->priv->pipeline_suspended) {
+                    mm_dbg ("(%s): resuming command pipelining", mm_port_get_device (MM_PORT (self)));
+                    self->priv->pipeline_suspended = FALSE;
+                }
                 if (ctx->allow_cached)
                     port_serial_set_cached_reply (self, ctx->command, parsed_response);
                 g_simple_async_result_set_op_res_gpointer (ctx->result,
@@ -755,7 +781,9 @@ port_serial_got_response (MMPortSerial *self,
             /* Don't complete in idle. We need the caller remove the response range which
              * was processed, and that must be done before processing any new queued command */
             command_context_complete_and_free (ctx, FALSE);
-        }
+        } else if (parsed_response)
+            mm_dbg ("(%s): dropping response with no command waiting for it",
+                    mm_port_get_device (MM_PORT (self)));
 
         if (!g_queue_is_empty (self->priv->queue))
             port_serial_schedule_queue_process (self, 0);
@@ -763,11 +791,48 @@ port_serial_got_response (MMPortSerial *self,
     g_object_unref (self);
 }
 
+/* When the command waiting for a response fails without one, the responses
+ * to the commands already pipelined after it can no longer be matched, so
+ * those commands are failed as well */
+static gboolean
+port_serial_suspend_pipeline (MMPortSerial *self)
+{
+    GList *l;
+
+    l = g_queue_peek_head_link (self->priv->queue);
+    if (!l || !l->next || !((CommandContext *) l->next->data)->pipelined)
+        return FALSE;
+
+    mm_dbg ("(%s): suspending command pipelining", mm_port_get_device (MM_PORT (self)));
+    self->priv->pipeline_suspended = TRUE;
+
+    /* Whatever is in the buffer belongs to the failed commands */
+    g_byte_array_set_size (self->priv->response, 0);
+    self->priv->response_scanned = 0;
+    return TRUE;
+}
+
+static void
+port_serial_abort_pipelined_commands (MMPortSerial *self)
+{
+    CommandContext *ctx;
+
+    while ((ctx = (CommandContext *) g_queue_peek_head (self->priv->queue)) != NULL && ctx->pipelined) {
+        g_queue_pop_head (self->priv->queue);
+        g_simple_async_result_set_error (ctx->result,
+                                         MM_SERIAL_ERROR,
+                                         MM_SERIAL_ERROR_RESPONSE_TIMEOUT,
+                                         "Serial command aborted: response lost after a previous command failed");
+        command_context_complete_and_free (ctx, TRUE);
+    }
+}
+
 static gboolean
 port_serial_timed_out (gpointer data)
 {
     MMPortSerial *self = MM_PORT_SERIAL (data);
     GError *error;
+    gboolean pipelined;
 
     self->priv->timeout_id = 0;
 
@@ -784,7 +849,10 @@ port_serial_timed_out (gpointer data)
     /* Make sure we have a valid reference when emitting the signal */
     g_object_ref (self);
     {
+        pipelined = port_serial_suspend_pipeline (self);
         port_serial_got_response (self, NULL, error);
+        if (pipelined)
+            port_serial_abort_pipelined_commands (self);
 
         /* Emit a timed out signal, used by upper layers to identify a disconnected
          * serial port */
@@ -802,6 +870,7 @@ port_serial_response_wait_cancelled (GCancellable *cancellable,
                                      MMPortSerial *self)
 {
     GError *error;
+    gboolean pipelined;
 
     /* We don't want to call disconnect () while in the signal handler */
     self->priv->cancellable_id = 0;
@@ -812,11 +881,61 @@ port_serial_response_wait_cancelled (GCancellable *cancellable,
     error = g_error_new_literal (MM_CORE_ERROR,
                                  MM_CORE_ERROR_CANCELLED,
                                  "Waiting for the reply cancelled");
-    /* Note: may complete last operation and unref the MMPortSerial */
-    port_serial_got_response (self, NULL, error);
+    g_object_ref (self);
+    {
+        pipelined = port_serial_suspend_pipeline (self);
+        port_serial_got_response (self, NULL, error);
+        if (pipelined)
+            port_serial_abort_pipelined_commands (self);
+    }
+    g_object_unref (self);
     g_error_free (error);
 }
 
+/* Send right away the commands queued after the one waiting for a response,
+ * as long as they can be fully written in one go */
+static void
+port_serial_pipeline_commands (MMPortSerial *self)
+{
+    GList *l;
+
+    if (!self->priv->pipeline || self->priv->pipeline_suspended)
+        return;
+
+    if (self->priv->send_delay > 0 && mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY)
+        return;
+
+    for (l = g_list_next (g_queue_peek_head_link (self->priv->queue)); l; l = g_list_next (l)) {
+        CommandContext *ctx = (CommandContext *) l->data;
+        GError *error = NULL;
+
+        if (ctx->done)
+            continue;
+
+        /* Commands with a cached reply or already cancelled are completed
+         * without being sent once they get to the head of the queue, so the
+         * ones after them cannot be sent yet */
+        if (ctx->allow_cached && port_serial_get_cached_reply (self, ctx->command))
+            break;
+        if (ctx->cancellable && g_cancellable_is_cancelled (ctx->cancellable))
+            break;
+
+        /* On error, the command will be retried when it gets to the head of
+         * the queue, and the error reported then */
+        if (!port_serial_process_command (self, ctx, &error)) {
+            mm_dbg ("(%s): couldn't pipeline command: %s",
+                    mm_port_get_device (MM_PORT (self)), error->message);
+            g_error_free (error);
+            break;
+        }
+
+        if (!ctx->done)
+            break;
+
+        ctx->pipelined = TRUE;
+    }
+}
+
 static gboolean
 port_serial_queue_process (gpointer data)
 {
@@ -830,73 +949,80 @@ port_serial_queue_process (gpointer data)
     if (!ctx)
         return G_SOURCE_REMOVE;
 
-    if (ctx->allow_cached) {
-        const GByteArray *cached;
+    /* Pipelined commands were already sent, just wait for the response */
+    if (!ctx->pipelined) {
+        if (ctx->allow_cached) {
+            const GByteArray *cached;
+
+            cached = port_serial_get_cached_reply (self, ctx->command);
+            if (cached) {
+                GByteArray *parsed_response;
+
+                /* The cached reply is shared with the caller, not copied; keep
+                 * our own reference as it may be replaced in the cache */
+                parsed_response = g_byte_array_ref ((GByteArray *) cached);
+                /* Note: may complete last operation and unref the MMPortSerial */
+                port_serial_got_response (self, parsed_response, NULL);
+                g_byte_array_unref (parsed_response);
+                return G_SOURCE_REMOVE;
+            }
 
-        cached = port_serial_get_cached_reply (self, ctx->command);
-        if (cached) {
-            GByteArray *parsed_response;
+            /* Cached reply wasn't found, keep on */
+        }
 
-            parsed_response = g_byte_array_sized_new (cached->len);
-            g_byte_array_append (parsed_response, cached->data, cached->len);
+        /* If error, report it */
+        if (!port_serial_process_command (self, ctx, &error)) {
             /* Note: may complete last operation and unref the MMPortSerial */
-            port_serial_got_response (self, parsed_response, NULL);
-            g_byte_array_unref (parsed_response);
+            port_serial_got_response (self, NULL, error);
+            g_error_free (error);
             return G_SOURCE_REMOVE;
         }
 
-        /* Cached reply wasn't found, keep on */
-    }
-
-    /* If error, report it */
-    if (!port_serial_process_command (self, ctx, &error)) {
-        /* Note: may complete last operation and unref the MMPortSerial */
-        port_serial_got_response (self, NULL, error);
-        g_error_free (error);
-        return G_SOURCE_REMOVE;
-    }
-
-    /* Schedule the next byte of the command to be sent */
-    if (!ctx->done) {
-        port_serial_schedule_queue_process (self,
-                                            (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
-                                             self->priv->send_delay / 1000 :
-                                             0));
-        return G_SOURCE_REMOVE;
-    }
-
-    /* Setup the cancellable so that we can stop waiting for a response */
-    if (ctx->cancellable) {
-        gulong cancellable_id;
+        /* Schedule the next byte of the command to be sent */
+        if (!ctx->done) {
+            port_serial_schedule_queue_process (self,
+                                                (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
+                                                 self->priv->send_delay / 1000 :
+                                                 0));
+            return G_SOURCE_REMOVE;
+        }
 
-        self->priv->cancellable = g_object_ref (ctx->cancellable);
+        /* Setup the cancellable so that we can stop waiting for a response */
+        if (ctx->cancellable) {
+            gulong cancellable_id;
 
-        /* If the GCancellable is already cancelled here, the callback will be
-         * called right away, and a GError will be propagated as response. In
-         * this case we need to completely avoid doing anything else with the
-         * MMPortSerial, as it may already be disposed.
-         * So, use an intermediate variable to store the cancellable id, and
-         * just return without further processing if we're already cancelled.
-         */
-        cancellable_id = g_cancellable_connect (ctx->cancellable,
-                                                (GCallback)port_serial_response_wait_cancelled,
-                                                self,
-                                                NULL);
-        if (!cancellable_id)
-            return G_SOURCE_REMOVE;
+            self->priv->cancellable = g_object_ref (ctx->cancellable);
 
-        self->priv->cancellable_id = cancellable_id;
+            /* If the GCancellable is already cancelled here, the callback will be
+             * called right away, and a GError will be propagated as response. In
+             * this case we need to completely avoid doing anything else with the
+             * MMPortSerial, as it may already be disposed.
+             * So, use an intermediate variable to store the cancellable id, and
+             * just return without further processing if we're already cancelled.
+             */
+            cancellable_id = g_cancellable_connect (ctx->cancellable,
+                                                    (GCallback)port_serial_response_wait_cancelled,
+                                                    self,
+                                                    NULL);
+            if (!cancellable_id)
+                return G_SOURCE_REMOVE;
+
+            self->priv->cancellable_id = cancellable_id;
+        }
     }
 
     /* If the command is finished being sent, schedule the timeout */
     self->priv->timeout_id = g_timeout_add_seconds (ctx->timeout,
                                                     port_serial_timed_out,
                                                     self);
+
+    /* And if pipelining, send the following ones right away */
+    port_serial_pipeline_commands (self);
     return G_SOURCE_REMOVE;
 }
 
-static void
-parse_response_buffer (MMPortSerial *self)
+static gboolean
+parse_response_buffer_once (MMPortSerial *self)
 {
     GError *error = NULL;
     GByteArray *parsed_response = NULL;
@@ -922,25 +1048,45 @@ parse_response_buffer (MMPortSerial *self)
                                                              &parsed_response,
                                                              &error)) {
     case MM_PORT_SERIAL_RESPONSE_BUFFER:
-        /* We have a valid response to process */
+        /* We have a valid response to process; whatever is left in the buffer
+         * hasn't been fully parsed yet */
         g_assert (parsed_response);
+        self->priv->response_scanned = 0;
         self->priv->n_consecutive_timeouts = 0;
         /* Note: may complete last operation and unref the MMPortSerial */
         port_serial_got_response (self, parsed_response, NULL);
         g_byte_array_unref (parsed_response);
-        break;
+        return TRUE;
     case MM_PORT_SERIAL_RESPONSE_ERROR:
         /* We have an error to process */
         g_assert (error);
+        self->priv->response_scanned = 0;
         self->priv->n_consecutive_timeouts = 0;
         /* Note: may complete last operation and unref the MMPortSerial */
         port_serial_got_response (self, NULL, error);
         g_error_free (error);
-        break;
+        return TRUE;
     case MM_PORT_SERIAL_RESPONSE_NONE:
-        /* Nothing to do this time */
-        break;
+        /* Nothing to do this time; next time only the newly arrived bytes
+         * need to be looked at */
+        self->priv->response_scanned = self->priv->response->len;
+        return FALSE;
     }
+
+    g_assert_not_reached ();
+}
+
+static void
+parse_response_buffer (MMPortSerial *self)
+{
+    /* When pipelining, the buffer may also have the responses to the commands
+     * sent after the one just completed, or late responses to commands that
+     * were already aborted, which are dropped if no command is waiting. The
+     * caller holds a reference, so the port is still valid after the
+     * completion. */
+    while (parse_response_buffer_once (self) &&
+           self->priv->pipeline &&
+           self->priv->response->len > 0);
 }
 
 static gboolean
@@ -960,15 +1106,15 @@ common_input_available (MMPortSerial *self,
         device = mm_port_get_device (MM_PORT (self));
         mm_dbg ("(%s) unexpected port hangup!", device);
 
-        if (self->priv->response->len)
-            g_byte_array_remove_range (self->priv->response, 0, self->priv->response->len);
+        g_byte_array_set_size (self->priv->response, 0);
+        self->priv->response_scanned = 0;
         port_serial_close_force (self);
         return G_SOURCE_REMOVE;
     }
 
     if (condition & G_IO_ERR) {
-        if (self->priv->response->len)
-            g_byte_array_remove_range (self->priv->response, 0, self->priv->response->len);
+        g_byte_array_set_size (self->priv->response, 0);
+        self->priv->response_scanned = 0;
         return G_SOURCE_CONTINUE;
     }
 
@@ -1031,6 +1177,7 @@ common_input_available (MMPortSerial *self,
             /* Notify listeners and then trim the buffer */
             g_signal_emit (self, signals[BUFFER_FULL], 0, self->priv->response);
             g_byte_array_remove_range (self->priv->response, 0, (SERIAL_BUF_SIZE / 2));
+            self->priv->response_scanned = 0;
         }
 
         /* See if we can parse anything. The response parsing may actually
@@ -1464,6 +1611,7 @@ _close_internal (MMPortSerial *self, gboolean force)
         command_context_complete_and_free (ctx, TRUE);
     }
     g_queue_clear (self->priv->queue);
+    self->priv->pipeline_suspended = FALSE;
 
     if (self->priv->timeout_id) {
         g_source_remove (self->priv->timeout_id);
@@ -1891,6 +2039,24 @@ mm_port_serial_get_flow_control (MMPortSerial *self)
 
 /*****************************************************************************/
 
+gboolean
+mm_port_serial_get_pipeline (MMPortSerial *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_SERIAL (self), FALSE);
+
+    return self->priv->pipeline;
+}
+
+gsize
+mm_port_serial_get_response_scanned (MMPortSerial *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_SERIAL (self), 0);
+
+    return self->priv->response_scanned;
+}
+
+/*****************************************************************************/
+
 MMPortSerial *
 mm_port_serial_new (const char *name, MMPortType ptype)
 {
@@ -1998,6 +2164,9 @@ set_property (GObject *object,
     case PROP_FLASH_OK:
         self->priv->flash_ok = g_value_get_boolean (value);
         break;
+    case PROP_PIPELINE:
+        self->priv->pipeline = g_value_get_boolean (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -2040,6 +2209,9 @@ get_property (GObject *object,
     case PROP_FLASH_OK:
         g_value_set_boolean (value, self->priv->flash_ok);
         break;
+    case PROP_PIPELINE:
+        g_value_set_boolean (value, self->priv->pipeline);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -2162,6 +2334,15 @@ mm_port_serial_class_init (MMPortSerialClass *klass)
                                TRUE,
                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT));
 
+    g_object_class_install_property
+        (object_class, PROP_PIPELINE,
+         g_param_spec_boolean (MM_PORT_SERIAL_PIPELINE,
+                               "Pipeline",
+                               "Send queued commands without waiting for "
+                               "the response to the previous one.",
+                               FALSE,
+                               G_PARAM_READWRITE));
+
     /* Signals */
     signals[BUFFER_FULL] =
         g_signal_new ("buffer-full",
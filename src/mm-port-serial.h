@@ -40,6 +40,7 @@
 #define MM_PORT_SERIAL_FD           "fd" /* Construct-only */
 #define MM_PORT_SERIAL_SPEW_CONTROL "spew-control" /* Construct-only */
 #define MM_PORT_SERIAL_FLASH_OK     "flash-ok" /* Construct-only */
+#define MM_PORT_SERIAL_PIPELINE     "pipeline"
 
 typedef enum {
     MM_PORT_SERIAL_RESPONSE_NONE,
@@ -80,6 +81,11 @@ struct _MMPortSerialClass {
      *
      * The implementation is allowed to cleanup the @response byte array, e.g. to
      * just remove 1 single response if more than one found.
+     *
+     * Both parse_unsolicited() and parse_response() may use
+     * mm_port_serial_get_response_scanned() to skip the leading bytes of
+     * @response that were already looked at in a previous run, as long as
+     * they haven't modified @response themselves in the current run.
      */
     MMPortSerialResponseType (*parse_response) (MMPortSerial *self,
                                                 GByteArray *response,
@@ -140,6 +146,8 @@ gboolean mm_port_serial_flash_finish      (MMPortSerial *self,
                                            GError **error);
 void     mm_port_serial_flash_cancel      (MMPortSerial *self);
 
+/* The response returned by finish() may be shared with the reply cache of the
+ * port, so it must not be modified */
 void        mm_port_serial_command        (MMPortSerial *self,
                                            GByteArray *command,
                                            guint32 timeout_seconds,
@@ -156,4 +164,15 @@ gboolean mm_port_serial_set_flow_control (MMPortSerial   *self,
                                           GError        **error);
 
 MMFlowControl mm_port_serial_get_flow_control (MMPortSerial *self);
+
+/* Whether queued commands are sent without waiting for the response to the
+ * previous one; see MM_PORT_SERIAL_PIPELINE */
+gboolean mm_port_serial_get_pipeline (MMPortSerial *self);
+
+/* Number of leading bytes in the response buffer that were already given to
+ * the parsers in a previous run without a full response being found, and that
+ * have not been modified since then. Newly arrived data is always appended
+ * after these. */
+gsize mm_port_serial_get_response_scanned (MMPortSerial *self);
+
 #endif /* MM_PORT_SERIAL_H */
@@ -0,0 +1,449 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include <gio/gio.h>
+
+#include "mm-scheduler.h"
+#include "mm-utils.h"
+#include "mm-log.h"
+
+G_DEFINE_TYPE (MMScheduler, mm_scheduler, G_TYPE_OBJECT)
+
+/* Jobs are kept in a timer wheel of one-second slots, indexed by the tick in
+ * which they're due modulo the number of slots. Jobs due further away than
+ * the wheel size just share the slot with closer ones. */
+#define WHEEL_SLOTS 128
+
+typedef struct {
+    guint        id;
+    GObject     *owner;
+    const gchar *name;
+    guint        interval;
+    GSourceFunc  callback;
+    gpointer     user_data;
+    guint64      due_tick;
+    guint        n_runs;
+    /* Set while the job is being dispatched, or about to be */
+    gboolean     in_dispatch;
+    gboolean     removed;
+} Job;
+
+struct _MMSchedulerPrivate {
+    GList      *slots[WHEEL_SLOTS];
+    GHashTable *jobs;
+    guint       next_id;
+    guint       slack;
+    gint64      start_time;
+    guint64     last_tick;
+    guint       source_id;
+    guint64     source_tick;
+    /* Time source, in microseconds */
+    MMSchedulerClockFunc clock;
+    gpointer             clock_data;
+};
+
+static void
+job_free (Job *job)
+{
+    if (job->owner)
+        g_object_remove_weak_pointer (job->owner, (gpointer *) &job->owner);
+    g_slice_free (Job, job);
+}
+
+/*****************************************************************************/
+
+static gint64
+monotonic_clock (gpointer unused)
+{
+    return g_get_monotonic_time ();
+}
+
+static gint64
+current_time (MMScheduler *self)
+{
+    return self->priv->clock (self->priv->clock_data);
+}
+
+static guint64
+current_tick (MMScheduler *self)
+{
+    return (guint64) ((current_time (self) - self->priv->start_time) / G_USEC_PER_SEC);
+}
+
+static GList **
+slot_for_tick (MMScheduler *self,
+               guint64      tick)
+{
+    return &self->priv->slots[tick % WHEEL_SLOTS];
+}
+
+static gboolean
+tick_has_jobs (MMScheduler *self,
+               guint64      tick)
+{
+    GList *l;
+
+    for (l = *slot_for_tick (self, tick); l; l = g_list_next (l)) {
+        if (((Job *) l->data)->due_tick == tick)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+job_schedule (MMScheduler *self,
+              Job         *job,
+              guint64      from_tick)
+{
+    guint64 due;
+    guint64 tick;
+    guint   max_delay;
+
+    /* Never delay a job more than half of its interval, so that the rate
+     * of short period jobs isn't changed too much */
+    max_delay = MIN (self->priv->slack, job->interval / 2);
+
+    /* Join the first tick within the slack that already has jobs due, if
+     * any; otherwise, run at the exact time and let others join us */
+    due = from_tick + job->interval;
+    job->due_tick = due;
+    for (tick = due; tick <= due + max_delay; tick++) {
+        if (tick_has_jobs (self, tick)) {
+            job->due_tick = tick;
+            break;
+        }
+    }
+
+    *slot_for_tick (self, job->due_tick) = g_list_prepend (*slot_for_tick (self, job->due_tick), job);
+}
+
+static void
+job_unschedule (MMScheduler *self,
+                Job         *job)
+{
+    *slot_for_tick (self, job->due_tick) = g_list_remove (*slot_for_tick (self, job->due_tick), job);
+}
+
+/*****************************************************************************/
+
+static void     scheduler_arm         (MMScheduler *self);
+static gboolean scheduler_dispatch_cb (MMScheduler *self);
+
+static gint
+job_cmp (const Job *a,
+         const Job *b)
+{
+    if (a->due_tick != b->due_tick)
+        return (a->due_tick < b->due_tick ? -1 : 1);
+    return ((gint) a->id - (gint) b->id);
+}
+
+static void
+scheduler_dispatch (MMScheduler *self)
+{
+    GList   *due = NULL;
+    GList   *l;
+    guint64  now;
+    guint64  tick;
+    guint64  first;
+    guint    n_jobs = 0;
+
+    now = current_tick (self);
+
+    /* Collect all jobs due since the last dispatch, scanning the whole wheel
+     * if we're late enough (e.g. after a system suspension) */
+    first = ((now - self->priv->last_tick) >= WHEEL_SLOTS) ? (now - WHEEL_SLOTS + 1) : (self->priv->last_tick + 1);
+    for (tick = first; tick <= now; tick++) {
+        GList **slot;
+        GList  *next;
+
+        slot = slot_for_tick (self, tick);
+        for (l = *slot; l; l = next) {
+            Job *job = (Job *) l->data;
+
+            next = g_list_next (l);
+            if (job->due_tick <= now) {
+                *slot = g_list_delete_link (*slot, l);
+                job->in_dispatch = TRUE;
+                due = g_list_prepend (due, job);
+            }
+        }
+    }
+    self->priv->last_tick = now;
+
+    due = g_list_sort (due, (GCompareFunc) job_cmp);
+    for (l = due; l; l = g_list_next (l)) {
+        Job      *job = (Job *) l->data;
+        gboolean  keep = FALSE;
+
+        /* May have been removed by a previous job in this same run */
+        if (!job->removed) {
+            job->n_runs++;
+            n_jobs++;
+            keep = (job->callback (job->user_data) == G_SOURCE_CONTINUE);
+        }
+        job->in_dispatch = FALSE;
+
+        if (keep && !job->removed)
+            job_schedule (self, job, now);
+        else
+            g_hash_table_remove (self->priv->jobs, GUINT_TO_POINTER (job->id));
+    }
+    g_list_free (due);
+
+    if (n_jobs > 1)
+        mm_dbg ("[scheduler] %u periodic jobs run in the same tick", n_jobs);
+}
+
+static gboolean
+scheduler_dispatch_cb (MMScheduler *self)
+{
+    self->priv->source_id = 0;
+    scheduler_dispatch (self);
+    scheduler_arm (self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+scheduler_arm (MMScheduler *self)
+{
+    GHashTableIter iter;
+    gpointer       value;
+    guint64        next_tick = G_MAXUINT64;
+    gint64         delay;
+
+    g_hash_table_iter_init (&iter, self->priv->jobs);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        Job *job = (Job *) value;
+
+        if (!job->in_dispatch && job->due_tick < next_tick)
+            next_tick = job->due_tick;
+    }
+
+    /* Already armed for the right tick? */
+    if (self->priv->source_id && self->priv->source_tick == next_tick)
+        return;
+
+    if (self->priv->source_id) {
+        g_source_remove (self->priv->source_id);
+        self->priv->source_id = 0;
+    }
+
+    /* Nothing else to run, so don't wake up at all */
+    if (next_tick == G_MAXUINT64)
+        return;
+
+    /* Wake up right at the start of the tick, rounding up so that we never
+     * wake up before it */
+    delay = self->priv->start_time + (gint64) (next_tick * G_USEC_PER_SEC) - current_time (self);
+    self->priv->source_tick = next_tick;
+    self->priv->source_id = g_timeout_add ((guint) ((MAX (delay, 0) + 999) / 1000),
+                                           (GSourceFunc) scheduler_dispatch_cb,
+                                           self);
+}
+
+/*****************************************************************************/
+
+void
+mm_scheduler_run_pending (MMScheduler *self)
+{
+    g_return_if_fail (MM_IS_SCHEDULER (self));
+
+    scheduler_dispatch (self);
+    scheduler_arm (self);
+}
+
+/*****************************************************************************/
+
+guint
+mm_scheduler_add (MMScheduler *self,
+                  GObject     *owner,
+                  const gchar *name,
+                  guint        interval,
+                  GSourceFunc  callback,
+                  gpointer     user_data)
+{
+    Job *job;
+
+    g_return_val_if_fail (MM_IS_SCHEDULER (self), 0);
+    g_return_val_if_fail (callback != NULL, 0);
+
+    job = g_slice_new0 (Job);
+    job->id = ++self->priv->next_id;
+    if (!job->id)
+        job->id = ++self->priv->next_id;
+    job->name = name;
+    job->interval = MAX (interval, 1);
+    job->callback = callback;
+    job->user_data = user_data;
+    if (owner) {
+        job->owner = owner;
+        g_object_add_weak_pointer (owner, (gpointer *) &job->owner);
+    }
+
+    g_hash_table_insert (self->priv->jobs, GUINT_TO_POINTER (job->id), job);
+    job_schedule (self, job, current_tick (self));
+    scheduler_arm (self);
+
+    return job->id;
+}
+
+gboolean
+mm_scheduler_remove (MMScheduler *self,
+                     guint        id)
+{
+    Job *job;
+
+    g_return_val_if_fail (MM_IS_SCHEDULER (self), FALSE);
+
+    job = g_hash_table_lookup (self->priv->jobs, GUINT_TO_POINTER (id));
+    if (!job || job->removed)
+        return FALSE;
+
+    /* Jobs being dispatched are disposed once done */
+    if (job->in_dispatch) {
+        job->removed = TRUE;
+        return TRUE;
+    }
+
+    job_unschedule (self, job);
+    g_hash_table_remove (self->priv->jobs, GUINT_TO_POINTER (id));
+    scheduler_arm (self);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+static const gchar *
+job_get_owner_path (Job *job)
+{
+    const gchar *path = NULL;
+
+    if (!job->owner)
+        return "";
+
+    if (G_IS_DBUS_OBJECT (job->owner))
+        path = g_dbus_object_get_object_path (G_DBUS_OBJECT (job->owner));
+    else if (G_IS_DBUS_INTERFACE_SKELETON (job->owner))
+        path = g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (job->owner));
+
+    return (path ? path : G_OBJECT_TYPE_NAME (job->owner));
+}
+
+GVariant *
+mm_scheduler_get_jobs (MMScheduler *self)
+{
+    GVariantBuilder builder;
+    GHashTableIter  iter;
+    gpointer        value;
+    guint64         now;
+
+    g_return_val_if_fail (MM_IS_SCHEDULER (self), NULL);
+
+    now = current_tick (self);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssuuu)"));
+    g_hash_table_iter_init (&iter, self->priv->jobs);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        Job *job = (Job *) value;
+
+        if (job->removed)
+            continue;
+
+        g_variant_builder_add (&builder,
+                               "(ssuuu)",
+                               job_get_owner_path (job),
+                               job->name ? job->name : "",
+                               job->interval,
+                               (guint) (job->due_tick > now ? job->due_tick - now : 0),
+                               job->n_runs);
+    }
+
+    return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
+void
+mm_scheduler_set_slack (MMScheduler *self,
+                        guint        slack)
+{
+    g_return_if_fail (MM_IS_SCHEDULER (self));
+
+    self->priv->slack = MIN (slack, WHEEL_SLOTS / 2);
+    mm_dbg ("[scheduler] periodic jobs slack set to %us", self->priv->slack);
+}
+
+guint
+mm_scheduler_get_slack (MMScheduler *self)
+{
+    g_return_val_if_fail (MM_IS_SCHEDULER (self), 0);
+
+    return self->priv->slack;
+}
+
+void
+mm_scheduler_set_clock (MMScheduler          *self,
+                        MMSchedulerClockFunc  clock,
+                        gpointer              user_data)
+{
+    g_return_if_fail (MM_IS_SCHEDULER (self));
+    g_return_if_fail (clock != NULL);
+    g_return_if_fail (g_hash_table_size (self->priv->jobs) == 0);
+
+    self->priv->clock = clock;
+    self->priv->clock_data = user_data;
+    self->priv->start_time = current_time (self);
+    self->priv->last_tick = 0;
+}
+
+/*****************************************************************************/
+
+MM_DEFINE_SINGLETON_GETTER (MMScheduler, mm_scheduler_get, MM_TYPE_SCHEDULER);
+
+static void
+mm_scheduler_init (MMScheduler *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MM_TYPE_SCHEDULER, MMSchedulerPrivate);
+    self->priv->jobs = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) job_free);
+    self->priv->clock = monotonic_clock;
+    self->priv->start_time = current_time (self);
+}
+
+static void
+finalize (GObject *object)
+{
+    MMScheduler *self = MM_SCHEDULER (object);
+    guint        i;
+
+    if (self->priv->source_id)
+        g_source_remove (self->priv->source_id);
+
+    for (i = 0; i < WHEEL_SLOTS; i++)
+        g_list_free (self->priv->slots[i]);
+    g_hash_table_destroy (self->priv->jobs);
+
+    G_OBJECT_CLASS (mm_scheduler_parent_class)->finalize (object);
+}
+
+static void
+mm_scheduler_class_init (MMSchedulerClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMSchedulerPrivate));
+
+    object_class->finalize = finalize;
+}
@@ -0,0 +1,79 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_SCHEDULER_H
+#define MM_SCHEDULER_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#define MM_TYPE_SCHEDULER            (mm_scheduler_get_type ())
+#define MM_SCHEDULER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_SCHEDULER, MMScheduler))
+#define MM_SCHEDULER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  MM_TYPE_SCHEDULER, MMSchedulerClass))
+#define MM_IS_SCHEDULER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MM_TYPE_SCHEDULER))
+#define MM_IS_SCHEDULER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_SCHEDULER))
+#define MM_SCHEDULER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_SCHEDULER, MMSchedulerClass))
+
+typedef struct _MMScheduler MMScheduler;
+typedef struct _MMSchedulerClass MMSchedulerClass;
+typedef struct _MMSchedulerPrivate MMSchedulerPrivate;
+
+struct _MMScheduler {
+    GObject parent;
+    MMSchedulerPrivate *priv;
+};
+
+struct _MMSchedulerClass {
+    GObjectClass parent;
+};
+
+GType mm_scheduler_get_type (void);
+
+/* Process-wide scheduler of the periodic jobs run for each modem. Jobs are
+ * run in whole-second ticks, and may be delayed up to the configured slack
+ * so that jobs due at about the same time run in the same wakeup. */
+MMScheduler *mm_scheduler_get (void);
+
+void  mm_scheduler_set_slack (MMScheduler *self,
+                              guint        slack);
+guint mm_scheduler_get_slack (MMScheduler *self);
+
+/* Same semantics as g_timeout_add_seconds(): the callback is run after
+ * 'interval' seconds, and again every 'interval' seconds for as long as it
+ * returns G_SOURCE_CONTINUE. 'owner' is only used to report the job, and
+ * 'name' must be a static string. Returns a job id, never 0. */
+guint    mm_scheduler_add    (MMScheduler *self,
+                              GObject     *owner,
+                              const gchar *name,
+                              guint        interval,
+                              GSourceFunc  callback,
+                              gpointer     user_data);
+gboolean mm_scheduler_remove (MMScheduler *self,
+                              guint        id);
+
+/* Only meant for unit tests: 'clock' returns the current time in
+ * microseconds and replaces the monotonic clock; it must be set before any
+ * job is added. mm_scheduler_run_pending() runs the jobs already due
+ * without waiting for the main loop. */
+typedef gint64 (* MMSchedulerClockFunc) (gpointer user_data);
+
+void mm_scheduler_set_clock   (MMScheduler          *self,
+                               MMSchedulerClockFunc  clock,
+                               gpointer              user_data);
+void mm_scheduler_run_pending (MMScheduler          *self);
+
+/* Description of the scheduled jobs, as an array of (owner path, job name,
+ * interval, seconds until next run, number of runs) tuples */
+GVariant *mm_scheduler_get_jobs (MMScheduler *self);
+
+#endif /* MM_SCHEDULER_H */
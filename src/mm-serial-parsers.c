@@ -404,3 +404,441 @@ mm_serial_parser_v1_destroy (gpointer data)
 
     g_slice_free (MMSerialParserV1, data);
 }
+
+/*****************************************************************************/
+/* Single-pass parser
+ *
+ * Gives the same results as the v1 parser, but without running the whole set
+ * of regular expressions over the full response on every read. Final result
+ * codes that must be found at the end of the response are matched by looking
+ * only at the trailing bytes, and those that may be found anywhere are looked
+ * for in a single scan which resumes where the previous one stopped, as long
+ * as the already scanned bytes are still in place.
+ */
+
+/* Longest marker that may be found anywhere in the response: "\r\nNO CARRIER" */
+#define MAX_ANYWHERE_MARKER_LEN 12
+
+typedef enum {
+    ANYWHERE_MARKER_NONE           = 0,
+    ANYWHERE_MARKER_CONNECT        = 1 << 0,
+    ANYWHERE_MARKER_ERROR          = 1 << 1,
+    ANYWHERE_MARKER_CONNECT_FAILED = 1 << 2,
+    ANYWHERE_MARKER_NA             = 1 << 3,
+} AnywhereMarker;
+
+typedef struct {
+    /* Regular expressions for custom replies */
+    GRegex *regex_custom_successful;
+    GRegex *regex_custom_error;
+    /* User-provided parser filter */
+    mm_serial_parser_v1_filter_fn filter_callback;
+    gpointer                      filter_user_data;
+    /* Leading bytes of the response already scanned without any match */
+    GByteArray *scanned;
+} MMSerialParserV2;
+
+#define MARKER_AT(str, len, pos, marker)                    \
+    (((pos) + sizeof (marker) - 1 <= (len)) &&              \
+     !memcmp (&(str)[pos], marker, sizeof (marker) - 1))
+
+#define MARKER_AT_END(str, len, marker)                     \
+    (((len) >= sizeof (marker) - 1) &&                      \
+     MARKER_AT (str, len, (len) - (sizeof (marker) - 1), marker))
+
+/* Looks for the markers that may be found anywhere in the response, starting
+ * at the given offset. Returns the offset where the next scan should start. */
+static gsize
+scan_anywhere_markers (const gchar *str,
+                       gsize        len,
+                       gsize        start,
+                       guint       *markers)
+{
+    gsize i;
+    gsize resume;
+    gsize connect_pending = len;
+
+    for (i = start; i < len; i++) {
+        switch (str[i]) {
+        case '\r':
+            if (MARKER_AT (str, len, i, "\r\nCONNECT")) {
+                const gchar *lf;
+                gsize        rest = i + 9;
+
+                /* "\r\nCONNECT.*\r\n", where '.' doesn't match '\n' */
+                lf = memchr (&str[rest], '\n', len - rest);
+                if (!lf) {
+                    /* Line not complete yet, must be re-scanned next time */
+                    if (connect_pending == len)
+                        connect_pending = i;
+                } else if (lf > &str[rest] && *(lf - 1) == '\r')
+                    *markers |= ANYWHERE_MARKER_CONNECT;
+            } else if (MARKER_AT (str, len, i, "\r\nERROR"))
+                *markers |= ANYWHERE_MARKER_ERROR;
+            else if (MARKER_AT (str, len, i, "\r\nNO CARRIER"))
+                *markers |= ANYWHERE_MARKER_CONNECT_FAILED;
+            else if (MARKER_AT (str, len, i, "\r\nNA\r\n"))
+                *markers |= ANYWHERE_MARKER_NA;
+            break;
+        case 'B':
+            if (MARKER_AT (str, len, i, "BUSY"))
+                *markers |= ANYWHERE_MARKER_CONNECT_FAILED;
+            break;
+        case 'N':
+            if (MARKER_AT (str, len, i, "NO ANSWER"))
+                *markers |= ANYWHERE_MARKER_CONNECT_FAILED;
+            break;
+        default:
+            break;
+        }
+    }
+
+    /* Markers may have been cut at the end of the buffer */
+    resume = (len >= MAX_ANYWHERE_MARKER_LEN ? len - (MAX_ANYWHERE_MARKER_LEN - 1) : 0);
+    return MIN (resume, connect_pending);
+}
+
+/* Matches "\r\nOK(\r\n)+$", returns the offset where the match starts or -1 */
+static gssize
+match_ok (const gchar *str,
+          gsize        len)
+{
+    gsize end = len;
+
+    while (end >= 2 && str[end - 2] == '\r' && str[end - 1] == '\n')
+        end -= 2;
+
+    if (end == len || !MARKER_AT_END (str, end, "\r\nOK"))
+        return -1;
+
+    return (gssize) (end - 4);
+}
+
+/* Matches "\r\n>\s*$" */
+static gboolean
+match_sms (const gchar *str,
+           gsize        len)
+{
+    while (len > 0 && g_ascii_isspace (str[len - 1]))
+        len--;
+
+    return MARKER_AT_END (str, len, "\r\n>");
+}
+
+/* Matches "<marker>\s*(\d+)\r\n$" */
+static gboolean
+match_error_code (const gchar *str,
+                  gsize        len,
+                  const gchar *marker,
+                  gint        *code)
+{
+    gsize marker_len;
+    gsize digits_start;
+    gsize digits_end;
+    gsize marker_end;
+
+    if (!MARKER_AT_END (str, len, "\r\n"))
+        return FALSE;
+
+    digits_end = len - 2;
+    digits_start = digits_end;
+    while (digits_start > 0 && g_ascii_isdigit (str[digits_start - 1]))
+        digits_start--;
+    if (digits_start == digits_end)
+        return FALSE;
+
+    /* All markers end with ':', so they can only end right before the
+     * whitespace preceding the digits */
+    marker_end = digits_start;
+    while (marker_end > 0 && g_ascii_isspace (str[marker_end - 1]))
+        marker_end--;
+
+    marker_len = strlen (marker);
+    if (marker_end < marker_len || memcmp (&str[marker_end - marker_len], marker, marker_len) != 0)
+        return FALSE;
+
+    *code = atoi (&str[digits_start]);
+    return TRUE;
+}
+
+/* Matches "<marker>\s*([^\n\r]+)\r\n$", returns the newly allocated group */
+static gchar *
+match_error_string (const gchar *str,
+                    gsize        len,
+                    const gchar *marker)
+{
+    gsize marker_len;
+    gsize line_start;
+    gsize line_end;
+    gsize ws_start;
+    gsize candidates[2];
+    guint i;
+
+    if (!MARKER_AT_END (str, len, "\r\n"))
+        return NULL;
+
+    line_end = len - 2;
+    line_start = line_end;
+    while (line_start > 0 && str[line_start - 1] != '\r' && str[line_start - 1] != '\n')
+        line_start--;
+    if (line_start == line_end)
+        return NULL;
+
+    ws_start = line_start;
+    while (ws_start > 0 && g_ascii_isspace (str[ws_start - 1]))
+        ws_start--;
+
+    /* The marker ends with ':' and starts with "\r\n", so it can only end
+     * either right before the whitespace preceding the last line, or within
+     * the last line if the marker itself starts the line. The leftmost one
+     * wins, as in the regex match. */
+    marker_len = strlen (marker);
+    candidates[0] = ws_start;
+    candidates[1] = line_start + marker_len - 2;
+
+    for (i = 0; i < G_N_ELEMENTS (candidates); i++) {
+        gsize marker_end = candidates[i];
+        gsize group_start;
+
+        if (marker_end < marker_len || marker_end >= line_end)
+            continue;
+        if (memcmp (&str[marker_end - marker_len], marker, marker_len) != 0)
+            continue;
+
+        /* Greedy whitespace skip, leaving at least one byte in the group */
+        group_start = marker_end;
+        while (group_start < line_end - 1 && g_ascii_isspace (str[group_start]))
+            group_start++;
+
+        return g_strndup (&str[group_start], line_end - group_start);
+    }
+
+    return NULL;
+}
+
+static void
+scan_state_update (MMSerialParserV2 *parser,
+                   const GString    *response,
+                   gsize             start,
+                   gsize             resume)
+{
+    if (resume <= start) {
+        g_byte_array_set_size (parser->scanned, resume);
+        return;
+    }
+
+    g_byte_array_set_size (parser->scanned, start);
+    g_byte_array_append (parser->scanned,
+                         (const guint8 *) &response->str[start],
+                         resume - start);
+}
+
+gpointer
+mm_serial_parser_v2_new (void)
+{
+    MMSerialParserV2 *parser;
+
+    parser = g_slice_new0 (MMSerialParserV2);
+    parser->scanned = g_byte_array_new ();
+    return parser;
+}
+
+void
+mm_serial_parser_v2_set_custom_regex (gpointer data,
+                                      GRegex *successful,
+                                      GRegex *error)
+{
+    MMSerialParserV2 *parser = (MMSerialParserV2 *) data;
+
+    g_return_if_fail (parser != NULL);
+
+    if (parser->regex_custom_successful)
+        g_regex_unref (parser->regex_custom_successful);
+    if (parser->regex_custom_error)
+        g_regex_unref (parser->regex_custom_error);
+
+    parser->regex_custom_successful = successful ? g_regex_ref (successful) : NULL;
+    parser->regex_custom_error = error ? g_regex_ref (error) : NULL;
+}
+
+void
+mm_serial_parser_v2_add_filter (gpointer data,
+                                mm_serial_parser_v1_filter_fn callback,
+                                gpointer user_data)
+{
+    MMSerialParserV2 *parser = (MMSerialParserV2 *) data;
+
+    g_return_if_fail (parser != NULL);
+
+    parser->filter_callback = callback;
+    parser->filter_user_data = user_data;
+}
+
+gboolean
+mm_serial_parser_v2_parse (gpointer data,
+                           GString *response,
+                           GError **error)
+{
+    MMSerialParserV2 *parser = (MMSerialParserV2 *) data;
+    GError *local_error = NULL;
+    gboolean found = FALSE;
+    guint markers = ANYWHERE_MARKER_NONE;
+    gsize start = 0;
+    gsize resume;
+    gssize ok_start;
+    gint code;
+    gchar *str;
+
+    g_return_val_if_fail (parser != NULL, FALSE);
+    g_return_val_if_fail (response != NULL, FALSE);
+
+    /* Skip NUL bytes if they are found leading the response */
+    while (response->len > 0 && response->str[0] == '\0')
+        g_string_erase (response, 0, 1);
+
+    if (G_UNLIKELY (!response->len)) {
+        g_byte_array_set_size (parser->scanned, 0);
+        return FALSE;
+    }
+
+    /* First, apply custom filter if any */
+    if (parser->filter_callback &&
+        !parser->filter_callback (parser,
+                                  parser->filter_user_data,
+                                  response,
+                                  &local_error)) {
+        g_assert (local_error != NULL);
+        mm_dbg ("Got response filtered in serial port: %s", local_error->message);
+        g_propagate_error (error, local_error);
+        response_clean (response);
+        g_byte_array_set_size (parser->scanned, 0);
+        return TRUE;
+    }
+
+    /* Resume the scan where the previous one stopped, unless the leading
+     * bytes were modified in the meantime (e.g. unsolicited messages removed) */
+    if (parser->scanned->len > 0 &&
+        parser->scanned->len <= response->len &&
+        !memcmp (parser->scanned->data, response->str, parser->scanned->len))
+        start = parser->scanned->len;
+    resume = scan_anywhere_markers (response->str, response->len, start, &markers);
+
+    /* Then, check for successful responses */
+
+    /* Custom successful replies first, if any */
+    if (parser->regex_custom_successful) {
+        found = g_regex_match_full (parser->regex_custom_successful,
+                                    response->str, response->len,
+                                    0, 0, NULL, NULL);
+    }
+
+    if (!found) {
+        ok_start = match_ok (response->str, response->len);
+        if (ok_start >= 0) {
+            g_string_truncate (response, ok_start);
+            found = TRUE;
+        }
+    }
+
+    if (!found)
+        found = !!(markers & ANYWHERE_MARKER_CONNECT);
+
+    if (!found)
+        found = match_sms (response->str, response->len);
+
+    if (found) {
+        response_clean (response);
+        g_byte_array_set_size (parser->scanned, 0);
+        return TRUE;
+    }
+
+    /* Now failures, in the same order as in the v1 parser */
+
+    /* Custom error matches first, if any */
+    if (parser->regex_custom_error) {
+        GMatchInfo *match_info;
+
+        if (g_regex_match_full (parser->regex_custom_error,
+                                response->str, response->len,
+                                0, 0, &match_info, NULL)) {
+            str = g_match_info_fetch (match_info, 1);
+            g_assert (str);
+            local_error = mm_mobile_equipment_error_for_code (atoi (str));
+            g_free (str);
+        }
+        g_match_info_free (match_info);
+    }
+
+    /* Numeric CME errors */
+    if (!local_error && match_error_code (response->str, response->len, "\r\n+CME ERROR:", &code))
+        local_error = mm_mobile_equipment_error_for_code (code);
+
+    /* Numeric CMS errors */
+    if (!local_error && match_error_code (response->str, response->len, "\r\n+CMS ERROR:", &code))
+        local_error = mm_message_error_for_code (code);
+
+    /* String CME errors */
+    if (!local_error && (str = match_error_string (response->str, response->len, "\r\n+CME ERROR:")) != NULL) {
+        local_error = mm_mobile_equipment_error_for_string (str);
+        g_free (str);
+    }
+
+    /* String CMS errors */
+    if (!local_error && (str = match_error_string (response->str, response->len, "\r\n+CMS ERROR:")) != NULL) {
+        local_error = mm_message_error_for_string (str);
+        g_free (str);
+    }
+
+    /* Motorola EZX errors */
+    if (!local_error && match_error_code (response->str, response->len, "\r\nMODEM ERROR:", &code))
+        local_error = mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN);
+
+    /* Last resort; unknown error */
+    if (!local_error &&
+        ((markers & ANYWHERE_MARKER_ERROR) ||
+         MARKER_AT_END (response->str, response->len, "COMMAND NOT SUPPORT\r\n")))
+        local_error = mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN);
+
+    /* Connection failures; the v1 parser ends up reporting NO CARRIER for
+     * all of them, so do the same */
+    if (!local_error &&
+        ((markers & ANYWHERE_MARKER_CONNECT_FAILED) ||
+         MARKER_AT_END (response->str, response->len, "NO DIALTONE\r\n")))
+        local_error = mm_connection_error_for_code (MM_CONNECTION_ERROR_NO_CARRIER);
+
+    /* NA error; assume NA means 'Not Allowed' :) */
+    if (!local_error && (markers & ANYWHERE_MARKER_NA))
+        local_error = g_error_new (MM_MOBILE_EQUIPMENT_ERROR,
+                                   MM_MOBILE_EQUIPMENT_ERROR_NOT_ALLOWED,
+                                   "Not Allowed");
+
+    if (!local_error) {
+        /* Nothing found yet, keep track of what we already scanned */
+        scan_state_update (parser, response, start, resume);
+        return FALSE;
+    }
+
+    response_clean (response);
+    g_byte_array_set_size (parser->scanned, 0);
+
+    mm_dbg ("Got failure code %d: %s", local_error->code, local_error->message);
+    g_propagate_error (error, local_error);
+    return TRUE;
+}
+
+void
+mm_serial_parser_v2_destroy (gpointer data)
+{
+    MMSerialParserV2 *parser = (MMSerialParserV2 *) data;
+
+    g_return_if_fail (parser != NULL);
+
+    if (parser->regex_custom_successful)
+        g_regex_unref (parser->regex_custom_successful);
+    if (parser->regex_custom_error)
+        g_regex_unref (parser->regex_custom_error);
+
+    g_byte_array_unref (parser->scanned);
+
+    g_slice_free (MMSerialParserV2, data);
+}
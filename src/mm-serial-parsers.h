@@ -38,4 +38,20 @@ void     mm_serial_parser_v1_add_filter (gpointer data,
                                          mm_serial_parser_v1_filter_fn callback,
                                          gpointer user_data);
 
+/* Single-pass parser, giving the same results as the v1 parser. It keeps track
+ * of the bytes already scanned, so a parser instance must not be shared among
+ * different ports. The v1 filter callback type and the v1 known error check
+ * also apply to this parser. */
+gpointer mm_serial_parser_v2_new                  (void);
+void     mm_serial_parser_v2_set_custom_regex     (gpointer data,
+                                                   GRegex *successful,
+                                                   GRegex *error);
+gboolean mm_serial_parser_v2_parse                (gpointer parser,
+                                                   GString *response,
+                                                   GError **error);
+void     mm_serial_parser_v2_destroy              (gpointer parser);
+void     mm_serial_parser_v2_add_filter           (gpointer data,
+                                                   mm_serial_parser_v1_filter_fn callback,
+                                                   gpointer user_data);
+
 #endif /* MM_SERIAL_PARSERS_H */
@@ -0,0 +1,256 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include "mm-sms-index.h"
+
+#define PART_KEY(storage, index) ((((gint64) (storage)) << 32) | (gint64) (index))
+
+struct _MMSmsIndex {
+    /* sms -> entry */
+    GHashTable *entries;
+    /* path -> sms */
+    GHashTable *by_path;
+    /* (storage, part index) -> sms */
+    GHashTable *by_part;
+    /* (number, multipart reference) -> queue of sms */
+    GHashTable *by_concat;
+};
+
+typedef struct {
+    /* Keys under which the sms is indexed */
+    gchar  *path;
+    GArray *part_keys;
+    gchar  *concat_key;
+} Entry;
+
+static void
+entry_free (Entry *entry)
+{
+    g_free (entry->path);
+    g_free (entry->concat_key);
+    g_array_unref (entry->part_keys);
+    g_slice_free (Entry, entry);
+}
+
+static gchar *
+concat_key_new (const gchar *number,
+                guint        reference)
+{
+    return g_strdup_printf ("%s/%u", number ? number : "", reference);
+}
+
+/*****************************************************************************/
+
+static void
+remove_path (MMSmsIndex *self,
+             gpointer    sms,
+             Entry      *entry)
+{
+    if (!entry->path)
+        return;
+    if (g_hash_table_lookup (self->by_path, entry->path) == sms)
+        g_hash_table_remove (self->by_path, entry->path);
+    g_clear_pointer (&entry->path, g_free);
+}
+
+static void
+remove_parts (MMSmsIndex *self,
+              gpointer    sms,
+              Entry      *entry)
+{
+    guint i;
+
+    for (i = 0; i < entry->part_keys->len; i++) {
+        gint64 key;
+
+        key = g_array_index (entry->part_keys, gint64, i);
+        if (g_hash_table_lookup (self->by_part, &key) == sms)
+            g_hash_table_remove (self->by_part, &key);
+    }
+    g_array_set_size (entry->part_keys, 0);
+}
+
+static void
+remove_concat (MMSmsIndex *self,
+               gpointer    sms,
+               Entry      *entry)
+{
+    GQueue *bucket;
+
+    if (!entry->concat_key)
+        return;
+
+    bucket = g_hash_table_lookup (self->by_concat, entry->concat_key);
+    if (bucket) {
+        g_queue_remove (bucket, sms);
+        if (g_queue_is_empty (bucket))
+            g_hash_table_remove (self->by_concat, entry->concat_key);
+    }
+    g_clear_pointer (&entry->concat_key, g_free);
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_index_add (MMSmsIndex *self,
+                  gpointer    sms)
+{
+    Entry *entry;
+
+    g_return_if_fail (!g_hash_table_contains (self->entries, sms));
+
+    entry = g_slice_new0 (Entry);
+    entry->part_keys = g_array_new (FALSE, FALSE, sizeof (gint64));
+    g_hash_table_insert (self->entries, sms, entry);
+}
+
+void
+mm_sms_index_remove (MMSmsIndex *self,
+                     gpointer    sms)
+{
+    Entry *entry;
+
+    entry = g_hash_table_lookup (self->entries, sms);
+    if (!entry)
+        return;
+
+    remove_path (self, sms, entry);
+    remove_parts (self, sms, entry);
+    remove_concat (self, sms, entry);
+    g_hash_table_remove (self->entries, sms);
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_index_set_path (MMSmsIndex  *self,
+                       gpointer     sms,
+                       const gchar *path)
+{
+    Entry *entry;
+
+    entry = g_hash_table_lookup (self->entries, sms);
+    g_return_if_fail (entry != NULL);
+
+    remove_path (self, sms, entry);
+    if (path) {
+        entry->path = g_strdup (path);
+        g_hash_table_insert (self->by_path, g_strdup (path), sms);
+    }
+}
+
+gpointer
+mm_sms_index_lookup_path (MMSmsIndex  *self,
+                          const gchar *path)
+{
+    return g_hash_table_lookup (self->by_path, path);
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_index_add_part (MMSmsIndex   *self,
+                       gpointer      sms,
+                       MMSmsStorage  storage,
+                       guint         index)
+{
+    Entry  *entry;
+    gint64  key;
+    gint64 *hkey;
+
+    entry = g_hash_table_lookup (self->entries, sms);
+    g_return_if_fail (entry != NULL);
+
+    key = PART_KEY (storage, index);
+    hkey = g_new (gint64, 1);
+    *hkey = key;
+    g_hash_table_insert (self->by_part, hkey, sms);
+    g_array_append_val (entry->part_keys, key);
+}
+
+gpointer
+mm_sms_index_lookup_part (MMSmsIndex   *self,
+                          MMSmsStorage  storage,
+                          guint         index)
+{
+    gint64 key;
+
+    key = PART_KEY (storage, index);
+    return g_hash_table_lookup (self->by_part, &key);
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_index_set_multipart_reference (MMSmsIndex  *self,
+                                      gpointer     sms,
+                                      const gchar *number,
+                                      guint        reference)
+{
+    Entry  *entry;
+    GQueue *bucket;
+
+    entry = g_hash_table_lookup (self->entries, sms);
+    g_return_if_fail (entry != NULL);
+
+    remove_concat (self, sms, entry);
+    entry->concat_key = concat_key_new (number, reference);
+    bucket = g_hash_table_lookup (self->by_concat, entry->concat_key);
+    if (!bucket) {
+        bucket = g_queue_new ();
+        g_hash_table_insert (self->by_concat, g_strdup (entry->concat_key), bucket);
+    }
+    g_queue_push_head (bucket, sms);
+}
+
+GList *
+mm_sms_index_lookup_multipart_reference (MMSmsIndex  *self,
+                                         const gchar *number,
+                                         guint        reference)
+{
+    GQueue *bucket;
+    gchar  *key;
+
+    key = concat_key_new (number, reference);
+    bucket = g_hash_table_lookup (self->by_concat, key);
+    g_free (key);
+
+    return (bucket ? bucket->head : NULL);
+}
+
+/*****************************************************************************/
+
+MMSmsIndex *
+mm_sms_index_new (void)
+{
+    MMSmsIndex *self;
+
+    self = g_slice_new0 (MMSmsIndex);
+    self->entries = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) entry_free);
+    self->by_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->by_part = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+    self->by_concat = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_queue_free);
+    return self;
+}
+
+void
+mm_sms_index_free (MMSmsIndex *self)
+{
+    g_hash_table_destroy (self->by_concat);
+    g_hash_table_destroy (self->by_part);
+    g_hash_table_destroy (self->by_path);
+    g_hash_table_destroy (self->entries);
+    g_slice_free (MMSmsIndex, self);
+}
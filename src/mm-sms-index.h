@@ -0,0 +1,59 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_SMS_INDEX_H
+#define MM_SMS_INDEX_H
+
+#include <glib.h>
+#include <ModemManager.h>
+
+/* Lookup tables for the messages of a SMS list: by D-Bus path, by (storage,
+ * part index) and by (number, multipart reference). Messages are opaque
+ * pointers, and no reference is taken on them. Lookups may return messages
+ * whose keys changed without the index being told, so callers must check
+ * the hits again. */
+typedef struct _MMSmsIndex MMSmsIndex;
+
+MMSmsIndex *mm_sms_index_new  (void);
+void        mm_sms_index_free (MMSmsIndex *self);
+
+void     mm_sms_index_add    (MMSmsIndex *self,
+                              gpointer    sms);
+void     mm_sms_index_remove (MMSmsIndex *self,
+                              gpointer    sms);
+
+void     mm_sms_index_set_path    (MMSmsIndex  *self,
+                                   gpointer     sms,
+                                   const gchar *path);
+gpointer mm_sms_index_lookup_path (MMSmsIndex  *self,
+                                   const gchar *path);
+
+void     mm_sms_index_add_part    (MMSmsIndex   *self,
+                                   gpointer      sms,
+                                   MMSmsStorage  storage,
+                                   guint         index);
+gpointer mm_sms_index_lookup_part (MMSmsIndex   *self,
+                                   MMSmsStorage  storage,
+                                   guint         index);
+
+/* Messages sharing the same number and multipart reference are all kept,
+ * most recently added first */
+void   mm_sms_index_set_multipart_reference    (MMSmsIndex  *self,
+                                                gpointer     sms,
+                                                const gchar *number,
+                                                guint        reference);
+GList *mm_sms_index_lookup_multipart_reference (MMSmsIndex  *self,
+                                                const gchar *number,
+                                                guint        reference);
+
+#endif /* MM_SMS_INDEX_H */
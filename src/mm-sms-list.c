@@ -26,6 +26,7 @@
 
 #include "mm-iface-modem-messaging.h"
 #include "mm-sms-list.h"
+#include "mm-sms-index.h"
 #include "mm-base-sms.h"
 #include "mm-log.h"
 
@@ -50,9 +51,125 @@ struct _MMSmsListPrivate {
     MMBaseModem *modem;
     /* List of sms objects */
     GList *list;
+    /* Link of each sms object in the list */
+    GHashTable *links;
+    /* Indexes by path, part index and multipart reference */
+    MMSmsIndex *index;
+    /* SMS created by the user, whose parts may get stored (and so indexed)
+     * after having been added to the list */
+    GList *local;
 };
 
 /*****************************************************************************/
+/* Indexes */
+
+static void
+sms_path_updated (MMBaseSms  *sms,
+                  GParamSpec *pspec,
+                  MMSmsList  *self)
+{
+    mm_sms_index_set_path (self->priv->index, sms, mm_base_sms_get_path (sms));
+}
+
+static void
+index_add_part (MMSmsList *self,
+                MMBaseSms *sms,
+                MMSmsPart *part)
+{
+    MMSmsStorage storage;
+
+    storage = mm_base_sms_get_storage (sms);
+    if (storage == MM_SMS_STORAGE_UNKNOWN ||
+        mm_sms_part_get_index (part) == SMS_PART_INVALID_INDEX)
+        return;
+
+    mm_sms_index_add_part (self->priv->index, sms, storage, mm_sms_part_get_index (part));
+}
+
+static void
+list_add (MMSmsList   *self,
+          MMBaseSms   *sms,
+          const gchar *number,
+          gboolean     local)
+{
+    GList *l;
+
+    self->priv->list = g_list_prepend (self->priv->list, sms);
+    g_hash_table_insert (self->priv->links, sms, self->priv->list);
+    mm_sms_index_add (self->priv->index, sms);
+
+    /* Paths are only given once the sms gets exported */
+    g_signal_connect (sms,
+                      "notify::" MM_BASE_SMS_PATH,
+                      G_CALLBACK (sms_path_updated),
+                      self);
+    sms_path_updated (sms, NULL, self);
+
+    if (local)
+        self->priv->local = g_list_prepend (self->priv->local, sms);
+    else {
+        for (l = mm_base_sms_get_parts (sms); l; l = g_list_next (l))
+            index_add_part (self, sms, (MMSmsPart *) l->data);
+    }
+
+    if (mm_base_sms_is_multipart (sms))
+        mm_sms_index_set_multipart_reference (self->priv->index,
+                                              sms,
+                                              number,
+                                              mm_base_sms_get_multipart_reference (sms));
+}
+
+static void
+list_remove (MMSmsList *self,
+             MMBaseSms *sms)
+{
+    GList *link;
+
+    link = g_hash_table_lookup (self->priv->links, sms);
+    if (!link)
+        return;
+
+    self->priv->list = g_list_delete_link (self->priv->list, link);
+    g_hash_table_remove (self->priv->links, sms);
+
+    g_signal_handlers_disconnect_by_func (sms, sms_path_updated, self);
+    mm_sms_index_remove (self->priv->index, sms);
+    self->priv->local = g_list_remove (self->priv->local, sms);
+    g_object_unref (sms);
+}
+
+static void
+clear_indexes (MMSmsList *self)
+{
+    GList *l;
+
+    if (!self->priv->index)
+        return;
+
+    for (l = self->priv->list; l; l = g_list_next (l))
+        g_signal_handlers_disconnect_by_func (l->data, sms_path_updated, self);
+
+    g_list_free (self->priv->local);
+    self->priv->local = NULL;
+    g_hash_table_destroy (self->priv->links);
+    self->priv->links = NULL;
+    mm_sms_index_free (self->priv->index);
+    self->priv->index = NULL;
+}
+
+/*****************************************************************************/
+
+static gboolean
+is_local_multipart_reference (MMBaseSms   *sms,
+                              const gchar *number,
+                              guint8       reference)
+{
+    return (mm_base_sms_is_multipart (sms) &&
+            mm_gdbus_sms_get_pdu_type (MM_GDBUS_SMS (sms)) == MM_SMS_PDU_TYPE_SUBMIT &&
+            mm_base_sms_get_storage (sms) != MM_SMS_STORAGE_UNKNOWN &&
+            mm_base_sms_get_multipart_reference (sms) == reference &&
+            !g_strcmp0 (mm_gdbus_sms_get_number (MM_GDBUS_SMS (sms)), number));
+}
 
 gboolean
 mm_sms_list_has_local_multipart_reference (MMSmsList *self,
@@ -64,20 +181,21 @@ mm_sms_list_has_local_multipart_reference (MMSmsList *self,
     /* No one should look for multipart reference 0, which isn't valid */
     g_assert (reference != 0);
 
-    for (l = self->priv->list; l; l = g_list_next (l)) {
-        MMBaseSms *sms = MM_BASE_SMS (l->data);
-
-        if (mm_base_sms_is_multipart (sms) &&
-            mm_gdbus_sms_get_pdu_type (MM_GDBUS_SMS (sms)) == MM_SMS_PDU_TYPE_SUBMIT &&
-            mm_base_sms_get_storage (sms) != MM_SMS_STORAGE_UNKNOWN &&
-            mm_base_sms_get_multipart_reference (sms) == reference &&
-            g_str_equal (mm_gdbus_sms_get_number (MM_GDBUS_SMS (sms)), number)) {
+    for (l = mm_sms_index_lookup_multipart_reference (self->priv->index, number, reference); l; l = g_list_next (l)) {
+        if (is_local_multipart_reference (MM_BASE_SMS (l->data), number, reference)) {
             /* Yes, the SMS list has an SMS with the same destination number
              * and multipart reference */
             return TRUE;
         }
     }
 
+    /* SMS created by the user only get a multipart reference once they're
+     * stored or sent, after having been added to the list */
+    for (l = self->priv->local; l; l = g_list_next (l)) {
+        if (is_local_multipart_reference (MM_BASE_SMS (l->data), number, reference))
+            return TRUE;
+    }
+
     return FALSE;
 }
 
@@ -121,13 +239,6 @@ mm_sms_list_delete_sms_finish (MMSmsList *self,
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
-static guint
-cmp_sms_by_path (MMBaseSms *sms,
-                 const gchar *path)
-{
-    return g_strcmp0 (mm_base_sms_get_path (sms), path);
-}
-
 static void
 delete_ready (MMBaseSms *sms,
               GAsyncResult *res,
@@ -136,7 +247,7 @@ delete_ready (MMBaseSms *sms,
     MMSmsList *self;
     const gchar *path;
     GError *error = NULL;
-    GList *l;
+    MMBaseSms *listed;
 
     if (!mm_base_sms_delete_finish (sms, res, &error)) {
         /* We report the error */
@@ -148,13 +259,9 @@ delete_ready (MMBaseSms *sms,
     self = g_task_get_source_object (task);
     path = g_task_get_task_data (task);
     /* The SMS was properly deleted, we now remove it from our list */
-    l = g_list_find_custom (self->priv->list,
-                            path,
-                            (GCompareFunc)cmp_sms_by_path);
-    if (l) {
-        g_object_unref (MM_BASE_SMS (l->data));
-        self->priv->list = g_list_delete_link (self->priv->list, l);
-    }
+    listed = mm_sms_index_lookup_path (self->priv->index, path);
+    if (listed)
+        list_remove (self, listed);
 
     /* We don't need to unref the SMS any more, but we can use the
      * reference we got in the method, which is the one kept alive
@@ -175,13 +282,11 @@ mm_sms_list_delete_sms (MMSmsList *self,
                         GAsyncReadyCallback callback,
                         gpointer user_data)
 {
-    GList *l;
+    MMBaseSms *sms;
     GTask *task;
 
-    l = g_list_find_custom (self->priv->list,
-                            (gpointer)sms_path,
-                            (GCompareFunc)cmp_sms_by_path);
-    if (!l) {
+    sms = mm_sms_index_lookup_path (self->priv->index, sms_path);
+    if (!sms) {
         g_task_report_new_error (self,
                                  callback,
                                  user_data,
@@ -197,7 +302,7 @@ mm_sms_list_delete_sms (MMSmsList *self,
     task = g_task_new (self, NULL, callback, user_data);
     g_task_set_task_data (task, g_strdup (sms_path), g_free);
 
-    mm_base_sms_delete (MM_BASE_SMS (l->data),
+    mm_base_sms_delete (sms,
                         (GAsyncReadyCallback)delete_ready,
                         task);
 }
@@ -208,7 +313,10 @@ void
 mm_sms_list_add_sms (MMSmsList *self,
                      MMBaseSms *sms)
 {
-    self->priv->list = g_list_prepend (self->priv->list, g_object_ref (sms));
+    list_add (self,
+              g_object_ref (sms),
+              mm_gdbus_sms_get_number (MM_GDBUS_SMS (sms)),
+              TRUE);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    FALSE);
@@ -216,29 +324,6 @@ mm_sms_list_add_sms (MMSmsList *self,
 
 /*****************************************************************************/
 
-static guint
-cmp_sms_by_concat_reference (MMBaseSms *sms,
-                             gpointer user_data)
-{
-    if (!mm_base_sms_is_multipart (sms))
-        return -1;
-
-    return (GPOINTER_TO_UINT (user_data) - mm_base_sms_get_multipart_reference (sms));
-}
-
-typedef struct {
-    guint part_index;
-    MMSmsStorage storage;
-} PartIndexAndStorage;
-
-static guint
-cmp_sms_by_part_index_and_storage (MMBaseSms *sms,
-                                   PartIndexAndStorage *ctx)
-{
-    return !(mm_base_sms_get_storage (sms) == ctx->storage &&
-             mm_base_sms_has_part_index (sms, ctx->part_index));
-}
-
 static gboolean
 take_singlepart (MMSmsList *self,
                  MMSmsPart *part,
@@ -256,7 +341,7 @@ take_singlepart (MMSmsList *self,
     if (!sms)
         return FALSE;
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
+    list_add (self, sms, mm_sms_part_get_number (part), FALSE);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    state == MM_SMS_STATE_RECEIVED);
@@ -274,13 +359,19 @@ take_multipart (MMSmsList *self,
     MMBaseSms *sms;
     guint concat_reference;
 
+    /* Parts of the same message come from the same number */
     concat_reference = mm_sms_part_get_concat_reference (part);
-    l = g_list_find_custom (self->priv->list,
-                            GUINT_TO_POINTER (concat_reference),
-                            (GCompareFunc)cmp_sms_by_concat_reference);
-    if (l)
+    l = mm_sms_index_lookup_multipart_reference (self->priv->index,
+                                                 mm_sms_part_get_number (part),
+                                                 concat_reference);
+    if (l) {
         /* Try to take the part */
-        return mm_base_sms_multipart_take_part (MM_BASE_SMS (l->data), part, error);
+        sms = MM_BASE_SMS (l->data);
+        if (!mm_base_sms_multipart_take_part (sms, part, error))
+            return FALSE;
+        index_add_part (self, sms, part);
+        return TRUE;
+    }
 
     /* Create new Multipart */
     sms = mm_base_sms_multipart_new (self->priv->modem,
@@ -293,7 +384,7 @@ take_multipart (MMSmsList *self,
     if (!sms)
         return FALSE;
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
+    list_add (self, sms, mm_sms_part_get_number (part), FALSE);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    (state == MM_SMS_STATE_RECEIVED ||
@@ -307,18 +398,30 @@ mm_sms_list_has_part (MMSmsList *self,
                       MMSmsStorage storage,
                       guint index)
 {
-    PartIndexAndStorage ctx;
+    MMBaseSms *sms;
+    GList *l;
 
     if (storage == MM_SMS_STORAGE_UNKNOWN ||
         index == SMS_PART_INVALID_INDEX)
         return FALSE;
 
-    ctx.part_index = index;
-    ctx.storage = storage;
+    /* Part indexes are reset when deleted, so double check */
+    sms = mm_sms_index_lookup_part (self->priv->index, storage, index);
+    if (sms &&
+        mm_base_sms_get_storage (sms) == storage &&
+        mm_base_sms_has_part_index (sms, index))
+        return TRUE;
+
+    /* SMS created by the user aren't indexed by part, as they may be stored
+     * at any time */
+    for (l = self->priv->local; l; l = g_list_next (l)) {
+        sms = MM_BASE_SMS (l->data);
+        if (mm_base_sms_get_storage (sms) == storage &&
+            mm_base_sms_has_part_index (sms, index))
+            return TRUE;
+    }
 
-    return !!g_list_find_custom (self->priv->list,
-                                 &ctx,
-                                 (GCompareFunc)cmp_sms_by_part_index_and_storage);
+    return FALSE;
 }
 
 gboolean
@@ -421,6 +524,8 @@ mm_sms_list_init (MMSmsList *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_SMS_LIST,
                                               MMSmsListPrivate);
+    self->priv->links = g_hash_table_new (g_direct_hash, g_direct_equal);
+    self->priv->index = mm_sms_index_new ();
 }
 
 static void
@@ -429,6 +534,7 @@ dispose (GObject *object)
     MMSmsList *self = MM_SMS_LIST (object);
 
     g_clear_object (&self->priv->modem);
+    clear_indexes (self);
     g_list_free_full (self->priv->list, g_object_unref);
     self->priv->list = NULL;
 
@@ -17,7 +17,11 @@
 #include <string.h>
 #include <glib.h>
 
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
 #include "mm-port-serial-at.h"
+#include "mm-serial-parsers.h"
 #include "mm-log.h"
 
 typedef struct {
@@ -64,6 +68,232 @@ at_serial_echo_removal (void)
     }
 }
 
+/*****************************************************************************/
+
+static void
+at_serial_parser_v2_modified_buffer (void)
+{
+    gpointer  parser;
+    GString  *buffer;
+    GError   *error = NULL;
+
+    parser = mm_serial_parser_v2_new ();
+
+    /* Leading bytes already scanned get removed before the final reply
+     * arrives, e.g. when an unsolicited message is processed */
+    buffer = g_string_new ("\r\n+CIEV: 1,2\r\n\r\n+CSQ: 20,99\r\n\r\nNO CARR");
+    g_assert (!mm_serial_parser_v2_parse (parser, buffer, &error));
+    g_assert_no_error (error);
+
+    g_string_erase (buffer, 0, strlen ("\r\n+CIEV: 1,2\r\n"));
+    g_string_append (buffer, "IER\r\n");
+    g_assert (mm_serial_parser_v2_parse (parser, buffer, &error));
+    g_assert_error (error, MM_CONNECTION_ERROR, MM_CONNECTION_ERROR_NO_CARRIER);
+    g_clear_error (&error);
+
+    g_string_free (buffer, TRUE);
+    mm_serial_parser_v2_destroy (parser);
+}
+
+/*****************************************************************************/
+
+static const gchar *urc_patterns[] = {
+    "\\r\\n\\+CREG:\\s*(\\d+)(,\"?([0-9A-Fa-f]*)\"?,\"?([0-9A-Fa-f]*)\"?)?\\r\\n",
+    "\\r\\n\\+CGREG:\\s*(\\d+)(,\"?([0-9A-Fa-f]*)\"?,\"?([0-9A-Fa-f]*)\"?)?\\r\\n",
+    "\\r\\n\\+CEREG:\\s*(\\d+)(,\"?([0-9A-Fa-f]*)\"?,\"?([0-9A-Fa-f]*)\"?)?\\r\\n",
+    "\\r\\n\\+CIEV: (\\d+),(\\d)\\r\\n",
+    "\\r\\n\\+CMTI: \"(\\S+)\",(\\d+)\\r\\n",
+    "\\r\\n\\+CDSI: \"(\\S+)\",(\\d+)\\r\\n",
+    "\\r\\nRING\\r\\n",
+    "\\r\\n\\+CLIP:(.*)\\r\\n",
+    "\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
+    "\\r\\n\\^RSSI:\\s*(\\d+)\\r\\n",
+    "\\r\\n\\^RSSILVL:\\s*(\\d+)\\r+\\n",
+    "\\r\\n\\^HRSSILVL:\\s*(\\d+)\\r+\\n",
+    "\\r\\n\\^MODE:\\s*(\\d*),?(\\d*)\\r+\\n",
+    "\\r\\n\\^DSFLOWRPT:(.+)\\r\\n",
+    "\\r\\n(\\^NDISSTAT:.+)\\r+\\n",
+    "\\r\\n\\^BOOT:.+\\r\\n",
+    "\\r\\n\\^CONNECT .+\\r\\n",
+    "\\r\\n\\^CSNR:.+\\r\\n",
+    "\\r\\n\\^SIMST:.+\\r\\n",
+    "\\r\\n\\^SRVST:.+\\r\\n",
+    "\\r\\n(\\^HCSQ:.+)\\r+\\n",
+    "\\r\\n\\^RFSWITCH:.+\\r\\n",
+    "\\r\\n\\^ECCLIST:.+\\r\\n",
+    "\\r\\n\\^EONS:.+\\r\\n",
+    "\\r\\n\\+PACSP(\\d)\\r\\n",
+    "\\r\\n%IPDPACT:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)\\r\\n",
+    "\\r\\n\\*E2NAP: (\\d)\\r\\n",
+    "\\r\\n\\*E2NAP: (\\d),.*\\r\\n",
+    /* Not indexed, always run */
+    "\\r\\n(NO CARRIER)|(BUSY)\\r\\n",
+    "\\r+\\n\\+ZEND\\r\\n",
+};
+
+static const gchar *urc_stream[] = {
+    "\r\n^RSSI: 18\r\n",
+    "\r\n^DSFLOWRPT:00000046,00000000,00000000,0000000000000000,0000000000000000,0003E800,0003E800\r\n",
+    "\r\n+CREG: 1,\"1F0C\",\"0003C1A2\"\r\n",
+    "\r\n^HCSQ:\"LTE\",55,47,109,18\r\n",
+    "\r\n+CIEV: 2,3\r\n",
+    "\r\n^MODE: 5,4\r\n",
+    "\r\n+CGREG: 1\r\n",
+    "\r\n^BOOT:23456789,0,0,0,75\r\n",
+    "\r\n+CSQ: 20,99\r\n",
+    "\r\n^SRVST:2\r\n",
+    "\r\n+CEREG: 1,\"1F0C\",\"0003C1A2\",7\r\n",
+    "\r\n^NDISSTAT:1,,,\"IPV4\"\r\n",
+    "\r\n+PACSP1\r\n",
+    "\r\n*E2NAP: 1\r\n",
+    "\r\n*E2NAP: 2,1\r\n",
+    "\r\n%IPDPACT: 1,0,0\r\n",
+    "\r\n+CMTI: \"SM\",3\r\n",
+    "\r\nRING\r\n",
+    "\r\n^RSSILVL: 77\r\n",
+    "\r\nBUSY\r\n",
+    "\r\n+ZEND\r\n",
+};
+
+static void
+urc_counter_cb (MMPortSerialAt *port,
+                GMatchInfo     *match_info,
+                guint          *counter)
+{
+    (*counter)++;
+}
+
+static gdouble
+urc_dispatch_indexed (const gchar **stream,
+                      guint         stream_len,
+                      guint         repetitions,
+                      guint        *counters)
+{
+    MMPortSerialAt *port;
+    GByteArray     *buffer;
+    GTimer         *timer;
+    gdouble         elapsed;
+    guint           i;
+    guint           j;
+
+    port = mm_port_serial_at_new ("ttyTEST", MM_PORT_SUBSYS_TTY);
+    g_object_set (port, MM_PORT_SERIAL_AT_REMOVE_ECHO, FALSE, NULL);
+
+    for (i = 0; i < G_N_ELEMENTS (urc_patterns); i++) {
+        GRegex *regex;
+
+        regex = g_regex_new (urc_patterns[i], G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        g_assert (regex);
+        mm_port_serial_at_add_unsolicited_msg_handler (port,
+                                                       regex,
+                                                       (MMPortSerialAtUnsolicitedMsgFn) urc_counter_cb,
+                                                       &counters[i],
+                                                       NULL);
+        g_regex_unref (regex);
+    }
+
+    buffer = g_byte_array_new ();
+    timer = g_timer_new ();
+    for (j = 0; j < repetitions; j++) {
+        for (i = 0; i < stream_len; i++) {
+            g_byte_array_append (buffer, (const guint8 *) stream[i], strlen (stream[i]));
+            MM_PORT_SERIAL_GET_CLASS (port)->parse_unsolicited (MM_PORT_SERIAL (port), buffer);
+            g_byte_array_set_size (buffer, 0);
+        }
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+
+    g_timer_destroy (timer);
+    g_byte_array_unref (buffer);
+    g_object_unref (port);
+    return elapsed;
+}
+
+/* Linear dispatch, running every regex on every chunk, as done before the
+ * handlers were indexed */
+static gdouble
+urc_dispatch_linear (const gchar **stream,
+                     guint         stream_len,
+                     guint         repetitions,
+                     guint        *counters)
+{
+    GRegex     *regexes[G_N_ELEMENTS (urc_patterns)];
+    GByteArray *buffer;
+    GTimer     *timer;
+    gdouble     elapsed;
+    guint       i;
+    guint       j;
+    guint       k;
+
+    for (k = 0; k < G_N_ELEMENTS (urc_patterns); k++)
+        regexes[k] = g_regex_new (urc_patterns[k], G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+
+    buffer = g_byte_array_new ();
+    timer = g_timer_new ();
+    for (j = 0; j < repetitions; j++) {
+        for (i = 0; i < stream_len; i++) {
+            g_byte_array_append (buffer, (const guint8 *) stream[i], strlen (stream[i]));
+            /* Handlers are prepended, so the last one added runs first */
+            for (k = G_N_ELEMENTS (urc_patterns); k > 0; k--) {
+                GMatchInfo *match_info;
+                gchar      *str;
+
+                if (!g_regex_match_full (regexes[k - 1], (const gchar *) buffer->data, buffer->len, 0, 0, &match_info, NULL)) {
+                    g_match_info_free (match_info);
+                    continue;
+                }
+                while (g_match_info_matches (match_info)) {
+                    counters[k - 1]++;
+                    g_match_info_next (match_info, NULL);
+                }
+                g_match_info_free (match_info);
+
+                str = g_regex_replace_literal (regexes[k - 1], (const gchar *) buffer->data, buffer->len, 0, "", 0, NULL);
+                g_byte_array_set_size (buffer, 0);
+                g_byte_array_append (buffer, (const guint8 *) str, strlen (str));
+                g_free (str);
+            }
+            g_byte_array_set_size (buffer, 0);
+        }
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+
+    g_timer_destroy (timer);
+    g_byte_array_unref (buffer);
+    for (k = 0; k < G_N_ELEMENTS (urc_patterns); k++)
+        g_regex_unref (regexes[k]);
+    return elapsed;
+}
+
+static void
+at_serial_unsolicited_dispatch (void)
+{
+    guint   counters_indexed[G_N_ELEMENTS (urc_patterns)] = { 0 };
+    guint   counters_linear[G_N_ELEMENTS (urc_patterns)] = { 0 };
+    guint   repetitions;
+    guint   n_lines;
+    gdouble elapsed_indexed;
+    gdouble elapsed_linear;
+    guint   i;
+
+    repetitions = (g_test_perf () ? 10000 : 10);
+    n_lines = repetitions * G_N_ELEMENTS (urc_stream);
+
+    elapsed_linear = urc_dispatch_linear (urc_stream, G_N_ELEMENTS (urc_stream), repetitions, counters_linear);
+    elapsed_indexed = urc_dispatch_indexed (urc_stream, G_N_ELEMENTS (urc_stream), repetitions, counters_indexed);
+
+    /* Every handler must get exactly the same messages */
+    for (i = 0; i < G_N_ELEMENTS (urc_patterns); i++)
+        g_assert_cmpuint (counters_indexed[i], ==, counters_linear[i]);
+
+    if (elapsed_linear > 0 && elapsed_indexed > 0) {
+        g_test_message ("linear dispatch:  %.0f lines/s", n_lines / elapsed_linear);
+        g_test_message ("indexed dispatch: %.0f lines/s", n_lines / elapsed_indexed);
+    }
+}
+
+/*****************************************************************************/
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -89,6 +319,8 @@ int main (int argc, char **argv)
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/ModemManager/AT-serial/echo-removal", at_serial_echo_removal);
+    g_test_add_func ("/ModemManager/AT-serial/parser-v2-modified-buffer", at_serial_parser_v2_modified_buffer);
+    g_test_add_func ("/ModemManager/AT-serial/unsolicited-dispatch", at_serial_unsolicited_dispatch);
 
     return g_test_run ();
 }
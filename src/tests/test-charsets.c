@@ -315,6 +315,342 @@ test_gsm7_pack_7_chars_offset (void)
     g_free (packed);
 }
 
+/* Reference bit-by-bit implementations, to validate the ones in the
+ * charset helpers against */
+static void
+reference_gsm_pack (const guint8 *src,
+                    guint32       src_len,
+                    guint8        start_offset,
+                    guint8       *packed)
+{
+    guint32 i, j;
+
+    for (i = 0; i < src_len; i++) {
+        for (j = 0; j < 7; j++) {
+            guint32 bit = start_offset + (i * 7) + j;
+
+            if (src[i] & (1 << j))
+                packed[bit / 8] |= (1 << (bit % 8));
+        }
+    }
+}
+
+static void
+reference_gsm_unpack (const guint8 *packed,
+                      guint32       num_septets,
+                      guint8        start_offset,
+                      guint8       *unpacked)
+{
+    guint32 i, j;
+
+    for (i = 0; i < num_septets; i++) {
+        unpacked[i] = 0;
+        for (j = 0; j < 7; j++) {
+            guint32 bit = start_offset + (i * 7) + j;
+
+            if (packed[bit / 8] & (1 << (bit % 8)))
+                unpacked[i] |= (1 << j);
+        }
+    }
+}
+
+static void
+test_gsm7_pack_unpack_random (void)
+{
+    guint32 len;
+    guint8  offset;
+
+    /* Lengths around the group size, for all possible bit offsets */
+    for (len = 0; len <= 70; len++) {
+        for (offset = 0; offset < 8; offset++) {
+            guint8  *src;
+            guint8  *expected;
+            guint8  *packed;
+            guint8  *unpacked;
+            guint32  expected_len;
+            guint32  packed_len = 0;
+            guint32  unpacked_len = 0;
+            guint32  i;
+
+            src = g_malloc (len + 1);
+            for (i = 0; i < len; i++)
+                src[i] = (guint8) g_test_rand_int_range (0, 0x80);
+
+            expected_len = ((len * 7) + offset + 7) / 8;
+            expected = g_malloc0 (expected_len + 1);
+            reference_gsm_pack (src, len, offset, expected);
+
+            trace ("testing GSM7 pack/unpack: %u septets, %u bit offset\n", len, offset);
+
+            packed = mm_charset_gsm_pack (src, len, offset, &packed_len);
+            g_assert (packed);
+            g_assert_cmpuint (packed_len, ==, expected_len);
+            g_assert_cmpint (memcmp (packed, expected, packed_len), ==, 0);
+
+            unpacked = mm_charset_gsm_unpack (packed, len, offset, &unpacked_len);
+            g_assert (unpacked);
+            g_assert_cmpuint (unpacked_len, ==, len);
+            g_assert_cmpint (memcmp (unpacked, src, len), ==, 0);
+
+            /* The reference unpacker must agree as well */
+            memset (unpacked, 0xFF, len);
+            reference_gsm_unpack (packed, len, offset, unpacked);
+            g_assert_cmpint (memcmp (unpacked, src, len), ==, 0);
+
+            g_free (unpacked);
+            g_free (packed);
+            g_free (expected);
+            g_free (src);
+        }
+    }
+}
+
+static void
+test_gsm7_unpacked_all_chars (void)
+{
+    guint8  gsm[128];
+    guint8 *utf8;
+    guint8 *back;
+    guint32 back_len = 0;
+    guint32 i, j;
+
+    /* Every char in the default alphabet, except for the escape one, must
+     * have a UTF-8 representation which maps back to the same char */
+    for (i = 0, j = 0; i < 128; i++) {
+        if (i != 0x1B)
+            gsm[j++] = i;
+    }
+
+    utf8 = mm_charset_gsm_unpacked_to_utf8 (gsm, j);
+    g_assert (utf8);
+    g_assert (g_utf8_validate ((const gchar *) utf8, -1, NULL));
+
+    back = mm_charset_utf8_to_unpacked_gsm ((const gchar *) utf8, &back_len);
+    g_assert (back);
+    g_assert_cmpuint (back_len, ==, j);
+    g_assert_cmpint (memcmp (back, gsm, j), ==, 0);
+
+    g_free (back);
+    g_free (utf8);
+}
+
+static void
+test_gsm7_unpacked_unknown_chars (void)
+{
+    static const guint8 gsm[] = { 0x41, 0x1B, 0x41, 0x42, 0x1B };
+    guint8 *utf8;
+
+    /* Unknown extended chars are replaced, and so is a trailing escape */
+    utf8 = mm_charset_gsm_unpacked_to_utf8 (gsm, sizeof (gsm));
+    g_assert (utf8);
+    g_assert_cmpstr ((const gchar *) utf8, ==, "A?AB?");
+    g_free (utf8);
+}
+
+static void
+test_gsm7_hex (void)
+{
+    gchar *hex;
+    gchar *utf8;
+
+    /* GSM conversions go through the 03.38 tables, not through iconv */
+    hex = mm_modem_charset_utf8_to_hex ("Hello {€}", MM_MODEM_CHARSET_GSM);
+    g_assert_cmpstr (hex, ==, "48656C6C6F201B281B651B29");
+
+    utf8 = mm_modem_charset_hex_to_utf8 (hex, MM_MODEM_CHARSET_GSM);
+    g_assert_cmpstr (utf8, ==, "Hello {€}");
+
+    g_free (utf8);
+    g_free (hex);
+
+    utf8 = mm_utf8_take_and_convert_to_charset (g_strdup ("ΔΦΓ patín"), MM_MODEM_CHARSET_GSM);
+    g_assert (utf8 == NULL);
+}
+
+static void
+test_gsm7_at_sign (void)
+{
+    static const guint8 expected[] = { '"', 'a', 0x00, 'b', '"' };
+    GByteArray *array;
+    gchar      *hex;
+    gchar      *str;
+
+    /* '@' is 0x00 in the GSM alphabet, so it's kept when the length is known... */
+    array = g_byte_array_new ();
+    g_assert (mm_modem_charset_byte_array_append (array, "a@b", TRUE, MM_MODEM_CHARSET_GSM));
+    g_assert_cmpuint (array->len, ==, sizeof (expected));
+    g_assert (memcmp (array->data, expected, sizeof (expected)) == 0);
+    g_byte_array_unref (array);
+
+    hex = mm_modem_charset_utf8_to_hex ("a@b", MM_MODEM_CHARSET_GSM);
+    g_assert_cmpstr (hex, ==, "610062");
+    str = mm_modem_charset_hex_to_utf8 (hex, MM_MODEM_CHARSET_GSM);
+    g_assert_cmpstr (str, ==, "a@b");
+    g_free (str);
+    g_free (hex);
+
+    /* ...but not returned truncated as a NUL-terminated string */
+    g_assert (!mm_utf8_take_and_convert_to_charset (g_strdup ("a@b"), MM_MODEM_CHARSET_GSM));
+    g_assert (!mm_utf8_take_and_convert_to_charset (g_strdup ("@"), MM_MODEM_CHARSET_GSM));
+
+    /* And it's no problem in other charsets */
+    str = mm_utf8_take_and_convert_to_charset (g_strdup ("a@b"), MM_MODEM_CHARSET_8859_1);
+    g_assert_cmpstr (str, ==, "a@b");
+    g_free (str);
+}
+
+static void
+test_iconv_cached (void)
+{
+    guint  i;
+    gchar *str;
+
+    /* The iconv descriptors are opened once and reused; a failed strict
+     * conversion in between must not leave them in a bad state */
+    for (i = 0; i < 3; i++) {
+        str = mm_utf8_take_and_convert_to_charset (g_strdup ("patín"), MM_MODEM_CHARSET_8859_1);
+        g_assert_cmpstr (str, ==, "pat\xedn");
+        g_free (str);
+
+        g_assert (!mm_utf8_take_and_convert_to_charset (g_strdup ("ΔΦΓ"), MM_MODEM_CHARSET_8859_1));
+
+        str = mm_modem_charset_utf8_to_hex ("patín", MM_MODEM_CHARSET_UCS2);
+        g_assert_cmpstr (str, ==, "00700061007400ED006E");
+        g_free (str);
+
+        str = mm_modem_charset_hex_to_utf8 ("00700061007400ED006E", MM_MODEM_CHARSET_UCS2);
+        g_assert_cmpstr (str, ==, "patín");
+        g_free (str);
+    }
+}
+
+static void
+test_iconv_perf (void)
+{
+    static const char *s = "The quick brown fox jumps over the lazy dog: 0123456789 ÄÖÑÜ àéíóú ";
+    GString *text;
+    GTimer  *timer;
+    gchar   *hex;
+    gchar   *utf8;
+    guint    i;
+
+    if (!g_test_perf ())
+        return;
+
+    /* Roughly the size of a long multipart SMS */
+    text = g_string_new (NULL);
+    while (text->len < 4000)
+        g_string_append (text, s);
+
+    timer = g_timer_new ();
+
+#define PERF_ITERATIONS 1000
+
+    /* All these reuse the cached iconv descriptors */
+    g_timer_start (timer);
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        hex = mm_modem_charset_utf8_to_hex (text->str, MM_MODEM_CHARSET_UCS2);
+        g_free (hex);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                             "UTF-8 to UCS2: %u x %" G_GSIZE_FORMAT " bytes", PERF_ITERATIONS, text->len);
+
+    hex = mm_modem_charset_utf8_to_hex (text->str, MM_MODEM_CHARSET_UCS2);
+
+    g_timer_start (timer);
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        utf8 = mm_modem_charset_hex_to_utf8 (hex, MM_MODEM_CHARSET_UCS2);
+        g_free (utf8);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                             "UCS2 to UTF-8: %u x %" G_GSIZE_FORMAT " bytes", PERF_ITERATIONS, strlen (hex) / 2);
+
+    g_timer_start (timer);
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        utf8 = mm_utf8_take_and_convert_to_charset (g_strdup (text->str), MM_MODEM_CHARSET_8859_1);
+        g_free (utf8);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                             "UTF-8 to 8859-1: %u x %" G_GSIZE_FORMAT " bytes", PERF_ITERATIONS, text->len);
+
+#undef PERF_ITERATIONS
+
+    g_free (hex);
+    g_timer_destroy (timer);
+    g_string_free (text, TRUE);
+}
+
+static void
+test_gsm7_perf (void)
+{
+    static const char *s = "The quick brown fox jumps over the lazy dog: 0123456789 {[€]} ÄÖÑÜ ΔΦΓΛΩ ";
+    GString *text;
+    GTimer  *timer;
+    guint8  *gsm;
+    guint8  *packed;
+    guint8  *unpacked;
+    guint8  *utf8;
+    guint32  gsm_len = 0;
+    guint32  packed_len = 0;
+    guint32  unpacked_len = 0;
+    guint    i;
+
+    if (!g_test_perf ())
+        return;
+
+    /* Roughly the size of a long multipart SMS */
+    text = g_string_new (NULL);
+    while (text->len < 4000)
+        g_string_append (text, s);
+
+    timer = g_timer_new ();
+
+#define PERF_ITERATIONS 1000
+
+    g_timer_start (timer);
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        gsm = mm_charset_utf8_to_unpacked_gsm (text->str, &gsm_len);
+        g_free (gsm);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                             "UTF-8 to GSM: %u x %" G_GSIZE_FORMAT " bytes", PERF_ITERATIONS, text->len);
+
+    gsm = mm_charset_utf8_to_unpacked_gsm (text->str, &gsm_len);
+
+    g_timer_start (timer);
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        utf8 = mm_charset_gsm_unpacked_to_utf8 (gsm, gsm_len);
+        g_free (utf8);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                             "GSM to UTF-8: %u x %u septets", PERF_ITERATIONS, gsm_len);
+
+    g_timer_start (timer);
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        packed = mm_charset_gsm_pack (gsm, gsm_len, 0, &packed_len);
+        g_free (packed);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                             "GSM pack: %u x %u septets", PERF_ITERATIONS, gsm_len);
+
+    packed = mm_charset_gsm_pack (gsm, gsm_len, 0, &packed_len);
+
+    g_timer_start (timer);
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        unpacked = mm_charset_gsm_unpack (packed, gsm_len, 0, &unpacked_len);
+        g_free (unpacked);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                             "GSM unpack: %u x %u septets", PERF_ITERATIONS, gsm_len);
+
+#undef PERF_ITERATIONS
+
+    g_free (packed);
+    g_free (gsm);
+    g_timer_destroy (timer);
+    g_string_free (text, TRUE);
+}
+
 static void
 test_take_convert_ucs2_hex_utf8 (void)
 {
@@ -448,6 +784,15 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/charsets/gsm7/pack/24-chars",          test_gsm7_pack_24_chars);
     g_test_add_func ("/MM/charsets/gsm7/pack/last-septet-alone", test_gsm7_pack_last_septet_alone);
     g_test_add_func ("/MM/charsets/gsm7/pack/7-chars-offset",    test_gsm7_pack_7_chars_offset);
+    g_test_add_func ("/MM/charsets/gsm7/pack-unpack/random",     test_gsm7_pack_unpack_random);
+    g_test_add_func ("/MM/charsets/gsm7/unpacked/all-chars",     test_gsm7_unpacked_all_chars);
+    g_test_add_func ("/MM/charsets/gsm7/unpacked/unknown-chars", test_gsm7_unpacked_unknown_chars);
+    g_test_add_func ("/MM/charsets/gsm7/hex",                    test_gsm7_hex);
+    g_test_add_func ("/MM/charsets/gsm7/at-sign",                test_gsm7_at_sign);
+    g_test_add_func ("/MM/charsets/gsm7/perf",                   test_gsm7_perf);
+
+    g_test_add_func ("/MM/charsets/iconv/cached", test_iconv_cached);
+    g_test_add_func ("/MM/charsets/iconv/perf",   test_iconv_perf);
 
     g_test_add_func ("/MM/charsets/take-convert/ucs2/hex",         test_take_convert_ucs2_hex_utf8);
     g_test_add_func ("/MM/charsets/take-convert/ucs2/bad-ascii",   test_take_convert_ucs2_bad_ascii);
@@ -0,0 +1,233 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <locale.h>
+
+/* Define symbol to enable test message traces */
+#undef ENABLE_TEST_MESSAGE_TRACES
+
+#include "mm-log-history.h"
+#include "mm-log.h"
+
+#define TEST_UID "/sys/devices/pci0000:00/0000:00:14.0/usb1/1-1"
+
+static const gchar *test_keys[] = { TEST_UID, "ttyUSB1", "cdc-wdm0", NULL };
+
+static void
+append (const gchar *line)
+{
+    mm_log_history_append (line, strlen (line));
+}
+
+static guint
+history_length (const gchar *id)
+{
+    gchar **lines;
+    guint   n;
+
+    lines = mm_log_history_get (id);
+    g_assert (lines);
+    n = g_strv_length (lines);
+    g_strfreev (lines);
+    return n;
+}
+
+/************************************************************/
+
+static void
+test_disabled (void)
+{
+    mm_log_history_setup (0);
+
+    mm_log_history_add (TEST_UID, &test_keys, test_keys);
+    g_assert (!mm_log_history_is_active ());
+    append ("ttyUSB1 opened");
+    g_assert (!mm_log_history_get (TEST_UID));
+
+    mm_log_history_shutdown ();
+}
+
+static void
+test_ring (void)
+{
+    gchar **lines;
+    gchar  *line;
+    guint   i;
+
+    mm_log_history_setup (4);
+    g_assert (!mm_log_history_is_active ());
+    mm_log_history_add (TEST_UID, &test_keys, test_keys);
+    g_assert (mm_log_history_is_active ());
+    g_assert_cmpuint (history_length (TEST_UID), ==, 0);
+
+    for (i = 0; i < 3; i++) {
+        line = g_strdup_printf ("ttyUSB1 line %u", i);
+        append (line);
+        g_free (line);
+    }
+    lines = mm_log_history_get (TEST_UID);
+    g_assert_cmpuint (g_strv_length (lines), ==, 3);
+    g_assert_cmpstr (lines[0], ==, "ttyUSB1 line 0");
+    g_assert_cmpstr (lines[2], ==, "ttyUSB1 line 2");
+    g_strfreev (lines);
+
+    /* Wrap around the ring a few times: the last lines are kept, oldest
+     * first */
+    for (i = 3; i < 14; i++) {
+        line = g_strdup_printf ("ttyUSB1 line %u", i);
+        append (line);
+        g_free (line);
+    }
+    lines = mm_log_history_get (TEST_UID);
+    g_assert_cmpuint (g_strv_length (lines), ==, 4);
+    g_assert_cmpstr (lines[0], ==, "ttyUSB1 line 10");
+    g_assert_cmpstr (lines[1], ==, "ttyUSB1 line 11");
+    g_assert_cmpstr (lines[2], ==, "ttyUSB1 line 12");
+    g_assert_cmpstr (lines[3], ==, "ttyUSB1 line 13");
+    g_strfreev (lines);
+
+    /* Only the given length of the line is kept */
+    mm_log_history_append ("ttyUSB1 line 14\n", strlen ("ttyUSB1 line 14"));
+    lines = mm_log_history_get (TEST_UID);
+    g_assert_cmpstr (lines[3], ==, "ttyUSB1 line 14");
+    g_strfreev (lines);
+
+    /* Lines are kept when the keys change */
+    mm_log_history_add (TEST_UID, &test_keys, test_keys);
+    g_assert_cmpuint (history_length (TEST_UID), ==, 4);
+
+    /* Only the owner removes it */
+    mm_log_history_remove (TEST_UID, NULL);
+    g_assert_cmpuint (history_length (TEST_UID), ==, 4);
+
+    mm_log_history_remove (TEST_UID, &test_keys);
+    g_assert (!mm_log_history_get (TEST_UID));
+    g_assert (!mm_log_history_is_active ());
+
+    mm_log_history_shutdown ();
+}
+
+static void
+test_owner (void)
+{
+    gint old_device;
+    gint new_device;
+
+    mm_log_history_setup (4);
+
+    mm_log_history_add (TEST_UID, &old_device, test_keys);
+    append ("ttyUSB1 line 0");
+
+    /* The device is re-added before the old object is gone: the new one
+     * takes over the history, lines included */
+    mm_log_history_add (TEST_UID, &new_device, test_keys);
+    append ("ttyUSB1 line 1");
+    mm_log_history_remove (TEST_UID, &old_device);
+    g_assert_cmpuint (history_length (TEST_UID), ==, 2);
+
+    mm_log_history_remove (TEST_UID, &new_device);
+    g_assert (!mm_log_history_get (TEST_UID));
+
+    mm_log_history_shutdown ();
+}
+
+typedef struct {
+    const gchar *line;
+    gboolean     matches;
+} KeyTest;
+
+static const KeyTest key_tests[] = {
+    { "[device " TEST_UID "] creating modem",                 TRUE  },
+    { "Couldn't find support for device at '" TEST_UID "'",   TRUE  },
+    { "Creating device " TEST_UID ".",                        TRUE  },
+    { TEST_UID,                                               TRUE  },
+    /* Another device behind a hub on the same port */
+    { "[device " TEST_UID ".2] creating modem",               FALSE },
+    { "[device " TEST_UID "/1-1.2] creating modem",           FALSE },
+    { "[device " TEST_UID "0] creating modem",                FALSE },
+    { "(ttyUSB1) opening serial port...",                     TRUE  },
+    { "(tty/ttyUSB1): port probing finished",                 TRUE  },
+    { "ttyUSB1: port is now closed",                          TRUE  },
+    { "(ttyUSB10) opening serial port...",                    FALSE },
+    { "(ttyUSB1.1) opening serial port...",                   FALSE },
+    { "(xttyUSB1) opening serial port...",                    FALSE },
+    { "(usbmisc/cdc-wdm0) opening QMI device...",             TRUE  },
+    { "(usbmisc/cdc-wdm01) opening QMI device...",            FALSE },
+    { "Nothing to see here",                                  FALSE },
+};
+
+static void
+test_keys_match (void)
+{
+    static const gchar *other_keys[] = { "/sys/devices/pci0000:00/0000:00:14.0/usb1/1-2", "ttyUSB10", NULL };
+    guint n_expected = 0;
+    guint i;
+
+    mm_log_history_setup (G_N_ELEMENTS (key_tests));
+    mm_log_history_add (TEST_UID, &test_keys, test_keys);
+    mm_log_history_add ("other", &other_keys, other_keys);
+
+    for (i = 0; i < G_N_ELEMENTS (key_tests); i++) {
+        append (key_tests[i].line);
+        if (key_tests[i].matches)
+            n_expected++;
+        g_assert_cmpuint (history_length (TEST_UID), ==, n_expected);
+    }
+
+    /* The same lines may go to several histories */
+    append ("(ttyUSB1) and (ttyUSB10) opened");
+    g_assert_cmpuint (history_length (TEST_UID), ==, n_expected + 1);
+    g_assert_cmpuint (history_length ("other"), ==, 2);
+
+    mm_log_history_shutdown ();
+    g_assert (!mm_log_history_is_active ());
+    g_assert (!mm_log_history_get (TEST_UID));
+}
+
+/************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/log-history/disabled", test_disabled);
+    g_test_add_func ("/MM/log-history/ring",     test_ring);
+    g_test_add_func ("/MM/log-history/owner",    test_owner);
+    g_test_add_func ("/MM/log-history/keys",     test_keys_match);
+
+    return g_test_run ();
+}
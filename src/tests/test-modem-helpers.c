@@ -21,6 +21,7 @@
 
 #include <libmm-glib.h>
 #include "mm-modem-helpers.h"
+#include "mm-serial-parsers.h"
 #include "mm-log.h"
 
 #if defined ENABLE_TEST_MESSAGE_TRACES
@@ -32,6 +33,103 @@
 #define g_assert_cmpfloat_tolerance(val1, val2, tolerance)  \
     g_assert_cmpfloat (fabs (val1 - val2), <, tolerance)
 
+/*****************************************************************************/
+/* The replies in this file are also given to both AT serial parsers, which
+ * must agree on every one of them, whatever the final result code and however
+ * the reply is split when read */
+
+static const gchar *serial_parsers_final_codes[] = {
+    "OK\r\n",
+    "ERROR\r\n",
+    "+CME ERROR: 10\r\n",
+    "+CME ERROR: SIM not inserted\r\n",
+    "+CME ERROR: \r\n+CME ERROR: 3\r\n",
+    "+CMS ERROR: 321\r\n",
+    "MODEM ERROR: 3\r\n",
+    "NO CARRIER\r\n",
+    "NO DIALTONE\r\n",
+    "BUSY\r\n",
+    "NO ANSWER\r\n",
+    "CONNECT\r\n",
+    "CONNECT 115200\r\n",
+    "COMMAND NOT SUPPORT\r\n",
+    "ERROR",
+    "> ",
+};
+
+static void
+serial_parsers_compare (const gchar *response,
+                        gsize        chunk_size)
+{
+    gpointer  parser_v1;
+    gpointer  parser_v2;
+    GString  *buffer_v1;
+    GString  *buffer_v2;
+    gsize     response_len;
+    gsize     fed;
+
+    parser_v1 = mm_serial_parser_v1_new ();
+    parser_v2 = mm_serial_parser_v2_new ();
+    buffer_v1 = g_string_new ("");
+    buffer_v2 = g_string_new ("");
+
+    response_len = strlen (response);
+    for (fed = 0; fed < response_len; fed += chunk_size) {
+        GError   *error_v1 = NULL;
+        GError   *error_v2 = NULL;
+        gboolean  found_v1;
+        gboolean  found_v2;
+
+        g_string_append_len (buffer_v1, &response[fed], MIN (chunk_size, response_len - fed));
+        g_string_append_len (buffer_v2, &response[fed], MIN (chunk_size, response_len - fed));
+
+        found_v1 = mm_serial_parser_v1_parse (parser_v1, buffer_v1, &error_v1);
+        found_v2 = mm_serial_parser_v2_parse (parser_v2, buffer_v2, &error_v2);
+
+        g_assert_cmpint (found_v1, ==, found_v2);
+        g_assert_cmpstr (buffer_v1->str, ==, buffer_v2->str);
+        if (error_v1) {
+            g_assert (error_v2);
+            g_assert_cmpuint (error_v1->domain, ==, error_v2->domain);
+            g_assert_cmpint (error_v1->code, ==, error_v2->code);
+            g_assert_cmpstr (error_v1->message, ==, error_v2->message);
+            g_error_free (error_v1);
+            g_error_free (error_v2);
+        } else
+            g_assert (!error_v2);
+
+        if (found_v1)
+            break;
+    }
+
+    g_string_free (buffer_v1, TRUE);
+    g_string_free (buffer_v2, TRUE);
+    mm_serial_parser_v1_destroy (parser_v1);
+    mm_serial_parser_v2_destroy (parser_v2);
+}
+
+static void
+test_serial_parsers (const gchar *reply)
+{
+    guint i;
+
+    if (!reply)
+        return;
+
+    for (i = 0; i < G_N_ELEMENTS (serial_parsers_final_codes); i++) {
+        gchar *response;
+
+        response = g_strdup_printf ("\r\n%s\r\n\r\n%s", reply, serial_parsers_final_codes[i]);
+        /* Whole reply at once, and split in small chunks; byte by byte only
+         * for the most common final result code, as it is slow with v1 */
+        serial_parsers_compare (response, strlen (response));
+        serial_parsers_compare (response, 7);
+        if (i == 0)
+            serial_parsers_compare (response, 1);
+        g_free (response);
+    }
+}
+
 /*****************************************************************************/
 /* Test IFC=? responses */
 
@@ -42,6 +140,8 @@ test_ifc_response (const gchar         *str,
     MMFlowControl  mask;
     GError        *error = NULL;
 
+    test_serial_parsers (str);
+
     mask = mm_parse_ifc_test_response (str, &error);
     g_assert_no_error (error);
     g_assert_cmpuint (mask, ==, expected);
@@ -131,6 +231,8 @@ test_ws46_response (const gchar       *str,
     GArray *modes;
     GError *error = NULL;
 
+    test_serial_parsers (str);
+
     modes = mm_3gpp_parse_ws46_test_response (str, &error);
     g_assert_no_error (error);
     g_assert (modes != NULL);
@@ -257,6 +359,8 @@ test_cmgl_response (const gchar *str,
     GList *list;
     GError *error = NULL;
 
+    test_serial_parsers (str);
+
     list = mm_3gpp_parse_pdu_cmgl_response (str, &error);
     g_assert_no_error (error);
     g_assert (list != NULL);
@@ -412,6 +516,41 @@ test_cmgl_response_pantech_multiple (void *f, gpointer d)
     test_cmgl_response (str, expected, G_N_ELEMENTS (expected));
 }
 
+static void
+test_cmgl_response_incremental (void *f, gpointer d)
+{
+    const gchar *str =
+        "+CMGL: 17,3,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "+CMGL: 15,3,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "+CMGL: 13,1,,35\r\n079100F40D1101000F001000B917118336058F300\r\n"
+        "\r\nOK\r\n";
+    const gint expected_index[] = { 17, 15, 13 };
+    const gint expected_status[] = { 3, 3, 1 };
+    MM3gppPduInfo *info;
+    GError *error = NULL;
+    gsize len;
+    gsize offset = 0;
+    guint i = 0;
+
+    len = strlen (str);
+    while ((info = mm_3gpp_parse_pdu_cmgl_response_next (str, len, &offset, &error)) != NULL) {
+        g_assert_cmpuint (i, <, G_N_ELEMENTS (expected_index));
+        g_assert_cmpint (info->index, ==, expected_index[i]);
+        g_assert_cmpint (info->status, ==, expected_status[i]);
+        g_assert (g_str_has_prefix (info->pdu, "079100F40D11"));
+        g_assert_cmpuint (offset, <=, len);
+        mm_3gpp_pdu_info_free (info);
+        i++;
+    }
+    g_assert_no_error (error);
+    g_assert_cmpuint (i, ==, G_N_ELEMENTS (expected_index));
+    g_assert_cmpuint (offset, ==, len);
+
+    /* Nothing else once done */
+    g_assert (mm_3gpp_parse_pdu_cmgl_response_next (str, len, &offset, &error) == NULL);
+    g_assert_no_error (error);
+}
+
 /*****************************************************************************/
 /* Test CMGR responses */
 
@@ -422,6 +561,8 @@ test_cmgr_response (const gchar *str,
     MM3gppPduInfo *info;
     GError *error = NULL;
 
+    test_serial_parsers (str);
+
     info = mm_3gpp_parse_cmgr_read_response (str, 0, &error);
     g_assert_no_error (error);
     g_assert (info != NULL);
@@ -488,6 +629,8 @@ test_cops_results (const gchar *desc,
     GError *error = NULL;
     GList *results;
 
+    test_serial_parsers (reply);
+
     trace ("\nTesting %s +COPS response...\n", desc);
 
     results = mm_3gpp_parse_cops_test_response (reply, &error);
@@ -1085,6 +1228,8 @@ test_creg_match (const char *test,
     guint regex_num = 0;
     GPtrArray *array;
 
+    test_serial_parsers (reply);
+
     g_assert (reply);
     g_assert (test);
     g_assert (data);
@@ -1909,6 +2054,8 @@ test_cmer_response (const gchar    *str,
     MM3gppCmerInd   inds = MM_3GPP_CMER_IND_NONE;
     GError         *error = NULL;
 
+    test_serial_parsers (str);
+
     ret = mm_3gpp_parse_cmer_test_response (str, &modes, &inds, &error);
     g_assert_no_error (error);
     g_assert (ret);
@@ -1989,6 +2136,8 @@ test_cind_results (const char *desc,
     GError *error = NULL;
     GHashTable *results;
 
+    test_serial_parsers (reply);
+
     trace ("\nTesting %s +CIND response...\n", desc);
 
     results = mm_3gpp_parse_cind_test_response (reply, &error);
@@ -2408,6 +2557,8 @@ test_cgdcont_test_results (const gchar *desc,
     GError *error = NULL;
     GList *results;
 
+    test_serial_parsers (reply);
+
     trace ("\nTesting %s +CGDCONT test response...\n", desc);
 
     results = mm_3gpp_parse_cgdcont_test_response (reply, &error);
@@ -2536,6 +2687,8 @@ test_cgdcont_read_results (const gchar *desc,
     GError *error = NULL;
     GList *results;
 
+    test_serial_parsers (reply);
+
     trace ("\nTesting %s +CGDCONT response...\n", desc);
 
     results = mm_3gpp_parse_cgdcont_read_response (reply, &error);
@@ -2606,6 +2759,8 @@ test_cgact_read_results (const gchar *desc,
     GError *error = NULL;
     GList *results;
 
+    test_serial_parsers (reply);
+
     trace ("\nTesting %s +CGACT response...\n", desc);
 
     results = mm_3gpp_parse_cgact_read_response (reply, &error);
@@ -2894,6 +3049,8 @@ test_cnum_results (const gchar *desc,
     GStrv results;
     guint i;
 
+    test_serial_parsers (reply);
+
     trace ("\nTesting +CNUM response (%s)...\n", desc);
 
     results = mm_3gpp_parse_cnum_exec_response (reply);
@@ -3064,6 +3221,8 @@ common_parse_cds (const gchar *str,
     gchar *pdu_len_str;
     gchar *pdu;
 
+    test_serial_parsers (str);
+
     regex = mm_3gpp_cds_regex_get ();
     g_regex_match (regex, str, 0, &match_info);
     g_assert (g_match_info_matches (match_info));
@@ -4004,6 +4163,311 @@ test_bcd_to_string (void *f, gpointer d)
     }
 }
 
+/*****************************************************************************/
+/* Test signal samples statistics */
+
+static void
+test_signal_samples_statistics (void *f, gpointer d)
+{
+    gdouble            values[] = { -90.0, -100.0, -80.0, -95.0, -85.0 };
+    gdouble            single[] = { -70.5 };
+    MMSignalStatistics stats;
+
+    g_assert (!mm_signal_samples_get_statistics (values, 0, &stats));
+
+    g_assert (mm_signal_samples_get_statistics (values, G_N_ELEMENTS (values), &stats));
+    g_assert_cmpuint (stats.n_samples, ==, 5);
+    g_assert_cmpfloat_tolerance (stats.min,  -100.0, 0.001);
+    g_assert_cmpfloat_tolerance (stats.max,   -80.0, 0.001);
+    g_assert_cmpfloat_tolerance (stats.mean,  -90.0, 0.001);
+    g_assert_cmpfloat_tolerance (stats.p10,   -98.0, 0.001);
+    g_assert_cmpfloat_tolerance (stats.p50,   -90.0, 0.001);
+    g_assert_cmpfloat_tolerance (stats.p90,   -82.0, 0.001);
+
+    /* Values are left sorted */
+    g_assert_cmpfloat (values[0], ==, -100.0);
+    g_assert_cmpfloat (values[4], ==,  -80.0);
+
+    g_assert (mm_signal_samples_get_statistics (single, G_N_ELEMENTS (single), &stats));
+    g_assert_cmpuint (stats.n_samples, ==, 1);
+    g_assert_cmpfloat_tolerance (stats.min,  -70.5, 0.001);
+    g_assert_cmpfloat_tolerance (stats.max,  -70.5, 0.001);
+    g_assert_cmpfloat_tolerance (stats.p10,  -70.5, 0.001);
+    g_assert_cmpfloat_tolerance (stats.p90,  -70.5, 0.001);
+}
+
+/*****************************************************************************/
+/* Test NMEA sentence tokenizer */
+
+static void
+test_nmea_sentence_find (void *f, gpointer d)
+{
+    static const gchar data[] =
+        "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"        /* valid */
+        "garbage\r\n"
+        "$GPGGA,123410.00,4807.0$GPVTG,084.4,T,087.5,M,022.4,N,041.5,K*48\r\n" /* truncated, then valid */
+        "$GPVTG,084.4,T,087.5,M,022.4,N,041.5,K*49\r\n"            /* wrong checksum */
+        "$PXXX,no,checksum\r\n"                                      /* valid */
+        "$GPRMC,123410.00,A,4807.038,N";                              /* incomplete */
+    gsize    len = sizeof (data) - 1;
+    gsize    offset = 0;
+    gsize    start = 0;
+    gsize    end = 0;
+    gboolean valid = FALSE;
+
+    g_assert (mm_nmea_sentence_find (data, len, offset, &start, &end, &valid));
+    g_assert_cmpuint (start, ==, 0);
+    g_assert (g_str_has_prefix (&data[end], "garbage"));
+    g_assert (valid);
+
+    offset = end;
+    g_assert (mm_nmea_sentence_find (data, len, offset, &start, &end, &valid));
+    g_assert (g_str_has_prefix (&data[start], "$GPVTG,084.4,T,087.5,M,022.4,N,041.5,K*48\r\n"));
+    g_assert_cmpuint (end - start, ==, strlen ("$GPVTG,084.4,T,087.5,M,022.4,N,041.5,K*48\r\n"));
+    g_assert (valid);
+
+    offset = end;
+    g_assert (mm_nmea_sentence_find (data, len, offset, &start, &end, &valid));
+    g_assert (g_str_has_prefix (&data[start], "$GPVTG,084.4,T,087.5,M,022.4,N,041.5,K*49"));
+    g_assert (!valid);
+
+    offset = end;
+    g_assert (mm_nmea_sentence_find (data, len, offset, &start, &end, &valid));
+    g_assert (g_str_has_prefix (&data[start], "$PXXX,no,checksum\r\n"));
+    g_assert (valid);
+
+    offset = end;
+    g_assert (!mm_nmea_sentence_find (data, len, offset, &start, &end, &valid));
+}
+
+/*****************************************************************************/
+/* Test regex cache */
+
+static void
+regex_cache_run_helpers (void)
+{
+    GList        *list;
+    GStrv         strv;
+    GArray       *mem1 = NULL;
+    GArray       *mem2 = NULL;
+    GArray       *mem3 = NULL;
+    GPtrArray    *creg;
+    MMModemCharset charsets = MM_MODEM_CHARSET_UNKNOWN;
+    MMModem3gppFacility facilities = MM_MODEM_3GPP_FACILITY_NONE;
+    guint         sw1 = 0;
+    guint         sw2 = 0;
+    gchar        *hex = NULL;
+    gchar        *str = NULL;
+    guint         state = 0;
+    guint         values[6];
+    gboolean      enabled = FALSE;
+    gboolean      pdu = FALSE;
+    gboolean      text = FALSE;
+    const gchar  *cmgl;
+    gsize         offset = 0;
+    MMSmsStorage  storage1 = MM_SMS_STORAGE_UNKNOWN;
+    MMSmsStorage  storage2 = MM_SMS_STORAGE_UNKNOWN;
+    MMModemCdmaRmProtocol rm_min = MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN;
+    MMModemCdmaRmProtocol rm_max = MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN;
+    MMModemAccessTechnology act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
+    MM3gppPduInfo *info;
+    GHashTable   *table;
+    GByteArray   *array;
+    GRegex       *r;
+
+    g_assert_cmpuint (mm_parse_ifc_test_response ("+IFC (0-2),(0-2)", NULL), !=, MM_FLOW_CONTROL_UNKNOWN);
+
+    list = mm_3gpp_parse_cops_test_response ("+COPS: (2,\"T-Mobile\",\"TMO\",\"31026\",0),,(0-4),(0-2)", NULL);
+    g_assert (list);
+    mm_3gpp_network_info_list_free (list);
+
+    list = mm_3gpp_parse_cgdcont_test_response ("+CGDCONT: (1-10),\"IP\",,,(0,1),(0,1)", NULL);
+    g_assert (list);
+    mm_3gpp_pdp_context_format_list_free (list);
+
+    list = mm_3gpp_parse_cgdcont_read_response ("+CGDCONT: 1,\"IP\",\"internet\",\"0.0.0.0\",0,0", NULL);
+    g_assert (list);
+    mm_3gpp_pdp_context_list_free (list);
+
+    list = mm_3gpp_parse_cgact_read_response ("+CGACT: 1,1", NULL);
+    g_assert (list);
+    mm_3gpp_pdp_context_active_list_free (list);
+
+    g_assert (mm_3gpp_parse_cpms_test_response ("+CPMS: (\"SM\",\"ME\"),(\"SM\",\"ME\"),(\"SM\",\"ME\")", &mem1, &mem2, &mem3));
+    g_array_unref (mem1);
+    g_array_unref (mem2);
+    g_array_unref (mem3);
+
+    g_assert (mm_3gpp_parse_cscs_test_response ("+CSCS: (\"IRA\",\"GSM\",\"UCS2\")", &charsets));
+    g_assert (mm_3gpp_parse_clck_test_response ("+CLCK: (\"SC\",\"PN\")", &facilities));
+
+    g_assert (mm_3gpp_parse_crsm_response ("+CRSM: 144, 0, \"0054485552415941FFFFFFFFFFFFFFFFFF\"", &sw1, &sw2, &hex, NULL));
+    g_free (hex);
+
+    g_assert (mm_3gpp_parse_cfun_query_response ("+CFUN: 1", &state, NULL));
+
+    strv = mm_3gpp_parse_cnum_exec_response ("+CNUM: something,\"+34600000001\",145");
+    g_assert (strv);
+    g_strfreev (strv);
+
+    g_assert (mm_3gpp_parse_cesq_response ("+CESQ: 99,99,255,255,20,80",
+                                           &values[0], &values[1], &values[2],
+                                           &values[3], &values[4], &values[5], NULL));
+
+    g_assert (mm_3gpp_parse_cgcontrdp_response ("+CGCONTRDP: 4,5,\"internet\"",
+                                                &values[0], &values[1], &str,
+                                                NULL, NULL, NULL, NULL, NULL, NULL));
+    g_free (str);
+
+    g_assert (mm_3gpp_parse_cgev_indication_pdp ("+CGEV: REJECT IP, 123.123.123.123", MM_3GPP_CGEV_REJECT,
+                                                 NULL, NULL, NULL, NULL));
+    g_assert (mm_3gpp_parse_cgev_indication_primary ("+CGEV: NW PDN ACT 2", MM_3GPP_CGEV_NW_ACT_PRIMARY,
+                                                     NULL, NULL));
+    g_assert (mm_3gpp_parse_cgev_indication_secondary ("+CGEV: NW ACT 3, 2, 1", MM_3GPP_CGEV_NW_ACT_SECONDARY,
+                                                       NULL, NULL, NULL, NULL));
+
+    table = mm_3gpp_parse_cind_test_response ("+CIND: (\"signal\",(0-5)),(\"service\",(0,1))", NULL);
+    g_assert (table);
+    g_hash_table_unref (table);
+
+    array = mm_3gpp_parse_cind_read_response ("+CIND: 5,1", NULL);
+    g_assert (array);
+    g_byte_array_unref (array);
+
+    g_assert (mm_3gpp_parse_clck_write_response ("+CLCK: 1", &enabled));
+    g_assert (mm_3gpp_parse_cmgf_test_response ("+CMGF: (0-1)", &pdu, &text, NULL));
+
+    info = mm_3gpp_parse_cmgr_read_response ("+CMGR: 0,,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020", 0, NULL);
+    g_assert (info);
+    mm_3gpp_pdu_info_free (info);
+
+    cmgl = "+CMGL: 17,3,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020";
+    info = mm_3gpp_parse_pdu_cmgl_response_next (cmgl, strlen (cmgl), &offset, NULL);
+    g_assert (info);
+    mm_3gpp_pdu_info_free (info);
+
+    g_assert (mm_3gpp_parse_cops_read_response ("+COPS: 1,0,\"CHINA MOBILE\",7",
+                                                &values[0], &values[1], &str, &act, NULL));
+    g_free (str);
+
+    g_assert (mm_3gpp_parse_cpms_query_response ("+CPMS: \"ME\",1,100,\"MT\",5,100,\"TA\",1,100",
+                                                 &storage1, &storage2, NULL));
+
+    g_assert (mm_cdma_parse_crm_test_response ("+CRM: (0-2)", &rm_min, &rm_max, NULL));
+
+    g_assert (mm_parse_cclk_response ("+CCLK: \"14/08/05,04:00:21\"", &str, NULL, NULL));
+    g_free (str);
+
+    g_assert_cmpint (mm_parse_csim_response ("+CSIM:8,\"000063C1\"", NULL), ==, 1);
+
+    r = mm_3gpp_cds_regex_get ();
+    g_regex_unref (r);
+    r = mm_3gpp_cgev_regex_get ();
+    g_regex_unref (r);
+    r = mm_3gpp_ciev_regex_get ();
+    g_regex_unref (r);
+    r = mm_3gpp_cmti_regex_get ();
+    g_regex_unref (r);
+    r = mm_3gpp_cusd_regex_get ();
+    g_regex_unref (r);
+    r = mm_voice_ring_regex_get ();
+    g_regex_unref (r);
+    r = mm_voice_cring_regex_get ();
+    g_regex_unref (r);
+    r = mm_voice_clip_regex_get ();
+    g_regex_unref (r);
+
+    creg = mm_3gpp_creg_regex_get (TRUE);
+    mm_3gpp_creg_regex_destroy (creg);
+}
+
+static gpointer
+regex_cache_thread (gpointer unused)
+{
+    guint i;
+
+    for (i = 0; i < 10; i++)
+        regex_cache_run_helpers ();
+    return NULL;
+}
+
+static void
+test_regex_cache (void *f, gpointer d)
+{
+    GRegex  *a;
+    GRegex  *b;
+    GThread *threads[4];
+    guint    n_compiled;
+    guint    i;
+
+    /* Same pattern and flags give the same compiled regex */
+    a = mm_regex_cache_get ("\\+TEST:\\s*(\\d+)", G_REGEX_RAW, 0, NULL);
+    b = mm_regex_cache_get ("\\+TEST:\\s*(\\d+)", G_REGEX_RAW, 0, NULL);
+    g_assert (a);
+    g_assert (a == b);
+    g_regex_unref (b);
+
+    /* Different flags give a different one */
+    b = mm_regex_cache_get ("\\+TEST:\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    g_assert (b);
+    g_assert (a != b);
+    g_regex_unref (a);
+    g_regex_unref (b);
+
+    /* Invalid patterns are reported and not cached */
+    n_compiled = mm_regex_cache_get_n_compiled ();
+    g_assert (!mm_regex_cache_get ("(", 0, 0, NULL));
+    g_assert_cmpuint (mm_regex_cache_get_n_compiled (), ==, n_compiled);
+
+    /* The first run may compile the patterns used by each helper... */
+    regex_cache_run_helpers ();
+    n_compiled = mm_regex_cache_get_n_compiled ();
+    g_assert_cmpuint (n_compiled, >, 0);
+
+    /* ...but no further compilations are needed afterwards, not even when
+     * running them from several threads at once */
+    regex_cache_run_helpers ();
+    for (i = 0; i < G_N_ELEMENTS (threads); i++)
+        threads[i] = g_thread_new ("regex-cache", regex_cache_thread, NULL);
+    for (i = 0; i < G_N_ELEMENTS (threads); i++)
+        g_thread_join (threads[i]);
+    g_assert_cmpuint (mm_regex_cache_get_n_compiled (), ==, n_compiled);
+}
+
+/*****************************************************************************/
+/* Test the AT serial parsers with the replies of the table-driven tests; the
+ * other replies are tested as they are parsed */
+
+static void
+test_serial_parsers_corpora (void *f, gpointer d)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (cops_query_data); i++)
+        test_serial_parsers (cops_query_data[i].str);
+    for (i = 0; i < G_N_ELEMENTS (cgev_indication_tests); i++)
+        test_serial_parsers (cgev_indication_tests[i].str);
+    for (i = 0; cpms_query_test[i].query; i++)
+        test_serial_parsers (cpms_query_test[i].query);
+    for (i = 0; cclk_tests[i].str; i++)
+        test_serial_parsers (cclk_tests[i].str);
+    for (i = 0; crsm_tests[i].str; i++)
+        test_serial_parsers (crsm_tests[i].str);
+    for (i = 0; i < G_N_ELEMENTS (cgcontrdp_response_tests); i++)
+        test_serial_parsers (cgcontrdp_response_tests[i].str);
+    for (i = 0; i < G_N_ELEMENTS (cfun_query_tests); i++)
+        test_serial_parsers (cfun_query_tests[i].str);
+    for (i = 0; i < G_N_ELEMENTS (cesq_response_tests); i++)
+        test_serial_parsers (cesq_response_tests[i].str);
+    for (i = 0; i < G_N_ELEMENTS (cfun_query_generic_tests); i++)
+        test_serial_parsers (cfun_query_generic_tests[i].str);
+    for (i = 0; i < G_N_ELEMENTS (csim_response_test_list); i++)
+        test_serial_parsers (csim_response_test_list[i].response);
+
+    /* Final result codes alone */
+    test_serial_parsers ("");
+}
+
 /*****************************************************************************/
 
 void
@@ -4214,6 +4678,7 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_generic_multiple, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech_multiple, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cmgl_response_incremental, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_generic, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_telit, NULL));
@@ -4235,11 +4700,18 @@ int main (int argc, char **argv)
 
     g_test_suite_add (suite, TESTCASE (test_cesq_response, NULL));
     g_test_suite_add (suite, TESTCASE (test_cesq_response_to_signal, NULL));
+    g_test_suite_add (suite, TESTCASE (test_signal_samples_statistics, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_nmea_sentence_find, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_parse_uint_list, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_bcd_to_string, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_regex_cache, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_serial_parsers_corpora, NULL));
+
     result = g_test_run ();
 
     reg_test_data_free (reg_data);
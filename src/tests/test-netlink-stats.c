@@ -0,0 +1,190 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <string.h>
+#include <locale.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+/* Define symbol to enable test message traces */
+#undef ENABLE_TEST_MESSAGE_TRACES
+
+#include "mm-netlink-stats.h"
+#include "mm-log.h"
+
+/* The loopback interface is always available, so use it instead of setting
+ * up dummy or veth interfaces, which would require privileges */
+#define TEST_INTERFACE "lo"
+
+#define TEST_PAYLOAD_SIZE 1000
+#define TEST_N_PACKETS    10
+
+/************************************************************/
+
+static gboolean
+read_loopback_stats (guint64 *rx_bytes,
+                     guint64 *tx_bytes)
+{
+    GError *error = NULL;
+
+    if (!mm_netlink_stats_read (TEST_INTERFACE, rx_bytes, tx_bytes, &error)) {
+        /* e.g. when running in a sandbox without netlink access */
+        g_test_message ("couldn't read loopback interface stats: %s", error->message);
+        g_error_free (error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+loopback_is_up (void)
+{
+    struct ifreq ifr;
+    gint         fd;
+    gboolean     up;
+
+    fd = socket (AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return FALSE;
+
+    memset (&ifr, 0, sizeof (ifr));
+    g_strlcpy (ifr.ifr_name, TEST_INTERFACE, sizeof (ifr.ifr_name));
+    up = (ioctl (fd, SIOCGIFFLAGS, &ifr) == 0 && (ifr.ifr_flags & IFF_UP));
+    close (fd);
+    return up;
+}
+
+static void
+test_read (void)
+{
+    guint64 rx_bytes = 0;
+    guint64 tx_bytes = 0;
+
+    if (!read_loopback_stats (&rx_bytes, &tx_bytes)) {
+        g_test_message ("loopback interface stats not available, skipping");
+        return;
+    }
+
+    /* Whatever is sent through the loopback is also received */
+    g_assert_cmpuint (rx_bytes, ==, tx_bytes);
+}
+
+static void
+test_traffic (void)
+{
+    guint64             rx_before = 0;
+    guint64             tx_before = 0;
+    guint64             rx_after = 0;
+    guint64             tx_after = 0;
+    struct sockaddr_in  addr;
+    socklen_t           addr_len;
+    gint                rx_fd;
+    gint                tx_fd;
+    guint8              payload[TEST_PAYLOAD_SIZE];
+    guint               i;
+
+    /* e.g. in network namespaces where it wasn't brought up */
+    if (!loopback_is_up ()) {
+        g_test_message ("loopback interface is down, skipping");
+        return;
+    }
+
+    if (!read_loopback_stats (&rx_before, &tx_before)) {
+        g_test_message ("loopback interface stats not available, skipping");
+        return;
+    }
+
+    rx_fd = socket (AF_INET, SOCK_DGRAM, 0);
+    g_assert_cmpint (rx_fd, >=, 0);
+    tx_fd = socket (AF_INET, SOCK_DGRAM, 0);
+    g_assert_cmpint (tx_fd, >=, 0);
+
+    memset (&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    g_assert_cmpint (bind (rx_fd, (struct sockaddr *) &addr, sizeof (addr)), ==, 0);
+    addr_len = sizeof (addr);
+    g_assert_cmpint (getsockname (rx_fd, (struct sockaddr *) &addr, &addr_len), ==, 0);
+
+    memset (payload, 0xAA, sizeof (payload));
+    for (i = 0; i < TEST_N_PACKETS; i++)
+        g_assert_cmpint (sendto (tx_fd, payload, sizeof (payload), 0, (struct sockaddr *) &addr, sizeof (addr)), ==, sizeof (payload));
+
+    g_assert (read_loopback_stats (&rx_after, &tx_after));
+
+    /* Other traffic may also go through the loopback while testing */
+    g_assert_cmpuint (rx_after - rx_before, >=, TEST_N_PACKETS * TEST_PAYLOAD_SIZE);
+    g_assert_cmpuint (tx_after - tx_before, >=, TEST_N_PACKETS * TEST_PAYLOAD_SIZE);
+
+    close (tx_fd);
+    close (rx_fd);
+}
+
+static void
+test_unknown_interface (void)
+{
+    GError   *error = NULL;
+    guint64   rx_bytes = 0;
+    guint64   tx_bytes = 0;
+    gboolean  ret;
+
+    ret = mm_netlink_stats_read ("mmtest-none0", &rx_bytes, &tx_bytes, &error);
+    g_assert (!ret);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_NOT_FOUND);
+    g_error_free (error);
+}
+
+/************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/netlink-stats/read",              test_read);
+    g_test_add_func ("/MM/netlink-stats/traffic",           test_traffic);
+    g_test_add_func ("/MM/netlink-stats/unknown-interface", test_unknown_interface);
+
+    return g_test_run ();
+}
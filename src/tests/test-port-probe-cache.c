@@ -0,0 +1,408 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <locale.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+/* Define symbol to enable test message traces */
+#undef ENABLE_TEST_MESSAGE_TRACES
+
+#include "mm-kernel-device.h"
+#include "mm-port-probe-cache.h"
+#include "mm-log.h"
+
+/************************************************************/
+/* Kernel device with fixed properties */
+
+#define TEST_TYPE_KERNEL_DEVICE (test_kernel_device_get_type ())
+#define TEST_KERNEL_DEVICE(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), TEST_TYPE_KERNEL_DEVICE, TestKernelDevice))
+
+typedef struct {
+    MMKernelDevice parent;
+    const gchar   *name;
+    const gchar   *driver;
+    const gchar   *interface_number;
+    gint           interface_class;
+    gint           interface_subclass;
+    gint           interface_protocol;
+} TestKernelDevice;
+
+typedef struct {
+    MMKernelDeviceClass parent;
+} TestKernelDeviceClass;
+
+GType test_kernel_device_get_type (void);
+
+G_DEFINE_TYPE (TestKernelDevice, test_kernel_device, MM_TYPE_KERNEL_DEVICE)
+
+static const gchar *
+test_kernel_device_get_subsystem (MMKernelDevice *self)
+{
+    return "tty";
+}
+
+static const gchar *
+test_kernel_device_get_name (MMKernelDevice *self)
+{
+    return TEST_KERNEL_DEVICE (self)->name;
+}
+
+static const gchar *
+test_kernel_device_get_driver (MMKernelDevice *self)
+{
+    return TEST_KERNEL_DEVICE (self)->driver;
+}
+
+static gint
+test_kernel_device_get_interface_class (MMKernelDevice *self)
+{
+    return TEST_KERNEL_DEVICE (self)->interface_class;
+}
+
+static gint
+test_kernel_device_get_interface_subclass (MMKernelDevice *self)
+{
+    return TEST_KERNEL_DEVICE (self)->interface_subclass;
+}
+
+static gint
+test_kernel_device_get_interface_protocol (MMKernelDevice *self)
+{
+    return TEST_KERNEL_DEVICE (self)->interface_protocol;
+}
+
+static guint16
+test_kernel_device_get_physdev_vid (MMKernelDevice *self)
+{
+    return 0x1234;
+}
+
+static guint16
+test_kernel_device_get_physdev_pid (MMKernelDevice *self)
+{
+    return 0x5678;
+}
+
+static guint16
+test_kernel_device_get_physdev_revision (MMKernelDevice *self)
+{
+    return 0x0100;
+}
+
+static const gchar *
+test_kernel_device_get_property (MMKernelDevice *self,
+                                 const gchar    *property)
+{
+    if (g_str_equal (property, "ID_USB_INTERFACE_NUM"))
+        return TEST_KERNEL_DEVICE (self)->interface_number;
+    return NULL;
+}
+
+static void
+test_kernel_device_init (TestKernelDevice *self)
+{
+}
+
+static void
+test_kernel_device_class_init (TestKernelDeviceClass *klass)
+{
+    MMKernelDeviceClass *kernel_device_class = MM_KERNEL_DEVICE_CLASS (klass);
+
+    kernel_device_class->get_subsystem          = test_kernel_device_get_subsystem;
+    kernel_device_class->get_name               = test_kernel_device_get_name;
+    kernel_device_class->get_driver             = test_kernel_device_get_driver;
+    kernel_device_class->get_interface_class    = test_kernel_device_get_interface_class;
+    kernel_device_class->get_interface_subclass = test_kernel_device_get_interface_subclass;
+    kernel_device_class->get_interface_protocol = test_kernel_device_get_interface_protocol;
+    kernel_device_class->get_physdev_vid        = test_kernel_device_get_physdev_vid;
+    kernel_device_class->get_physdev_pid        = test_kernel_device_get_physdev_pid;
+    kernel_device_class->get_physdev_revision   = test_kernel_device_get_physdev_revision;
+    kernel_device_class->get_property           = test_kernel_device_get_property;
+}
+
+static MMKernelDevice *
+test_kernel_device_new (const gchar *name,
+                        const gchar *driver,
+                        const gchar *interface_number)
+{
+    TestKernelDevice *self;
+
+    self = g_object_new (TEST_TYPE_KERNEL_DEVICE, NULL);
+    self->name = name;
+    self->driver = driver;
+    self->interface_number = interface_number;
+    self->interface_class = 0xff;
+    self->interface_subclass = 0xff;
+    self->interface_protocol = 0xff;
+    return MM_KERNEL_DEVICE (self);
+}
+
+/************************************************************/
+
+typedef struct {
+    gchar *dir;
+    gchar *path;
+} TestFixture;
+
+static void
+test_fixture_setup (TestFixture   *fixture,
+                    gconstpointer  unused)
+{
+    fixture->dir = g_dir_make_tmp ("mm-test-probe-cache-XXXXXX", NULL);
+    g_assert (fixture->dir);
+    fixture->path = g_build_filename (fixture->dir, "probe-cache", NULL);
+}
+
+static void
+test_fixture_teardown (TestFixture   *fixture,
+                       gconstpointer  unused)
+{
+    g_unlink (fixture->path);
+    g_rmdir (fixture->dir);
+    g_free (fixture->path);
+    g_free (fixture->dir);
+}
+
+/* Any mask of results, the cache doesn't interpret it */
+#define TEST_FLAGS 0x3f
+
+/* Stores the results of an AT port with vendor and product, which isn't
+ * QCDM, in a new cache file */
+static void
+store_at_port (TestFixture    *fixture,
+               MMKernelDevice *port)
+{
+    MMPortProbeCache        *cache;
+    MMPortProbeCacheResults  results = { 0 };
+
+    cache = mm_port_probe_cache_new (fixture->path);
+    results.flags = TEST_FLAGS;
+    results.is_at = TRUE;
+    results.vendor = g_strdup ("acme");
+    results.product = g_strdup ("rocket 3000");
+    mm_port_probe_cache_store (cache, port, &results, "acme");
+    mm_port_probe_cache_results_clear (&results);
+    mm_port_probe_cache_set_device_n_ports (cache, port, 3);
+
+    /* Pending changes are written when the cache is disposed */
+    g_object_unref (cache);
+    g_assert (g_file_test (fixture->path, G_FILE_TEST_IS_REGULAR));
+}
+
+/* Restores the results of the port from a new cache loaded from the file,
+ * returning the plugin name; results are only set if found */
+static gchar *
+restore_port (TestFixture             *fixture,
+              MMKernelDevice          *port,
+              MMPortProbeCacheResults *out_results)
+{
+    MMPortProbeCache        *cache;
+    MMPortProbeCacheResults  results;
+    gchar                   *plugin_name;
+    gboolean                 has;
+
+    cache = mm_port_probe_cache_new (fixture->path);
+    has = mm_port_probe_cache_has (cache, port);
+    plugin_name = mm_port_probe_cache_restore (cache, port, &results);
+    g_assert_cmpint (has, ==, (plugin_name != NULL));
+    g_object_unref (cache);
+
+    if (!plugin_name)
+        g_assert_cmpuint (results.flags, ==, 0);
+
+    if (out_results)
+        *out_results = results;
+    else
+        mm_port_probe_cache_results_clear (&results);
+    return plugin_name;
+}
+
+static void
+test_round_trip (TestFixture   *fixture,
+                 gconstpointer  unused)
+{
+    MMPortProbeCache        *cache;
+    MMKernelDevice          *port;
+    MMKernelDevice          *other;
+    MMPortProbeCacheResults  results;
+    gchar                   *plugin_name;
+
+    port = test_kernel_device_new ("ttyUSB0", "option", "02");
+    store_at_port (fixture, port);
+
+    plugin_name = restore_port (fixture, port, &results);
+    g_assert_cmpstr (plugin_name, ==, "acme");
+    g_assert_cmpuint (results.flags, ==, TEST_FLAGS);
+    g_assert (results.is_at);
+    g_assert_cmpstr (results.vendor, ==, "acme");
+    g_assert_cmpstr (results.product, ==, "rocket 3000");
+    g_assert (!results.is_icera);
+    g_assert (!results.is_xmm);
+    g_assert (!results.is_qcdm);
+    g_assert (!results.is_qmi);
+    g_assert (!results.is_mbim);
+    g_free (plugin_name);
+    mm_port_probe_cache_results_clear (&results);
+
+    /* Same port with a different kernel name after a reboot */
+    other = test_kernel_device_new ("ttyUSB3", "option", "02");
+    plugin_name = restore_port (fixture, other, NULL);
+    g_assert_cmpstr (plugin_name, ==, "acme");
+    g_free (plugin_name);
+    g_object_unref (other);
+
+    /* Other interface of the same device */
+    other = test_kernel_device_new ("ttyUSB1", "option", "03");
+    g_assert (!restore_port (fixture, other, NULL));
+    g_object_unref (other);
+
+    /* Ports without interface number are never cached */
+    other = test_kernel_device_new ("ttyACM0", "cdc_acm", NULL);
+    g_assert (!restore_port (fixture, other, NULL));
+    g_object_unref (other);
+
+    cache = mm_port_probe_cache_new (fixture->path);
+    g_assert_cmpuint (mm_port_probe_cache_get_device_n_ports (cache, port), ==, 3);
+    g_object_unref (cache);
+
+    g_object_unref (port);
+}
+
+static void
+test_invalidate (TestFixture   *fixture,
+                 gconstpointer  unused)
+{
+    MMPortProbeCache *cache;
+    MMKernelDevice   *port;
+
+    port = test_kernel_device_new ("ttyUSB0", "option", "02");
+    store_at_port (fixture, port);
+
+    cache = mm_port_probe_cache_new (fixture->path);
+    g_assert (mm_port_probe_cache_has (cache, port));
+    mm_port_probe_cache_invalidate (cache, port);
+    g_assert (!mm_port_probe_cache_has (cache, port));
+    g_object_unref (cache);
+
+    /* Invalidation is written to disk too */
+    g_assert (!restore_port (fixture, port, NULL));
+
+    g_object_unref (port);
+}
+
+static void
+test_driver_changed (TestFixture   *fixture,
+                     gconstpointer  unused)
+{
+    MMKernelDevice *port;
+    MMKernelDevice *other;
+
+    port = test_kernel_device_new ("ttyUSB0", "option", "02");
+    store_at_port (fixture, port);
+
+    /* Same interface now bound to a different driver: results dropped */
+    other = test_kernel_device_new ("ttyUSB0", "qcserial", "02");
+    g_assert (!restore_port (fixture, other, NULL));
+    g_object_unref (other);
+
+    /* And not available any more for the original driver either */
+    g_assert (!restore_port (fixture, port, NULL));
+
+    g_object_unref (port);
+}
+
+static void
+test_interface_changed (TestFixture   *fixture,
+                        gconstpointer  unused)
+{
+    MMKernelDevice *port;
+    MMKernelDevice *other;
+
+    port = test_kernel_device_new ("ttyUSB0", "option", "02");
+    store_at_port (fixture, port);
+
+    /* Same interface number and driver, but a different interface protocol,
+     * e.g. after switching the firmware to another USB composition */
+    other = test_kernel_device_new ("ttyUSB0", "option", "02");
+    ((TestKernelDevice *) other)->interface_protocol = 0x12;
+    g_assert (!restore_port (fixture, other, NULL));
+    g_object_unref (other);
+
+    g_assert (!restore_port (fixture, port, NULL));
+
+    g_object_unref (port);
+}
+
+static void
+test_old_format (TestFixture   *fixture,
+                 gconstpointer  unused)
+{
+    MMKernelDevice *port;
+    static const gchar *old_contents =
+        "[port 1234:5678:0100:02:tty]\n"
+        "flags=1\n"
+        "at=true\n"
+        "plugin=acme\n";
+
+    /* Entries without driver can't be validated */
+    g_assert (g_file_set_contents (fixture->path, old_contents, -1, NULL));
+    port = test_kernel_device_new ("ttyUSB0", "option", "02");
+    g_assert (!restore_port (fixture, port, NULL));
+    g_object_unref (port);
+}
+
+/************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+#define TEST_ADD(path, func) \
+    g_test_add (path, TestFixture, NULL, test_fixture_setup, func, test_fixture_teardown)
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    TEST_ADD ("/MM/port-probe-cache/round-trip",        test_round_trip);
+    TEST_ADD ("/MM/port-probe-cache/invalidate",        test_invalidate);
+    TEST_ADD ("/MM/port-probe-cache/driver-changed",    test_driver_changed);
+    TEST_ADD ("/MM/port-probe-cache/interface-changed", test_interface_changed);
+    TEST_ADD ("/MM/port-probe-cache/old-format",        test_old_format);
+
+    return g_test_run ();
+}
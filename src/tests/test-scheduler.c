@@ -0,0 +1,347 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <string.h>
+#include <locale.h>
+
+/* Define symbol to enable test message traces */
+#undef ENABLE_TEST_MESSAGE_TRACES
+
+#include "mm-scheduler.h"
+#include "mm-log.h"
+
+/* Must match the wheel size in mm-scheduler.c */
+#define WHEEL_SLOTS 128
+
+/************************************************************/
+/* The scheduler runs on a fake clock, so that the tests don't need to wait
+ * for the jobs to be due */
+
+typedef struct {
+    MMScheduler *scheduler;
+    gint64       now;
+} TestContext;
+
+typedef struct {
+    TestContext *ctx;
+    const gchar *name;
+    guint        id;
+    guint        n_runs;
+    gboolean     keep;
+    /* Job to remove when run */
+    guint        remove_id;
+} TestJob;
+
+static gint64
+test_clock (TestContext *ctx)
+{
+    return ctx->now;
+}
+
+static TestContext *
+test_context_new (guint slack)
+{
+    TestContext *ctx;
+
+    ctx = g_new0 (TestContext, 1);
+    ctx->now = 1000 * G_USEC_PER_SEC;
+    ctx->scheduler = g_object_new (MM_TYPE_SCHEDULER, NULL);
+    mm_scheduler_set_clock (ctx->scheduler, (MMSchedulerClockFunc) test_clock, ctx);
+    mm_scheduler_set_slack (ctx->scheduler, slack);
+    return ctx;
+}
+
+static void
+test_context_free (TestContext *ctx)
+{
+    g_object_unref (ctx->scheduler);
+    g_free (ctx);
+}
+
+/* Moves the fake clock forward and runs whatever became due */
+static void
+test_context_advance (TestContext *ctx,
+                      guint        seconds)
+{
+    ctx->now += (gint64) seconds * G_USEC_PER_SEC;
+    mm_scheduler_run_pending (ctx->scheduler);
+}
+
+static gboolean
+test_job_cb (TestJob *job)
+{
+    job->n_runs++;
+    if (job->remove_id)
+        g_assert (mm_scheduler_remove (job->ctx->scheduler, job->remove_id));
+    return (job->keep ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE);
+}
+
+static void
+test_job_add (TestContext *ctx,
+              TestJob     *job,
+              const gchar *name,
+              guint        interval)
+{
+    memset (job, 0, sizeof (*job));
+    job->ctx = ctx;
+    job->name = name;
+    job->keep = TRUE;
+    job->id = mm_scheduler_add (ctx->scheduler, NULL, name, interval, (GSourceFunc) test_job_cb, job);
+    g_assert_cmpuint (job->id, !=, 0);
+}
+
+/* Seconds until the next run of the job, as reported by the scheduler;
+ * returns -1 if the job isn't scheduled */
+static gint
+test_job_get_next_run (TestJob *job)
+{
+    GVariant     *jobs;
+    GVariantIter  iter;
+    const gchar  *name;
+    guint         interval;
+    guint         next_run;
+    guint         n_runs;
+    gint          found = -1;
+
+    jobs = mm_scheduler_get_jobs (job->ctx->scheduler);
+    g_variant_iter_init (&iter, jobs);
+    while (g_variant_iter_next (&iter, "(&s&suuu)", NULL, &name, &interval, &next_run, &n_runs)) {
+        if (g_str_equal (name, job->name)) {
+            g_assert_cmpuint (n_runs, ==, job->n_runs);
+            found = (gint) next_run;
+        }
+    }
+    g_variant_unref (jobs);
+    return found;
+}
+
+static guint
+test_count_jobs (TestContext *ctx)
+{
+    GVariant *jobs;
+    guint     n;
+
+    jobs = mm_scheduler_get_jobs (ctx->scheduler);
+    n = g_variant_n_children (jobs);
+    g_variant_unref (jobs);
+    return n;
+}
+
+/************************************************************/
+
+static void
+test_no_slack (void)
+{
+    TestContext *ctx;
+    TestJob      a;
+    TestJob      b;
+
+    ctx = test_context_new (0);
+    test_job_add (ctx, &a, "a", 10);
+    test_job_add (ctx, &b, "b", 8);
+
+    /* Without slack, every job runs at its exact interval */
+    test_context_advance (ctx, 8);
+    g_assert_cmpuint (a.n_runs, ==, 0);
+    g_assert_cmpuint (b.n_runs, ==, 1);
+    test_context_advance (ctx, 2);
+    g_assert_cmpuint (a.n_runs, ==, 1);
+    g_assert_cmpuint (b.n_runs, ==, 1);
+    test_context_advance (ctx, 6);
+    g_assert_cmpuint (a.n_runs, ==, 1);
+    g_assert_cmpuint (b.n_runs, ==, 2);
+
+    test_context_free (ctx);
+}
+
+static void
+test_join_within_slack (void)
+{
+    TestContext *ctx;
+    TestJob      a;
+    TestJob      b;
+
+    ctx = test_context_new (5);
+    test_job_add (ctx, &a, "a", 10);
+    /* Due at 8, but may wait up to 4s, so joins the job due at 10 */
+    test_job_add (ctx, &b, "b", 8);
+    g_assert_cmpint (test_job_get_next_run (&a), ==, 10);
+    g_assert_cmpint (test_job_get_next_run (&b), ==, 10);
+
+    test_context_advance (ctx, 8);
+    g_assert_cmpuint (a.n_runs, ==, 0);
+    g_assert_cmpuint (b.n_runs, ==, 0);
+    test_context_advance (ctx, 2);
+    g_assert_cmpuint (a.n_runs, ==, 1);
+    g_assert_cmpuint (b.n_runs, ==, 1);
+
+    test_context_free (ctx);
+}
+
+static void
+test_slack_capped_to_half_interval (void)
+{
+    TestContext *ctx;
+    TestJob      a;
+    TestJob      b;
+
+    ctx = test_context_new (5);
+    test_job_add (ctx, &a, "a", 10);
+    /* Due at 6, and joining the job due at 10 would delay it 4s, more than
+     * half of its interval */
+    test_job_add (ctx, &b, "b", 6);
+    g_assert_cmpint (test_job_get_next_run (&a), ==, 10);
+    g_assert_cmpint (test_job_get_next_run (&b), ==, 6);
+
+    test_context_advance (ctx, 6);
+    g_assert_cmpuint (a.n_runs, ==, 0);
+    g_assert_cmpuint (b.n_runs, ==, 1);
+
+    test_context_free (ctx);
+}
+
+static void
+test_remove_during_dispatch (void)
+{
+    TestContext *ctx;
+    TestJob      a;
+    TestJob      b;
+    TestJob      c;
+
+    ctx = test_context_new (0);
+    test_job_add (ctx, &a, "a", 10);
+    test_job_add (ctx, &b, "b", 10);
+    test_job_add (ctx, &c, "c", 10);
+
+    /* Jobs due in the same tick run in the order they were added: the first
+     * one removes the second, which must then not run, and the third one
+     * removes itself while asking to be run again */
+    a.remove_id = b.id;
+    c.remove_id = c.id;
+    test_context_advance (ctx, 10);
+    g_assert_cmpuint (a.n_runs, ==, 1);
+    g_assert_cmpuint (b.n_runs, ==, 0);
+    g_assert_cmpuint (c.n_runs, ==, 1);
+    g_assert_cmpuint (test_count_jobs (ctx), ==, 1);
+
+    /* Removed jobs can't be removed again */
+    g_assert (!mm_scheduler_remove (ctx->scheduler, b.id));
+    g_assert (!mm_scheduler_remove (ctx->scheduler, c.id));
+
+    a.remove_id = 0;
+    test_context_advance (ctx, 10);
+    g_assert_cmpuint (a.n_runs, ==, 2);
+    g_assert_cmpuint (b.n_runs, ==, 0);
+    g_assert_cmpuint (c.n_runs, ==, 1);
+
+    test_context_free (ctx);
+}
+
+static void
+test_catch_up (void)
+{
+    TestContext *ctx;
+    TestJob      a;
+    TestJob      b;
+
+    ctx = test_context_new (0);
+    test_job_add (ctx, &a, "a", 10);
+    test_job_add (ctx, &b, "b", 3 * WHEEL_SLOTS);
+
+    /* No dispatch for longer than the whole wheel (e.g. system suspended):
+     * each overdue job runs once, and is then rescheduled from now on */
+    test_context_advance (ctx, 5 * WHEEL_SLOTS / 2);
+    g_assert_cmpuint (a.n_runs, ==, 1);
+    g_assert_cmpuint (b.n_runs, ==, 0);
+    g_assert_cmpint (test_job_get_next_run (&a), ==, 10);
+
+    test_context_advance (ctx, WHEEL_SLOTS);
+    g_assert_cmpuint (a.n_runs, ==, 2);
+    g_assert_cmpuint (b.n_runs, ==, 1);
+    g_assert_cmpint (test_job_get_next_run (&b), ==, 3 * WHEEL_SLOTS);
+
+    test_context_free (ctx);
+}
+
+static void
+test_interval_longer_than_wheel (void)
+{
+    TestContext *ctx;
+    TestJob      a;
+    TestJob      b;
+    guint        i;
+
+    ctx = test_context_new (5);
+    test_job_add (ctx, &a, "a", WHEEL_SLOTS + 20);
+
+    /* Same wheel slot as the long job, but a different tick: must neither
+     * join it nor make it run early */
+    test_context_advance (ctx, 2);
+    test_job_add (ctx, &b, "b", 18);
+    g_assert_cmpint (test_job_get_next_run (&b), ==, 18);
+
+    for (i = 0; i < 20; i++)
+        test_context_advance (ctx, 1);
+    g_assert_cmpuint (a.n_runs, ==, 0);
+    g_assert_cmpuint (b.n_runs, ==, 1);
+
+    /* Tick by tick up to the exact due time of the long job */
+    while (a.n_runs == 0) {
+        g_assert_cmpint (ctx->now, <, (gint64) (1000 + WHEEL_SLOTS + 20) * G_USEC_PER_SEC);
+        test_context_advance (ctx, 1);
+    }
+    g_assert_cmpint (ctx->now, ==, (gint64) (1000 + WHEEL_SLOTS + 20) * G_USEC_PER_SEC);
+    g_assert_cmpint (test_job_get_next_run (&a), ==, WHEEL_SLOTS + 20);
+
+    test_context_free (ctx);
+}
+
+/************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/scheduler/no-slack",                  test_no_slack);
+    g_test_add_func ("/MM/scheduler/join-within-slack",         test_join_within_slack);
+    g_test_add_func ("/MM/scheduler/slack-capped",              test_slack_capped_to_half_interval);
+    g_test_add_func ("/MM/scheduler/remove-during-dispatch",    test_remove_during_dispatch);
+    g_test_add_func ("/MM/scheduler/catch-up",                  test_catch_up);
+    g_test_add_func ("/MM/scheduler/interval-longer-than-wheel", test_interval_longer_than_wheel);
+
+    return g_test_run ();
+}
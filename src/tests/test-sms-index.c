@@ -0,0 +1,253 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <locale.h>
+
+/* Define symbol to enable test message traces */
+#undef ENABLE_TEST_MESSAGE_TRACES
+
+#include "mm-sms-index.h"
+#include "mm-log.h"
+
+/************************************************************/
+
+static void
+test_path (void)
+{
+    MMSmsIndex *index;
+    gint        a;
+    gint        b;
+
+    index = mm_sms_index_new ();
+    mm_sms_index_add (index, &a);
+    mm_sms_index_add (index, &b);
+
+    /* Not exported yet */
+    mm_sms_index_set_path (index, &a, NULL);
+    g_assert (!mm_sms_index_lookup_path (index, "/SMS/0"));
+
+    mm_sms_index_set_path (index, &a, "/SMS/0");
+    mm_sms_index_set_path (index, &b, "/SMS/1");
+    g_assert (mm_sms_index_lookup_path (index, "/SMS/0") == &a);
+    g_assert (mm_sms_index_lookup_path (index, "/SMS/1") == &b);
+
+    /* Unexported */
+    mm_sms_index_set_path (index, &a, NULL);
+    g_assert (!mm_sms_index_lookup_path (index, "/SMS/0"));
+
+    mm_sms_index_remove (index, &b);
+    g_assert (!mm_sms_index_lookup_path (index, "/SMS/1"));
+
+    mm_sms_index_free (index);
+}
+
+static void
+test_part (void)
+{
+    MMSmsIndex *index;
+    gint        a;
+    gint        b;
+
+    index = mm_sms_index_new ();
+    mm_sms_index_add (index, &a);
+    mm_sms_index_add (index, &b);
+
+    mm_sms_index_add_part (index, &a, MM_SMS_STORAGE_SM, 1);
+    mm_sms_index_add_part (index, &a, MM_SMS_STORAGE_SM, 2);
+    mm_sms_index_add_part (index, &b, MM_SMS_STORAGE_ME, 1);
+
+    /* Same index in different storages */
+    g_assert (mm_sms_index_lookup_part (index, MM_SMS_STORAGE_SM, 1) == &a);
+    g_assert (mm_sms_index_lookup_part (index, MM_SMS_STORAGE_SM, 2) == &a);
+    g_assert (mm_sms_index_lookup_part (index, MM_SMS_STORAGE_ME, 1) == &b);
+    g_assert (!mm_sms_index_lookup_part (index, MM_SMS_STORAGE_ME, 2));
+
+    /* Removing a message doesn't drop the part indexes reused by another one */
+    mm_sms_index_add_part (index, &b, MM_SMS_STORAGE_SM, 2);
+    mm_sms_index_remove (index, &a);
+    g_assert (!mm_sms_index_lookup_part (index, MM_SMS_STORAGE_SM, 1));
+    g_assert (mm_sms_index_lookup_part (index, MM_SMS_STORAGE_SM, 2) == &b);
+    g_assert (mm_sms_index_lookup_part (index, MM_SMS_STORAGE_ME, 1) == &b);
+
+    mm_sms_index_free (index);
+}
+
+static void
+test_multipart_reference (void)
+{
+    MMSmsIndex *index;
+    GList      *l;
+    gint        a;
+    gint        b;
+    gint        c;
+
+    index = mm_sms_index_new ();
+    mm_sms_index_add (index, &a);
+    mm_sms_index_add (index, &b);
+    mm_sms_index_add (index, &c);
+
+    mm_sms_index_set_multipart_reference (index, &a, "+1234", 7);
+    mm_sms_index_set_multipart_reference (index, &b, "+1234", 7);
+    mm_sms_index_set_multipart_reference (index, &c, "+5678", 7);
+
+    /* Most recently added first */
+    l = mm_sms_index_lookup_multipart_reference (index, "+1234", 7);
+    g_assert_cmpuint (g_list_length (l), ==, 2);
+    g_assert (l->data == &b);
+    g_assert (l->next->data == &a);
+
+    l = mm_sms_index_lookup_multipart_reference (index, "+5678", 7);
+    g_assert_cmpuint (g_list_length (l), ==, 1);
+    g_assert (l->data == &c);
+
+    g_assert (!mm_sms_index_lookup_multipart_reference (index, "+1234", 8));
+    g_assert (!mm_sms_index_lookup_multipart_reference (index, NULL, 7));
+
+    /* Re-indexed under a different reference */
+    mm_sms_index_set_multipart_reference (index, &b, "+1234", 8);
+    l = mm_sms_index_lookup_multipart_reference (index, "+1234", 7);
+    g_assert_cmpuint (g_list_length (l), ==, 1);
+    g_assert (l->data == &a);
+    l = mm_sms_index_lookup_multipart_reference (index, "+1234", 8);
+    g_assert_cmpuint (g_list_length (l), ==, 1);
+    g_assert (l->data == &b);
+
+    mm_sms_index_remove (index, &a);
+    g_assert (!mm_sms_index_lookup_multipart_reference (index, "+1234", 7));
+
+    mm_sms_index_free (index);
+}
+
+/************************************************************/
+/* Reassembly of bursts of concatenated messages, the way MMSmsList does it */
+
+#define PARTS_PER_MESSAGE 3
+
+typedef struct {
+    gchar number[16];
+    guint reference;
+    guint n_parts;
+} TestSms;
+
+/* Returns the number of candidate messages the lookups by multipart
+ * reference gave; with references shared among many messages a linear scan
+ * of a bucket would show up here */
+static guint
+run_burst (guint n_messages)
+{
+    MMSmsIndex *index;
+    TestSms    *messages;
+    guint       n_candidates = 0;
+    guint       i;
+    guint       part;
+
+    messages = g_new0 (TestSms, n_messages);
+    for (i = 0; i < n_messages; i++) {
+        g_snprintf (messages[i].number, sizeof (messages[i].number), "+%u", 1000 + (i / 255));
+        messages[i].reference = 1 + (i % 255);
+    }
+
+    index = mm_sms_index_new ();
+
+    /* Parts of all messages arrive interleaved */
+    for (part = 0; part < PARTS_PER_MESSAGE; part++) {
+        for (i = 0; i < n_messages; i++) {
+            TestSms *sms = &messages[i];
+            guint    part_index;
+            GList   *l;
+
+            part_index = part * n_messages + i;
+            g_assert (!mm_sms_index_lookup_part (index, MM_SMS_STORAGE_SM, part_index));
+
+            l = mm_sms_index_lookup_multipart_reference (index, sms->number, sms->reference);
+            n_candidates += g_list_length (l);
+            if (l)
+                g_assert (l->data == sms);
+            else {
+                gchar path[64];
+
+                g_assert_cmpuint (sms->n_parts, ==, 0);
+                mm_sms_index_add (index, sms);
+                mm_sms_index_set_multipart_reference (index, sms, sms->number, sms->reference);
+                g_snprintf (path, sizeof (path), "/org/freedesktop/ModemManager1/SMS/%u", i);
+                mm_sms_index_set_path (index, sms, path);
+            }
+            mm_sms_index_add_part (index, sms, MM_SMS_STORAGE_SM, part_index);
+            sms->n_parts++;
+        }
+    }
+
+    /* And then all get deleted */
+    for (i = 0; i < n_messages; i++) {
+        gchar    path[64];
+        gpointer sms;
+
+        g_snprintf (path, sizeof (path), "/org/freedesktop/ModemManager1/SMS/%u", i);
+        sms = mm_sms_index_lookup_path (index, path);
+        g_assert (sms == &messages[i]);
+        g_assert_cmpuint (messages[i].n_parts, ==, PARTS_PER_MESSAGE);
+        g_assert (mm_sms_index_lookup_part (index, MM_SMS_STORAGE_SM, i) == sms);
+        mm_sms_index_remove (index, sms);
+        g_assert (!mm_sms_index_lookup_part (index, MM_SMS_STORAGE_SM, i));
+    }
+
+    mm_sms_index_free (index);
+    g_free (messages);
+    return n_candidates;
+}
+
+static void
+test_burst_scales_linearly (void)
+{
+    /* Every part after the first one of each message finds exactly its own
+     * message, however many messages there are */
+    g_assert_cmpuint (run_burst (2000), ==, 2000 * (PARTS_PER_MESSAGE - 1));
+    g_assert_cmpuint (run_burst (16000), ==, 16000 * (PARTS_PER_MESSAGE - 1));
+}
+
+/************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/sms-index/path",                test_path);
+    g_test_add_func ("/MM/sms-index/part",                test_part);
+    g_test_add_func ("/MM/sms-index/multipart-reference", test_multipart_reference);
+    g_test_add_func ("/MM/sms-index/burst",               test_burst_scales_linearly);
+
+    return g_test_run ();
+}
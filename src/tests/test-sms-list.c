@@ -0,0 +1,393 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <locale.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+/* Define symbol to enable test message traces */
+#undef ENABLE_TEST_MESSAGE_TRACES
+
+#include "mm-base-modem.h"
+#include "mm-base-sms.h"
+#include "mm-sms-part.h"
+#include "mm-sms-list.h"
+#include "mm-log.h"
+
+/************************************************************/
+/* MMSmsList is built along with this test; the modem and SMS objects it
+ * uses would otherwise need the whole daemon to be linked, so provide
+ * minimal implementations of them here */
+
+G_DEFINE_ABSTRACT_TYPE (MMBaseModem, mm_base_modem, MM_GDBUS_TYPE_OBJECT_SKELETON)
+
+static void
+mm_base_modem_init (MMBaseModem *self)
+{
+}
+
+static void
+mm_base_modem_class_init (MMBaseModemClass *klass)
+{
+}
+
+struct _MMBaseSmsPrivate {
+    gchar    *path;
+    gboolean  is_multipart;
+    guint     multipart_reference;
+    GList    *parts;
+};
+
+enum {
+    PROP_0,
+    PROP_PATH,
+};
+
+G_DEFINE_TYPE (MMBaseSms, mm_base_sms, MM_GDBUS_TYPE_SMS_SKELETON)
+
+static MMBaseSms *
+test_sms_new (const gchar  *number,
+              MMSmsPduType  pdu_type,
+              MMSmsStorage  storage)
+{
+    MMBaseSms *self;
+
+    self = g_object_new (MM_TYPE_BASE_SMS, NULL);
+    mm_gdbus_sms_set_number (MM_GDBUS_SMS (self), number);
+    mm_gdbus_sms_set_pdu_type (MM_GDBUS_SMS (self), pdu_type);
+    mm_gdbus_sms_set_storage (MM_GDBUS_SMS (self), storage);
+    return self;
+}
+
+/* Same as storing the SMS, which doesn't tell the list */
+static void
+test_sms_store (MMBaseSms    *self,
+                MMSmsStorage  storage,
+                guint         reference,
+                guint         first_index,
+                guint         n_parts)
+{
+    guint i;
+
+    mm_gdbus_sms_set_storage (MM_GDBUS_SMS (self), storage);
+    self->priv->is_multipart = (n_parts > 1);
+    self->priv->multipart_reference = reference;
+    for (i = 0; i < n_parts; i++)
+        self->priv->parts = g_list_append (self->priv->parts,
+                                           mm_sms_part_new (first_index + i, MM_SMS_PDU_TYPE_SUBMIT));
+}
+
+MMBaseSms *
+mm_base_sms_singlepart_new (MMBaseModem   *modem,
+                            MMSmsState     state,
+                            MMSmsStorage   storage,
+                            MMSmsPart     *part,
+                            GError       **error)
+{
+    MMBaseSms *self;
+
+    self = test_sms_new (mm_sms_part_get_number (part), mm_sms_part_get_pdu_type (part), storage);
+    self->priv->parts = g_list_append (NULL, part);
+    return self;
+}
+
+MMBaseSms *
+mm_base_sms_multipart_new (MMBaseModem   *modem,
+                           MMSmsState     state,
+                           MMSmsStorage   storage,
+                           guint          reference,
+                           guint          max_parts,
+                           MMSmsPart     *first_part,
+                           GError       **error)
+{
+    MMBaseSms *self;
+
+    self = mm_base_sms_singlepart_new (modem, state, storage, first_part, error);
+    self->priv->is_multipart = TRUE;
+    self->priv->multipart_reference = reference;
+    return self;
+}
+
+gboolean
+mm_base_sms_multipart_take_part (MMBaseSms  *self,
+                                 MMSmsPart  *part,
+                                 GError    **error)
+{
+    self->priv->parts = g_list_append (self->priv->parts, part);
+    return TRUE;
+}
+
+void
+mm_base_sms_unexport (MMBaseSms *self)
+{
+    g_object_set (self, MM_BASE_SMS_PATH, NULL, NULL);
+}
+
+const gchar *
+mm_base_sms_get_path (MMBaseSms *self)
+{
+    return self->priv->path;
+}
+
+MMSmsStorage
+mm_base_sms_get_storage (MMBaseSms *self)
+{
+    return mm_gdbus_sms_get_storage (MM_GDBUS_SMS (self));
+}
+
+gboolean
+mm_base_sms_has_part_index (MMBaseSms *self,
+                            guint      index)
+{
+    GList *l;
+
+    for (l = self->priv->parts; l; l = g_list_next (l)) {
+        if (mm_sms_part_get_index ((MMSmsPart *) l->data) == index)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+GList *
+mm_base_sms_get_parts (MMBaseSms *self)
+{
+    return self->priv->parts;
+}
+
+gboolean
+mm_base_sms_is_multipart (MMBaseSms *self)
+{
+    return self->priv->is_multipart;
+}
+
+guint
+mm_base_sms_get_multipart_reference (MMBaseSms *self)
+{
+    return self->priv->multipart_reference;
+}
+
+void
+mm_base_sms_delete (MMBaseSms           *self,
+                    GAsyncReadyCallback  callback,
+                    gpointer             user_data)
+{
+    GTask *task;
+
+    task = g_task_new (self, NULL, callback, user_data);
+    g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+gboolean
+mm_base_sms_delete_finish (MMBaseSms     *self,
+                           GAsyncResult  *res,
+                           GError       **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+set_property (GObject      *object,
+              guint         prop_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+    MMBaseSms *self = MM_BASE_SMS (object);
+
+    switch (prop_id) {
+    case PROP_PATH:
+        g_free (self->priv->path);
+        self->priv->path = g_value_dup_string (value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+get_property (GObject    *object,
+              guint       prop_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+    MMBaseSms *self = MM_BASE_SMS (object);
+
+    switch (prop_id) {
+    case PROP_PATH:
+        g_value_set_string (value, self->priv->path);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+mm_base_sms_init (MMBaseSms *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MM_TYPE_BASE_SMS, MMBaseSmsPrivate);
+}
+
+static void
+finalize (GObject *object)
+{
+    MMBaseSms *self = MM_BASE_SMS (object);
+
+    g_list_free_full (self->priv->parts, (GDestroyNotify) mm_sms_part_free);
+    g_free (self->priv->path);
+
+    G_OBJECT_CLASS (mm_base_sms_parent_class)->finalize (object);
+}
+
+static void
+mm_base_sms_class_init (MMBaseSmsClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMBaseSmsPrivate));
+
+    object_class->get_property = get_property;
+    object_class->set_property = set_property;
+    object_class->finalize = finalize;
+
+    g_object_class_install_property
+        (object_class, PROP_PATH,
+         g_param_spec_string (MM_BASE_SMS_PATH,
+                              "Path",
+                              "DBus path of the SMS",
+                              NULL,
+                              G_PARAM_READWRITE));
+}
+
+/************************************************************/
+
+static MMSmsPart *
+received_part (guint index,
+               guint reference,
+               guint sequence)
+{
+    MMSmsPart *part;
+
+    part = mm_sms_part_new (index, MM_SMS_PDU_TYPE_DELIVER);
+    mm_sms_part_set_number (part, "+1234");
+    mm_sms_part_set_concat_reference (part, reference);
+    mm_sms_part_set_concat_max (part, 2);
+    mm_sms_part_set_concat_sequence (part, sequence);
+    return part;
+}
+
+static void
+test_local_multipart_stored (void)
+{
+    MMSmsList *list;
+    MMBaseSms *sms;
+
+    list = mm_sms_list_new (NULL);
+
+    /* Created by the user: no multipart reference nor parts stored yet */
+    sms = test_sms_new ("+1234", MM_SMS_PDU_TYPE_SUBMIT, MM_SMS_STORAGE_UNKNOWN);
+    g_object_set (sms, MM_BASE_SMS_PATH, "/org/freedesktop/ModemManager1/SMS/0", NULL);
+    mm_sms_list_add_sms (list, sms);
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 1);
+    g_assert (!mm_sms_list_has_local_multipart_reference (list, "+1234", 5));
+    g_assert (!mm_sms_list_has_part (list, MM_SMS_STORAGE_ME, 3));
+
+    /* Stored afterwards, without the list being told */
+    test_sms_store (sms, MM_SMS_STORAGE_ME, 5, 3, 2);
+    g_assert (mm_sms_list_has_local_multipart_reference (list, "+1234", 5));
+    g_assert (!mm_sms_list_has_local_multipart_reference (list, "+1234", 6));
+    g_assert (!mm_sms_list_has_local_multipart_reference (list, "+5678", 5));
+    g_assert (mm_sms_list_has_part (list, MM_SMS_STORAGE_ME, 3));
+    g_assert (mm_sms_list_has_part (list, MM_SMS_STORAGE_ME, 4));
+    g_assert (!mm_sms_list_has_part (list, MM_SMS_STORAGE_ME, 5));
+    g_assert (!mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 3));
+
+    /* Parts of a received message with the same reference don't clash */
+    g_assert (mm_sms_list_take_part (list, received_part (0, 5, 1), MM_SMS_STATE_RECEIVED, MM_SMS_STORAGE_SM, NULL));
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 2);
+    g_assert (mm_sms_list_has_local_multipart_reference (list, "+1234", 5));
+
+    g_object_unref (sms);
+    g_object_unref (list);
+}
+
+static void
+test_received_multipart (void)
+{
+    MMSmsList *list;
+    MMSmsPart *part;
+    GError    *error = NULL;
+
+    list = mm_sms_list_new (NULL);
+
+    g_assert (mm_sms_list_take_part (list, received_part (1, 7, 1), MM_SMS_STATE_RECEIVED, MM_SMS_STORAGE_SM, &error));
+    g_assert_no_error (error);
+    g_assert (mm_sms_list_take_part (list, received_part (2, 7, 2), MM_SMS_STATE_RECEIVED, MM_SMS_STORAGE_SM, &error));
+    g_assert_no_error (error);
+
+    /* Both parts went to the same message, found by part index */
+    g_assert_cmpuint (mm_sms_list_get_count (list), ==, 1);
+    g_assert (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 1));
+    g_assert (mm_sms_list_has_part (list, MM_SMS_STORAGE_SM, 2));
+    g_assert (!mm_sms_list_has_part (list, MM_SMS_STORAGE_ME, 1));
+
+    /* The same part can't be taken twice */
+    part = received_part (2, 7, 2);
+    g_assert (!mm_sms_list_take_part (list, part, MM_SMS_STATE_RECEIVED, MM_SMS_STORAGE_SM, &error));
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED);
+    g_clear_error (&error);
+    mm_sms_part_free (part);
+
+    /* Received messages aren't local */
+    g_assert (!mm_sms_list_has_local_multipart_reference (list, "+1234", 7));
+
+    g_object_unref (list);
+}
+
+/************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/sms-list/local-multipart-stored", test_local_multipart_stored);
+    g_test_add_func ("/MM/sms-list/received-multipart",     test_received_multipart);
+
+    return g_test_run ();
+}
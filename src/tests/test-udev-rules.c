@@ -18,6 +18,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <locale.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
 
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
@@ -44,6 +46,232 @@ test_load_cleanup_core (void)
     g_array_unref (rules);
 }
 
+/************************************************************/
+/* All shipped rules, core and plugins, applied to test devices */
+
+static gchar *
+setup_all_rules_dir (void)
+{
+    static const gchar *dirs[] = { TESTUDEVRULESDIR, TESTUDEVRULESDIR "../plugins" };
+    gchar *rules_dir;
+    guint  i;
+
+    rules_dir = g_dir_make_tmp ("mm-test-udev-rules-XXXXXX", NULL);
+    g_assert (rules_dir);
+
+    for (i = 0; i < G_N_ELEMENTS (dirs); i++) {
+        GDir        *dir;
+        const gchar *name;
+
+        dir = g_dir_open (dirs[i], 0, NULL);
+        g_assert (dir);
+        while ((name = g_dir_read_name (dir)) != NULL) {
+            gchar       *path;
+            GDir        *plugin_dir;
+            const gchar *plugin_file;
+
+            path = g_build_filename (dirs[i], name, NULL);
+            if (g_str_has_suffix (name, ".rules")) {
+                gchar *link_path;
+
+                link_path = g_build_filename (rules_dir, name, NULL);
+                g_assert_cmpint (symlink (path, link_path), ==, 0);
+                g_free (link_path);
+            } else if ((plugin_dir = g_dir_open (path, 0, NULL)) != NULL) {
+                while ((plugin_file = g_dir_read_name (plugin_dir)) != NULL) {
+                    gchar *link_path;
+                    gchar *plugin_path;
+
+                    if (!g_str_has_suffix (plugin_file, ".rules"))
+                        continue;
+                    plugin_path = g_build_filename (path, plugin_file, NULL);
+                    link_path = g_build_filename (rules_dir, plugin_file, NULL);
+                    g_assert_cmpint (symlink (plugin_path, link_path), ==, 0);
+                    g_free (plugin_path);
+                    g_free (link_path);
+                }
+                g_dir_close (plugin_dir);
+            }
+            g_free (path);
+        }
+        g_dir_close (dir);
+    }
+
+    return rules_dir;
+}
+
+static void
+cleanup_all_rules_dir (gchar *rules_dir)
+{
+    GDir        *dir;
+    const gchar *name;
+
+    dir = g_dir_open (rules_dir, 0, NULL);
+    g_assert (dir);
+    while ((name = g_dir_read_name (dir)) != NULL) {
+        gchar *path;
+
+        path = g_build_filename (rules_dir, name, NULL);
+        g_unlink (path);
+        g_free (path);
+    }
+    g_dir_close (dir);
+    g_rmdir (rules_dir);
+    g_free (rules_dir);
+}
+
+static gconstpointer
+test_device_get_property (GQuark   name,
+                          gpointer user_data)
+{
+    return g_hash_table_lookup ((GHashTable *) user_data, GUINT_TO_POINTER (name));
+}
+
+static void
+test_device_set_property (GQuark         name,
+                          gpointer       value,
+                          GDestroyNotify value_free,
+                          gpointer       user_data)
+{
+    g_hash_table_insert ((GHashTable *) user_data,
+                         GUINT_TO_POINTER (name),
+                         value_free ? value : g_strdup ((const gchar *) value));
+}
+
+static GHashTable *
+apply_rules (GArray  *rules,
+             guint16  vid,
+             guint16  pid,
+             guint8   interface_number)
+{
+    MMUdevRuleDevice  device = { 0 };
+    GHashTable       *props;
+
+    props = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+    device.subsystem          = "tty";
+    device.name               = "ttyUSB0";
+    device.sysfs_path         = "/sys/devices/pci0000:00/0000:00:14.0/usb1/1-2/1-2:1.0/ttyUSB0/tty/ttyUSB0";
+    device.driver             = "option";
+    device.vid                = vid;
+    device.pid                = pid;
+    device.interface_class    = 0xff;
+    device.interface_number   = interface_number;
+    device.get_property       = test_device_get_property;
+    device.set_property       = test_device_set_property;
+    device.user_data          = props;
+
+    mm_kernel_device_generic_rules_apply (rules, &device);
+    return props;
+}
+
+static const gchar *
+get_property (GHashTable  *props,
+              const gchar *name)
+{
+    return g_hash_table_lookup (props, GUINT_TO_POINTER (g_quark_from_string (name)));
+}
+
+static void
+test_apply_all (void)
+{
+    GArray     *rules;
+    GError     *error = NULL;
+    gchar      *rules_dir;
+    GHashTable *props;
+
+    rules_dir = setup_all_rules_dir ();
+    rules = mm_kernel_device_generic_rules_load (rules_dir, &error);
+    g_assert_no_error (error);
+    g_assert (rules);
+
+    /* Blacklisted by vid only */
+    props = apply_rules (rules, 0x051d, 0x0002, 0);
+    g_assert_cmpstr (get_property (props, "ID_MM_DEVICE_IGNORE"), ==, "1");
+    g_assert_cmpstr (get_property (props, "ID_MM_CANDIDATE"), ==, "1");
+    g_hash_table_unref (props);
+
+    /* Blacklisted by vid and pid */
+    props = apply_rules (rules, 0x0925, 0x1234, 0);
+    g_assert_cmpstr (get_property (props, "ID_MM_DEVICE_IGNORE"), ==, "1");
+    g_hash_table_unref (props);
+
+    /* Same vid, different pid */
+    props = apply_rules (rules, 0x0925, 0x1235, 0);
+    g_assert (!get_property (props, "ID_MM_DEVICE_IGNORE"));
+    g_hash_table_unref (props);
+
+    /* Port type tags depending on a previously set property */
+    props = apply_rules (rules, 0x19d2, 0x0001, 0);
+    g_assert_cmpstr (get_property (props, ".MM_USBIFNUM"), ==, "00");
+    g_assert_cmpstr (get_property (props, "ID_MM_PORT_TYPE_AT_PRIMARY"), ==, "1");
+    g_assert (!get_property (props, "ID_MM_PORT_TYPE_AT_SECONDARY"));
+    g_hash_table_unref (props);
+
+    props = apply_rules (rules, 0x19d2, 0x0001, 2);
+    g_assert_cmpstr (get_property (props, ".MM_USBIFNUM"), ==, "02");
+    g_assert (!get_property (props, "ID_MM_PORT_TYPE_AT_PRIMARY"));
+    g_assert_cmpstr (get_property (props, "ID_MM_PORT_TYPE_AT_SECONDARY"), ==, "1");
+    g_hash_table_unref (props);
+
+    /* Unknown device */
+    props = apply_rules (rules, 0x1234, 0x5678, 0);
+    g_assert (!get_property (props, "ID_MM_DEVICE_IGNORE"));
+    g_assert (!get_property (props, "ID_MM_PORT_TYPE_AT_PRIMARY"));
+    g_assert_cmpstr (get_property (props, "ID_MM_CANDIDATE"), ==, "1");
+    g_hash_table_unref (props);
+
+    g_array_unref (rules);
+    cleanup_all_rules_dir (rules_dir);
+}
+
+static void
+test_apply_benchmark (void)
+{
+    static const guint16 vid_pids[][2] = {
+        { 0x051d, 0x0002 },
+        { 0x19d2, 0x0001 },
+        { 0x12d1, 0x1506 },
+        { 0x1199, 0x68a3 },
+        { 0x1234, 0x5678 },
+    };
+    GArray *rules;
+    GError *error = NULL;
+    gchar  *rules_dir;
+    GTimer *timer;
+    guint   n_iterations;
+    guint   i;
+    gdouble elapsed;
+
+    rules_dir = setup_all_rules_dir ();
+    rules = mm_kernel_device_generic_rules_load (rules_dir, &error);
+    g_assert_no_error (error);
+    g_assert (rules);
+
+    n_iterations = (g_test_perf () ? 20000 : 500);
+
+    timer = g_timer_new ();
+    for (i = 0; i < n_iterations; i++) {
+        GHashTable *props;
+
+        props = apply_rules (rules,
+                             vid_pids[i % G_N_ELEMENTS (vid_pids)][0],
+                             vid_pids[i % G_N_ELEMENTS (vid_pids)][1],
+                             i % 4);
+        g_hash_table_unref (props);
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_timer_destroy (timer);
+
+    g_test_message ("%u rules applied to %u ports in %.3fs: %.2fus per port",
+                    rules->len, n_iterations, elapsed, (elapsed * G_USEC_PER_SEC) / n_iterations);
+    g_test_minimized_result ((elapsed * G_USEC_PER_SEC) / n_iterations,
+                             "%.2fus per port", (elapsed * G_USEC_PER_SEC) / n_iterations);
+
+    g_array_unref (rules);
+    cleanup_all_rules_dir (rules_dir);
+}
+
 /************************************************************/
 
 void
@@ -73,6 +301,8 @@ int main (int argc, char **argv)
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/MM/test-udev-rules/load-cleanup-core", test_load_cleanup_core);
+    g_test_add_func ("/MM/test-udev-rules/apply-all", test_apply_all);
+    g_test_add_func ("/MM/test-udev-rules/apply-benchmark", test_apply_benchmark);
 
     return g_test_run ();
 }